@@ -1,16 +1,36 @@
 """
 AsymmetricLP - Telegram Alert Manager
 Handles notifications for rebalances, errors, and system events
+
+Alerts are only enqueued on the caller's thread; a background sender
+delivers them, so a slow or unreachable Telegram API never stalls the
+monitoring loop. Repeated errors are coalesced and sends are rate limited.
 """
 import logging
+import threading
+import time
 import requests
-import json
+from collections import deque
+from dataclasses import dataclass
 from typing import Dict, Any, Optional
 from datetime import datetime
 from config import Config
 
 logger = logging.getLogger(__name__)
 
+
+@dataclass
+class _Alert:
+    """A queued message; duplicates of a pending keyed alert bump its count"""
+    text: str
+    parse_mode: str
+    key: Optional[str]
+    critical: bool
+    enqueued_at: float
+    not_before: float = 0.0
+    count: int = 1
+
+
 class TelegramAlertManager:
     """Manages Telegram notifications for the rebalancer"""
     
@@ -25,12 +45,31 @@ class TelegramAlertManager:
         self.bot_token = config.TELEGRAM_BOT_TOKEN
         self.chat_id = config.TELEGRAM_CHAT_ID
         self.enabled = config.TELEGRAM_ENABLED
+        self.api_url = config.TELEGRAM_API_URL.rstrip('/')
+        self.queue_size = config.ALERT_QUEUE_SIZE
+        self.coalesce_window = config.ALERT_COALESCE_WINDOW_SECONDS
+        self.rate_per_minute = config.ALERT_RATE_LIMIT_PER_MINUTE
+        self.send_timeout = config.ALERT_SEND_TIMEOUT_SECONDS
+        
+        self._cond = threading.Condition()
+        self._queue: deque = deque()
+        self._pending: Dict[str, _Alert] = {}
+        self._last_sent: Dict[str, float] = {}
+        self._tokens = float(self.rate_per_minute)
+        self._tokens_at = time.monotonic()
+        self._in_flight = 0
+        self._running = False
+        self._thread: Optional[threading.Thread] = None
+        self._session = requests.Session()
+        
+        self.stats = {'queued': 0, 'sent': 0, 'failed': 0, 'coalesced': 0,
+                      'dropped': 0, 'rate_limited': 0}
         
         if self.enabled:
             logger.info("Telegram alerts enabled")
-            # Test connection
-            if not self._test_connection():
-                logger.warning("Telegram connection test failed - alerts may not work")
+            self._running = True
+            self._thread = threading.Thread(target=self._sender_loop, name='telegram-alerts', daemon=True)
+            self._thread.start()
         else:
             logger.info("Telegram alerts disabled (missing bot token or chat ID)")
     
@@ -42,30 +81,134 @@ class TelegramAlertManager:
             True if connection successful, False otherwise
         """
         try:
-            url = f"https://api.telegram.org/bot{self.bot_token}/getMe"
-            response = requests.get(url, timeout=10)
+            url = f"{self.api_url}/bot{self.bot_token}/getMe"
+            response = self._session.get(url, timeout=self.send_timeout)
             return response.status_code == 200
         except Exception as e:
             logger.error(f"Telegram connection test failed: {e}")
             return False
     
-    def _send_message(self, message: str, parse_mode: str = "HTML") -> bool:
+    def _send_message(self, message: str, parse_mode: str = "HTML",
+                      coalesce_key: Optional[str] = None, critical: bool = False) -> bool:
         """
-        Send message to Telegram
+        Queue a message for Telegram (never blocks on the network)
         
         Args:
             message: Message to send
             parse_mode: Message parse mode (HTML or Markdown)
+            coalesce_key: Alerts sharing a key are merged while one is pending,
+                          and sent at most once per ALERT_COALESCE_WINDOW_SECONDS
+            critical: Never dropped when the queue is full
             
         Returns:
-            True if message sent successfully, False otherwise
+            True if the message was queued (or merged into a queued one)
         """
         if not self.enabled:
             logger.debug("Telegram alerts disabled - not sending message")
             return False
         
+        now = time.monotonic()
+        with self._cond:
+            if coalesce_key is not None:
+                pending = self._pending.get(coalesce_key)
+                if pending is not None:
+                    pending.count += 1
+                    self.stats['coalesced'] += 1
+                    return True
+            
+            if len(self._queue) >= self.queue_size:
+                # Drop the oldest non-critical alert to make room. Critical alerts
+                # are never dropped and may overfill a queue holding only critical ones.
+                victim = next((a for a in self._queue if not a.critical), None)
+                if victim is None and not critical:
+                    self.stats['dropped'] += 1
+                    return False
+                if victim is not None:
+                    self._queue.remove(victim)
+                    if victim.key is not None:
+                        self._pending.pop(victim.key, None)
+                    self.stats['dropped'] += 1
+            
+            alert = _Alert(message, parse_mode, coalesce_key, critical, now)
+            if coalesce_key is not None:
+                alert.not_before = self._last_sent.get(coalesce_key, float('-inf')) + self.coalesce_window
+                self._pending[coalesce_key] = alert
+            self._queue.append(alert)
+            self.stats['queued'] += 1
+            self._cond.notify()
+        return True
+    
+    # ------------------------------------------------------------------ sender
+    
+    def _take_token(self, now: float) -> float:
+        """Consume a rate-limit token; returns seconds to wait if none is available (lock held)"""
+        if self.rate_per_minute <= 0:
+            return 0.0  # 0 disables the limit
+        capacity = float(self.rate_per_minute)
+        self._tokens = min(capacity, self._tokens + (now - self._tokens_at) * capacity / 60.0)
+        self._tokens_at = now
+        if self._tokens >= 1.0:
+            self._tokens -= 1.0
+            return 0.0
+        return (1.0 - self._tokens) * 60.0 / capacity
+    
+    def _next_alert(self) -> Optional[_Alert]:
+        """Block until an alert is due and a rate-limit token is available"""
+        with self._cond:
+            while True:
+                if not self._queue and not self._running:
+                    return None
+                now = time.monotonic()
+                due = next((a for a in self._queue if a.not_before <= now or not self._running), None)
+                if due is None:
+                    timeout = min(a.not_before for a in self._queue) - now if self._queue else None
+                    self._cond.wait(timeout)
+                    continue
+                wait = self._take_token(now)
+                if wait > 0:
+                    self.stats['rate_limited'] += 1
+                    self._cond.wait(wait)
+                    continue
+                self._queue.remove(due)
+                if due.key is not None:
+                    self._pending.pop(due.key, None)
+                    self._last_sent[due.key] = now
+                self._in_flight += 1
+                return due
+    
+    def _sender_loop(self):
+        if not self._test_connection():
+            logger.warning("Telegram connection test failed - alerts may not work")
+        while True:
+            alert = self._next_alert()
+            if alert is None:
+                return
+            try:
+                text = alert.text
+                if alert.count > 1:
+                    text += f"\n\n🔁 Repeated {alert.count}× within {self.coalesce_window:.0f}s"
+                retry_after = self._post(text, alert.parse_mode)
+                if retry_after is not None:
+                    # Telegram asked us to back off: requeue at the front
+                    with self._cond:
+                        alert.not_before = time.monotonic() + retry_after
+                        self._queue.appendleft(alert)
+                        if alert.key is not None:
+                            self._pending.setdefault(alert.key, alert)
+            finally:
+                with self._cond:
+                    self._in_flight -= 1
+                    self._cond.notify_all()
+    
+    def _post(self, message: str, parse_mode: str) -> Optional[float]:
+        """
+        Deliver one message (sender thread only)
+        
+        Returns:
+            Seconds Telegram asked us to wait before retrying, or None when done
+        """
         try:
-            url = f"https://api.telegram.org/bot{self.bot_token}/sendMessage"
+            url = f"{self.api_url}/bot{self.bot_token}/sendMessage"
             data = {
                 'chat_id': self.chat_id,
                 'text': message,
@@ -73,18 +216,77 @@ class TelegramAlertManager:
                 'disable_web_page_preview': True
             }
             
-            response = requests.post(url, data=data, timeout=10)
+            response = self._session.post(url, data=data, timeout=self.send_timeout)
             
             if response.status_code == 200:
                 logger.debug("Telegram message sent successfully")
-                return True
-            else:
-                logger.error(f"Failed to send Telegram message: {response.status_code} - {response.text}")
-                return False
+                self.stats['sent'] += 1
+                return None
+            if response.status_code == 429:
+                try:
+                    retry_after = float(response.json()['parameters']['retry_after'])
+                except Exception:
+                    retry_after = 5.0
+                logger.warning(f"Telegram rate limit hit; retrying in {retry_after:.0f}s")
+                return retry_after
+            logger.error(f"Failed to send Telegram message: {response.status_code} - {response.text}")
+            self.stats['failed'] += 1
+            return None
                 
         except Exception as e:
             logger.error(f"Error sending Telegram message: {e}")
-            return False
+            self.stats['failed'] += 1
+            return None
+    
+    def flush(self, timeout: float = 10.0) -> bool:
+        """
+        Wait for queued alerts to be delivered
+        
+        Coalesced alerts still wait out ALERT_COALESCE_WINDOW_SECONDS, so a
+        flush shorter than the window can time out; close() sends them at once.
+        
+        Args:
+            timeout: Maximum seconds to wait
+            
+        Returns:
+            True if the queue drained in time
+        """
+        deadline = time.monotonic() + timeout
+        with self._cond:
+            while self._queue or self._in_flight:
+                remaining = deadline - time.monotonic()
+                if remaining <= 0:
+                    return False
+                self._cond.wait(remaining)
+            return True
+    
+    def close(self, timeout: float = 10.0):
+        """
+        Deliver whatever is queued (coalescing delays are skipped) and stop the sender
+        
+        Args:
+            timeout: Maximum seconds to spend draining
+        """
+        if not self._thread:
+            return
+        with self._cond:
+            self._running = False
+            self._cond.notify_all()
+        self._thread.join(timeout=timeout)
+        self._thread = None
+        with self._cond:
+            if self._queue:
+                logger.warning(f"{len(self._queue)} Telegram alerts undelivered at shutdown")
+    
+    def get_stats(self) -> Dict[str, Any]:
+        """
+        Alert queue counters
+        
+        Returns:
+            Counters plus current queue depth
+        """
+        with self._cond:
+            return dict(self.stats, queue_depth=len(self._queue))
     
     def send_rebalance_notification(self, 
                                   token_a_symbol: str, 
@@ -174,7 +376,7 @@ class TelegramAlertManager:
 ⚠️ Please check the logs for more details.
         """.strip()
         
-        return self._send_message(message)
+        return self._send_message(message, coalesce_key=f"error:{error_type}")
     
     def send_startup_notification(self, 
                                  token_a_symbol: str,
@@ -230,7 +432,7 @@ class TelegramAlertManager:
 👋 Monitoring stopped
         """.strip()
         
-        return self._send_message(message)
+        return self._send_message(message, critical=True)
     
     def send_critical_alert(self, 
                            alert_type: str,
@@ -261,4 +463,4 @@ class TelegramAlertManager:
 {'⚡ Please take immediate action!' if action_required else '📋 Please review when convenient.'}
         """.strip()
         
-        return self._send_message(alert_message)
+        return self._send_message(alert_message, coalesce_key=f"critical:{alert_type}", critical=True)
@@ -4,13 +4,20 @@ Based on Uniswap V3 math from Skewed_LP_AMM notebook
 """
 import pandas as pd
 import math
+from array import array
 from typing import List, Tuple, Optional
 from dataclasses import dataclass
 from datetime import datetime
 from abc import ABC, abstractmethod
 import logging
+import fastlog
 
 logger = logging.getLogger(__name__)
+_log = fastlog.get_logger(__name__)
+
+MSG_SWAP = fastlog.message("AMM Simulator: {} at {:.6f} (move: {:.4%}, sold_t0: {:.6f}, sold_t1: {:.6f}, "
+                           "fees_t0: {:.6f}, fees_t1: {:.6f})")
+MSG_POSITION_BALANCES = fastlog.message("Active positions balances: token0={:.6f}, token1={:.2f}")
 
 @dataclass
 class SwapEvent:
@@ -29,7 +36,14 @@ class SwapEvent:
 
 class Record:
     """Record for tracking range position state changes"""
+    __slots__ = ('balance_token1', 'balance_token0', 'sold_token0', 'bought_token0', 'sold_token1',
+                 'bought_token1', 'fees_token0', 'fees_token1', 'range_lower', 'range_upper')
+
     def __init__(self):
+        self.reset()
+
+    def reset(self):
+        """Zero every field so the record can be reused for the next swap"""
         self.balance_token1 = 0.0
         self.balance_token0 = 0.0
         self.sold_token0 = 0.0
@@ -42,6 +56,98 @@ class Record:
         self.range_upper = 0.0
 
 
+class SwapEventArena:
+    """
+    Append-only columnar store of swap events
+
+    Events are written field by field into preallocated float columns (grown
+    by doubling), so recording a swap creates no per-event objects. A SwapEvent
+    is only built when a caller asks for one with event(index).
+    """
+    FIELDS = ('price', 'liquidity_size', 'liquidity_share', 'fees_token0', 'fees_token1',
+              'volume_usd', 'new_token0_balance', 'new_token1_balance')
+
+    def __init__(self, capacity: int = 1024):
+        capacity = max(int(capacity), 1)
+        self.count = 0
+        self.timestamps = [None] * capacity
+        self.is_buy = bytearray(capacity)
+        for name in self.FIELDS:
+            setattr(self, name, array('d', [0.0]) * capacity)
+
+    def __len__(self) -> int:
+        return self.count
+
+    @property
+    def capacity(self) -> int:
+        return len(self.timestamps)
+
+    def _grow(self):
+        capacity = self.capacity
+        self.timestamps.extend([None] * capacity)
+        self.is_buy.extend(bytes(capacity))
+        for name in self.FIELDS:
+            getattr(self, name).extend(array('d', [0.0]) * capacity)
+
+    def append(self, timestamp, price, is_buy, liquidity_size, liquidity_share, fees_token0, fees_token1,
+               volume_usd, new_token0_balance, new_token1_balance) -> int:
+        """Write one event; returns its index"""
+        index = self.count
+        if index == len(self.timestamps):
+            self._grow()
+        self.timestamps[index] = timestamp
+        self.is_buy[index] = is_buy
+        self.price[index] = price
+        self.liquidity_size[index] = liquidity_size
+        self.liquidity_share[index] = liquidity_share
+        self.fees_token0[index] = fees_token0
+        self.fees_token1[index] = fees_token1
+        self.volume_usd[index] = volume_usd
+        self.new_token0_balance[index] = new_token0_balance
+        self.new_token1_balance[index] = new_token1_balance
+        self.count = index + 1
+        return index
+
+    def clear(self):
+        """Forget all events but keep the allocated columns"""
+        self.count = 0
+
+    def __getstate__(self):
+        # Pickle only the recorded events, not the spare capacity or cleared slots
+        count = self.count
+        state = {name: getattr(self, name)[:count] for name in self.FIELDS}
+        state.update(count=count, timestamps=self.timestamps[:count], is_buy=self.is_buy[:count])
+        return state
+
+    def __setstate__(self, state):
+        self.__dict__.update(state)
+        if self.count == 0:
+            self.timestamps.append(None)
+            self.is_buy.append(0)
+            for name in self.FIELDS:
+                getattr(self, name).append(0.0)
+
+    def trade_type(self, index: int) -> str:
+        return 'buy' if self.is_buy[index] else 'sell'
+
+    def event(self, index: int) -> SwapEvent:
+        """Materialize event index as a SwapEvent"""
+        if not 0 <= index < self.count:
+            raise IndexError(f"swap event {index} out of range ({self.count} events)")
+        return SwapEvent(
+            timestamp=self.timestamps[index],
+            price=self.price[index],
+            trade_type=self.trade_type(index),
+            liquidity_size=self.liquidity_size[index],
+            liquidity_share=self.liquidity_share[index],
+            fees_token0=self.fees_token0[index],
+            fees_token1=self.fees_token1[index],
+            volume_usd=self.volume_usd[index],
+            new_token0_balance=self.new_token0_balance[index],
+            new_token1_balance=self.new_token1_balance[index]
+        )
+
+
 class UniswapV3SingleSidedRange(ABC):
     """
     Base class for single-sided Uniswap V3 range positions
@@ -326,6 +432,11 @@ class AMMSimulator:
         # Track last price for swap detection
         self.last_price = None
 
+        # Scratch state reused by every compute_into() call
+        self._token0_record = Record()
+        self._token1_record = Record()
+        self._events = SwapEventArena(capacity=1)
+
     def compute(self, ohlc_row: pd.Series) -> Optional[SwapEvent]:
         """
         Process single OHLC row and calculate liquidity changes
@@ -336,27 +447,45 @@ class AMMSimulator:
         Returns:
             SwapEvent if liquidity changes detected, None otherwise
         """
-        timestamp = ohlc_row['timestamp']
-        close_price = ohlc_row['close']
+        self._events.clear()
+        index = self.compute_into(ohlc_row['timestamp'], ohlc_row['close'], self._events)
+        return self._events.event(index) if index >= 0 else None
 
+    def compute_into(self, timestamp, close_price: float, events: SwapEventArena) -> int:
+        """
+        Process one bar and append the swap (if any) to an event arena
+
+        Same detection and math as compute(), but the range records are reused
+        scratch objects and the event is written into the arena's columns, so a
+        bar allocates no event objects.
+
+        Args:
+            timestamp: Bar timestamp
+            close_price: Bar close (token1/token0)
+            events: Arena the swap event is appended to
+
+        Returns:
+            Index of the event in the arena, or -1 if no swap was detected
+        """
         # Initialize last price if not set
         if self.last_price is None:
             self.last_price = close_price
-            return None
+            return -1
 
         # Only process if we have active positions
         if not self.has_active_positions():
             self.last_price = close_price
-            return None
+            return -1
 
         # Calculate price movement
         price_change_pct = abs(close_price - self.last_price) / self.last_price
 
         # Detect significant price movements
         if price_change_pct > self.trade_detection_threshold:
-            # Create records for swap
-            token0_record = Record()
-            token1_record = Record()
+            token0_record = self._token0_record
+            token1_record = self._token1_record
+            token0_record.reset()
+            token1_record.reset()
 
             # Process swap through Uniswap V3 pool (this updates position balances)
             self.pool.swap(close_price, token0_record, token1_record)
@@ -370,13 +499,13 @@ class AMMSimulator:
             fees_token1 = token0_record.fees_token1 + token1_record.fees_token1
 
             # Calculate trade metrics
-            trade_type = 'buy' if close_price > self.last_price else 'sell'
-            
+            is_buy = close_price > self.last_price
+
             # Calculate liquidity size based on what was actually traded
             sold_token0 = token0_record.sold_token0 + token1_record.sold_token0
             sold_token1 = token0_record.sold_token1 + token1_record.sold_token1
-            
-            if trade_type == 'buy':
+
+            if is_buy:
                 # Price went up - selling token0 for token1
                 liquidity_size = sold_token0
                 # token0 is in token0 units (e.g., USD); use as USD volume
@@ -386,36 +515,20 @@ class AMMSimulator:
                 liquidity_size = sold_token1
                 # Convert token1 sold into token0 (USD) using 1/price
                 volume_usd = sold_token1 * (1.0 / close_price)
-            
+
             liquidity_share = price_change_pct
 
             # Update last price
             self.last_price = close_price
 
-            # Create swap event with updated balances
-            swap_event = SwapEvent(
-                timestamp=timestamp,
-                price=close_price,
-                trade_type=trade_type,
-                liquidity_size=liquidity_size,
-                liquidity_share=liquidity_share,
-                fees_token0=fees_token0,
-                fees_token1=fees_token1,
-                volume_usd=volume_usd,
-                new_token0_balance=new_token0_balance,
-                new_token1_balance=new_token1_balance
-            )
-
-            logger.debug(
-                f"AMM Simulator: {trade_type} at {close_price:.6f} (move: {price_change_pct:.4%}, "
-                f"sold_t0: {sold_token0:.6f}, sold_t1: {sold_token1:.6f}, "
-                f"fees_t0: {fees_token0:.6f}, fees_t1: {fees_token1:.6f})"
-            )
-            return swap_event
+            _log.debug(MSG_SWAP, 'buy' if is_buy else 'sell', close_price, price_change_pct,
+                       sold_token0, sold_token1, fees_token0, fees_token1)
+            return events.append(timestamp, close_price, is_buy, liquidity_size, liquidity_share,
+                                 fees_token0, fees_token1, volume_usd, new_token0_balance, new_token1_balance)
 
         # DO NOT update last_price if no swap occurred - we need to track actual AMM spot rate
         # If minute 1 had no trade, minute 2 should compare against minute 1's price
-        return None
+        return -1
 
 
     def get_active_positions_balances(self) -> Tuple[float, float]:
@@ -437,7 +550,7 @@ class AMMSimulator:
             token0_balance += self.pool.token1_range.balance_token0
             token1_balance += self.pool.token1_range.balance_token1
 
-        logger.debug(f"Active positions balances: token0={token0_balance:.6f}, token1={token1_balance:.2f}")
+        _log.debug(MSG_POSITION_BALANCES, token0_balance, token1_balance)
         return token0_balance, token1_balance
 
     def has_active_positions(self) -> bool:
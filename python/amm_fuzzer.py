@@ -0,0 +1,425 @@
+"""
+AsymmetricLP - AMM Invariant Fuzzer
+Generates random mint/swap sequences against AMMSimulator (the path the
+backtest takes: mint_bands_percent, then compute() per bar) and checks
+every step against an independent model of each single-sided range:
+
+- negative_balance: neither range ever holds a negative amount
+- conservation: balances equal the V3 curve of the range's liquidity at
+  the last (clipped) price plus the fees collected so far, where the fee
+  is the fee tier times the amount the range sold
+- round_trip: back at the mint price, balances minus fees equal the deposit
+- orientation: a price rise sells token0 and buys token1, a fall the
+  reverse, and trade_type says which
+- no_value_creation: ex-fee value never exceeds holding the deposit
+  (impermanent loss is never a gain)
+- fee_growth: per-event fees are non-negative and match the model
+- event_balances: the SwapEvent reports the balances the ranges hold
+
+A failing sequence is shrunk (drop chunks, drop steps, simplify numbers)
+while the same invariant still fails, and can be written out as a pytest
+reproducer under tests/.
+"""
+import argparse
+import hashlib
+import logging
+import math
+import os
+import random
+import sys
+import time
+from dataclasses import dataclass
+from typing import Any, Callable, List, Optional, Sequence, Tuple
+
+from amm import AMMSimulator
+
+logger = logging.getLogger(__name__)
+
+# ('mint', price, range_a_pct, range_b_pct, amount0, amount1) or ('swap', price)
+Step = Tuple[Any, ...]
+
+REL_TOL = 1e-9
+# Roundoff grows with 1/(sqrt(upper) - sqrt(lower)): narrow bands lose digits
+# to cancellation, so each range's tolerance scales with its conditioning
+ULP_SLACK = 64 * sys.float_info.epsilon
+FEE_TIERS_BPS = (1, 5, 30, 100)
+
+
+@dataclass
+class Violation:
+    """An invariant that failed at one step of a sequence"""
+    invariant: str
+    step: int
+    message: str
+
+    def __str__(self):
+        return f"{self.invariant} at step {self.step}: {self.message}"
+
+
+class _RangeModel:
+    """Expected state of one minted range, computed independently of amm.py's swap code"""
+
+    def __init__(self, position, mint_price: float, fee: float):
+        self.position = position
+        self.deposit0 = position.balance_token0
+        self.deposit1 = position.balance_token1
+        self.mint_price = mint_price
+        self.fee = fee
+        self.fees0 = 0.0
+        self.fees1 = 0.0
+        self.price = mint_price
+        sL, sU = math.sqrt(position.range_lower), math.sqrt(position.range_upper)
+        self.tol = REL_TOL + ULP_SLACK * sU / (sU - sL) if sU > sL else math.inf
+
+    def curve(self, price: float) -> Tuple[float, float]:
+        """Ex-fee balances at price on this range's curve"""
+        p = self.position
+        s = math.sqrt(min(max(price, p.range_lower), p.range_upper))
+        return p.liquidity * (1.0 / s - 1.0 / math.sqrt(p.range_upper)), p.liquidity * (s - math.sqrt(p.range_lower))
+
+    def advance(self, price: float) -> Tuple[float, float]:
+        """Move to price; returns the fees this move earns (token0, token1)"""
+        (was0, was1), (now0, now1) = self.curve(self.price), self.curve(price)
+        fee0 = self.fee * (was0 - now0) if now0 < was0 else 0.0
+        fee1 = self.fee * (was1 - now1) if now1 < was1 else 0.0
+        self.fees0 += fee0
+        self.fees1 += fee1
+        self.price = price
+        return fee0, fee1
+
+    def scale(self, price: float) -> Tuple[float, float]:
+        """Magnitudes (token0, token1) the tolerances are relative to"""
+        return max(self.deposit0, self.deposit1 / price), max(self.deposit1, self.deposit0 * price)
+
+
+def _close(a: float, b: float, scale: float, tol: float = REL_TOL) -> bool:
+    return abs(a - b) <= tol * max(scale, abs(a), abs(b), 1e-300)
+
+
+class AMMInvariantChecker:
+    """Replays one sequence against a fresh AMMSimulator and its model"""
+
+    def __init__(self, fee_tier_bps: int = 5):
+        self.simulator = AMMSimulator(fee_tier_bps=fee_tier_bps, trade_detection_threshold=0.0)
+        self.fee = self.simulator.fee_tier_percent
+        self.models: List[_RangeModel] = []
+        self.price: Optional[float] = None
+        self.bar = 0
+
+    def mint(self, price: float, range_a: float, range_b: float, amount0: float, amount1: float):
+        pool = self.simulator.pool
+        self.simulator.clear_all_positions()
+        self.simulator.last_price = price
+        self.simulator.mint_bands_percent(price, range_a, range_b, amount0, amount1)
+        self.models = [_RangeModel(r, price, self.fee) for r in (pool.token0_range, pool.token1_range)
+                       if r is not None]
+        self.price = price
+        for model in self.models:
+            deposit = model.curve(price)
+            if not (_close(deposit[0], model.deposit0, model.scale(price)[0], model.tol)
+                    and _close(deposit[1], model.deposit1, model.scale(price)[1], model.tol)):
+                return 'round_trip', f"minted liquidity puts {deposit} at the mint price, deposit was " \
+                                     f"{model.deposit0}/{model.deposit1}"
+        return None
+
+    def swap(self, price: float) -> Optional[Tuple[str, str]]:
+        previous, self.price = self.price, price
+        balances = [(m.position.balance_token0, m.position.balance_token1) for m in self.models]
+        self.bar += 1
+        event = self.simulator.compute({'timestamp': self.bar, 'close': price})
+        if not self.models or price == previous:
+            return None
+        if event is None:
+            return 'orientation', f"no swap event for {previous} -> {price}"
+
+        fees0 = fees1 = 0.0
+        for model in self.models:
+            fee0, fee1 = model.advance(price)
+            fees0, fees1 = fees0 + fee0, fees1 + fee1
+        scale0 = sum(m.scale(price)[0] for m in self.models)
+        scale1 = sum(m.scale(price)[1] for m in self.models)
+        tol = max(m.tol for m in self.models)
+
+        if event.fees_token0 < 0 or event.fees_token1 < 0 or not (
+                _close(event.fees_token0, fees0, scale0, tol) and _close(event.fees_token1, fees1, scale1, tol)):
+            return 'fee_growth', f"event fees {event.fees_token0}/{event.fees_token1}, expected {fees0}/{fees1}"
+        total0 = sum(m.position.balance_token0 for m in self.models)
+        total1 = sum(m.position.balance_token1 for m in self.models)
+        if not (_close(event.new_token0_balance, total0, scale0, tol)
+                and _close(event.new_token1_balance, total1, scale1, tol)):
+            return 'event_balances', (f"event {event.new_token0_balance}/{event.new_token1_balance} "
+                                      f"!= ranges {total0}/{total1}")
+
+        rising = price > previous
+        if event.trade_type != ('buy' if rising else 'sell'):
+            return 'orientation', f"{previous} -> {price} reported as {event.trade_type}"
+        for (was0, was1), model in zip(balances, self.models):
+            d0 = model.position.balance_token0 - was0
+            d1 = model.position.balance_token1 - was1
+            tol0, tol1 = (model.tol * s for s in model.scale(price))
+            if (rising and (d0 > tol0 or d1 < -tol1)) or (not rising and (d0 < -tol0 or d1 > tol1)):
+                return 'orientation', f"{previous} -> {price} moved token0 by {d0}, token1 by {d1}"
+        return None
+
+    def check(self) -> Optional[Tuple[str, str]]:
+        """State invariants after a step"""
+        for model in self.models:
+            p = model.position
+            if p.balance_token0 < 0 or p.balance_token1 < 0:
+                return 'negative_balance', f"balances {p.balance_token0}/{p.balance_token1}"
+            want0, want1 = model.curve(self.price)
+            scale0, scale1 = model.scale(self.price)
+            if not (_close(p.balance_token0, want0 + model.fees0, scale0, model.tol)
+                    and _close(p.balance_token1, want1 + model.fees1, scale1, model.tol)):
+                return 'conservation', (f"balances {p.balance_token0}/{p.balance_token1} != curve {want0}/{want1} "
+                                        f"+ fees {model.fees0}/{model.fees1} at {self.price}")
+            ex0, ex1 = p.balance_token0 - model.fees0, p.balance_token1 - model.fees1
+            if self.price == model.mint_price and not (
+                    _close(ex0, model.deposit0, scale0, model.tol) and _close(ex1, model.deposit1, scale1, model.tol)):
+                return 'round_trip', f"back at {self.price}: {ex0}/{ex1} != deposit {model.deposit0}/{model.deposit1}"
+            held = model.deposit0 * self.price + model.deposit1
+            value = ex0 * self.price + ex1
+            if value > held + model.tol * max(held, scale1):
+                return 'no_value_creation', f"ex-fee value {value} > held value {held} at {self.price}"
+        return None
+
+
+def run_sequence(steps: Sequence[Step], fee_tier_bps: int = 5) -> Optional[Violation]:
+    """
+    Replay steps and return the first invariant violation
+
+    Args:
+        steps: Mint/swap steps
+        fee_tier_bps: Pool fee tier
+
+    Returns:
+        Violation, or None if every invariant held
+    """
+    checker = AMMInvariantChecker(fee_tier_bps)
+    for index, step in enumerate(steps):
+        try:
+            failure = checker.mint(*step[1:]) if step[0] == 'mint' else checker.swap(step[1])
+            failure = failure or checker.check()
+        except (ValueError, ZeroDivisionError, OverflowError) as e:
+            failure = ('exception', f"{type(e).__name__}: {e}")
+        if failure is not None:
+            return Violation(failure[0], index, failure[1])
+    return None
+
+
+# ---------------------------------------------------------------- generation
+
+def random_price(rng: random.Random, price: float) -> float:
+    """Next price: mostly small moves, sometimes jumps, band edges and repeats"""
+    roll = rng.random()
+    if roll < 0.6:
+        return price * math.exp(rng.gauss(0.0, 0.002))
+    if roll < 0.8:
+        return price * math.exp(rng.gauss(0.0, 0.05))
+    if roll < 0.9:
+        return price * rng.choice((0.5, 0.9, 0.999, 1.0, 1.001, 1.1, 2.0))
+    return price * math.exp(rng.uniform(-3.0, 3.0))
+
+
+def random_sequence(rng: random.Random, max_steps: int = 64) -> List[Step]:
+    """A mint followed by swaps, with occasional re-mints at the current price"""
+    price = 10 ** rng.uniform(-6, 6)
+    steps: List[Step] = []
+    for _ in range(rng.randint(2, max_steps)):
+        if not steps or rng.random() < 0.08:
+            width = lambda: rng.choice((1e-6, 1e-4, 0.01, 0.1, 0.5, 0.95, rng.uniform(1e-4, 0.9)))
+            amount = lambda: rng.choice((0.0, 1e-9, 1.0, 3000.0, 1e12, 10 ** rng.uniform(-6, 9)))
+            steps.append(('mint', price, width(), width(), amount(), amount()))
+        else:
+            price = random_price(rng, price)
+            steps.append(('swap', price))
+    return steps
+
+
+# ---------------------------------------------------------------- shrinking
+
+def _simplify(value: float) -> List[float]:
+    """Simpler stand-ins for a number (fewer significant digits)"""
+    if value == 0 or not math.isfinite(value):
+        return []
+    candidates = []
+    for digits in (1, 2, 4, 8):
+        simpler = float(f"{value:.{digits}g}")
+        if simpler != value and simpler not in candidates:
+            candidates.append(simpler)
+    return candidates
+
+
+def shrink(steps: List[Step], violation: Violation, fee_tier_bps: int = 5,
+           max_runs: int = 20000) -> Tuple[List[Step], Violation]:
+    """
+    Smallest sequence (greedy) that still violates the same invariant
+
+    Args:
+        steps: Failing sequence
+        violation: Its violation
+        fee_tier_bps: Pool fee tier
+        max_runs: Replay budget
+
+    Returns:
+        (shrunk steps, their violation)
+    """
+    runs = 0
+
+    def fails(candidate: List[Step]) -> Optional[Violation]:
+        nonlocal runs
+        runs += 1
+        found = run_sequence(candidate, fee_tier_bps)
+        return found if found is not None and found.invariant == violation.invariant else None
+
+    steps = list(steps[:violation.step + 1])
+    changed = True
+    while changed and runs < max_runs:
+        changed = False
+        # Drop chunks, halving the chunk size
+        chunk = len(steps) // 2
+        while chunk >= 1 and runs < max_runs:
+            start = 0
+            while start < len(steps) and runs < max_runs:
+                candidate = steps[:start] + steps[start + chunk:]
+                found = fails(candidate) if candidate else None
+                if found:
+                    steps, violation, changed = candidate[:found.step + 1], found, True
+                else:
+                    start += chunk
+            chunk //= 2
+        # Simplify numbers
+        index = 0
+        while index < len(steps) and runs < max_runs:
+            for position in range(1, len(steps[index])):
+                for simpler in _simplify(steps[index][position]):
+                    step = steps[index][:position] + (simpler,) + steps[index][position + 1:]
+                    candidate = steps[:index] + [step] + steps[index + 1:]
+                    found = fails(candidate)
+                    if found:
+                        steps, violation, changed = candidate[:found.step + 1], found, True
+                        break
+                if index >= len(steps):
+                    break
+            index += 1
+    return steps, violation
+
+
+# ---------------------------------------------------------------- reproducers
+
+def reproducer_source(steps: Sequence[Step], violation: Violation, fee_tier_bps: int, seed: Any) -> str:
+    """pytest module that replays a shrunk failing sequence"""
+    lines = ',\n'.join(f"    {step!r}" for step in steps)
+    return (f'"""AMM fuzzer reproducer (seed {seed}): {violation.invariant}"""\n'
+            f"import os\nimport sys\n\n"
+            f"sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))\n"
+            f"from amm_fuzzer import run_sequence\n\n"
+            f"# {violation}\nSTEPS = [\n{lines}\n]\n\n\n"
+            f"def test_{violation.invariant}():\n"
+            f"    assert run_sequence(STEPS, fee_tier_bps={fee_tier_bps}) is None\n")
+
+
+def write_reproducer(directory: str, steps: Sequence[Step], violation: Violation,
+                     fee_tier_bps: int, seed: Any) -> str:
+    """Write the reproducer as tests/test_amm_repro_<invariant>_<hash>.py; returns the path"""
+    digest = hashlib.sha1(repr((steps, fee_tier_bps)).encode()).hexdigest()[:10]
+    path = os.path.join(directory, f"test_amm_repro_{violation.invariant}_{digest}.py")
+    with open(path, 'w') as f:
+        f.write(reproducer_source(steps, violation, fee_tier_bps, seed))
+    return path
+
+
+# ---------------------------------------------------------------- driver
+
+@dataclass
+class FuzzStats:
+    sequences: int = 0
+    steps: int = 0
+    seconds: float = 0.0
+    failures: int = 0
+
+
+def fuzz(seed: int, seconds: float = 10.0, max_steps: int = 64, max_sequences: Optional[int] = None,
+         on_failure: Optional[Callable[[List[Step], Violation, int], None]] = None,
+         max_failures: int = 1) -> FuzzStats:
+    """
+    Run random sequences until the time or sequence budget is spent
+
+    Args:
+        seed: RNG seed (each sequence's fee tier and steps derive from it)
+        seconds: Time budget
+        max_steps: Steps per sequence
+        max_sequences: Sequence budget (unbounded if None)
+        on_failure: Called with (shrunk steps, violation, fee tier) for each failure
+        max_failures: Stop after this many failures
+
+    Returns:
+        FuzzStats
+    """
+    rng = random.Random(seed)
+    stats = FuzzStats()
+    started = time.perf_counter()
+    deadline = started + seconds
+    while time.perf_counter() < deadline and (max_sequences is None or stats.sequences < max_sequences):
+        fee_tier = rng.choice(FEE_TIERS_BPS)
+        steps = random_sequence(rng, max_steps)
+        stats.sequences += 1
+        stats.steps += len(steps)
+        violation = run_sequence(steps, fee_tier)
+        if violation is None:
+            continue
+        stats.failures += 1
+        shrunk, violation = shrink(steps, violation, fee_tier)
+        logger.error(f"Invariant violated ({len(steps)} -> {len(shrunk)} steps): {violation}")
+        if on_failure:
+            on_failure(shrunk, violation, fee_tier)
+        if stats.failures >= max_failures:
+            break
+    stats.seconds = time.perf_counter() - started
+    return stats
+
+
+def _fuzz_worker(args):
+    seed, seconds, max_steps, emit_dir = args
+    failures = []
+
+    def record(steps, violation, fee_tier):
+        path = write_reproducer(emit_dir, steps, violation, fee_tier, seed) if emit_dir else None
+        failures.append((str(violation), path))
+    stats = fuzz(seed, seconds, max_steps, on_failure=record)
+    return stats, failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Fuzz AMMSimulator against its conservation invariants')
+    parser.add_argument('--seconds', type=float, default=30.0, help='Time budget per worker')
+    parser.add_argument('--seed', type=int, help='Base seed (random if omitted)')
+    parser.add_argument('--workers', type=int, default=os.cpu_count() or 1, help='Parallel processes')
+    parser.add_argument('--max-steps', type=int, default=64, help='Steps per sequence')
+    parser.add_argument('--emit', default=os.path.join(os.path.dirname(os.path.abspath(__file__)), 'tests'),
+                        help="Directory for pytest reproducers ('' to disable)")
+    args = parser.parse_args()
+
+    logging.basicConfig(level=logging.WARNING)
+    base_seed = args.seed if args.seed is not None else random.randrange(2 ** 32)
+    jobs = [(base_seed + i, args.seconds, args.max_steps, args.emit) for i in range(args.workers)]
+    if args.workers > 1:
+        from concurrent.futures import ProcessPoolExecutor
+        with ProcessPoolExecutor(args.workers) as pool:
+            outcomes = list(pool.map(_fuzz_worker, jobs))
+    else:
+        outcomes = [_fuzz_worker(jobs[0])]
+
+    sequences = sum(s.sequences for s, _ in outcomes)
+    steps = sum(s.steps for s, _ in outcomes)
+    wall = max(s.seconds for s, _ in outcomes)
+    print(f"seed {base_seed}: {sequences:,} sequences, {steps:,} steps in {wall:.1f}s "
+          f"({sequences / wall:,.0f} sequences/s, {steps / wall:,.0f} steps/s, {args.workers} workers)")
+    failures = [f for _, found in outcomes for f in found]
+    for message, path in failures:
+        print(f"FAIL {message}" + (f" -> {path}" if path else ''))
+    return 1 if failures else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
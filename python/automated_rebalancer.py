@@ -5,6 +5,7 @@ Monitors positions and rebalances based on inventory imbalance.
 import logging
 import time
 import threading
+import uuid
 from typing import Dict, Any, List, Optional, Tuple
 from web3 import Web3
 from config import Config
@@ -15,27 +16,61 @@ from models.model_factory import ModelFactory
 from strategy import AsymmetricLPStrategy
 from alert_manager import TelegramAlertManager
 from inventory_publisher import InventoryPublisher
+from latency_metrics import metrics, MetricsExporter
+from inventory_snapshot import InventorySnapshotWriter, FLAG_REBALANCING, FLAG_RECOVERED
+from tx_executor import TransactionExecutor
+from position_calldata import build_unwind_calls, encode_collect, encode_mint
+from price_feed import PoolPriceFeed, PoolState
+from receipt_decoder import decode_receipts
+from rebalance_wal import (
+    RebalanceWAL, RecoveredState, STATE_INTENT, STATE_SUBMITTED, STATE_UNWOUND,
+    STATE_COMPLETE, STATE_ABORTED
+)
+from multicall3 import Multicall3, encode_call
+from rpc_gateway import LANE_EXECUTION, rpc_lane
 
 logger = logging.getLogger(__name__)
 
 class AutomatedRebalancer:
     """Automated LP position rebalancer"""
     
-    def __init__(self, config: Config = None):
-        """Initialize the automated rebalancer"""
+    def __init__(self, config: Config = None, client: Optional[UniswapV3Client] = None,
+                 executor: Optional[TransactionExecutor] = None,
+                 alert_manager: Optional[TelegramAlertManager] = None,
+                 inventory_publisher: Optional[InventoryPublisher] = None):
+        """
+        Initialize the automated rebalancer
+        
+        Args:
+            config: Configuration object
+            client: Shared client (the orchestrator passes one per wallet)
+            executor: Shared executor for client's wallet (nonces must come from one allocator)
+            alert_manager: Shared alert manager
+            inventory_publisher: Shared inventory publisher
+        """
         self.config = config or Config()
         self.config.validate_config()
         
         # Initialize clients
-        self.client = UniswapV3Client(self.config)
+        self.client = client or UniswapV3Client(self.config)
         self.lp_manager = LPPositionManager(self.client)
         self.utils = UniswapV3Utils()
         
+        # Pipelined transaction executor (local nonces, async receipts)
+        self.executor = executor or TransactionExecutor(self.client, self.config)
+        self.lp_manager.nonce_manager = self.executor.nonce_manager
+        
+        # Websocket pool feed (only used when PRICE_FEED_WS_URL is set)
+        self.price_feed = None
+        
+        # Prometheus /metrics endpoint and periodic latency summaries (started with monitoring)
+        self.metrics_exporter = None
+        
         # Initialize alert manager
-        self.alert_manager = TelegramAlertManager(self.config)
+        self.alert_manager = alert_manager or TelegramAlertManager(self.config)
         
         # Initialize inventory publisher
-        self.inventory_publisher = InventoryPublisher(self.config)
+        self.inventory_publisher = inventory_publisher or InventoryPublisher(self.config)
         
         # Initialize inventory model (can be easily swapped)
         model_name = getattr(self.config, 'INVENTORY_MODEL', 'AvellanedaStoikovModel')
@@ -45,6 +80,9 @@ class AutomatedRebalancer:
         # Initialize strategy (shared logic for backtest and live)
         self.strategy = AsymmetricLPStrategy(self.config, self.inventory_model)
         
+        # Reloaded config published by apply_config(), swapped in at the start of the next tick
+        self._pending_config: Optional[Config] = None
+        
         # Monitoring state
         self.is_running = False
         self.monitoring_thread = None
@@ -60,6 +98,26 @@ class AutomatedRebalancer:
         self.last_rebalance_token1: Optional[float] = None
         self.last_rebalance_price: Optional[float] = None
         
+        # Wallet amounts seen by the last trigger check (used for scheduling only)
+        self.last_wallet_amounts: Optional[Tuple[float, float]] = None
+        
+        # Crash-safe rebalance journal
+        self.wal = RebalanceWAL(
+            self.config.REBALANCE_WAL_PATH,
+            price_window=self.config.VOLATILITY_WINDOW_SIZE,
+            compact_every=self.config.REBALANCE_WAL_COMPACT_EVERY
+        ) if self.config.REBALANCE_WAL_PATH else None
+        self._active_rebalance: Optional[Dict[str, Any]] = None
+        self.resume_rebalance = False
+        
+        # Same-host seqlock snapshot read by the CeFi MM on every quote update
+        self.snapshot = None
+        if self.config.INVENTORY_SNAPSHOT_PATH:
+            try:
+                self.snapshot = InventorySnapshotWriter(self.config.INVENTORY_SNAPSHOT_PATH)
+            except Exception as e:
+                logger.error(f"Failed to create inventory snapshot at {self.config.INVENTORY_SNAPSHOT_PATH}: {e}")
+        
         logger.info("Automated Rebalancer initialized")
     
     def validate_token_ordering(self, token_a: str, token_b: str, fee: int) -> bool:
@@ -212,34 +270,43 @@ class AutomatedRebalancer:
             pool_address = self.client.get_pool_address(token0, token1, fee)
             pool_info = self.client.get_pool_info(pool_address)
             
-            # Get actual token addresses from pool
-            pool_token0 = pool_info['token0']
-            pool_token1 = pool_info['token1']
-            
-            # Get token decimals dynamically
-            token0_decimals = self.client.get_token_decimals(pool_token0)
-            token1_decimals = self.client.get_token_decimals(pool_token1)
-            
-            # Convert sqrtPriceX96 to actual price
-            sqrt_price_x96 = pool_info['sqrt_price_x96']
-            price = (sqrt_price_x96 / (2 ** 96)) ** 2
-            
-            # Adjust for token decimals difference
-            # sqrtPriceX96 represents sqrt(price) where price = token1/token0
-            price_adjusted = price * (10 ** (token0_decimals - token1_decimals))
-            
-            logger.debug(f"Spot price calculation:")
-            logger.debug(f"  Pool: {pool_token0}/{pool_token1}")
-            logger.debug(f"  Decimals: {token0_decimals}/{token1_decimals}")
-            logger.debug(f"  Raw price: {price:.10f}")
-            logger.debug(f"  Adjusted price: {price_adjusted:.10f}")
-            
-            return price_adjusted
+            return self._sqrt_price_to_spot(pool_info['sqrt_price_x96'], pool_info['token0'], pool_info['token1'])
             
         except Exception as e:
             logger.error(f"Error getting spot price: {e}")
             return 0.0
     
+    def _sqrt_price_to_spot(self, sqrt_price_x96: int, pool_token0: str, pool_token1: str) -> float:
+        """
+        Convert a pool sqrtPriceX96 to a decimal-adjusted spot price
+        
+        Args:
+            sqrt_price_x96: Pool sqrtPriceX96
+            pool_token0: Pool token0 address
+            pool_token1: Pool token1 address
+            
+        Returns:
+            Spot price (token1 per token0)
+        """
+        # Get token decimals dynamically
+        token0_decimals = self.client.get_token_decimals(pool_token0)
+        token1_decimals = self.client.get_token_decimals(pool_token1)
+        
+        # Convert sqrtPriceX96 to actual price
+        price = (sqrt_price_x96 / (2 ** 96)) ** 2
+        
+        # Adjust for token decimals difference
+        # sqrtPriceX96 represents sqrt(price) where price = token1/token0
+        price_adjusted = price * (10 ** (token0_decimals - token1_decimals))
+        
+        logger.debug(f"Spot price calculation:")
+        logger.debug(f"  Pool: {pool_token0}/{pool_token1}")
+        logger.debug(f"  Decimals: {token0_decimals}/{token1_decimals}")
+        logger.debug(f"  Raw price: {price:.10f}")
+        logger.debug(f"  Adjusted price: {price_adjusted:.10f}")
+        
+        return price_adjusted
+    
     def _get_token_balance(self, token_address: str) -> float:
         """
         Get token balance for a given token address
@@ -279,8 +346,17 @@ class AutomatedRebalancer:
         try:
             logger.info("Initializing positions on startup...")
             
-            # Query all positions from blockchain
-            positions = self._query_positions_from_blockchain()
+            positions = None
+            if self.wal:
+                recovered = self.wal.replay()
+                if not recovered.empty:
+                    positions = self._recover_from_wal(recovered)
+            
+            if positions is None:
+                # Query all positions from blockchain
+                positions = self._query_positions_from_blockchain()
+                if self.wal:
+                    self.wal.record_positions([p['token_id'] for p in positions])
             
             # Store in memory
             self.current_positions = positions
@@ -300,6 +376,193 @@ class AutomatedRebalancer:
             logger.error(f"Error initializing positions: {e}")
             return False
     
+    def _recover_from_wal(self, recovered: RecoveredState) -> Optional[List[Dict[str, Any]]]:
+        """
+        Restore state from the rebalance journal and reconcile it with one batched read
+        
+        Args:
+            recovered: State replayed from the WAL
+            
+        Returns:
+            Reconciled positions, or None if a full chain rescan is needed
+        """
+        started = time.time()
+        
+        # Baselines and rolling price window
+        self.last_rebalance_token0 = recovered.last_rebalance_token0
+        self.last_rebalance_token1 = recovered.last_rebalance_token1
+        self.last_rebalance_price = recovered.last_rebalance_price
+        self.last_rebalance_time = recovered.last_rebalance_time
+        self.price_history = recovered.price_history[-self.config.VOLATILITY_WINDOW_SIZE:]
+        if self.price_history:
+            self.last_spot_price = self.price_history[-1]['price']
+        if self.snapshot:
+            self.snapshot.update(
+                last_rebalance_price=self.last_rebalance_price,
+                last_rebalance_ts_ns=int(self.last_rebalance_time * 1e9),
+                flags=FLAG_RECOVERED
+            )
+        
+        # Resolve an interrupted rebalance from its last phase's transaction receipts
+        in_flight = recovered.in_flight
+        needs_rescan = False
+        position_ids = recovered.positions
+        if in_flight:
+            rebalance_id = in_flight['id']
+            state = in_flight['state']
+            phase = in_flight.get('phase')
+            receipts = []
+            for tx_hash in in_flight.get('tx_hashes', []):
+                try:
+                    receipts.append(self.client.w3.eth.get_transaction_receipt(tx_hash))
+                except Exception:
+                    receipts.append(None)
+            pending = any(r is None for r in receipts)
+            mined_ok = bool(receipts) and not pending and all(r['status'] == 1 for r in receipts)
+            
+            resume = state == STATE_UNWOUND or (state == STATE_SUBMITTED and not pending and (
+                (phase == 'unwind' and mined_ok) or (phase == 'mint' and not mined_ok)))
+            
+            if resume:
+                # Old positions are gone but the new ones were never minted: re-mint on the first tick
+                logger.warning(f"Resuming rebalance {rebalance_id}: positions unwound, re-minting")
+                self._active_rebalance = {'id': rebalance_id, 'state': STATE_UNWOUND}
+                self.wal.record_rebalance(rebalance_id, STATE_UNWOUND)
+                self.resume_rebalance = True
+                return []
+            elif state == STATE_SUBMITTED and phase == 'multicall' and pending:
+                # The atomic multicall may still be mined: keep the old positions for now
+                # and settle it from its receipt on the first tick
+                logger.warning(f"Rebalance {rebalance_id} still unconfirmed; settling on the first tick")
+                self._active_rebalance = {'id': rebalance_id, 'state': STATE_SUBMITTED, 'phase': phase,
+                                          'tx_hashes': in_flight.get('tx_hashes', [])}
+                self.resume_rebalance = True
+            elif state == STATE_SUBMITTED and mined_ok:
+                # The final transaction landed before the crash; new token IDs come from its receipts
+                logger.info(f"Rebalance {rebalance_id} completed before restart")
+                self.wal.record_rebalance(rebalance_id, STATE_COMPLETE)
+                minted = decode_receipts(receipts, self.config.UNISWAP_V3_POSITION_MANAGER).minted()
+                if minted:
+                    position_ids = [m.token_id for m in minted]
+                    self.wal.record_positions(position_ids)
+                else:
+                    needs_rescan = True
+            else:
+                # Nothing sent, an atomic multicall reverted, or outcome unknown (still pending)
+                logger.warning(f"Rebalance {rebalance_id} did not complete ({state}/{phase}); aborting")
+                self.wal.record_rebalance(rebalance_id, STATE_ABORTED)
+                needs_rescan = state == STATE_SUBMITTED and phase != 'multicall'
+        
+        token_ids = [t for t in position_ids if isinstance(t, int)]
+        if needs_rescan or len(token_ids) != len(position_ids):
+            return None
+        
+        positions = self._read_positions_batched(token_ids)
+        if positions is None:
+            return None
+        
+        logger.info(f"Recovered {len(positions)} positions from WAL in {(time.time() - started) * 1000:.0f}ms")
+        return positions
+    
+    def _read_positions_batched(self, token_ids: List[int]) -> Optional[List[Dict[str, Any]]]:
+        """
+        Read several positions and their owners in one Multicall3 call
+        
+        Ownership is checked per token ID: the wallet may share its NFT balance
+        with other pools or other tools, so a wallet-wide count proves nothing.
+        
+        Args:
+            token_ids: Position NFT token IDs believed to be owned
+            
+        Returns:
+            Positions with liquidity, or None if the journal disagrees with the chain
+        """
+        npm = self.config.UNISWAP_V3_POSITION_MANAGER
+        position_types = ['uint96', 'address', 'address', 'address', 'uint24', 'int24', 'int24',
+                          'uint128', 'uint256', 'uint256', 'uint128', 'uint128']
+        calls = []
+        for token_id in token_ids:
+            calls.append((npm, encode_call('ownerOf(uint256)', ['uint256'], [token_id]), ['address']))
+            calls.append((npm, encode_call('positions(uint256)', ['uint256'], [token_id]), position_types))
+        
+        try:
+            results = Multicall3(self.client.w3, self.config.MULTICALL3_ADDRESS).read(calls)
+        except Exception as e:
+            logger.warning(f"Batched position read failed, falling back to full scan: {e}")
+            return None
+        
+        wallet = self.client.wallet_address.lower()
+        existing = []
+        for token_id, owner, r in zip(token_ids, results[0::2], results[1::2]):
+            if r is None:
+                continue  # burned since it was journaled
+            if owner is None or owner[0].lower() != wallet:
+                logger.warning(f"WAL position {token_id} is not owned by this wallet; rescanning")
+                return None
+            if not self._is_own_pool({'token0': r[2], 'token1': r[3], 'fee': r[4]}):
+                logger.warning(f"WAL position {token_id} belongs to another pool; rescanning")
+                return None
+            existing.append((token_id, r))
+        
+        return [{
+            'token_id': token_id,
+            'token0': r[2],
+            'token1': r[3],
+            'fee': r[4],
+            'tick_lower': r[5],
+            'tick_upper': r[6],
+            'liquidity': r[7],
+            'tokens_owed0': r[10],
+            'tokens_owed1': r[11]
+        } for token_id, r in existing if r[7] > 0]
+    
+    def _journal_rebalance(self, state: str, **fields):
+        """Record a rebalance state transition in the WAL (no-op when disabled)"""
+        if self._active_rebalance is None:
+            return
+        self._active_rebalance['state'] = state
+        self._active_rebalance.update({k: fields[k] for k in ('phase', 'tx_hashes') if k in fields})
+        if self.wal:
+            self.wal.record_rebalance(self._active_rebalance['id'], state, **fields)
+        if state in (STATE_COMPLETE, STATE_ABORTED):
+            self._active_rebalance = None
+    
+    def _settle_submitted_rebalance(self) -> Optional[Dict[str, Any]]:
+        """
+        Resolve an atomic multicall rebalance left 'submitted' by a receipt timeout
+        
+        Returns:
+            A result to return from this tick (still pending, or the late mint
+            landed), or None if it reverted and a new rebalance may start
+        """
+        active = self._active_rebalance
+        receipts = []
+        for tx_hash in active.get('tx_hashes', []):
+            try:
+                receipts.append(self.client.w3.eth.get_transaction_receipt(tx_hash))
+            except Exception:
+                receipts.append(None)
+        if not receipts or any(r is None for r in receipts):
+            logger.warning(f"Rebalance {active['id']} still unconfirmed; not starting another")
+            return {'error': f"Rebalance {active['id']} still pending"}
+        
+        if all(r['status'] == 1 for r in receipts):
+            # The multicall landed late: the old positions are gone, the new ones are in its logs
+            minted = decode_receipts(receipts, self.config.UNISWAP_V3_POSITION_MANAGER).minted()
+            positions = self._read_positions_batched([m.token_id for m in minted]) if minted else None
+            self.current_positions = positions if positions is not None else self._query_positions_from_blockchain()
+            logger.info(f"Rebalance {active['id']} confirmed late; {len(self.current_positions)} positions")
+            if self.wal:
+                self.wal.record_positions([p['token_id'] for p in self.current_positions])
+            self._journal_rebalance(STATE_COMPLETE)
+            self.resume_rebalance = False
+            self.last_rebalance_time = time.time()
+            return {'success': True, 'settled': active['id'], 'positions_burned': 0}
+        
+        logger.warning(f"Rebalance {active['id']} reverted on chain; old positions remain")
+        self._journal_rebalance(STATE_ABORTED, error='Multicall reverted')
+        return None
+    
     def _query_positions_from_blockchain(self) -> List[Dict[str, Any]]:
         """
         Query all positions from blockchain (only used on startup/restart)
@@ -318,8 +581,9 @@ class AutomatedRebalancer:
                     # Get position info for each token
                     position_info = self.client.get_position_info(token_id)
                     
-                    # Only include positions with liquidity > 0
-                    if position_info['liquidity'] > 0:
+                    # Only include this pool's positions with liquidity > 0 (the
+                    # wallet may hold positions of other pools run by the orchestrator)
+                    if position_info['liquidity'] > 0 and self._is_own_pool(position_info):
                         positions.append({
                             'token_id': token_id,
                             'token0': position_info['token0'],
@@ -343,6 +607,47 @@ class AutomatedRebalancer:
             logger.error(f"Error querying positions from blockchain: {e}")
             return []
     
+    def _is_own_pool(self, position_info: Dict[str, Any]) -> bool:
+        """Whether a position belongs to the configured token pair and fee tier"""
+        pair = {self.config.TOKEN_A_ADDRESS.lower(), self.config.TOKEN_B_ADDRESS.lower()}
+        return ({position_info['token0'].lower(), position_info['token1'].lower()} == pair
+                and position_info['fee'] == self.config.FEE_TIER)
+    
+    def _write_snapshot(self, inventory_status: Dict[str, Any], positions: List[Dict[str, Any]]):
+        """
+        Publish the current inventory and bands to the shared-memory snapshot
+        
+        Args:
+            inventory_status: Output of get_inventory_status
+            positions: Current positions (bands are taken from their ticks)
+        """
+        if not self.snapshot:
+            return
+        try:
+            bands = {}
+            ranged = sorted((p for p in positions if 'tick_lower' in p), key=lambda p: p['tick_lower'])
+            if len(ranged) == 2:
+                # Position B sits below spot, position A above
+                bands = {
+                    'tick_lower_b': ranged[0]['tick_lower'], 'tick_upper_b': ranged[0]['tick_upper'],
+                    'tick_lower_a': ranged[1]['tick_lower'], 'tick_upper_a': ranged[1]['tick_upper']
+                }
+            self.snapshot.update(
+                block_number=self.client.state_cache.current_block(),
+                token0_balance=inventory_status['token_a_balance'],
+                token1_balance=inventory_status['token_b_balance'],
+                spot_price=inventory_status['spot_price'],
+                inventory_ratio=inventory_status['token_a_ratio'],
+                target_ratio=inventory_status['target_ratio'],
+                volatility=inventory_status['volatility'],
+                range_a_pct=inventory_status['token_a_range_percent'],
+                range_b_pct=inventory_status['token_b_range_percent'],
+                position_count=len(positions),
+                **bands
+            )
+        except Exception as e:
+            logger.warning(f"Failed to write inventory snapshot: {e}")
+    
     def get_position_ranges(self) -> List[Dict[str, Any]]:
         """
         Get current LP position ranges from memory (not blockchain)
@@ -485,6 +790,7 @@ class AutomatedRebalancer:
             token1_decimals = self.client.get_token_decimals(self.config.TOKEN_B_ADDRESS)
             token0_amount = token0_balance / (10 ** token0_decimals)
             token1_amount = token1_balance / (10 ** token1_decimals)
+            self.last_wallet_amounts = (token0_amount, token1_amount)
             
             # Use strategy's should_rebalance method (aligned with backtest)
             return self.strategy.should_rebalance(
@@ -502,6 +808,29 @@ class AutomatedRebalancer:
             logger.error(f"Error checking rebalance condition: {e}")
             return False
     
+    def rebalance_urgency(self, spot_price: Optional[float]) -> float:
+        """
+        Trigger proximity without any RPC (wallet amounts from the last check)
+        
+        Args:
+            spot_price: Latest spot price
+            
+        Returns:
+            Deviation / threshold (see AsymmetricLPStrategy.rebalance_urgency)
+        """
+        if self.resume_rebalance:
+            return float('inf')
+        token0_amount, token1_amount = self.last_wallet_amounts or (None, None)
+        return self.strategy.rebalance_urgency(
+            current_price=spot_price,
+            current_token0=token0_amount,
+            current_token1=token1_amount,
+            last_rebalance_token0=self.last_rebalance_token0,
+            last_rebalance_token1=self.last_rebalance_token1,
+            last_rebalance_price=self.last_rebalance_price,
+            has_positions=len(self.current_positions) > 0
+        )
+    
     def get_inventory_status(self, spot_price: float) -> Dict[str, Any]:
         """
         Get detailed inventory status for monitoring
@@ -522,16 +851,20 @@ class AutomatedRebalancer:
                 self.config.TOKEN_A_ADDRESS, self.config.TOKEN_B_ADDRESS, self.client
             )
             
+            token0_decimals = self.client.get_token_decimals(self.config.TOKEN_A_ADDRESS)
+            token1_decimals = self.client.get_token_decimals(self.config.TOKEN_B_ADDRESS)
+            
             return {
                 'spot_price': spot_price,
-                'inventory_imbalance': inventory_result['inventory_imbalance'],
-                'excess_token': inventory_result['excess_token'],
-                'target_rebalance': inventory_result['target_rebalance'],
-                'token_a_ratio': inventory_result['token_values']['token_a_ratio'],
-                'token_b_ratio': inventory_result['token_values']['token_b_ratio'],
-                'total_value_usd': inventory_result['token_values']['total_value_usd'],
-                'token_a_range_percent': inventory_result['token_a_range_percent'],
-                'token_b_range_percent': inventory_result['token_b_range_percent']
+                'token_a_balance': token0_balance / (10 ** token0_decimals),
+                'token_b_balance': token1_balance / (10 ** token1_decimals),
+                'token_a_ratio': inventory_result['inventory_ratio'],
+                'token_b_ratio': 1.0 - inventory_result['inventory_ratio'],
+                'target_ratio': inventory_result['target_ratio'],
+                'inventory_deviation': inventory_result['deviation'],
+                'volatility': inventory_result['volatility'],
+                'token_a_range_percent': inventory_result['range_a_percentage'],
+                'token_b_range_percent': inventory_result['range_b_percentage']
             }
             
         except Exception as e:
@@ -539,7 +872,10 @@ class AutomatedRebalancer:
             return {}
     
     def create_single_sided_positions(self, token0: str, token1: str, fee: int, 
-                                    spot_price: float, range_a: float, range_b: float) -> Dict[str, Any]:
+                                    spot_price: float, range_a: float, range_b: float,
+                                    balances: Optional[Tuple[int, int]] = None,
+                                    unwind_calls: Optional[List[bytes]] = None,
+                                    on_submitted=None) -> Dict[str, Any]:
         """
         Create two single-sided LP positions
         
@@ -550,6 +886,9 @@ class AutomatedRebalancer:
             spot_price: Current spot price
             range_a: Range percentage for position A
             range_b: Range percentage for position B
+            balances: Token balances to size the mints from (defaults to wallet balances)
+            unwind_calls: Position-manager calls to run first in the same multicall
+            on_submitted: Called with tx hashes once broadcast (journaling hook)
             
         Returns:
             Transaction results
@@ -579,40 +918,66 @@ class AutomatedRebalancer:
             logger.info(f"Creating Position B: ticks {tick_b_lower} to {tick_b_upper}")
             
             # Get wallet balances
-            token0_balance, token1_balance = self.get_wallet_balances(token0, token1)
+            token0_balance, token1_balance = balances or self.get_wallet_balances(token0, token1)
+            
+            deadline = int(self.client.w3.eth.get_block('latest')['timestamp']) + 1800  # 30 minutes
+            
+            # Position A (above spot, token0 only) and Position B (below spot, token1 only)
+            mints = [
+                {'token0': token0, 'token1': token1, 'fee': fee, 'tick_lower': tick_a_lower,
+                 'tick_upper': tick_a_upper, 'amount0_desired': token0_balance // 2,
+                 'amount1_desired': 0, 'amount0_min': 0, 'amount1_min': 0},
+                {'token0': token0, 'token1': token1, 'fee': fee, 'tick_lower': tick_b_lower,
+                 'tick_upper': tick_b_upper, 'amount0_desired': 0,
+                 'amount1_desired': token1_balance // 2, 'amount0_min': 0, 'amount1_min': 0}
+            ]
             
-            # Create Position A (above spot)
-            result_a = self.lp_manager.add_liquidity(
-                token0=token0,
-                token1=token1,
-                fee=fee,
-                amount0_desired=token0_balance // 2,  # Use half of balance
-                amount1_desired=0,  # Single-sided position
-                tick_lower=tick_a_lower,
-                tick_upper=tick_a_upper,
-                amount0_min=0,
-                amount1_min=0
-            )
+            # Simulate the exact plan first (after the unwind, when it shares the transaction)
+            preflight = self.lp_manager.preflight
+            if preflight:
+                plan = preflight.plan_mints(mints, self.client.wallet_address, deadline,
+                                            prefix_calls=unwind_calls or ())
+                if not plan.ok:
+                    return {'success': False, 'error': f"Pre-flight rejected: {plan.reason}"}
+                mints = plan.mints
+            
+            if unwind_calls is not None:
+                # Burn-and-remint as one atomic multicall: a single transaction,
+                # a single gas estimate and no window between unwind and mint
+                calls = list(unwind_calls)
+                calls.extend(encode_mint(recipient=self.client.wallet_address, deadline=deadline, **mint)
+                             for mint in mints)
+                batch = self.executor.execute_batch([self.executor.build_multicall_step('rebalance', calls)],
+                                                    on_submitted=on_submitted)
+                return {
+                    'success': batch['success'],
+                    'multicall': batch['steps'][0],
+                    'spot_price': spot_price,
+                    'range_a': range_a,
+                    'range_b': range_b,
+                    'ticks': {'a': (tick_a_lower, tick_a_upper), 'b': (tick_b_lower, tick_b_upper)},
+                    'gas_used': batch['gas_used'],
+                    'block_span': batch['block_span']
+                }
             
-            # Create Position B (below spot)
-            result_b = self.lp_manager.add_liquidity(
-                token0=token0,
-                token1=token1,
-                fee=fee,
-                amount0_desired=0,  # Single-sided position
-                amount1_desired=token1_balance // 2,  # Use half of balance
-                tick_lower=tick_b_lower,
-                tick_upper=tick_b_upper,
-                amount0_min=0,
-                amount1_min=0
-            )
+            # Position A (above spot) and Position B (below spot) are pre-signed
+            # and submitted back-to-back so both land in the same block or the next
+            mint_a, mint_b = [self.lp_manager.build_mint_step(
+                self.executor, current_tick=current_tick, deadline=deadline, **mint
+            ) for mint in mints]
+            batch = self.executor.execute_batch([mint_a, mint_b], on_submitted=on_submitted)
+            result_a, result_b = batch['steps']
             
             return {
+                'success': batch['success'],
                 'position_a': result_a,
                 'position_b': result_b,
                 'spot_price': spot_price,
                 'range_a': range_a,
-                'range_b': range_b
+                'range_b': range_b,
+                'ticks': {'a': (tick_a_lower, tick_a_upper), 'b': (tick_b_lower, tick_b_upper)},
+                'gas_used': batch['gas_used'],
+                'block_span': batch['block_span']
             }
             
         except Exception as e:
@@ -629,64 +994,152 @@ class AutomatedRebalancer:
         Returns:
             Transaction results
         """
-        try:
-            logger.info(f"Collecting fees and burning position {token_id}")
-            
-            # Get position info to check for fees owed
-            position_info = self.client.get_position_info(token_id)
-            fees_owed0 = position_info['tokens_owed0']
-            fees_owed1 = position_info['tokens_owed1']
-            
-            logger.info(f"Fees owed: {fees_owed0} token0, {fees_owed1} token1")
+        return self.unwind_positions([token_id]).get(token_id, {'success': False, 'error': 'Unknown position'})
+    
+    def unwind_positions(self, token_ids: List[int], on_submitted=None) -> Dict[int, Dict[str, Any]]:
+        """
+        Remove liquidity, collect and burn several positions in one pipelined batch
+        
+        Each position's decreaseLiquidity -> collect -> burn steps are pre-signed
+        with consecutive local nonces and submitted back-to-back, then all
+        receipts are awaited together.
+        
+        Args:
+            token_ids: NFT token IDs of the positions
+            on_submitted: Called with tx hashes once broadcast (journaling hook)
             
-            # Collect fees first (if any)
-            if fees_owed0 > 0 or fees_owed1 > 0:
-                collect_result = self._collect_fees(token_id, fees_owed0, fees_owed1)
-                if not collect_result.get('success', False):
-                    logger.warning(f"Failed to collect fees for position {token_id}")
+        Returns:
+            Per-position results keyed by token ID
+        """
+        results: Dict[int, Dict[str, Any]] = {}
+        try:
+            deadline = int(self.client.w3.eth.get_block('latest')['timestamp']) + 1800  # 30 minutes
+            
+            steps = []
+            step_owner = []
+            fees_owed = {}
+            for token_id in token_ids:
+                # One read per position: liquidity to remove and fees owed
+                position_info = self.client.get_position_info(token_id)
+                fees_owed[token_id] = {
+                    'token0': position_info['tokens_owed0'],
+                    'token1': position_info['tokens_owed1']
+                }
+                logger.info(f"Unwinding position {token_id}: liquidity {position_info['liquidity']}, "
+                            f"fees owed {fees_owed[token_id]['token0']}/{fees_owed[token_id]['token1']}")
+                
+                position_steps = self.executor.build_unwind_steps(token_id, position_info['liquidity'], deadline)
+                steps.extend(position_steps)
+                step_owner.extend([token_id] * len(position_steps))
+            
+            batch = self.executor.execute_batch(steps, on_submitted=on_submitted)
+            
+            for token_id in token_ids:
+                position_steps = [r for r, owner in zip(batch['steps'], step_owner) if owner == token_id]
+                success = bool(position_steps) and all(r['success'] for r in position_steps)
+                results[token_id] = {
+                    'success': success,
+                    'fees_collected': fees_owed[token_id],
+                    'burn_result': {'success': success, 'steps': position_steps},
+                    'error': None if success else next((r['error'] for r in position_steps if not r['success']), None)
+                }
             
-            # Burn the position (remove all liquidity)
-            burn_result = self._burn_position(token_id)
+        except Exception as e:
+            logger.error(f"Error unwinding positions {token_ids}: {e}")
+            for token_id in token_ids:
+                results.setdefault(token_id, {'success': False, 'error': str(e)})
+        
+        return results
+    
+    def _positions_from_mint_result(self, result: Dict[str, Any], token0: str, token1: str,
+                                    fee: int) -> List[Dict[str, Any]]:
+        """
+        Build the new in-memory positions from the mint receipts (no follow-up reads)
+        
+        Args:
+            result: create_single_sided_positions result (receipts and tick ranges)
+            token0: Token0 address
+            token1: Token1 address
+            fee: Fee tier
             
-            return {
-                'success': burn_result.get('success', False),
-                'fees_collected': {'token0': fees_owed0, 'token1': fees_owed1},
-                'burn_result': burn_result
-            }
+        Returns:
+            Positions in the same shape as _query_positions_from_blockchain
+        """
+        steps = [result['multicall']] if 'multicall' in result else [result.get('position_a'), result.get('position_b')]
+        receipts = [step.get('receipt') for step in steps if step]
+        minted = decode_receipts(receipts, self.config.UNISWAP_V3_POSITION_MANAGER).minted()
+        
+        # Mints are always A (above spot) then B (below spot), and logs keep that order
+        ticks = result.get('ticks') or {}
+        ranges = [ticks.get('a'), ticks.get('b')]
+        if len(minted) != len(ranges) or None in ranges:
+            logger.warning(f"Found {len(minted)} minted positions in receipts, expected {len(ranges)}; "
+                           f"re-reading positions from chain")
+            return self._query_positions_from_blockchain()
+        
+        return [{
+            'token_id': position.token_id,
+            'token0': token0,
+            'token1': token1,
+            'fee': fee,
+            'tick_lower': tick_range[0],
+            'tick_upper': tick_range[1],
+            'liquidity': position.liquidity,
+            'tokens_owed0': 0,
+            'tokens_owed1': 0,
+            'amount0': position.amount0,
+            'amount1': position.amount1
+        } for position, tick_range in zip(minted, ranges)]
+    
+    def _plan_multicall_unwind(self, token0: str, token1: str, fee: int,
+                               token_ids: List[int]) -> Dict[str, Any]:
+        """
+        Build unwind calls for a single-transaction rebalance and project its proceeds
+        
+        Args:
+            token0: Token0 address
+            token1: Token1 address
+            fee: Fee tier
+            token_ids: NFT token IDs of the positions to close
             
-        except Exception as e:
-            logger.error(f"Error collecting fees and burning position {token_id}: {e}")
-            return {'success': False, 'error': str(e)}
+        Returns:
+            Dictionary with calldata, projected token amounts and fees owed
+        """
+        pool_address = self.client.get_pool_address(token0, token1, fee)
+        sqrt_price_x96 = self.client.get_pool_info(pool_address)['sqrt_price_x96']
+        deadline = int(self.client.w3.eth.get_block('latest')['timestamp']) + 1800  # 30 minutes
+        
+        calls: List[bytes] = []
+        amount0 = amount1 = 0
+        fees = {'token0': 0, 'token1': 0}
+        for token_id in token_ids:
+            position_info = self.client.get_position_info(token_id)
+            principal0, principal1 = self.utils.get_amounts_for_liquidity(
+                position_info['liquidity'], sqrt_price_x96,
+                position_info['tick_lower'], position_info['tick_upper']
+            )
+            amount0 += principal0 + position_info['tokens_owed0']
+            amount1 += principal1 + position_info['tokens_owed1']
+            fees['token0'] += position_info['tokens_owed0']
+            fees['token1'] += position_info['tokens_owed1']
+            calls.extend(build_unwind_calls(token_id, position_info['liquidity'],
+                                            self.client.wallet_address, deadline))
+        
+        logger.info(f"Planned multicall unwind of {len(token_ids)} positions: "
+                    f"~{amount0} token0, ~{amount1} token1 returned")
+        return {'calls': calls, 'amount0': amount0, 'amount1': amount1, 'fees': fees}
     
     def _collect_fees(self, token_id: int, amount0: int, amount1: int) -> Dict[str, Any]:
         """Collect fees from a position"""
         try:
             logger.info(f"Collecting {amount0} token0 and {amount1} token1 fees from position {token_id}")
             
-            # Prepare collect transaction
-            collect_params = {
-                'tokenId': token_id,
-                'recipient': self.client.wallet_address,
-                'amount0Max': amount0,
-                'amount1Max': amount1
-            }
-            
-            # Build transaction
-            transaction = self.client.position_manager.functions.collect(**collect_params).build_transaction({
-                'from': self.client.wallet_address,
-                'gas': self.client.estimate_gas({
-                    'from': self.client.wallet_address,
-                    'to': self.config.UNISWAP_V3_POSITION_MANAGER,
-                    'data': self.client.position_manager.functions.collect(**collect_params).build_transaction()['data']
-                }),
-                'gasPrice': self.client.get_gas_price(),
-                'nonce': self.client.w3.eth.get_transaction_count(self.client.wallet_address),
-                'value': 0
-            })
+            # Build transaction from natively encoded calldata (gas estimated once)
+            data = '0x' + encode_collect(token_id, self.client.wallet_address, amount0, amount1).hex()
+            transaction = self.lp_manager.build_transaction(data)
             
             # Sign and send transaction
-            signed_txn = self.client.account.sign_transaction(transaction)
-            tx_hash = self.client.w3.eth.send_raw_transaction(signed_txn.rawTransaction)
+            tx_hash = self.lp_manager.send_transaction(transaction)
             
             logger.info(f"Fee collection transaction sent: {tx_hash.hex()}")
             
@@ -749,14 +1202,41 @@ class AutomatedRebalancer:
             
             logger.info(f"Processing {len(existing_positions)} existing positions")
             
-            # Collect fees and burn each position
-            for position in existing_positions:
-                token_id = position.get('token_id')
-                if token_id:
-                    logger.info(f"Processing position {token_id}")
-                    
-                    # Collect fees and burn position
-                    burn_result = self.collect_fees_and_burn_position(token_id)
+            if self._active_rebalance and self._active_rebalance['state'] == STATE_SUBMITTED and \
+                    self._active_rebalance.get('phase') == 'multicall':
+                settled = self._settle_submitted_rebalance()
+                if settled is not None:
+                    return settled
+                existing_positions = self.current_positions.copy()
+            
+            token_ids = [p.get('token_id') for p in existing_positions if p.get('token_id')]
+            unwind = None
+            use_multicall = self.config.MULTICALL_REBALANCE and bool(token_ids)
+            
+            # Journal the intent before anything is sent (a resumed re-mint keeps its ID)
+            if self._active_rebalance is None:
+                self._active_rebalance = {'id': uuid.uuid4().hex[:12], 'state': STATE_INTENT}
+                self._journal_rebalance(STATE_INTENT, token_ids=token_ids,
+                                        mode='multicall' if use_multicall else 'pipelined')
+            
+            def journal_submitted(phase):
+                return lambda tx_hashes: self._journal_rebalance(STATE_SUBMITTED, phase=phase, tx_hashes=tx_hashes)
+            
+            if use_multicall:
+                # Positions are unwound inside the same multicall as the new mints;
+                # size the new positions from what the unwind will return
+                with metrics.span('rebalance.plan_unwind'):
+                    unwind = self._plan_multicall_unwind(token0, token1, fee, token_ids)
+                total_fees_collected = unwind['fees']
+            else:
+                # Collect fees and burn all positions in one pipelined batch
+                with metrics.span('rebalance.unwind'):
+                    burn_results = self.unwind_positions(
+                        token_ids, on_submitted=journal_submitted('unwind')
+                    ) if token_ids else {}
+                
+                for token_id in token_ids:
+                    burn_result = burn_results[token_id]
                     
                     if burn_result.get('success', False):
                         fees = burn_result.get('fees_collected', {'token0': 0, 'token1': 0})
@@ -765,17 +1245,21 @@ class AutomatedRebalancer:
                         logger.info(f"Successfully burned position {token_id}")
                     else:
                         logger.error(f"Failed to burn position {token_id}: {burn_result.get('error', 'Unknown error')}")
+                
+                # Verify all positions have been burned
+                if not self.verify_positions_burned():
+                    logger.error("Not all positions were successfully burned!")
+                    self._journal_rebalance(STATE_ABORTED, error='Failed to burn all positions')
+                    return {'error': 'Failed to burn all positions'}
+                
+                # Clear positions from memory
+                self.current_positions = []
+                self._journal_rebalance(STATE_UNWOUND)
+                if self.wal:
+                    self.wal.record_positions([])
             
             logger.info(f"Total fees collected: {total_fees_collected}")
             
-            # Verify all positions have been burned
-            if not self.verify_positions_burned():
-                logger.error("Not all positions were successfully burned!")
-                return {'error': 'Failed to burn all positions'}
-            
-            # Clear positions from memory
-            self.current_positions = []
-            
             # Get current spot price
             spot_price = self.get_current_spot_price(token0, token1, fee)
             if spot_price == 0:
@@ -785,6 +1269,9 @@ class AutomatedRebalancer:
             
             # Get updated wallet balances (including collected fees)
             token0_balance, token1_balance = self.get_wallet_balances(token0, token1)
+            if unwind is not None:
+                token0_balance += unwind['amount0']
+                token1_balance += unwind['amount1']
             logger.info(f"Updated balances: Token0={token0_balance}, Token1={token1_balance}")
             
             # Convert from wei to human-readable amounts for baseline tracking
@@ -794,7 +1281,8 @@ class AutomatedRebalancer:
             token1_amount = token1_balance / (10 ** token1_decimals)
             
             # Calculate dynamic ranges
-            range_a, range_b = self.calculate_dynamic_ranges(token0_balance, token1_balance, spot_price)
+            with metrics.span('rebalance.model_eval'):
+                range_a, range_b = self.calculate_dynamic_ranges(token0_balance, token1_balance, spot_price)
             logger.info(f"Calculated ranges: A={range_a}%, B={range_b}%")
             
             # Calculate inventory ratio for notifications
@@ -813,16 +1301,36 @@ class AutomatedRebalancer:
                 old_inventory_ratio = old_token0_value / old_total_value if old_total_value > 0 else 0.5
             
             # Create new single-sided positions
-            result = self.create_single_sided_positions(token0, token1, fee, spot_price, range_a, range_b)
+            with metrics.span('rebalance.mint'):
+                if unwind is not None:
+                    result = self.create_single_sided_positions(
+                        token0, token1, fee, spot_price, range_a, range_b,
+                        balances=(token0_balance, token1_balance), unwind_calls=unwind['calls'],
+                        on_submitted=journal_submitted('multicall')
+                    )
+                else:
+                    result = self.create_single_sided_positions(token0, token1, fee, spot_price, range_a, range_b,
+                                                                on_submitted=journal_submitted('mint'))
+            
+            if not result.get('success', False) and use_multicall:
+                if (result.get('multicall') or {}).get('receipt') is None and \
+                        self._active_rebalance and self._active_rebalance['state'] == STATE_SUBMITTED:
+                    # Broadcast but no receipt before the timeout: it may still be mined.
+                    # Stay 'submitted'; the next tick (or a restart) settles it from the receipt
+                    logger.warning(f"Rebalance multicall unconfirmed: {result.get('error')}")
+                    self.resume_rebalance = True
+                else:
+                    # Never sent, or reverted on chain (atomic: the old positions remain)
+                    self._journal_rebalance(STATE_ABORTED, error=result.get('error', 'Multicall failed'))
+            elif not result.get('success', False):
+                # Old positions are already burned; stay 'unwound' so the next tick re-mints
+                self._journal_rebalance(STATE_UNWOUND)
+                self.resume_rebalance = True
             
             # Update positions in memory with new positions
             if result.get('success', False):
-                # Extract new position IDs from transaction logs (simplified)
-                # In practice, you'd parse the transaction logs to get the actual token IDs
-                new_positions = [
-                    {'token_id': 'new_position_a', 'status': 'created'},
-                    {'token_id': 'new_position_b', 'status': 'created'}
-                ]
+                # Token IDs, liquidity and amounts come from the mint receipts
+                new_positions = self._positions_from_mint_result(result, token0, token1, fee)
                 self.current_positions = new_positions
                 
                 # Update last rebalance baselines (aligned with backtest logic)
@@ -832,8 +1340,24 @@ class AutomatedRebalancer:
                 self.last_rebalance_price = spot_price
                 logger.info(f"Updated rebalance baselines: token0={token0_amount:.6f}, token1={token1_amount:.6f}, price={spot_price:.6f}")
                 
+                if self.wal:
+                    self.wal.record_baseline(token0_amount, token1_amount, spot_price)
+                    self.wal.record_positions([p['token_id'] for p in new_positions])
+                self._journal_rebalance(STATE_COMPLETE)
+                self.resume_rebalance = False
+                
                 # Update rebalance time and log success
                 self.last_rebalance_time = time.time()
+                if self.snapshot:
+                    ticks = result.get('ticks') or {'a': (None, None), 'b': (None, None)}
+                    self.snapshot.update(
+                        last_rebalance_price=spot_price,
+                        last_rebalance_ts_ns=int(self.last_rebalance_time * 1e9),
+                        tick_lower_a=ticks['a'][0], tick_upper_a=ticks['a'][1],
+                        tick_lower_b=ticks['b'][0], tick_upper_b=ticks['b'][1],
+                        range_a_pct=range_a, range_b_pct=range_b,
+                        position_count=len(new_positions)
+                    )
                 logger.info("Rebalancing completed successfully")
                 
                 # Get token symbols for notifications (needed for both notification and event publishing)
@@ -880,6 +1404,16 @@ class AutomatedRebalancer:
                             gas_used=result.get('gas_used', 0),
                             ranges=ranges_formatted
                         )
+                        ticks = result.get('ticks')
+                        if ticks:
+                            self.inventory_publisher.publish_bands(
+                                tick_lower_a=ticks['a'][0], tick_upper_a=ticks['a'][1],
+                                tick_lower_b=ticks['b'][0], tick_upper_b=ticks['b'][1],
+                                range_a_pct=result.get('range_a', 0),
+                                range_b_pct=result.get('range_b', 0),
+                                spot_price=spot_price,
+                                pool=f"{token0}/{token1}/{fee}"
+                            )
                     except Exception as publish_error:
                         logger.warning(f"Failed to publish rebalance event: {publish_error}")
                 except Exception as token_info_error:
@@ -897,6 +1431,10 @@ class AutomatedRebalancer:
         except Exception as e:
             logger.error(f"Error during rebalancing: {e}")
             
+            # Nothing was sent yet: drop the intent; otherwise leave it for the next attempt/restart
+            if self._active_rebalance and self._active_rebalance['state'] == STATE_INTENT:
+                self._journal_rebalance(STATE_ABORTED, error=str(e))
+            
             # Send error notification
             try:
                 self.alert_manager.send_error_notification(
@@ -929,98 +1467,171 @@ class AutomatedRebalancer:
             
             return {'error': str(e)}
     
-    def monitoring_loop(self, token0: str, token1: str, fee: int):
+    def monitoring_tick(self, token0: str, token1: str, fee: int, spot_price: Optional[float] = None):
         """
-        Main monitoring loop - only monitors spot price, positions tracked in memory
+        One monitoring cycle: record price, publish inventory, rebalance if needed
         
         Args:
             token0: Token0 address
             token1: Token1 address
             fee: Fee tier
+            spot_price: Spot price from the event feed (read from slot0 if None)
         """
-        logger.info("Starting monitoring loop...")
+        with metrics.span('tick.total'):
+            self._monitoring_tick(token0, token1, fee, spot_price)
+    
+    def apply_config(self, config):
+        """
+        Use a reloaded config from the next monitoring tick on
         
-        while self.is_running:
-            try:
-                # Get current spot price
+        Safe to call from any thread: the tick in progress keeps the config it
+        started with, so no tick ever mixes old and new parameters.
+        
+        Args:
+            config: Config snapshot (class or instance)
+        """
+        self._pending_config = config() if isinstance(config, type) else config
+    
+    def _refresh_config(self):
+        """Swap in a config published by apply_config(), rebuilding the model and strategy"""
+        config, self._pending_config = self._pending_config, None
+        if config is None:
+            return
+        try:
+            model = ModelFactory.create_model(config.INVENTORY_MODEL, config)
+        except Exception as e:
+            logger.error(f"Keeping current config, cannot build {config.INVENTORY_MODEL}: {e}")
+            return
+        self.config = config
+        self.inventory_model = model
+        self.strategy = AsymmetricLPStrategy(config, model)
+        self.price_history = self.price_history[-config.VOLATILITY_WINDOW_SIZE:]
+        logger.info(f"Config v{getattr(config, 'CONFIG_VERSION', '?')} active: "
+                    f"threshold={config.REBALANCE_THRESHOLD}, model={config.INVENTORY_MODEL}")
+    
+    def _monitoring_tick(self, token0: str, token1: str, fee: int, spot_price: Optional[float]):
+        if self._pending_config is not None:
+            self._refresh_config()
+        
+        # Get current spot price (unless the price feed already supplied it)
+        if spot_price is None:
+            with metrics.span('tick.price_read'):
                 spot_price = self.get_current_spot_price(token0, token1, fee)
+        
+        if spot_price != self.last_spot_price:
+            logger.info(f"Spot price changed: {self.last_spot_price} -> {spot_price}")
+            self.last_spot_price = spot_price
+            self.price_history.append({
+                'timestamp': time.time(),
+                'price': spot_price
+            })
+            if self.wal:
+                self.wal.record_price(spot_price, self.price_history[-1]['timestamp'])
+            
+            # Keep only last VOLATILITY_WINDOW_SIZE price points
+            max_history = self.config.VOLATILITY_WINDOW_SIZE
+            if len(self.price_history) > max_history:
+                self.price_history = self.price_history[-max_history:]
+        
+        # Get current positions from memory
+        positions = self.get_position_ranges()
+        
+        # Get inventory status and publish to CeFi MM agent on every monitoring cycle
+        with metrics.span('tick.model_eval'):
+            inventory_status = self.get_inventory_status(spot_price)
+        if inventory_status:
+            # Publish inventory data to CeFi MM agent
+            try:
+                # Get token symbols for publishing
+                token_a_info = self.client.get_token_info(token0)
+                token_b_info = self.client.get_token_info(token1)
                 
-                if spot_price != self.last_spot_price:
-                    logger.info(f"Spot price changed: {self.last_spot_price} -> {spot_price}")
-                    self.last_spot_price = spot_price
-                    self.price_history.append({
-                        'timestamp': time.time(),
-                        'price': spot_price
-                    })
-                    
-                    # Keep only last VOLATILITY_WINDOW_SIZE price points
-                    max_history = self.config.VOLATILITY_WINDOW_SIZE
-                    if len(self.price_history) > max_history:
-                        self.price_history = self.price_history[-max_history:]
-                
-                # Get current positions from memory
-                positions = self.get_position_ranges()
-                
-                # Get inventory status and publish to CeFi MM agent on every monitoring cycle
-                inventory_status = self.get_inventory_status(spot_price)
-                if inventory_status:
-                    # Publish inventory data to CeFi MM agent
-                    try:
-                        # Get token symbols for publishing
-                        token_a_info = self.client.get_token_info(token0)
-                        token_b_info = self.client.get_token_info(token1)
-                        
-                        # Calculate ranges for publishing
-                        ranges = {
-                            'token_a_range': inventory_status['token_a_range_percent'],
-                            'token_b_range': inventory_status['token_b_range_percent']
-                        }
-                        
-                        # Get current volatility from price history
-                        volatility = self.inventory_model.calculate_volatility(self.price_history)
-                        
-                        self.inventory_publisher.update_inventory_data(
-                            token_a_address=token0,
-                            token_b_address=token1,
-                            token_a_balance=inventory_status['token_a_balance'],
-                            token_b_balance=inventory_status['token_b_balance']
-                        )
-                    except Exception as publish_error:
-                        logger.warning(f"Failed to publish inventory data: {publish_error}")
+                # Calculate ranges for publishing
+                ranges = {
+                    'token_a_range': inventory_status['token_a_range_percent'],
+                    'token_b_range': inventory_status['token_b_range_percent']
+                }
                 
-                # Log position summary and inventory status every 5 minutes
-                if int(time.time()) % 300 == 0:
-                    logger.info(f"Position Summary: {len(positions)} active positions")
-                    for pos in positions:
-                        logger.info(f"  Position {pos['token_id']}: "
-                                  f"Range {pos['tick_lower']}-{pos['tick_upper']}, "
-                                  f"Liquidity {pos['liquidity']}, "
-                                  f"Fees owed: {pos['tokens_owed0']}/{pos['tokens_owed1']}")
-                    
-                    # Log inventory status (detailed logging every 5 minutes)
-                    if inventory_status:
-                        logger.info(f"Inventory Status:")
-                        logger.info(f"  Spot Price: {inventory_status['spot_price']:.6f}")
-                        logger.info(f"  Token A Ratio: {inventory_status['token_a_ratio']:.3f}")
-                        logger.info(f"  Token B Ratio: {inventory_status['token_b_ratio']:.3f}")
-                        logger.info(f"  Inventory Imbalance: {inventory_status['inventory_imbalance']:.3f}")
-                        logger.info(f"  Excess Token: {inventory_status['excess_token']}")
-                        logger.info(f"  Target Rebalance: {inventory_status['target_rebalance']}")
-                        logger.info(f"  Total Value USD: ${inventory_status['total_value_usd']:.2f}")
-                        logger.info(f"  Range A: {inventory_status['token_a_range_percent']:.2f}%")
-                        logger.info(f"  Range B: {inventory_status['token_b_range_percent']:.2f}%")
+                volatility = inventory_status['volatility']
                 
-                # Check if rebalancing is needed
-                if self.should_rebalance(spot_price, positions):
-                    logger.info("Rebalancing triggered")
+                self.inventory_publisher.update_inventory_data(
+                    token_a_address=token0,
+                    token_b_address=token1,
+                    token_a_balance=inventory_status['token_a_balance'],
+                    token_b_balance=inventory_status['token_b_balance'],
+                    spot_price=spot_price,
+                    volatility=volatility,
+                    range_a_pct=ranges['token_a_range'],
+                    range_b_pct=ranges['token_b_range']
+                )
+            except Exception as publish_error:
+                logger.warning(f"Failed to publish inventory data: {publish_error}")
+            
+            self._write_snapshot(inventory_status, positions)
+        
+        # Log position summary and inventory status every 5 minutes
+        if int(time.time()) % 300 == 0:
+            logger.info(f"Position Summary: {len(positions)} active positions")
+            for pos in positions:
+                logger.info(f"  Position {pos['token_id']}: "
+                          f"Range {pos['tick_lower']}-{pos['tick_upper']}, "
+                          f"Liquidity {pos['liquidity']}, "
+                          f"Fees owed: {pos['tokens_owed0']}/{pos['tokens_owed1']}")
+            
+            # Log inventory status (detailed logging every 5 minutes)
+            if inventory_status:
+                logger.info(f"Inventory Status:")
+                logger.info(f"  Spot Price: {inventory_status['spot_price']:.6f}")
+                logger.info(f"  Token A Ratio: {inventory_status['token_a_ratio']:.3f}")
+                logger.info(f"  Token B Ratio: {inventory_status['token_b_ratio']:.3f}")
+                logger.info(f"  Target Ratio: {inventory_status['target_ratio']:.3f}")
+                logger.info(f"  Inventory Deviation: {inventory_status['inventory_deviation']:.3f}")
+                logger.info(f"  Volatility: {inventory_status['volatility']:.4f}")
+                logger.info(f"  Range A: {inventory_status['token_a_range_percent']:.2f}%")
+                logger.info(f"  Range B: {inventory_status['token_b_range_percent']:.2f}%")
+        
+        # Check if rebalancing is needed (or an interrupted one must be finished)
+        with metrics.span('tick.should_rebalance'):
+            triggered = self.resume_rebalance or self.should_rebalance(spot_price, positions)
+        if triggered:
+            logger.info("Rebalancing triggered" if not self.resume_rebalance else "Resuming interrupted rebalance")
+            if self.snapshot:
+                self.snapshot.set_flag(FLAG_REBALANCING, True)
+            try:
+                with metrics.span('rebalance.total'), rpc_lane(LANE_EXECUTION):
                     result = self.rebalance_positions(token0, token1, fee)
-                    
-                    if 'error' in result:
-                        logger.error(f"Rebalancing failed: {result['error']}")
-                    else:
-                        logger.info("Rebalancing successful")
-                        logger.info(f"Fees collected: {result.get('fees_collected', {})}")
-                        logger.info(f"Positions burned: {result.get('positions_burned', 0)}")
+            finally:
+                if self.snapshot:
+                    self.snapshot.set_flag(FLAG_REBALANCING, False)
+            
+            if 'error' in result:
+                logger.error(f"Rebalancing failed: {result['error']}")
+            else:
+                logger.info("Rebalancing successful")
+                logger.info(f"Fees collected: {result.get('fees_collected', {})}")
+                logger.info(f"Positions burned: {result.get('positions_burned', 0)}")
+    
+    def monitoring_loop(self, token0: str, token1: str, fee: int):
+        """
+        Main monitoring loop - only monitors spot price, positions tracked in memory
+        
+        With PRICE_FEED_WS_URL set, cycles run on pool state changes pushed by the
+        websocket feed; otherwise slot0 is polled every MONITORING_INTERVAL_SECONDS.
+        
+        Args:
+            token0: Token0 address
+            token1: Token1 address
+            fee: Fee tier
+        """
+        logger.info("Starting monitoring loop...")
+        
+        if self.config.PRICE_FEED_WS_URL:
+            self._event_driven_loop(token0, token1, fee)
+            return
+        
+        while self.is_running:
+            try:
+                self.monitoring_tick(token0, token1, fee)
                 
                 # Wait for next check
                 time.sleep(self.config.MONITORING_INTERVAL_SECONDS)
@@ -1029,6 +1640,61 @@ class AutomatedRebalancer:
                 logger.error(f"Error in monitoring loop: {e}")
                 time.sleep(10)  # Wait 10 seconds before retrying
     
+    def _event_driven_loop(self, token0: str, token1: str, fee: int):
+        """
+        Run monitoring cycles only when the websocket feed reports a new pool state
+        
+        Updates arriving while a cycle (or a rebalance) is in progress are
+        conflated: the next cycle sees only the latest state.
+        
+        Args:
+            token0: Token0 address
+            token1: Token1 address
+            fee: Fee tier
+        """
+        pool_address = self.client.get_pool_address(token0, token1, fee)
+        pool_info = self.client.get_pool_info(pool_address)
+        pool_token0, pool_token1 = pool_info['token0'], pool_info['token1']
+        
+        state_changed = threading.Event()
+        latest = {'state': None}
+        
+        def on_state_change(state: PoolState):
+            latest['state'] = state
+            state_changed.set()
+        
+        self.price_feed = PoolPriceFeed(
+            self.config.PRICE_FEED_WS_URL, pool_address, on_state_change,
+            on_new_head=self.client.on_new_head,
+            initial_state=PoolState(
+                block_number=self.client.w3.eth.block_number, log_index=-1,
+                sqrt_price_x96=pool_info['sqrt_price_x96'], tick=pool_info['tick'],
+                liquidity=self.client.get_pool_liquidity(pool_address)
+            ),
+            config=self.config
+        )
+        self.price_feed.start()
+        
+        try:
+            # Initial cycle from the seed state (an RPC error here must not end the thread)
+            try:
+                self.monitoring_tick(token0, token1, fee)
+            except Exception as e:
+                logger.error(f"Error in monitoring loop: {e}")
+            while self.is_running:
+                if not state_changed.wait(timeout=1.0):
+                    continue
+                state_changed.clear()
+                try:
+                    spot_price = self._sqrt_price_to_spot(
+                        latest['state'].sqrt_price_x96, pool_token0, pool_token1
+                    )
+                    self.monitoring_tick(token0, token1, fee, spot_price=spot_price)
+                except Exception as e:
+                    logger.error(f"Error in monitoring loop: {e}")
+        finally:
+            self.price_feed.stop()
+    
     def start_monitoring(self, token0: str, token1: str, fee: int):
         """
         Start the monitoring process
@@ -1056,6 +1722,16 @@ class AutomatedRebalancer:
         
         self.is_running = True
         
+        if self.client.fee_oracle:
+            self.client.fee_oracle.start()
+        
+        if self.config.METRICS_PORT or self.config.METRICS_SUMMARY_INTERVAL_SECONDS:
+            self.metrics_exporter = MetricsExporter(
+                metrics, port=self.config.METRICS_PORT, host=self.config.METRICS_HOST,
+                summary_interval=self.config.METRICS_SUMMARY_INTERVAL_SECONDS
+            )
+            self.metrics_exporter.start()
+        
         self.monitoring_thread = threading.Thread(
             target=self.monitoring_loop,
             args=(token0, token1, fee),
@@ -1076,6 +1752,14 @@ class AutomatedRebalancer:
         if self.monitoring_thread:
             self.monitoring_thread.join(timeout=5)
         
+        if self.client.fee_oracle:
+            self.client.fee_oracle.stop()
+        
+        if self.metrics_exporter:
+            self.metrics_exporter.log_summary()
+            self.metrics_exporter.stop()
+            self.metrics_exporter = None
+        
         logger.info("Monitoring stopped")
     
     def get_status(self) -> Dict[str, Any]:
@@ -1089,5 +1773,7 @@ class AutomatedRebalancer:
             'current_positions': len(current_positions),
             'position_details': current_positions,
             'monitoring_interval': self.config.MONITORING_INTERVAL_SECONDS,
-            'rebalance_threshold': self.config.REBALANCE_THRESHOLD_PERCENTAGE
+            'rebalance_threshold': self.config.REBALANCE_THRESHOLD_PERCENTAGE,
+            'config_version': getattr(self.config, 'CONFIG_VERSION', 0),
+            'latency': metrics.summary()
         }
\ No newline at end of file
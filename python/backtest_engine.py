@@ -7,18 +7,33 @@ import logging
 import math
 import pandas as pd
 import numpy as np
+from array import array
+from collections.abc import Sequence
 from typing import Dict, List, Tuple, Any, Optional
 from datetime import datetime, timedelta
 import json
 from dataclasses import dataclass
 from config import Config
+from backtest_config import BacktestConfig
 from models.model_factory import ModelFactory
 from strategy import AsymmetricLPStrategy
 from alert_manager import TelegramAlertManager
-from amm import AMMSimulator, SwapEvent
+from amm import AMMSimulator, SwapEvent, SwapEventArena
+from backtest_summary import StreamingSummary
 from inventory_publisher import InventoryPublisher
+import fastlog
 
 logger = logging.getLogger(__name__)
+_log = fastlog.get_logger(__name__)
+
+# Bars boxed into Python objects at a time by summary-only runs
+SUMMARY_BAR_CHUNK = 1024
+
+MSG_AMM_BALANCES = fastlog.message("Using AMM active position balances: token0={:.6f}, token1={:.6f}")
+MSG_INITIAL_BALANCES = fastlog.message("No active AMM positions, using initial balances: token0={:.6f}, token1={:.6f}")
+MSG_POSITIONS_CREATED = fastlog.message("Created tick-aligned positions: A=[{:.8f},{:.8f}] B=[{:.8f},{:.8f}] "
+                                        "(ranges A={}%, B={}%)")
+MSG_REBALANCED = fastlog.message("Rebalanced at {}: burned {} positions, created {} new positions")
 
 @dataclass
 class BacktestPosition:
@@ -61,6 +76,60 @@ class BacktestTrade:
             range_b_percentage=range_b_pct_percent,
         )
 
+class TradeLog(Sequence):
+    """
+    Trades of a backtest, backed by a SwapEventArena
+
+    The backtest loop only records a row per trade (the arena event plus the
+    band widths active at the time); a BacktestTrade is built the first time
+    a trade is looked at, then cached so edits to it stick.
+    """
+
+    def __init__(self, events: Optional[SwapEventArena] = None):
+        self.events = events if events is not None else SwapEventArena()
+        self.range_a_percentage = array('d')
+        self.range_b_percentage = array('d')
+        self._materialized: Dict[int, BacktestTrade] = {}
+
+    def record(self, index: int, range_a_pct_percent: float, range_b_pct_percent: float):
+        """Register arena event index as the next trade"""
+        if index != len(self.range_a_percentage):
+            raise ValueError(f"Trade {index} recorded out of order")
+        self.range_a_percentage.append(range_a_pct_percent)
+        self.range_b_percentage.append(range_b_pct_percent)
+
+    def __len__(self) -> int:
+        return len(self.range_a_percentage)
+
+    def __getitem__(self, index):
+        if isinstance(index, slice):
+            return [self[i] for i in range(*index.indices(len(self)))]
+        if index < 0:
+            index += len(self)
+        if not 0 <= index < len(self):
+            raise IndexError(f"trade {index} out of range ({len(self)} trades)")
+        trade = self._materialized.get(index)
+        if trade is None:
+            trade = BacktestTrade.from_swap_event(self.events.event(index),
+                                                  self.range_a_percentage[index], self.range_b_percentage[index])
+            self._materialized[index] = trade
+        return trade
+
+def iter_bars(df: pd.DataFrame, chunk_size: Optional[int] = None):
+    """
+    (timestamp, close) per bar
+
+    Args:
+        df: OHLC frame
+        chunk_size: Box this many rows at a time (None: let pandas box whole columns)
+    """
+    timestamps, closes = df['timestamp'], df['close']
+    if chunk_size is None:
+        yield from zip(timestamps, closes)
+        return
+    for start in range(0, len(df), chunk_size):
+        yield from zip(timestamps.iloc[start:start + chunk_size], closes.iloc[start:start + chunk_size])
+
 @dataclass
 class BacktestResult:
     """Results from a backtest run"""
@@ -72,7 +141,7 @@ class BacktestResult:
     final_balance_1: float
     total_rebalances: int
     total_trades: int
-    trades: List[BacktestTrade]
+    trades: Sequence  # of BacktestTrade (a TradeLog from run_backtest)
     rebalances: List[Dict[str, Any]]
     # Performance metrics
     token0_return: float = 0.0
@@ -81,18 +150,22 @@ class BacktestResult:
     token0_drawdown: float = 0.0
     token1_drawdown: float = 0.0
     initial_target_ratio: float = 0.5
+    # Streaming aggregates of a summary_only run (trades/rebalances are then empty)
+    summary: Optional[StreamingSummary] = None
 
 class BacktestEngine:
     """Engine for backtesting LP rebalancing strategies"""
     
-    def __init__(self, config: Config):
+    def __init__(self, config: Config, backtest_config: Optional[BacktestConfig] = None):
         """
         Initialize backtest engine
         
         Args:
             config: Configuration object
+            backtest_config: Settings from backtest_config.json (part of the result cache key)
         """
         self.config = config
+        self.backtest_config = backtest_config
         # Initialize inventory model using factory
         model_name = getattr(config, 'INVENTORY_MODEL', 'AvellanedaStoikovModel')
         self.inventory_model = ModelFactory.create_model(model_name, config)
@@ -107,7 +180,7 @@ class BacktestEngine:
         self.balance_0 = 0.0  # Token A balance
         self.balance_1 = 0.0  # Token B balance
         self.price_history = []
-        self.trades = []
+        self.trades = TradeLog()
         self.rebalances = []
         self.last_rebalance_time = None
         # Baselines set at each rebalance (for edge-triggered rebalances)
@@ -118,6 +191,12 @@ class BacktestEngine:
         
         # Performance tracking
         self.portfolio_values = []  # Track portfolio value over time
+        # Per-phase profiling (profiler.PhaseProfiler); None disables it
+        self.profiler = None
+        # Content-addressed store of finished runs (result_cache.ResultCache); None disables it
+        self.result_cache = None
+        # Streaming aggregates while a summary_only run is in progress
+        self.summary: Optional[StreamingSummary] = None
         
         # Fee tier in basis points (e.g., 3000 = 0.3%)
         self.fee_tier_bps = config.FEE_TIER
@@ -294,14 +373,14 @@ class BacktestEngine:
         if amm_simulator.has_active_positions():
             # Get balances from active AMM positions
             amm_token0_balance, amm_token1_balance = amm_simulator.get_active_positions_balances()
-            logger.info(f"Using AMM active position balances: token0={amm_token0_balance:.6f}, token1={amm_token1_balance:.6f}")
+            _log.info(MSG_AMM_BALANCES, amm_token0_balance, amm_token1_balance)
             
             # Use AMM balances for rebalancing calculation
             rebalance_token0_balance = amm_token0_balance
             rebalance_token1_balance = amm_token1_balance
         else:
             # No active positions, use initial balances
-            logger.info(f"No active AMM positions, using initial balances: token0={self.balance_0:.6f}, token1={self.balance_1:.6f}")
+            _log.info(MSG_INITIAL_BALANCES, self.balance_0, self.balance_1)
             rebalance_token0_balance = self.balance_0
             rebalance_token1_balance = self.balance_1
         
@@ -403,35 +482,38 @@ class BacktestEngine:
             # Update engine-side balances to reflect AMM state post-mint
             self.balance_0, self.balance_1 = amm_simulator.get_active_positions_balances()
             # Capture state for JSON: first mint, next rebalance, and first trade after
-            if not hasattr(self, '_debug_capture'):
-                self._debug_capture = {
-                    'first_mint': None,
-                    'second_rebalance': None,
-                    'first_trade_after_second_rebalance': None
-                }
-            # Record first mint snapshot
-            if self._debug_capture['first_mint'] is None:
-                self._debug_capture['first_mint'] = {
-                    'timestamp': timestamp.isoformat(),
-                    'price': current_price,
-                    'post_mint_balances': {'token0': self.balance_0, 'token1': self.balance_1},
-                    'ranges': {'A': [position_a_lower, position_a_upper], 'B': [position_b_lower, position_b_upper]},
-                }
-            else:
-                # If first mint exists and second rebalance not yet captured, this is the second rebalance
-                if self._debug_capture['second_rebalance'] is None:
-                    self._debug_capture['second_rebalance'] = {
+            # (skipped in summary runs, which keep no per-event snapshots)
+            if self.summary is None:
+                if not hasattr(self, '_debug_capture'):
+                    self._debug_capture = {
+                        'first_mint': None,
+                        'second_rebalance': None,
+                        'first_trade_after_second_rebalance': None
+                    }
+                # Record first mint snapshot
+                if self._debug_capture['first_mint'] is None:
+                    self._debug_capture['first_mint'] = {
                         'timestamp': timestamp.isoformat(),
                         'price': current_price,
-                        'post_rebalance_balances': {'token0': self.balance_0, 'token1': self.balance_1},
+                        'post_mint_balances': {'token0': self.balance_0, 'token1': self.balance_1},
                         'ranges': {'A': [position_a_lower, position_a_upper], 'B': [position_b_lower, position_b_upper]},
                     }
+                else:
+                    # If first mint exists and second rebalance not yet captured, this is the second rebalance
+                    if self._debug_capture['second_rebalance'] is None:
+                        self._debug_capture['second_rebalance'] = {
+                            'timestamp': timestamp.isoformat(),
+                            'price': current_price,
+                            'post_rebalance_balances': {'token0': self.balance_0, 'token1': self.balance_1},
+                            'ranges': {'A': [position_a_lower, position_a_upper], 'B': [position_b_lower, position_b_upper]},
+                        }
             # Update rebalance baselines (edge-triggered logic)
             self.last_rebalance_token0 = self.balance_0
             self.last_rebalance_token1 = self.balance_1
             self.last_rebalance_price = current_price
             
-            logger.info(f"Created tick-aligned positions: A=[{position_a_lower:.8f},{position_a_upper:.8f}] B=[{position_b_lower:.8f},{position_b_upper:.8f}] (ranges A={ranges['range_a_percentage']}%, B={ranges['range_b_percentage']}%)")
+            _log.info(MSG_POSITIONS_CREATED, position_a_lower, position_a_upper, position_b_lower, position_b_upper,
+                      ranges['range_a_percentage'], ranges['range_b_percentage'])
             # Save current active range percentages (in percent units) for later inclusion on trades
             self._active_range_a_pct_percent = float(ranges.get('range_a_percentage', 0.0))
             self._active_range_b_pct_percent = float(ranges.get('range_b_percentage', 0.0))
@@ -446,34 +528,63 @@ class BacktestEngine:
             'is_initial_mint': startup_allocation
         }
         
-        self.rebalances.append(rebalance_result)
-        logger.info(f"Rebalanced at {timestamp}: burned {positions_burned} positions, created {len(self.positions)} new positions")
+        if self.summary is None:
+            self.rebalances.append(rebalance_result)
+        else:
+            self.summary.record_rebalance()
+        _log.info(MSG_REBALANCED, timestamp, positions_burned, len(self.positions))
         
         return rebalance_result
     
     def run_backtest(self, 
-                    ohlc_file: str,
+                    ohlc_file,
                     initial_balance_0: float,
                     initial_balance_1: float,
                     start_date: Optional[datetime] = None,
-                    end_date: Optional[datetime] = None) -> BacktestResult:
+                    end_date: Optional[datetime] = None,
+                    summary_only: bool = False) -> BacktestResult:
         """
         Run backtest on historical data
         
         Args:
-            ohlc_file: Path to OHLC CSV file
+            ohlc_file: Path to OHLC CSV file, or a DataFrame from load_ohlc_data (shared across runs)
             initial_balance_0: Initial token A balance
             initial_balance_1: Initial token B balance
             start_date: Start date for backtest (optional)
             end_date: End date for backtest (optional)
+            summary_only: Keep only streaming aggregates (result.summary) instead of
+                every trade, rebalance and portfolio value, so memory does not grow
+                with the number of bars (for parameter sweeps)
             
         Returns:
-            BacktestResult with performance metrics
+            BacktestResult with performance metrics (on a result_cache hit, the
+            stored result; the engine's own state is then left untouched)
         """
+        if self.result_cache is not None:
+            return self.result_cache.run(
+                self, lambda: self._run_profiled(ohlc_file, initial_balance_0, initial_balance_1, start_date,
+                                                 end_date, summary_only),
+                ohlc_file, initial_balance_0, initial_balance_1, start_date, end_date, summary_only)
+        return self._run_profiled(ohlc_file, initial_balance_0, initial_balance_1, start_date, end_date,
+                                  summary_only)
+    
+    def _run_profiled(self, ohlc_file, initial_balance_0: float, initial_balance_1: float,
+                      start_date: Optional[datetime], end_date: Optional[datetime],
+                      summary_only: bool) -> BacktestResult:
+        if self.profiler is None:
+            return self._run_backtest(ohlc_file, initial_balance_0, initial_balance_1, start_date, end_date,
+                                      summary_only)
+        with self.profiler.session(self):
+            return self._run_backtest(ohlc_file, initial_balance_0, initial_balance_1, start_date, end_date,
+                                      summary_only)
+    
+    def _run_backtest(self, ohlc_file, initial_balance_0: float, initial_balance_1: float,
+                      start_date: Optional[datetime], end_date: Optional[datetime],
+                      summary_only: bool) -> BacktestResult:
         logger.info("Starting backtest...")
         
         # Load OHLC data
-        df = self.load_ohlc_data(ohlc_file)
+        df = ohlc_file if isinstance(ohlc_file, pd.DataFrame) else self.load_ohlc_data(ohlc_file)
         
         # Filter by date range if specified
         if start_date:
@@ -491,8 +602,9 @@ class BacktestEngine:
         self.initial_token1 = initial_balance_1
         self.positions = []
         self.price_history = []
-        self.trades = []
+        self.trades = TradeLog()
         self.rebalances = []
+        summary = self.summary = StreamingSummary() if summary_only else None
         
         # Calculate initial target ratio based on initial balances (USD units)
         # token0 is already in token0 units (USD); token1 valued via 1/price
@@ -524,41 +636,49 @@ class BacktestEngine:
         
         # Set initial balances in AMM Simulator
         amm_simulator.set_initial_balances(initial_balance_0, initial_balance_1)
+        if self.profiler is not None:
+            from profiler import AMM_PHASES
+            self.profiler.instrument(amm_simulator, AMM_PHASES)
         
         # Process each minute
         prev_portfolio_value = None
         
-        for i, row in df.iterrows():
-            timestamp = row['timestamp']
-            current_price = row['close']
-            
+        # One arena for the whole run; trades are materialized only when inspected.
+        # A summary run reuses a single slot and folds each event into the aggregates.
+        events = self.trades.events if summary is None else SwapEventArena(capacity=1)
+        for timestamp, current_price in iter_bars(df, SUMMARY_BAR_CHUNK if summary is not None else None):
             # Update price history
             self.price_history.append({
                 'timestamp': timestamp.timestamp(),
                 'price': current_price
             })
             
-            # Keep only recent price history
+            # Keep only recent price history (trimmed in place)
             if len(self.price_history) > self.config.VOLATILITY_WINDOW_SIZE:
-                self.price_history = self.price_history[-self.config.VOLATILITY_WINDOW_SIZE:]
+                del self.price_history[:-self.config.VOLATILITY_WINDOW_SIZE]
             
-            # Process OHLC row through AMM Simulator
-            swap_event = amm_simulator.compute(row)
+            # Process OHLC bar through AMM Simulator
+            if summary is not None:
+                events.clear()
+            index = amm_simulator.compute_into(timestamp, current_price, events)
             
-            if swap_event:
-                # Convert swap event to trade
-                trade = BacktestTrade.from_swap_event(
-                    swap_event,
+            if index >= 0 and summary is not None:
+                summary.record_trade(events, index)
+                self.balance_0 = events.new_token0_balance[index]
+                self.balance_1 = events.new_token1_balance[index]
+            elif index >= 0:
+                self.trades.record(
+                    index,
                     getattr(self, '_active_range_a_pct_percent', 0.0),
                     getattr(self, '_active_range_b_pct_percent', 0.0)
                 )
-                self.trades.append(trade)
                 
                 # Update our balances with new balances from swap event
-                self.balance_0 = swap_event.new_token0_balance
-                self.balance_1 = swap_event.new_token1_balance
+                self.balance_0 = events.new_token0_balance[index]
+                self.balance_1 = events.new_token1_balance[index]
                 # If we've already captured the second rebalance, capture the very first trade after it
                 if hasattr(self, '_debug_capture') and self._debug_capture.get('second_rebalance') and not self._debug_capture.get('first_trade_after_second_rebalance'):
+                    trade = self.trades[index]
                     self._debug_capture['first_trade_after_second_rebalance'] = {
                         'timestamp': trade.timestamp.isoformat(),
                         'price': trade.price,
@@ -574,7 +694,10 @@ class BacktestEngine:
             
             # Track portfolio value
             current_portfolio_value = self.calculate_portfolio_value(current_price)
-            self.portfolio_values.append(current_portfolio_value)
+            if summary is None:
+                self.portfolio_values.append(current_portfolio_value)
+            else:
+                summary.record_bar(timestamp, current_price, current_portfolio_value, amm_simulator.pool)
         
         # Calculate final results
         initial_price = df['close'].iloc[0]
@@ -608,8 +731,11 @@ class BacktestEngine:
         final_inventory_deviation = abs(final_current_ratio - self.initial_target_ratio)
         
         # Calculate drawdowns for each token
-        token0_drawdown = self.calculate_token_drawdown(0)  # Token0 drawdown
-        token1_drawdown = self.calculate_token_drawdown(1)  # Token1 drawdown
+        if summary is None:
+            token0_drawdown = self.calculate_token_drawdown(0)  # Token0 drawdown
+            token1_drawdown = self.calculate_token_drawdown(1)  # Token1 drawdown
+        else:
+            token0_drawdown = token1_drawdown = summary.max_drawdown
         
         result = BacktestResult(
             start_time=start_time,
@@ -618,11 +744,12 @@ class BacktestEngine:
             initial_balance_1=initial_balance_1,
             final_balance_0=final_balance_0,
             final_balance_1=final_balance_1,
-            total_rebalances=len(self.rebalances),
-            total_trades=len(self.trades),
+            total_rebalances=len(self.rebalances) if summary is None else summary.rebalances,
+            total_trades=len(self.trades) if summary is None else summary.trades,
             trades=self.trades,
             rebalances=self.rebalances,
-            initial_target_ratio=self.initial_target_ratio
+            initial_target_ratio=self.initial_target_ratio,
+            summary=summary
         )
         
         # Add new metrics to result
@@ -636,8 +763,8 @@ class BacktestEngine:
         logger.info(f"  Total return: {total_return:.2%}")
         logger.info(f"  Token0 return: {token0_return:.2%}")
         logger.info(f"  Token1 return: {token1_return:.2%}")
-        logger.info(f"  Total rebalances: {len(self.rebalances)}")
-        logger.info(f"  Total trades: {len(self.trades)}")
+        logger.info(f"  Total rebalances: {result.total_rebalances}")
+        logger.info(f"  Total trades: {result.total_trades}")
         logger.info(f"  Token0 drawdown: {token0_drawdown:.2%}")
         logger.info(f"  Token1 drawdown: {token1_drawdown:.2%}")
         
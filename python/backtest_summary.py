@@ -0,0 +1,149 @@
+"""
+AsymmetricLP - Streaming Backtest Summary
+Fixed-size aggregates for summary-only backtests (parameter sweeps): trade
+and rebalance counts, fee and volume totals, running drawdown, a
+time-in-range histogram and a downsampled equity curve. Nothing here grows
+with the number of bars, so a run's memory is bounded by its settings.
+"""
+from array import array
+from typing import Any, Dict, List, Optional, Tuple
+
+
+class DownsampledSeries:
+    """
+    At most max_points (timestamp, value) samples spread over the whole run
+
+    Every stride-th sample is kept; when the buffer fills, every other kept
+    sample is dropped and the stride doubles, so the points stay evenly
+    spaced whatever the run length.
+    """
+
+    def __init__(self, max_points: int = 512):
+        self.max_points = max(int(max_points), 2)
+        self.times: List[Any] = []
+        self.values = array('d')
+        self.stride = 1
+        self.seen = 0
+
+    def add(self, timestamp: Any, value: float):
+        if self.seen % self.stride == 0:
+            if len(self.values) == self.max_points:
+                del self.times[1::2]
+                del self.values[1::2]
+                self.stride *= 2
+            if self.seen % self.stride == 0:
+                self.times.append(timestamp)
+                self.values.append(value)
+        self.seen += 1
+
+    def points(self) -> List[Tuple[Any, float]]:
+        return list(zip(self.times, self.values))
+
+
+class StreamingSummary:
+    """Per-bar and per-event aggregates of one backtest run"""
+
+    def __init__(self, range_bins: int = 10, equity_points: int = 512):
+        """
+        Args:
+            range_bins: Histogram bins across the active band [lower, upper]
+            equity_points: Maximum equity curve samples kept
+        """
+        self.bars = 0
+        self.trades = 0
+        self.buys = 0
+        self.rebalances = 0
+        self.fees_token0 = 0.0
+        self.fees_token1 = 0.0
+        self.volume_usd = 0.0
+        self.peak_value: Optional[float] = None
+        self.max_drawdown = 0.0
+        self.first_value: Optional[float] = None
+        self.last_value: Optional[float] = None
+        # bars with the price in each band bin, below/above the bands, or with no position
+        self.range_histogram = [0] * max(int(range_bins), 1)
+        self.bars_below_range = 0
+        self.bars_above_range = 0
+        self.bars_without_position = 0
+        self.equity = DownsampledSeries(equity_points)
+
+    def record_trade(self, events, index: int):
+        """Fold swap event index of a SwapEventArena into the totals"""
+        self.trades += 1
+        self.buys += events.is_buy[index]
+        self.fees_token0 += events.fees_token0[index]
+        self.fees_token1 += events.fees_token1[index]
+        self.volume_usd += events.volume_usd[index]
+
+    def record_rebalance(self):
+        self.rebalances += 1
+
+    def record_bar(self, timestamp: Any, price: float, value: float, pool=None):
+        """
+        Fold one bar's portfolio value and band position into the aggregates
+
+        Args:
+            timestamp: Bar timestamp
+            price: Bar close
+            value: Portfolio value at the close
+            pool: UniswapV3Pool holding the active ranges (None if no position)
+        """
+        self.bars += 1
+        if self.first_value is None:
+            self.first_value = value
+        self.last_value = value
+        # Same arithmetic as BacktestEngine.calculate_token_drawdown
+        if self.peak_value is None or value > self.peak_value:
+            self.peak_value = value
+        if self.peak_value > 0:
+            drawdown = (self.peak_value - value) / self.peak_value
+            if drawdown > self.max_drawdown:
+                self.max_drawdown = drawdown
+        self.equity.add(timestamp, value)
+
+        low_range = pool.token1_range if pool is not None else None
+        high_range = pool.token0_range if pool is not None else None
+        if low_range is None and high_range is None:
+            self.bars_without_position += 1
+            return
+        lower = (low_range or high_range).range_lower
+        upper = (high_range or low_range).range_upper
+        if price < lower:
+            self.bars_below_range += 1
+        elif price > upper:
+            self.bars_above_range += 1
+        else:
+            bins = len(self.range_histogram)
+            position = (price - lower) / (upper - lower) if upper > lower else 0.5
+            self.range_histogram[min(int(position * bins), bins - 1)] += 1
+
+    @property
+    def sells(self) -> int:
+        return self.trades - self.buys
+
+    @property
+    def time_in_range(self) -> float:
+        """Share of bars with a position whose price was inside the bands"""
+        with_position = self.bars - self.bars_without_position
+        return sum(self.range_histogram) / with_position if with_position else 0.0
+
+    def to_dict(self) -> Dict[str, Any]:
+        return {
+            'bars': self.bars,
+            'trades': self.trades,
+            'buys': self.buys,
+            'sells': self.sells,
+            'rebalances': self.rebalances,
+            'fees_token0': self.fees_token0,
+            'fees_token1': self.fees_token1,
+            'volume_usd': self.volume_usd,
+            'max_drawdown': self.max_drawdown,
+            'first_value': self.first_value,
+            'last_value': self.last_value,
+            'time_in_range': self.time_in_range,
+            'range_histogram': list(self.range_histogram),
+            'bars_below_range': self.bars_below_range,
+            'bars_above_range': self.bars_above_range,
+            'bars_without_position': self.bars_without_position,
+            'equity_curve': [[t.isoformat() if hasattr(t, 'isoformat') else t, v] for t, v in self.equity.points()],
+        }
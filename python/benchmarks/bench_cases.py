@@ -0,0 +1,25 @@
+"""
+pytest-benchmark entry point for the cases in benchmarks/cases.py (not
+collected by the regular test run; pass the file explicitly):
+
+    pytest benchmarks/bench_cases.py --benchmark-autosave --benchmark-compare --benchmark-compare-fail=mean:25%
+"""
+import logging
+import os
+import sys
+
+import pytest
+
+pytest.importorskip('pytest_benchmark')
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from benchmarks.cases import CASES
+
+
+@pytest.mark.slow
+@pytest.mark.parametrize('name', list(CASES))
+def test_benchmark(benchmark, name):
+    logging.disable(logging.INFO)
+    fn, ops = CASES[name]()
+    benchmark.extra_info['ops_per_call'] = ops
+    benchmark(fn)
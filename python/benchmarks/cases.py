@@ -0,0 +1,107 @@
+"""
+AsymmetricLP - Benchmark Cases
+Hot paths of the backtest: single-sided range swaps, band minting, each
+model's range calculation, the volatility estimators and a full bar loop.
+Every case factory does its setup once and returns (fn, ops): fn runs
+`ops` operations per call, so results are comparable as ops/second.
+"""
+import math
+import os
+import sys
+from types import SimpleNamespace
+from typing import Callable, Dict, Tuple
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from config import Config
+
+DATA_FILE = os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(__file__))),
+                         'data', 'eth_usdc_3weeks_real_fixed.csv')
+
+BenchConfig = type('BenchConfig', (Config,), {
+    'INVENTORY_MODEL': 'GLFTModel', 'MIN_RANGE_PERCENTAGE': 10.0, 'MAX_RANGE_PERCENTAGE': 50.0,
+    'BASE_SPREAD': 0.2, 'REBALANCE_THRESHOLD': 0.1, 'VOLATILITY_WINDOW_SIZE': 20
+})
+
+# A deterministic price path around 1/3000 (token1 per token0, as in the data files)
+PRICES = [(1 / 3000) * (1 + 0.01 * math.sin(i / 7) + 0.002 * math.cos(i / 3)) for i in range(1000)]
+HISTORY = [{'timestamp': 1_700_000_000 + 60 * i, 'price': p} for i, p in enumerate(PRICES[:100])]
+CLIENT = SimpleNamespace(get_token_decimals=lambda address: 18)
+
+
+def swap_case() -> Tuple[Callable, int]:
+    from amm import Record, UniswapV3RangeToken0, UniswapV3RangeToken1
+
+    spot = PRICES[0]
+    upper = UniswapV3RangeToken0(0.0005, spot, spot * 1.2, 1500.0)
+    lower = UniswapV3RangeToken1(0.0005, spot * 0.8, spot, 0.5)
+    record = Record()
+
+    def run():
+        for price in PRICES:
+            upper.swap(price)
+            upper.settle(record)
+            lower.swap(price)
+            lower.settle(record)
+    return run, 2 * len(PRICES)
+
+
+def mint_bands_case() -> Tuple[Callable, int]:
+    from amm import AMMSimulator
+
+    simulator = AMMSimulator(fee_tier_bps=5, trade_detection_threshold=0.0005)
+    prices = PRICES[:100]
+
+    def run():
+        for price in prices:
+            simulator.mint_bands_percent(price, 0.1, 0.25, 1500.0, 0.5)
+    return run, len(prices)
+
+
+def model_case(model_name: str) -> Callable[[], Tuple[Callable, int]]:
+    def factory():
+        from models.model_factory import ModelFactory
+
+        model = ModelFactory.create_model(model_name, BenchConfig())
+        balances = [(int(b0 * 10 ** 18), int(b1 * 10 ** 18)) for b0, b1 in
+                    ((3000.0, 1.0), (1000.0, 1.5), (5000.0, 0.3), (2500.0, 0.9))]
+
+        def run():
+            for i, (token0, token1) in enumerate(balances):
+                model.calculate_lp_ranges(token0, token1, PRICES[i], HISTORY, '0xa', '0xb', CLIENT)
+        return run, len(balances)
+    return factory
+
+
+def volatility_case(estimator: str) -> Callable[[], Tuple[Callable, int]]:
+    def factory():
+        from models.avellaneda_stoikov import AvellanedaStoikovModel
+
+        model = AvellanedaStoikovModel(BenchConfig())
+        estimate = getattr(model, estimator)
+        windows = [HISTORY[i:i + 20] for i in range(0, 80, 4)]
+
+        def run():
+            for window in windows:
+                estimate(window, 20)
+        return run, len(windows)
+    return factory
+
+
+def backtest_case() -> Tuple[Callable, int]:
+    from backtest_engine import BacktestEngine
+
+    def run():
+        BacktestEngine(BenchConfig()).run_backtest(DATA_FILE, 3000.0, 1.0)
+    return run, 1
+
+
+CASES: Dict[str, Callable[[], Tuple[Callable, int]]] = {
+    'amm.range_swap': swap_case,
+    'amm.mint_bands_percent': mint_bands_case,
+    'model.avellaneda_stoikov.ranges': model_case('AvellanedaStoikovModel'),
+    'model.glft.ranges': model_case('GLFTModel'),
+    'model.simple.ranges': model_case('SimpleModel'),
+    'volatility.log_returns': volatility_case('calculate_volatility'),
+    'volatility.realized': volatility_case('calculate_realized_volatility'),
+    'backtest.eth_usdc_3weeks': backtest_case,
+}
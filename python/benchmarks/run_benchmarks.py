@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+"""
+AsymmetricLP - Benchmark Runner
+Times every case in benchmarks/cases.py, writes the results as JSON and
+flags throughput regressions against a stored baseline. Each case is
+auto-ranged to at least --min-time seconds per round; the best round is
+kept, which is the least noisy estimate on a shared machine.
+
+    python benchmarks/run_benchmarks.py                    # run, compare with baseline.json
+                                                           # (skipped if recorded on another machine/Python)
+    python benchmarks/run_benchmarks.py --save-baseline    # record this machine's baseline
+"""
+import argparse
+import json
+import logging
+import os
+import platform
+import subprocess
+import sys
+import time
+import timeit
+from datetime import datetime, timezone
+from typing import Any, Dict, List, Optional
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from benchmarks.cases import CASES
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+BASELINE_FILE = os.path.join(HERE, 'baseline.json')
+RESULTS_DIR = os.path.join(HERE, 'results')
+
+
+def _git_revision() -> Optional[str]:
+    try:
+        return subprocess.run(['git', 'rev-parse', '--short', 'HEAD'], cwd=HERE, check=True,
+                              capture_output=True, text=True).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def measure(name: str, rounds: int = 5, min_time: float = 0.2) -> Dict[str, Any]:
+    """
+    Time one case
+
+    Args:
+        name: Case name in CASES
+        rounds: Timed rounds (best is kept)
+        min_time: Minimum seconds per round (loops per round are auto-ranged)
+
+    Returns:
+        {'ns_per_op', 'ops_per_sec', 'loops', 'rounds'}
+    """
+    fn, ops = CASES[name]()
+    fn()  # warm-up (imports, caches)
+    timer = timeit.Timer(fn)
+    loops, elapsed = timer.autorange()
+    if elapsed < min_time:
+        loops = max(loops, int(loops * min_time / max(elapsed, 1e-9)))
+    best = min(timer.repeat(repeat=rounds, number=loops)) / (loops * ops)
+    return {'ns_per_op': best * 1e9, 'ops_per_sec': 1.0 / best, 'loops': loops, 'rounds': rounds}
+
+
+def run_all(names: List[str], rounds: int, min_time: float) -> Dict[str, Any]:
+    results = {}
+    for name in names:
+        results[name] = measure(name, rounds, min_time)
+        print(f"{name:<36} {results[name]['ns_per_op']:>14,.0f} ns/op {results[name]['ops_per_sec']:>14,.1f} ops/s")
+    return {
+        'created_at': datetime.now(timezone.utc).isoformat(),
+        'git_revision': _git_revision(),
+        'python': platform.python_version(),
+        'machine': f"{platform.system()} {platform.machine()} ({os.cpu_count()} cpus)",
+        'benchmarks': results
+    }
+
+
+def compare(results: Dict[str, Any], baseline: Dict[str, Any], threshold: float) -> List[str]:
+    """
+    Cases whose throughput dropped by more than threshold
+
+    Args:
+        results: This run
+        baseline: Stored baseline
+        threshold: Allowed fractional drop in ops/s (0.2 = 20%)
+
+    Returns:
+        One message per regressed case
+    """
+    regressions = []
+    print(f"\n{'case':<36} {'baseline ops/s':>16} {'now ops/s':>14} {'change':>8}")
+    for name, current in results['benchmarks'].items():
+        reference = baseline.get('benchmarks', {}).get(name)
+        if reference is None:
+            print(f"{name:<36} {'-':>16} {current['ops_per_sec']:>14,.1f}      new")
+            continue
+        change = current['ops_per_sec'] / reference['ops_per_sec'] - 1.0
+        flag = '  REGRESSION' if change < -threshold else ''
+        print(f"{name:<36} {reference['ops_per_sec']:>16,.1f} {current['ops_per_sec']:>14,.1f} {change:>+7.1%}{flag}")
+        if flag:
+            regressions.append(f"{name}: {change:+.1%} ops/s vs baseline {baseline.get('git_revision')}")
+    return regressions
+
+
+def same_environment(results: Dict[str, Any], baseline: Dict[str, Any]) -> List[str]:
+    """
+    Differences in machine and interpreter between a run and the baseline
+
+    Returns:
+        One 'field: baseline -> now' line per mismatch (empty if comparable)
+    """
+    return [f"{field}: {baseline.get(field)} -> {results.get(field)}"
+            for field in ('machine', 'python') if baseline.get(field) != results.get(field)]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Run the AsymmetricLP microbenchmarks')
+    parser.add_argument('cases', nargs='*', help='Case names or prefixes (default: all)')
+    parser.add_argument('--rounds', type=int, default=5, help='Timed rounds per case')
+    parser.add_argument('--min-time', type=float, default=0.2, help='Minimum seconds per round')
+    parser.add_argument('--baseline', default=BASELINE_FILE, help='Baseline JSON to compare with')
+    parser.add_argument('--threshold', type=float, default=0.25,
+                        help='Allowed throughput drop (0.25 = 25%%; timings on shared machines vary ~10-20%%)')
+    parser.add_argument('--save-baseline', action='store_true', help='Write the results as the new baseline')
+    parser.add_argument('--force-compare', action='store_true',
+                        help='Compare even if the baseline was recorded on another machine or Python')
+    parser.add_argument('--out', help='Results JSON (default: benchmarks/results/<timestamp>.json)')
+    args = parser.parse_args()
+
+    logging.disable(logging.INFO)
+    names = [n for n in CASES if not args.cases or any(n.startswith(c) for c in args.cases)]
+    if not names:
+        parser.error(f"No cases match {args.cases}; available: {', '.join(CASES)}")
+    results = run_all(names, args.rounds, args.min_time)
+
+    out = args.out or os.path.join(RESULTS_DIR, time.strftime('%Y%m%d_%H%M%S') + '.json')
+    os.makedirs(os.path.dirname(out) or '.', exist_ok=True)
+    with open(out, 'w') as f:
+        json.dump(results, f, indent=2)
+    print(f"\nResults written to {out}")
+
+    if args.save_baseline:
+        with open(args.baseline, 'w') as f:
+            json.dump(results, f, indent=2)
+        print(f"Baseline written to {args.baseline}")
+        return 0
+    if not os.path.exists(args.baseline):
+        print(f"No baseline at {args.baseline}; run with --save-baseline to record one")
+        return 0
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    mismatches = same_environment(results, baseline)
+    if mismatches and not args.force_compare:
+        # Absolute ops/s from another machine say nothing about this change
+        print(f"Skipping comparison: {args.baseline} was recorded elsewhere ({'; '.join(mismatches)}). "
+              f"Run with --save-baseline on the base commit, or --force-compare.")
+        return 0
+    regressions = compare(results, baseline, args.threshold)
+    for message in regressions:
+        print(f"REGRESSION {message}")
+    return 1 if regressions else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -27,6 +27,19 @@ class Config:
     # Network settings
     ETHEREUM_RPC_URL = os.getenv('ETHEREUM_RPC_URL', 'https://mainnet.infura.io/v3/YOUR_PROJECT_ID')
     
+    # Shared RPC gateway: failover endpoints (default: ETHEREUM_RPC_URL), per-endpoint quota, batching
+    RPC_GATEWAY_ENABLED = os.getenv('RPC_GATEWAY_ENABLED', 'true').lower() == 'true'
+    RPC_ENDPOINTS = [url.strip() for url in os.getenv('RPC_ENDPOINTS', '').split(',') if url.strip()]
+    RPC_RATE_LIMIT_PER_SECOND = float(os.getenv('RPC_RATE_LIMIT_PER_SECOND', '25'))
+    RPC_BURST = float(os.getenv('RPC_BURST', '50'))
+    RPC_BATCH_MAX = int(os.getenv('RPC_BATCH_MAX', '20'))
+    RPC_BATCH_WINDOW_MS = float(os.getenv('RPC_BATCH_WINDOW_MS', '2'))
+    RPC_CONCURRENCY = int(os.getenv('RPC_CONCURRENCY', '4'))
+    RPC_HTTP2 = os.getenv('RPC_HTTP2', 'false').lower() == 'true'  # Opt-in, needs httpx[http2]; keep-alive HTTP/1.1 otherwise
+    RPC_TIMEOUT_SECONDS = float(os.getenv('RPC_TIMEOUT_SECONDS', '10'))
+    RPC_MAX_ATTEMPTS = int(os.getenv('RPC_MAX_ATTEMPTS', '3'))
+    RPC_FAILOVER_COOLDOWN_SECONDS = float(os.getenv('RPC_FAILOVER_COOLDOWN_SECONDS', '5'))
+    
     # Private key handling - ONLY environment variable references allowed
     PRIVATE_KEY = os.getenv('PRIVATE_KEY')
     if PRIVATE_KEY:
@@ -49,6 +62,32 @@ class Config:
     
     # Gas settings
     MAX_GAS_LIMIT = int(os.getenv('MAX_GAS_LIMIT', '500000'))
+    MULTICALL_GAS_LIMIT = int(os.getenv('MULTICALL_GAS_LIMIT', '1500000'))  # Cap for a bundled burn-and-remint
+    
+    # State cache: how often to re-check the head when no new-heads subscription is running
+    STATE_CACHE_BLOCK_POLL_SECONDS = float(os.getenv('STATE_CACHE_BLOCK_POLL_SECONDS', '2'))
+    
+    # Rebalance write-ahead log (empty path disables it)
+    REBALANCE_WAL_PATH = os.getenv('REBALANCE_WAL_PATH', 'state/rebalance_wal.jsonl')
+    REBALANCE_WAL_COMPACT_EVERY = int(os.getenv('REBALANCE_WAL_COMPACT_EVERY', '1000'))
+    MULTICALL3_ADDRESS = os.getenv('MULTICALL3_ADDRESS', '0xcA11bde05977b3631167028862bE2a173976CA11')
+    
+    # EIP-1559 fee oracle (eth_feeHistory refreshed once per block)
+    FEE_ORACLE_ENABLED = os.getenv('FEE_ORACLE_ENABLED', 'true').lower() == 'true'
+    FEE_HISTORY_BLOCKS = int(os.getenv('FEE_HISTORY_BLOCKS', '20'))
+    FEE_PRIORITY_PERCENTILE = int(os.getenv('FEE_PRIORITY_PERCENTILE', '50'))
+    FEE_BASE_FEE_HORIZON_BLOCKS = int(os.getenv('FEE_BASE_FEE_HORIZON_BLOCKS', '3'))
+    FEE_ORACLE_POLL_INTERVAL_SECONDS = float(os.getenv('FEE_ORACLE_POLL_INTERVAL_SECONDS', '2'))
+    
+    # Transaction execution (pipelined rebalance batches)
+    RECEIPT_POLL_INTERVAL_SECONDS = float(os.getenv('RECEIPT_POLL_INTERVAL_SECONDS', '0.5'))
+    RECEIPT_TIMEOUT_SECONDS = float(os.getenv('RECEIPT_TIMEOUT_SECONDS', '180'))
+    MULTICALL_REBALANCE = os.getenv('MULTICALL_REBALANCE', 'true').lower() == 'true'
+    
+    # Pre-flight eth_call of every mint plan (on a local fork when PREFLIGHT_RPC_URL is set)
+    PREFLIGHT_ENABLED = os.getenv('PREFLIGHT_ENABLED', 'true').lower() == 'true'
+    PREFLIGHT_RPC_URL = os.getenv('PREFLIGHT_RPC_URL', '')
+    PREFLIGHT_SLIPPAGE_BPS = int(os.getenv('PREFLIGHT_SLIPPAGE_BPS', '50'))  # Min bounds = simulated amounts minus this
     
     # Token pair configuration
     TOKEN_A_ADDRESS = os.getenv('TOKEN_A_ADDRESS')
@@ -76,8 +115,23 @@ class Config:
     MIN_RANGE_PERCENTAGE = float(os.getenv('MIN_RANGE_PERCENTAGE', '2.0'))
     MAX_RANGE_PERCENTAGE = float(os.getenv('MAX_RANGE_PERCENTAGE', '50.0'))
     MONITORING_INTERVAL_SECONDS = int(os.getenv('MONITORING_INTERVAL_SECONDS', '5'))  # Default: 5 seconds
+    
+    # Event-driven price feed (websocket newHeads + Swap logs); polling is used when unset
+    PRICE_FEED_WS_URL = os.getenv('PRICE_FEED_WS_URL', '')
+    PRICE_FEED_MAX_BACKOFF_SECONDS = float(os.getenv('PRICE_FEED_MAX_BACKOFF_SECONDS', '30'))
+    PRICE_FEED_BACKFILL_MAX_BLOCKS = int(os.getenv('PRICE_FEED_BACKFILL_MAX_BLOCKS', '1000'))
     REBALANCE_THRESHOLD = float(os.getenv('REBALANCE_THRESHOLD', '0.10'))  # 10% deviation threshold
     
+    # Strategy hot reload: file of strategy/model overrides re-read on SIGHUP or when it changes (0 = SIGHUP only)
+    CONFIG_RELOAD_PATH = os.getenv('CONFIG_RELOAD_PATH', '')
+    CONFIG_RELOAD_POLL_SECONDS = float(os.getenv('CONFIG_RELOAD_POLL_SECONDS', '5'))
+    
+    # Multi-pool orchestrator (orchestrator.py): pools file, cycle cadence and worker threads
+    ORCHESTRATOR_POOLS_FILE = os.getenv('ORCHESTRATOR_POOLS_FILE', 'pools.json')
+    ORCHESTRATOR_CYCLE_SECONDS = float(os.getenv('ORCHESTRATOR_CYCLE_SECONDS', '1.0'))
+    ORCHESTRATOR_WORKERS = int(os.getenv('ORCHESTRATOR_WORKERS', '16'))
+    ORCHESTRATOR_IDLE_TICK_SECONDS = float(os.getenv('ORCHESTRATOR_IDLE_TICK_SECONDS', '60'))
+    
     # Backtesting-only parameters (only loaded when BACKTEST_MODE=true or .env.backtest exists)
     # These have defaults but are only meaningful in backtest mode
     TRADE_DETECTION_THRESHOLD = float(os.getenv('TRADE_DETECTION_THRESHOLD', '0.0005'))  # 0.05% threshold for trade detection (5 bps) - BACKTEST ONLY
@@ -86,6 +140,7 @@ class Config:
     DEFAULT_DAILY_VOLATILITY = float(os.getenv('DEFAULT_DAILY_VOLATILITY', '0.02'))  # 2% daily volatility - BACKTEST ONLY
     DEFAULT_INITIAL_BALANCE_0 = float(os.getenv('DEFAULT_INITIAL_BALANCE_0', '2500.0'))  # Default initial token A balance - BACKTEST ONLY
     DEFAULT_INITIAL_BALANCE_1 = float(os.getenv('DEFAULT_INITIAL_BALANCE_1', '1.0'))  # Default initial token B balance - BACKTEST ONLY
+    RESULT_CACHE_DIR = os.getenv('RESULT_CACHE_DIR', '.backtest_cache')  # Content-addressed result store (result_cache.py) - BACKTEST ONLY
     
     # Inventory management model parameters
     INVENTORY_RISK_AVERSION = float(os.getenv('INVENTORY_RISK_AVERSION', '0.1'))
@@ -106,10 +161,33 @@ class Config:
     TERMINAL_INVENTORY_PENALTY = float(os.getenv('TERMINAL_INVENTORY_PENALTY', '0.2'))  # Terminal penalty
     INVENTORY_CONSTRAINT_ACTIVE = os.getenv('INVENTORY_CONSTRAINT_ACTIVE', 'false').lower() == 'true'
     
+    # CeFi MM inventory publishing (binary schema, see inventory_schema.py)
+    ZMQ_ENABLED = os.getenv('ZMQ_ENABLED', 'false').lower() == 'true'
+    ZMQ_PUBLISHER_HOST = os.getenv('ZMQ_PUBLISHER_HOST', '127.0.0.1')
+    ZMQ_PUBLISHER_PORT = int(os.getenv('ZMQ_PUBLISHER_PORT', '5555'))
+    INVENTORY_SHM_RING_PATH = os.getenv('INVENTORY_SHM_RING_PATH', '')  # e.g. /dev/shm/asymmetric_lp_ring
+    INVENTORY_SHM_RING_SLOTS = int(os.getenv('INVENTORY_SHM_RING_SLOTS', '1024'))
+    INVENTORY_SNAPSHOT_PATH = os.getenv('INVENTORY_SNAPSHOT_PATH', '')  # e.g. /dev/shm/asymmetric_lp_snapshot
+    
+    # Latency metrics (Prometheus text at http://METRICS_HOST:METRICS_PORT/metrics; 0 disables)
+    METRICS_HOST = os.getenv('METRICS_HOST', '127.0.0.1')
+    METRICS_PORT = int(os.getenv('METRICS_PORT', '0'))
+    METRICS_SUMMARY_INTERVAL_SECONDS = float(os.getenv('METRICS_SUMMARY_INTERVAL_SECONDS', '300'))
+    
+    # Deferred hot-path logging (fastlog.py): per-thread ring, drain cadence, optional unformatted binary file
+    FASTLOG_RING_SIZE = int(os.getenv('FASTLOG_RING_SIZE', '65536'))
+    FASTLOG_FLUSH_INTERVAL_SECONDS = float(os.getenv('FASTLOG_FLUSH_INTERVAL_SECONDS', '0.2'))
+    FASTLOG_BINARY_PATH = os.getenv('FASTLOG_BINARY_PATH', '')  # e.g. logs/hot.bin; decode with fastlog.py decode
+    
     # Telegram alerting
     TELEGRAM_BOT_TOKEN = os.getenv('TELEGRAM_BOT_TOKEN', '')
     TELEGRAM_CHAT_ID = os.getenv('TELEGRAM_CHAT_ID', '')
     TELEGRAM_ENABLED = bool(TELEGRAM_BOT_TOKEN and TELEGRAM_CHAT_ID)
+    TELEGRAM_API_URL = os.getenv('TELEGRAM_API_URL', 'https://api.telegram.org')
+    ALERT_QUEUE_SIZE = int(os.getenv('ALERT_QUEUE_SIZE', '256'))
+    ALERT_COALESCE_WINDOW_SECONDS = float(os.getenv('ALERT_COALESCE_WINDOW_SECONDS', '60'))  # Same error at most once per window
+    ALERT_RATE_LIMIT_PER_MINUTE = int(os.getenv('ALERT_RATE_LIMIT_PER_MINUTE', '20'))  # Telegram allows ~20/min per chat; 0 = no limit
+    ALERT_SEND_TIMEOUT_SECONDS = float(os.getenv('ALERT_SEND_TIMEOUT_SECONDS', '10'))
     
     # Error handling
     MAX_RETRIES = int(os.getenv('MAX_RETRIES', '3'))
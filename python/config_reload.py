@@ -0,0 +1,279 @@
+"""
+AsymmetricLP - Hot-Reloadable Strategy Configuration
+Versioned config snapshots that can be reloaded from a file (on SIGHUP or
+when the file changes), validated, and published with one reference swap.
+A reload builds a new Config subclass and never mutates the one in use:
+a tick that already holds the old snapshot finishes with it, and the next
+tick picks up the new one (read-copy-update), so the loop never pauses
+and never sees half-applied parameters.
+"""
+import json
+import logging
+import os
+import signal
+import threading
+import time
+from typing import Any, Callable, Dict, List, Optional
+from dotenv import dotenv_values
+from config import Config
+
+logger = logging.getLogger(__name__)
+
+# Strategy and model parameters that take effect at the next tick. Everything
+# else (endpoints, keys, addresses, paths, thread counts) needs a restart.
+RELOADABLE_SETTINGS = (
+    'REBALANCE_THRESHOLD',
+    'MIN_RANGE_PERCENTAGE',
+    'MAX_RANGE_PERCENTAGE',
+    'MONITORING_INTERVAL_SECONDS',
+    'INVENTORY_MODEL',
+    'INVENTORY_RISK_AVERSION',
+    'TARGET_INVENTORY_RATIO',
+    'MAX_INVENTORY_DEVIATION',
+    'BASE_SPREAD',
+    'VOLATILITY_WINDOW_SIZE',
+    'DEFAULT_VOLATILITY',
+    'MAX_VOLATILITY',
+    'MIN_VOLATILITY',
+    'EXECUTION_COST',
+    'INVENTORY_PENALTY',
+    'MAX_POSITION_SIZE',
+    'TERMINAL_INVENTORY_PENALTY',
+    'INVENTORY_CONSTRAINT_ACTIVE',
+)
+
+
+class ConfigReloadError(ValueError):
+    """The reload file could not be read or failed validation"""
+
+
+def _coerce(name: str, value: Any, current: Any) -> Any:
+    """Convert a file value to the type of the setting it replaces"""
+    if isinstance(current, bool):
+        if isinstance(value, bool):
+            return value
+        if str(value).lower() not in ('true', 'false'):
+            raise ConfigReloadError(f"{name} must be true or false, got {value!r}")
+        return str(value).lower() == 'true'
+    try:
+        if isinstance(current, int):
+            return int(value)
+        if isinstance(current, float):
+            return float(value)
+    except (TypeError, ValueError):
+        raise ConfigReloadError(f"{name} must be a {type(current).__name__}, got {value!r}")
+    return str(value)
+
+
+def read_settings(path: str) -> Dict[str, Any]:
+    """
+    Read settings from a JSON object (.json) or a KEY=VALUE env file
+
+    Args:
+        path: File path
+
+    Returns:
+        Raw setting values by name
+    """
+    try:
+        if path.endswith('.json'):
+            with open(path) as f:
+                values = json.load(f)
+            if not isinstance(values, dict):
+                raise ConfigReloadError(f"{path} must contain a JSON object")
+            return values
+        return {k: v for k, v in dotenv_values(path).items() if v is not None}
+    except OSError as e:
+        raise ConfigReloadError(f"Cannot read {path}: {e}") from e
+    except json.JSONDecodeError as e:
+        raise ConfigReloadError(f"Invalid JSON in {path}: {e}") from e
+
+
+def validate_snapshot(snapshot: type) -> List[str]:
+    """
+    Sanity-check the reloadable parameters of a snapshot
+
+    Args:
+        snapshot: Config class
+
+    Returns:
+        Error messages (empty if valid)
+    """
+    from models.model_factory import ModelFactory
+
+    errors = []
+    if not 0 < snapshot.REBALANCE_THRESHOLD < 1:
+        errors.append(f"REBALANCE_THRESHOLD must be in (0, 1), got {snapshot.REBALANCE_THRESHOLD}")
+    if not 0 < snapshot.MIN_RANGE_PERCENTAGE <= snapshot.MAX_RANGE_PERCENTAGE <= 100:
+        errors.append(f"Need 0 < MIN_RANGE_PERCENTAGE <= MAX_RANGE_PERCENTAGE <= 100, got "
+                      f"{snapshot.MIN_RANGE_PERCENTAGE}/{snapshot.MAX_RANGE_PERCENTAGE}")
+    if snapshot.MONITORING_INTERVAL_SECONDS <= 0:
+        errors.append("MONITORING_INTERVAL_SECONDS must be positive")
+    if not 0 <= snapshot.TARGET_INVENTORY_RATIO <= 1:
+        errors.append(f"TARGET_INVENTORY_RATIO must be in [0, 1], got {snapshot.TARGET_INVENTORY_RATIO}")
+    if snapshot.VOLATILITY_WINDOW_SIZE < 2:
+        errors.append("VOLATILITY_WINDOW_SIZE must be at least 2")
+    if not 0 < snapshot.MIN_VOLATILITY <= snapshot.MAX_VOLATILITY:
+        errors.append(f"Need 0 < MIN_VOLATILITY <= MAX_VOLATILITY, got "
+                      f"{snapshot.MIN_VOLATILITY}/{snapshot.MAX_VOLATILITY}")
+    if not errors:
+        # The rebalancer rebuilds its model from the snapshot; make sure that will work
+        try:
+            ModelFactory.create_model(snapshot.INVENTORY_MODEL, snapshot())
+        except Exception as e:
+            errors.append(f"Cannot build {snapshot.INVENTORY_MODEL}: {e}")
+    return errors
+
+
+class ConfigStore:
+    """
+    Holds the current config snapshot and publishes reloads.
+
+    Readers take `current` once per tick (a plain attribute read); a reload
+    serializes on a lock, builds and validates a new snapshot from the base
+    config plus the file, and only then swaps the reference and notifies
+    subscribers. An invalid file leaves the running snapshot untouched.
+    """
+
+    def __init__(self, base: type = Config, path: Optional[str] = None, poll_seconds: Optional[float] = None):
+        """
+        Initialize the store (applies the file once if it exists)
+
+        Args:
+            base: Config class the file's settings are layered on
+            path: Reload file (defaults to CONFIG_RELOAD_PATH)
+            poll_seconds: File mtime poll interval for start() (defaults to CONFIG_RELOAD_POLL_SECONDS)
+        """
+        self.base = base
+        self.path = base.CONFIG_RELOAD_PATH if path is None else path
+        self.poll_seconds = base.CONFIG_RELOAD_POLL_SECONDS if poll_seconds is None else poll_seconds
+        self.current: type = self._build({}, version=0)
+        self.version = 0
+        self.stats = {'reloads': 0, 'rejected': 0}
+        self._lock = threading.Lock()
+        self._subscribers: List[Callable[[type], None]] = []
+        self._mtime: Optional[float] = None
+        self._stop = threading.Event()
+        self._thread: Optional[threading.Thread] = None
+        if self.path and os.path.exists(self.path):
+            self.reload()
+
+    def _build(self, settings: Dict[str, Any], version: int) -> type:
+        snapshot = dict(settings, CONFIG_VERSION=version, CONFIG_LOADED_AT=time.time())
+        return type(f"{self.base.__name__}_v{version}", (self.base,), snapshot)
+
+    def subscribe(self, callback: Callable[[type], None]):
+        """Call callback(snapshot) after every successful reload"""
+        self._subscribers.append(callback)
+
+    def parse(self, values: Dict[str, Any]) -> Dict[str, Any]:
+        """
+        Typed reloadable settings from raw file values
+
+        Args:
+            values: Raw values by name
+
+        Returns:
+            Settings to layer on the base config
+
+        Raises:
+            ConfigReloadError: On unknown names or bad values
+        """
+        settings = {}
+        for name, value in values.items():
+            if not hasattr(self.base, name):
+                raise ConfigReloadError(f"Unknown setting {name}")
+            current = getattr(self.base, name)
+            if name not in RELOADABLE_SETTINGS:
+                if _coerce(name, value, current) != current:
+                    logger.warning(f"{name} changed in {self.path} but needs a restart; ignored")
+                continue
+            settings[name] = _coerce(name, value, current)
+        return settings
+
+    def reload(self, values: Optional[Dict[str, Any]] = None) -> bool:
+        """
+        Re-read the file (or apply values), validate, and publish a new snapshot
+
+        Args:
+            values: Raw settings to apply instead of reading the file
+
+        Returns:
+            True if a new snapshot was published
+        """
+        with self._lock:
+            try:
+                if values is None:
+                    if not self.path:
+                        raise ConfigReloadError("No CONFIG_RELOAD_PATH configured")
+                    self._mtime = os.path.getmtime(self.path) if os.path.exists(self.path) else None
+                    values = read_settings(self.path)
+                snapshot = self._build(self.parse(values), self.version + 1)
+                errors = validate_snapshot(snapshot)
+                if errors:
+                    raise ConfigReloadError("; ".join(errors))
+            except ConfigReloadError as e:
+                self.stats['rejected'] += 1
+                logger.error(f"Config reload rejected, keeping v{self.version}: {e}")
+                return False
+
+            changed = {name: getattr(snapshot, name) for name in RELOADABLE_SETTINGS
+                       if getattr(snapshot, name) != getattr(self.current, name)}
+            self.version += 1
+            self.current = snapshot
+            self.stats['reloads'] += 1
+            logger.info(f"Config v{self.version} published: {changed or 'no changes'}")
+            subscribers = list(self._subscribers)
+
+        for callback in subscribers:
+            try:
+                callback(snapshot)
+            except Exception as e:
+                logger.error(f"Config reload subscriber failed: {e}")
+        return True
+
+    def check_file(self) -> bool:
+        """Reload if the file's mtime changed since the last read"""
+        if not self.path or not os.path.exists(self.path):
+            return False
+        if os.path.getmtime(self.path) == self._mtime:
+            return False
+        return self.reload()
+
+    def _watch(self):
+        while not self._stop.wait(self.poll_seconds):
+            try:
+                self.check_file()
+            except Exception as e:
+                logger.error(f"Config file watch failed: {e}")
+
+    def start(self):
+        """Start polling the file (no-op when polling is disabled)"""
+        if not self.path or self.poll_seconds <= 0 or self._thread is not None:
+            return
+        self._stop.clear()
+        self._thread = threading.Thread(target=self._watch, name='config-reload', daemon=True)
+        self._thread.start()
+
+    def stop(self):
+        self._stop.set()
+        if self._thread is not None:
+            self._thread.join(timeout=5)
+            self._thread = None
+
+    def install_signal_handler(self, signum: int = getattr(signal, 'SIGHUP', None)):
+        """
+        Reload on a signal (SIGHUP by default)
+
+        The reload runs on its own thread: the handler may interrupt a thread
+        that is inside reload() and holding the lock.
+        """
+        if signum is None:
+            logger.warning("No SIGHUP on this platform; config reload is file-watch only")
+            return
+
+        def handle(signum, frame):
+            logger.info(f"Received signal {signum}, reloading {self.path}")
+            threading.Thread(target=self.reload, name='config-reload-signal', daemon=True).start()
+
+        signal.signal(signum, handle)
@@ -0,0 +1,309 @@
+"""
+AsymmetricLP - Deferred Logging
+Hot-path debug/info logging that records (message id, raw args) and leaves
+the formatting to a background drain thread or an offline decoder.
+
+Messages are registered once at import time:
+
+    _log = fastlog.get_logger(__name__)
+    MSG_SWAP = fastlog.message("swap {} at {:.6f}")
+    ...
+    _log.debug(MSG_SWAP, side, price)
+
+A call that passes the level check appends one tuple to the calling
+thread's ring (a bounded deque, so it never takes a lock or blocks); the
+drain thread formats entries with str.format and hands them to the stdlib
+logger as ordinary LogRecords (timestamp and thread preserved), or, when
+FASTLOG_BINARY_PATH is set, appends them unformatted to a marshal file that
+`python fastlog.py decode <file>` turns back into text. Python's logging
+stays the only sink configuration; warnings and errors should keep using
+it directly, since deferred lines reach handlers up to one flush interval
+late. A full ring drops its oldest entries and the drain reports how many.
+"""
+import argparse
+import atexit
+import logging
+import marshal
+import sys
+import threading
+import time
+from collections import deque
+from typing import Any, Dict, List, Optional
+
+logger = logging.getLogger(__name__)
+
+_catalog: List[str] = []
+_catalog_ids: Dict[str, int] = {}
+_catalog_lock = threading.Lock()
+
+
+def message(fmt: str) -> int:
+    """
+    Register a str.format-style message and return its id
+
+    Args:
+        fmt: Format string (e.g. "swap {} at {:.6f}")
+
+    Returns:
+        Message id to pass to FastLogger calls
+    """
+    with _catalog_lock:
+        msg_id = _catalog_ids.get(fmt)
+        if msg_id is None:
+            msg_id = len(_catalog)
+            _catalog.append(fmt)
+            _catalog_ids[fmt] = msg_id
+        return msg_id
+
+
+def format_message(msg_id: int, args: tuple) -> str:
+    """Render one entry (never raises: a bad format shows the raw args)"""
+    fmt = _catalog[msg_id] if 0 <= msg_id < len(_catalog) else f"<message {msg_id}>"
+    try:
+        return fmt.format(*args)
+    except (IndexError, KeyError, ValueError, TypeError) as e:
+        return f"{fmt} {args!r} (format error: {e})"
+
+
+class _Ring:
+    """One thread's pending entries; only that thread appends"""
+
+    def __init__(self, size: int):
+        self.entries = deque(maxlen=size)
+        self.written = 0
+        self.drained = 0
+        thread = self.owner = threading.current_thread()
+        self.thread_id = thread.ident
+        self.thread_name = thread.name
+
+
+class _Drainer:
+    """Formats and emits ring entries off the hot path"""
+
+    def __init__(self):
+        self.ring_size = None
+        self.flush_interval = None
+        self.binary_path = None
+        self.rings: List[_Ring] = []
+        self.local = threading.local()
+        self.lock = threading.Lock()  # guards rings and draining, never taken by writers
+        self.stop_event = threading.Event()
+        self.thread: Optional[threading.Thread] = None
+        self.binary_file = None
+        self.binary_catalog: set = set()
+        self.dropped = 0
+
+    def configure(self, ring_size: Optional[int] = None, flush_interval: Optional[float] = None,
+                  binary_path: Optional[str] = None):
+        if ring_size is None or flush_interval is None or binary_path is None:
+            from config import Config
+            ring_size = Config.FASTLOG_RING_SIZE if ring_size is None else ring_size
+            flush_interval = Config.FASTLOG_FLUSH_INTERVAL_SECONDS if flush_interval is None else flush_interval
+            binary_path = Config.FASTLOG_BINARY_PATH if binary_path is None else binary_path
+        self.flush()
+        with self.lock:
+            self.ring_size, self.flush_interval = max(int(ring_size), 1), float(flush_interval)
+            if binary_path != self.binary_path and self.binary_file is not None:
+                self.binary_file.close()
+                self.binary_file = None
+            self.binary_path = binary_path
+            self.binary_catalog = set()
+
+    def ring(self) -> _Ring:
+        """The calling thread's ring (created, and the drain thread started, on first use)"""
+        ring = getattr(self.local, 'ring', None)
+        if ring is None:
+            if self.ring_size is None:
+                self.configure()
+            ring = _Ring(self.ring_size)
+            with self.lock:
+                self.rings.append(ring)
+                if self.thread is None and self.flush_interval > 0:
+                    self.stop_event.clear()
+                    self.thread = threading.Thread(target=self._run, name='fastlog-drain', daemon=True)
+                    self.thread.start()
+            self.local.ring = ring
+        return ring
+
+    def _run(self):
+        while not self.stop_event.wait(self.flush_interval):
+            try:
+                self.flush()
+            except Exception as e:
+                logger.error(f"Deferred log drain failed: {e}")
+
+    def _emit_binary(self, entries: list):
+        if self.binary_file is None:
+            self.binary_file = open(self.binary_path, 'ab')
+        for created, level, name, msg_id, args, thread_name in entries:
+            if msg_id not in self.binary_catalog:
+                marshal.dump(('M', msg_id, _catalog[msg_id]), self.binary_file)
+                self.binary_catalog.add(msg_id)
+            try:
+                payload = marshal.dumps(('L', created, level, name, thread_name, msg_id, args))
+            except ValueError:  # e.g. Timestamps or Decimals: keep their text
+                payload = marshal.dumps(('L', created, level, name, thread_name, msg_id,
+                                         tuple(a if type(a) in (int, float, str, bool) else str(a) for a in args)))
+            self.binary_file.write(payload)
+        self.binary_file.flush()
+
+    def _emit_logging(self, entries: list, thread_id: int):
+        for created, level, name, msg_id, args, thread_name in entries:
+            sink = logging.getLogger(name)
+            record = sink.makeRecord(name, level, '(deferred)', 0, format_message(msg_id, args), None, None)
+            record.created = created
+            record.msecs = (created - int(created)) * 1000
+            record.relativeCreated = (created - logging._startTime) * 1000
+            record.thread = thread_id
+            record.threadName = thread_name
+            sink.handle(record)
+
+    def flush(self) -> int:
+        """Drain every ring now; returns the number of entries emitted"""
+        emitted = 0
+        with self.lock:
+            for ring in self.rings:
+                entries = []
+                pop = ring.entries.popleft
+                try:
+                    while True:
+                        entries.append(pop() + (ring.thread_name,))
+                except IndexError:
+                    pass
+                ring.drained += len(entries)
+                lost = ring.written - ring.drained - len(ring.entries)
+                if lost > 0:
+                    ring.drained += lost
+                    self.dropped += lost
+                    logger.warning(f"Deferred log ring of {ring.thread_name} overflowed; dropped {lost} entries")
+                if not entries:
+                    continue
+                if self.binary_path:
+                    self._emit_binary(entries)
+                else:
+                    self._emit_logging(entries, ring.thread_id)
+                emitted += len(entries)
+            # A finished thread writes nothing more: forget its ring once drained
+            self.rings = [ring for ring in self.rings if ring.owner.is_alive() or ring.entries]
+        return emitted
+
+    def stop(self):
+        self.stop_event.set()
+        thread, self.thread = self.thread, None
+        if thread is not None and thread is not threading.current_thread():
+            thread.join(timeout=5)
+        self.flush()
+        if self.binary_file is not None:
+            self.binary_file.close()
+            self.binary_file = None
+
+
+_drainer = _Drainer()
+atexit.register(_drainer.stop)
+
+
+def configure(ring_size: Optional[int] = None, flush_interval: Optional[float] = None,
+              binary_path: Optional[str] = None):
+    """
+    Override the FASTLOG_* settings (pending entries are flushed first)
+
+    Args:
+        ring_size: Entries buffered per thread
+        flush_interval: Seconds between drains (0 = only on flush())
+        binary_path: Write entries unformatted to this file instead of the logging module
+    """
+    _drainer.configure(ring_size, flush_interval, binary_path)
+
+
+def flush() -> int:
+    """Format and emit everything recorded so far"""
+    return _drainer.flush()
+
+
+class FastLogger:
+    """Deferred-formatting front end for one stdlib logger"""
+
+    def __init__(self, name: str):
+        self.name = name
+        self.logger = logging.getLogger(name)
+
+    def isEnabledFor(self, level: int) -> bool:
+        return self.logger.isEnabledFor(level)
+
+    def log(self, level: int, msg_id: int, *args: Any):
+        if self.logger.isEnabledFor(level):
+            ring = getattr(_drainer.local, 'ring', None) or _drainer.ring()
+            ring.entries.append((time.time(), level, self.name, msg_id, args))
+            ring.written += 1
+
+    def debug(self, msg_id: int, *args: Any):
+        if self.logger.isEnabledFor(logging.DEBUG):
+            ring = getattr(_drainer.local, 'ring', None) or _drainer.ring()
+            ring.entries.append((time.time(), logging.DEBUG, self.name, msg_id, args))
+            ring.written += 1
+
+    def info(self, msg_id: int, *args: Any):
+        if self.logger.isEnabledFor(logging.INFO):
+            ring = getattr(_drainer.local, 'ring', None) or _drainer.ring()
+            ring.entries.append((time.time(), logging.INFO, self.name, msg_id, args))
+            ring.written += 1
+
+
+_loggers: Dict[str, FastLogger] = {}
+
+
+def get_logger(name: str) -> FastLogger:
+    """The FastLogger that feeds logging.getLogger(name)"""
+    fast = _loggers.get(name)
+    if fast is None:
+        fast = _loggers.setdefault(name, FastLogger(name))
+    return fast
+
+
+def decode(path: str, out=sys.stdout) -> int:
+    """
+    Print a binary log file as text lines
+
+    Args:
+        path: File written with FASTLOG_BINARY_PATH
+        out: Text stream
+
+    Returns:
+        Number of entries decoded
+    """
+    formats: Dict[int, str] = {}
+    count = 0
+    with open(path, 'rb') as f:
+        while True:
+            try:
+                entry = marshal.load(f)
+            except EOFError:
+                break
+            if entry[0] == 'M':
+                formats[entry[1]] = entry[2]
+                continue
+            _, created, level, name, thread_name, msg_id, args = entry
+            fmt = formats.get(msg_id, f"<message {msg_id}>")
+            try:
+                text = fmt.format(*args)
+            except (IndexError, KeyError, ValueError, TypeError) as e:
+                text = f"{fmt} {args!r} (format error: {e})"
+            stamp = time.strftime('%Y-%m-%d %H:%M:%S', time.localtime(created))
+            out.write(f"{stamp},{int((created % 1) * 1000):03d} - {name} - {logging.getLevelName(level)} - "
+                      f"[{thread_name}] {text}\n")
+            count += 1
+    return count
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode a deferred binary log file')
+    sub = parser.add_subparsers(dest='command', required=True)
+    decode_parser = sub.add_parser('decode', help='Print a FASTLOG_BINARY_PATH file as text')
+    decode_parser.add_argument('path')
+    args = parser.parse_args()
+    decode(args.path)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,231 @@
+"""
+AsymmetricLP - EIP-1559 Fee Oracle
+Maintains eth_feeHistory priority-fee percentiles and a base-fee forecast in
+the background so transaction builders can read fee parameters without an
+RPC round trip.
+"""
+import logging
+import threading
+import time
+from dataclasses import dataclass, field
+from statistics import median
+from typing import Dict, Any, Optional, List
+from config import Config
+
+logger = logging.getLogger(__name__)
+
+# EIP-1559: base fee moves by at most 1/8 per block
+BASE_FEE_MAX_CHANGE_DENOMINATOR = 8
+
+
+@dataclass(frozen=True)
+class FeeSnapshot:
+    """Immutable fee view for one head block. Replaced wholesale, never mutated."""
+    block_number: int
+    base_fee: int
+    next_base_fee: int
+    priority_fees: Dict[int, int] = field(default_factory=dict)
+    max_priority_fee_per_gas: int = 0
+    max_fee_per_gas: int = 0
+    legacy: bool = False
+    updated_at: float = 0.0
+
+    def fee_params(self) -> Dict[str, int]:
+        """Transaction fee fields for this snapshot"""
+        if self.legacy:
+            return {'gasPrice': self.max_fee_per_gas}
+        return {
+            'maxFeePerGas': self.max_fee_per_gas,
+            'maxPriorityFeePerGas': self.max_priority_fee_per_gas
+        }
+
+
+def forecast_base_fee(base_fee: int, gas_used_ratio: float) -> int:
+    """
+    Next block's base fee from the EIP-1559 update rule
+
+    Args:
+        base_fee: Base fee of the current block
+        gas_used_ratio: gasUsed / gasLimit of the current block
+
+    Returns:
+        Forecast base fee for the next block
+    """
+    # Target is half the gas limit, so ratio 0.5 leaves the base fee unchanged
+    delta = (gas_used_ratio - 0.5) / 0.5
+    return max(0, int(base_fee + base_fee * delta / BASE_FEE_MAX_CHANGE_DENOMINATOR))
+
+
+class FeeOracle:
+    """
+    Background EIP-1559 fee oracle.
+
+    A poller thread (or an external new-heads subscription via on_new_head)
+    refreshes fee history once per block and publishes a new FeeSnapshot by
+    reference swap. Readers call snapshot()/fee_params() without locking.
+    """
+
+    def __init__(self, w3, config: Config = None):
+        """
+        Initialize the fee oracle
+
+        Args:
+            w3: Web3 instance
+            config: Configuration object
+        """
+        self.w3 = w3
+        self.config = config or Config()
+        self.history_blocks = self.config.FEE_HISTORY_BLOCKS
+        self.priority_percentile = self.config.FEE_PRIORITY_PERCENTILE
+        self.percentiles = sorted({10, 50, 90, self.priority_percentile})
+        self.base_fee_horizon = self.config.FEE_BASE_FEE_HORIZON_BLOCKS
+        self.poll_interval = self.config.FEE_ORACLE_POLL_INTERVAL_SECONDS
+
+        self._snapshot: Optional[FeeSnapshot] = None
+        self._refresh_lock = threading.Lock()
+        self._stop_event = threading.Event()
+        self._thread: Optional[threading.Thread] = None
+
+    def start(self):
+        """Start polling for new heads in a background thread"""
+        if self._thread and self._thread.is_alive():
+            return
+        self._stop_event.clear()
+        self._thread = threading.Thread(target=self._poll_heads, name='fee-oracle', daemon=True)
+        self._thread.start()
+        logger.info(f"Fee oracle started (p{self.priority_percentile} priority fee, "
+                    f"{self.history_blocks}-block history)")
+
+    def stop(self):
+        """Stop the background poller"""
+        self._stop_event.set()
+        if self._thread:
+            self._thread.join(timeout=self.poll_interval * 2)
+            self._thread = None
+
+    @property
+    def running(self) -> bool:
+        return self._thread is not None and self._thread.is_alive()
+
+    def _poll_heads(self):
+        """Refresh whenever the head block number advances"""
+        while not self._stop_event.is_set():
+            try:
+                block_number = self.w3.eth.block_number
+                current = self._snapshot
+                if current is None or block_number > current.block_number:
+                    self.refresh()
+            except Exception as e:
+                logger.warning(f"Fee oracle poll failed: {e}")
+            self._stop_event.wait(self.poll_interval)
+
+    def on_new_head(self, block: Dict[str, Any]):
+        """
+        New-heads hook for an external block subscription
+
+        Args:
+            block: Block header (needs 'number')
+        """
+        current = self._snapshot
+        if current is None or block['number'] > current.block_number:
+            self.refresh()
+
+    def refresh(self) -> Optional[FeeSnapshot]:
+        """
+        Fetch fee history and publish a new snapshot
+
+        Returns:
+            The published snapshot (or the previous one if the refresh failed)
+        """
+        if not self._refresh_lock.acquire(blocking=False):
+            # Another thread is already refreshing; its result will be published
+            return self._snapshot
+        try:
+            snapshot = self._build_snapshot()
+            self._snapshot = snapshot
+            logger.debug(f"Fee snapshot @ {snapshot.block_number}: "
+                         f"maxFee={snapshot.max_fee_per_gas} tip={snapshot.max_priority_fee_per_gas}")
+            return snapshot
+        except Exception as e:
+            logger.error(f"Error refreshing fee history: {e}")
+            return self._snapshot
+        finally:
+            self._refresh_lock.release()
+
+    def _build_snapshot(self) -> FeeSnapshot:
+        """Build a snapshot from eth_feeHistory (or gas_price on legacy chains)"""
+        history = self.w3.eth.fee_history(self.history_blocks, 'latest', self.percentiles)
+        base_fees: List[int] = list(history.get('baseFeePerGas') or [])
+        if not base_fees or not any(base_fees):
+            return self._legacy_snapshot()
+
+        rewards = history.get('reward') or []
+        gas_used_ratios = history.get('gasUsedRatio') or []
+        block_number = int(history['oldestBlock']) + len(gas_used_ratios) - 1
+
+        # Median across recent blocks of each reward percentile
+        priority_fees = {}
+        for i, percentile in enumerate(self.percentiles):
+            samples = [int(r[i]) for r in rewards if len(r) > i]
+            priority_fees[percentile] = int(median(samples)) if samples else 0
+
+        # feeHistory returns one extra base fee: the next block's, already known
+        base_fee = int(base_fees[-2]) if len(base_fees) > 1 else int(base_fees[-1])
+        if len(base_fees) > len(gas_used_ratios):
+            next_base_fee = int(base_fees[-1])
+        else:
+            next_base_fee = forecast_base_fee(base_fee, gas_used_ratios[-1] if gas_used_ratios else 0.5)
+
+        # Headroom so the tx stays valid if the base fee keeps rising at the max rate
+        worst_base_fee = next_base_fee
+        for _ in range(self.base_fee_horizon):
+            worst_base_fee += worst_base_fee // BASE_FEE_MAX_CHANGE_DENOMINATOR
+
+        priority_fee = priority_fees[self.priority_percentile]
+        return FeeSnapshot(
+            block_number=block_number,
+            base_fee=base_fee,
+            next_base_fee=next_base_fee,
+            priority_fees=priority_fees,
+            max_priority_fee_per_gas=priority_fee,
+            max_fee_per_gas=worst_base_fee + priority_fee,
+            updated_at=time.time()
+        )
+
+    def _legacy_snapshot(self) -> FeeSnapshot:
+        """Snapshot for chains without EIP-1559"""
+        gas_price = int(self.w3.eth.gas_price)
+        return FeeSnapshot(
+            block_number=int(self.w3.eth.block_number),
+            base_fee=0,
+            next_base_fee=0,
+            max_fee_per_gas=gas_price,
+            legacy=True,
+            updated_at=time.time()
+        )
+
+    def snapshot(self) -> Optional[FeeSnapshot]:
+        """
+        Current fee snapshot (O(1), no RPC while the poller is running)
+
+        Without a running poller the snapshot is refreshed on demand once it is
+        older than the poll interval.
+
+        Returns:
+            Latest FeeSnapshot, or None if fee history has never been fetched
+        """
+        current = self._snapshot
+        if current is None or (not self.running and time.time() - current.updated_at > self.poll_interval):
+            current = self.refresh()
+        return current
+
+    def fee_params(self) -> Optional[Dict[str, int]]:
+        """
+        Transaction fee fields from the current snapshot
+
+        Returns:
+            {'maxFeePerGas', 'maxPriorityFeePerGas'} ({'gasPrice'} on legacy chains),
+            or None if no snapshot is available
+        """
+        current = self.snapshot()
+        return current.fee_params() if current else None
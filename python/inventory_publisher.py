@@ -1,84 +1,447 @@
 """
-AsymmetricLP - Inventory Publisher (Stub)
+AsymmetricLP - Inventory Publisher
+Pushes inventory snapshots, band ranges, rebalance and error events to the
+co-located C++ CeFi market maker using the fixed-layout binary schema in
+inventory_schema.py.
 
-This module previously published inventory data to C++ via ZMQ.
-The ZMQ connectivity has been removed - Python and C++ now operate independently.
+Two transports are available and can run side by side:
+- ZMQ PUB (topic frame + binary payload frame)
+- a same-host shared-memory ring (mmap'd file, per-slot seqlock)
 
-This stub class is kept for backward compatibility with automated_rebalancer.py.
-All methods are no-ops.
+Inventory and band updates are conflated: if the sender has not yet
+shipped the previous snapshot, the newer one replaces it. Rebalance and
+error events are never conflated.
 """
 import logging
-from typing import Dict, Any
+import mmap
+import os
+import struct
+import threading
+import time
+from collections import deque
+from typing import Dict, Any, List, Optional, Tuple
 from config import Config
+from inventory_schema import (
+    MSG_INVENTORY, MSG_BANDS, TOPICS, MAX_MESSAGE_SIZE,
+    InventoryMessage, RebalanceMessage, BandsMessage, ErrorMessage, encode_message
+)
 
 logger = logging.getLogger(__name__)
 
+# Message types where only the latest value matters
+CONFLATED_TYPES = (MSG_INVENTORY, MSG_BANDS)
+
+# Shared-memory ring layout (little-endian):
+#   header (64 bytes): uint32 magic 'ALPR', uint16 version, uint16 reserved,
+#                      uint32 slot_size, uint32 slot_count, uint64 write_count
+#   slot i at 64 + i * slot_size: uint64 version, uint32 length, uint32 reserved, payload
+# Message n goes to slot n % slot_count. The slot version is 2n+1 while it is
+# being written and 2n+2 once complete, so a reader expecting message n knows
+# it is torn (odd), not yet written (< 2n+2) or overwritten (> 2n+2).
+RING_MAGIC = 0x52504C41  # b'ALPR' little-endian
+RING_VERSION = 1
+RING_HEADER = struct.Struct('<IHHIIQ')
+RING_HEADER_SIZE = 64
+RING_WRITE_COUNT_OFFSET = 16
+SLOT_HEADER = struct.Struct('<QII')
+_U64 = struct.Struct('<Q')
+
+
+class ZmqTransport:
+    """ZMQ PUB socket; each message is sent as [topic, payload]"""
+
+    name = 'zmq'
+
+    def __init__(self, endpoint: str, sndhwm: int = 10000):
+        """
+        Bind the PUB socket
+
+        Args:
+            endpoint: e.g. 'tcp://127.0.0.1:5555' or 'ipc:///tmp/alp.ipc'
+            sndhwm: Send high-water mark (messages queued per subscriber)
+        """
+        import zmq
+        self._zmq = zmq
+        self.endpoint = endpoint
+        self._context = zmq.Context.instance()
+        self._socket = self._context.socket(zmq.PUB)
+        self._socket.setsockopt(zmq.SNDHWM, sndhwm)
+        self._socket.setsockopt(zmq.LINGER, 0)
+        self._socket.bind(endpoint)
+        self.dropped = 0
+
+    def send(self, msg_type: int, payload: bytes):
+        try:
+            self._socket.send_multipart([TOPICS[msg_type], payload], flags=self._zmq.NOBLOCK, copy=False)
+        except self._zmq.Again:
+            # A slow subscriber hit the high-water mark; never block the publisher
+            self.dropped += 1
+
+    def close(self):
+        self._socket.close()
+
+
+class ShmRingTransport:
+    """Single-writer shared-memory ring of fixed-size slots"""
+
+    name = 'shm'
+
+    def __init__(self, path: str, slot_count: int = 1024, slot_size: int = 512):
+        """
+        Create (or reset) the ring file and map it
+
+        Args:
+            path: File path, typically under /dev/shm
+            slot_count: Number of slots (readers more than this far behind lose messages)
+            slot_size: Bytes per slot, including the 16-byte slot header
+        """
+        if slot_size < SLOT_HEADER.size + MAX_MESSAGE_SIZE:
+            raise ValueError(f"slot_size must be at least {SLOT_HEADER.size + MAX_MESSAGE_SIZE}")
+        self.path = path
+        self.slot_count = slot_count
+        self.slot_size = slot_size
+        size = RING_HEADER_SIZE + slot_count * slot_size
+
+        directory = os.path.dirname(os.path.abspath(path))
+        os.makedirs(directory, exist_ok=True)
+        fd = os.open(path, os.O_RDWR | os.O_CREAT | os.O_TRUNC, 0o644)
+        try:
+            os.ftruncate(fd, size)
+            self._map = mmap.mmap(fd, size)
+        finally:
+            os.close(fd)
+        RING_HEADER.pack_into(self._map, 0, RING_MAGIC, RING_VERSION, 0, slot_size, slot_count, 0)
+        self._count = 0
+
+    def send(self, msg_type: int, payload: bytes):
+        n = self._count
+        offset = RING_HEADER_SIZE + (n % self.slot_count) * self.slot_size
+        SLOT_HEADER.pack_into(self._map, offset, 2 * n + 1, len(payload), 0)
+        body = offset + SLOT_HEADER.size
+        self._map[body:body + len(payload)] = payload
+        _U64.pack_into(self._map, offset, 2 * n + 2)
+        self._count = n + 1
+        _U64.pack_into(self._map, RING_WRITE_COUNT_OFFSET, self._count)
+
+    def close(self):
+        self._map.close()
+
+
+class ShmRingReader:
+    """
+    Reader for ShmRingTransport (reference implementation for the C++ side)
+    """
+
+    def __init__(self, path: str, start_at_head: bool = True):
+        """
+        Map an existing ring
+
+        Args:
+            path: Ring file path
+            start_at_head: Skip messages already in the ring
+        """
+        fd = os.open(path, os.O_RDONLY)
+        try:
+            self._map = mmap.mmap(fd, 0, prot=mmap.PROT_READ)
+        finally:
+            os.close(fd)
+        magic, version, _, self.slot_size, self.slot_count, write_count = RING_HEADER.unpack_from(self._map, 0)
+        if magic != RING_MAGIC or version != RING_VERSION:
+            raise ValueError(f"Not an inventory ring: magic=0x{magic:08x} version={version}")
+        self.next = write_count if start_at_head else max(0, write_count - self.slot_count)
+        self.lost = 0
+
+    def poll(self) -> List[bytes]:
+        """
+        Read every message published since the last poll
+
+        Returns:
+            Payloads in publish order
+        """
+        messages = []
+        (write_count,) = _U64.unpack_from(self._map, RING_WRITE_COUNT_OFFSET)
+        if write_count - self.next > self.slot_count:
+            self.lost += write_count - self.slot_count - self.next
+            self.next = write_count - self.slot_count
+        while self.next < write_count:
+            offset = RING_HEADER_SIZE + (self.next % self.slot_count) * self.slot_size
+            expected = 2 * self.next + 2
+            version, length, _ = SLOT_HEADER.unpack_from(self._map, offset)
+            body = offset + SLOT_HEADER.size
+            payload = bytes(self._map[body:body + length])
+            (version_after,) = _U64.unpack_from(self._map, offset)
+            if version == expected and version_after == expected:
+                messages.append(payload)
+            elif version > expected or version_after > expected:
+                self.lost += 1  # overwritten while we were behind
+            else:
+                break  # writer is mid-slot; pick it up on the next poll
+            self.next += 1
+        return messages
+
+    def close(self):
+        self._map.close()
+
 
 class InventoryPublisher:
     """
-    Stub inventory publisher - all methods are no-ops.
-    
-    Previously published inventory data via ZMQ for CeFi MM integration.
-    Now Python DeFi LP and C++ CeFi MM operate independently.
+    Binary inventory publisher for the CeFi MM integration.
+
+    Callers enqueue messages; a sender thread assigns sequence numbers,
+    encodes and writes them to every transport. Publishing never blocks
+    the monitoring loop.
     """
-    
-    def __init__(self, config: Config):
+
+    def __init__(self, config: Config, transports: Optional[List[Any]] = None):
         """
-        Initialize stub publisher
-        
+        Initialize the publisher
+
         Args:
-            config: Configuration object (not used)
+            config: Configuration object
+            transports: Explicit transports (built from config when None)
         """
         self.config = config
-        logger.info("InventoryPublisher initialized (stub - no ZMQ publishing)")
-    
-    def update_inventory_data(self, 
-                            token_a_address: str,
-                            token_b_address: str,
-                            token_a_balance: float,
-                            token_b_balance: float) -> None:
-        """
-        Stub method - does nothing
-        
+        self.transports = transports if transports is not None else self._build_transports()
+        self.enabled = bool(self.transports)
+
+        self._cond = threading.Condition()
+        self._latest: Dict[Tuple[int, Any], Tuple[Any, int]] = {}
+        self._events: deque = deque()
+        self._seq = 0
+        self._running = False
+        self._thread: Optional[threading.Thread] = None
+
+        self.stats = {
+            'published': {TOPICS[t].decode(): 0 for t in TOPICS},
+            'conflated': 0,
+            'send_errors': 0,
+            'latency_us_last': 0.0,
+            'latency_us_max': 0.0,
+            'latency_us_total': 0.0,
+            'latency_samples': 0
+        }
+
+        if self.enabled:
+            self._running = True
+            self._thread = threading.Thread(target=self._sender_loop, name='inventory-publisher', daemon=True)
+            self._thread.start()
+            logger.info(f"InventoryPublisher started ({', '.join(t.name for t in self.transports)})")
+        else:
+            logger.info("InventoryPublisher disabled (no transports configured)")
+
+    def _build_transports(self) -> List[Any]:
+        transports = []
+        if self.config.ZMQ_ENABLED:
+            endpoint = f"tcp://{self.config.ZMQ_PUBLISHER_HOST}:{self.config.ZMQ_PUBLISHER_PORT}"
+            try:
+                transports.append(ZmqTransport(endpoint))
+            except Exception as e:
+                logger.error(f"Failed to bind ZMQ publisher at {endpoint}: {e}")
+        if self.config.INVENTORY_SHM_RING_PATH:
+            try:
+                transports.append(ShmRingTransport(self.config.INVENTORY_SHM_RING_PATH,
+                                                   self.config.INVENTORY_SHM_RING_SLOTS))
+            except Exception as e:
+                logger.error(f"Failed to create shared-memory ring at {self.config.INVENTORY_SHM_RING_PATH}: {e}")
+        return transports
+
+    # ------------------------------------------------------------------ enqueue
+
+    def _enqueue(self, message: Any, conflation_key: Any = None):
+        if not self.enabled:
+            return
+        item = (message, time.time_ns())
+        with self._cond:
+            if message.msg_type in CONFLATED_TYPES:
+                # Conflate per pool so pools sharing one publisher never replace each other
+                key = (message.msg_type, conflation_key)
+                if key in self._latest:
+                    self.stats['conflated'] += 1
+                self._latest[key] = item
+            else:
+                self._events.append(item)
+            self._cond.notify()
+
+    def update_inventory_data(self,
+                              token_a_address: str,
+                              token_b_address: str,
+                              token_a_balance: float,
+                              token_b_balance: float,
+                              spot_price: float = 0.0,
+                              volatility: float = 0.0,
+                              range_a_pct: float = 0.0,
+                              range_b_pct: float = 0.0) -> None:
+        """
+        Publish the current inventory snapshot (conflated)
+
         Args:
             token_a_address: Token A address
             token_b_address: Token B address
             token_a_balance: Token A balance
             token_b_balance: Token B balance
+            spot_price: Current spot price (token B per token A)
+            volatility: Current volatility estimate
+            range_a_pct: Current range of position A in percent
+            range_b_pct: Current range of position B in percent
+        """
+        self._enqueue(InventoryMessage(
+            token_a_balance=float(token_a_balance), token_b_balance=float(token_b_balance),
+            spot_price=float(spot_price), volatility=float(volatility),
+            range_a_pct=float(range_a_pct), range_b_pct=float(range_b_pct),
+            token_a_address=token_a_address, token_b_address=token_b_address
+        ), conflation_key=(token_a_address, token_b_address))
+
+    def publish_bands(self,
+                      tick_lower_a: int, tick_upper_a: int,
+                      tick_lower_b: int, tick_upper_b: int,
+                      range_a_pct: float = 0.0, range_b_pct: float = 0.0,
+                      spot_price: float = 0.0, pool: Optional[str] = None) -> None:
         """
-        pass
-    
+        Publish the active LP band ranges (conflated)
+
+        Args:
+            tick_lower_a: Lower tick of position A
+            tick_upper_a: Upper tick of position A
+            tick_lower_b: Lower tick of position B
+            tick_upper_b: Upper tick of position B
+            range_a_pct: Range of position A in percent
+            range_b_pct: Range of position B in percent
+            spot_price: Spot price the bands were set at
+            pool: Pool identifier, so bands of different pools are not conflated together
+        """
+        self._enqueue(BandsMessage(int(tick_lower_a), int(tick_upper_a), int(tick_lower_b), int(tick_upper_b),
+                                   float(range_a_pct), float(range_b_pct), float(spot_price)),
+                      conflation_key=pool)
+
     def publish_rebalance_event(self,
-                              token_a_symbol: str,
-                              token_b_symbol: str,
-                              spot_price: float,
-                              old_ratio: float,
-                              new_ratio: float,
-                              fees_collected: Dict[str, float],
-                              gas_used: int,
-                              ranges: Dict[str, float]):
-        """
-        Stub method - does nothing
-        """
-        pass
-    
+                                token_a_symbol: str,
+                                token_b_symbol: str,
+                                spot_price: float,
+                                old_ratio: float,
+                                new_ratio: float,
+                                fees_collected: Dict[str, float],
+                                gas_used: int,
+                                ranges: Dict[str, float]):
+        """
+        Publish a completed rebalance
+
+        Args:
+            token_a_symbol: Token A symbol
+            token_b_symbol: Token B symbol
+            spot_price: Spot price at rebalance
+            old_ratio: Inventory ratio before the rebalance
+            new_ratio: Inventory ratio after the rebalance
+            fees_collected: Fees collected keyed by token symbol
+            gas_used: Total gas used
+            ranges: {'token_a_range': pct, 'token_b_range': pct}
+        """
+        fees_collected = fees_collected or {}
+        ranges = ranges or {}
+        self._enqueue(RebalanceMessage(
+            spot_price=float(spot_price), old_ratio=float(old_ratio), new_ratio=float(new_ratio),
+            fee_a=float(fees_collected.get(token_a_symbol, 0) or 0),
+            fee_b=float(fees_collected.get(token_b_symbol, 0) or 0),
+            range_a_pct=float(ranges.get('token_a_range', 0) or 0),
+            range_b_pct=float(ranges.get('token_b_range', 0) or 0),
+            gas_used=int(gas_used or 0),
+            token_a_symbol=token_a_symbol, token_b_symbol=token_b_symbol
+        ))
+
     def publish_error_event(self,
-                           error_type: str,
-                           error_message: str,
-                           context: Dict[str, Any]):
+                            error_type: str,
+                            error_message: str,
+                            context: Dict[str, Any]):
+        """
+        Publish an error event (context is appended to the message text)
+
+        Args:
+            error_type: Short error category
+            error_message: Error description
+            context: Extra key/value details
+        """
+        details = ' '.join(f"{k}={v}" for k, v in (context or {}).items())
+        self._enqueue(ErrorMessage(error_type, f"{error_message} {details}".strip()))
+
+    # ------------------------------------------------------------------ sending
+
+    def _sender_loop(self):
+        while True:
+            with self._cond:
+                while self._running and not self._events and not self._latest:
+                    self._cond.wait()
+                if not self._running and not self._events and not self._latest:
+                    return
+                # Events first (ordered), then the latest conflated snapshots
+                batch = list(self._events)
+                self._events.clear()
+                batch.extend(item for _, item in sorted(self._latest.items(),
+                                                          key=lambda entry: CONFLATED_TYPES.index(entry[0][0])))
+                self._latest.clear()
+            for message, enqueued_ns in batch:
+                self._send(message, enqueued_ns)
+
+    def _send(self, message: Any, enqueued_ns: int):
+        self._seq += 1
+        payload = encode_message(message, self._seq, enqueued_ns)
+        for transport in self.transports:
+            try:
+                transport.send(message.msg_type, payload)
+            except Exception as e:
+                self.stats['send_errors'] += 1
+                logger.warning(f"Inventory publish via {transport.name} failed: {e}")
+        latency_us = (time.time_ns() - enqueued_ns) / 1000
+        self.stats['published'][TOPICS[message.msg_type].decode()] += 1
+        self.stats['latency_us_last'] = latency_us
+        self.stats['latency_us_max'] = max(self.stats['latency_us_max'], latency_us)
+        self.stats['latency_us_total'] += latency_us
+        self.stats['latency_samples'] += 1
+
+    def flush(self, timeout: float = 1.0) -> bool:
         """
-        Stub method - does nothing
+        Wait until everything enqueued so far has been sent
+
+        Returns:
+            True if the queue drained within the timeout
         """
-        pass
-    
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            with self._cond:
+                if not self._events and not self._latest:
+                    return True
+            time.sleep(0.0005)
+        return False
+
+    def close(self):
+        """Drain pending messages, stop the sender and close transports"""
+        if self._thread:
+            with self._cond:
+                self._running = False
+                self._cond.notify()
+            self._thread.join(timeout=2)
+            self._thread = None
+        for transport in self.transports:
+            try:
+                transport.close()
+            except Exception as e:
+                logger.warning(f"Error closing {transport.name} transport: {e}")
+
     def get_publisher_stats(self) -> Dict[str, Any]:
         """
         Get publisher statistics
-        
+
         Returns:
-            Dictionary with stub stats
+            Dictionary with transport, sequence and latency stats
         """
+        samples = self.stats['latency_samples']
         return {
-            'enabled': False,
-            'status': 'stub - ZMQ removed'
+            'enabled': self.enabled,
+            'transports': [t.name for t in self.transports],
+            'seq': self._seq,
+            'published': dict(self.stats['published']),
+            'conflated': self.stats['conflated'],
+            'send_errors': self.stats['send_errors'],
+            'zmq_dropped': sum(t.dropped for t in self.transports if isinstance(t, ZmqTransport)),
+            'latency_us_last': self.stats['latency_us_last'],
+            'latency_us_max': self.stats['latency_us_max'],
+            'latency_us_avg': self.stats['latency_us_total'] / samples if samples else 0.0
         }
@@ -0,0 +1,203 @@
+"""
+AsymmetricLP - Inventory Wire Schema
+Fixed-layout little-endian binary messages (SBE-style) published to the
+C++ CeFi market maker. Every message is a 24-byte header followed by a
+fixed-size body, so a C++ reader can reinterpret_cast a packed struct.
+
+Header (24 bytes):
+    uint32 magic           'ALPI' (0x49504C41)
+    uint16 schema_version
+    uint16 msg_type        1=inventory, 2=rebalance, 3=bands, 4=error
+    uint64 seq             per-publisher, strictly increasing across all types
+    int64  publish_ts_ns   CLOCK_REALTIME at publish (end-to-end latency)
+
+Bodies are listed with their struct formats below; strings are fixed-width,
+NUL-padded UTF-8.
+"""
+import struct
+import time
+from dataclasses import dataclass
+from typing import Union
+
+MAGIC = 0x49504C41  # b'ALPI' little-endian
+SCHEMA_VERSION = 1
+
+MSG_INVENTORY = 1
+MSG_REBALANCE = 2
+MSG_BANDS = 3
+MSG_ERROR = 4
+
+TOPICS = {
+    MSG_INVENTORY: b'inventory',
+    MSG_REBALANCE: b'rebalance',
+    MSG_BANDS: b'bands',
+    MSG_ERROR: b'error',
+}
+
+HEADER = struct.Struct('<IHHQq')
+
+# token_a_balance, token_b_balance, spot_price, volatility, range_a_pct, range_b_pct,
+# token_a_address[20], token_b_address[20]
+INVENTORY_BODY = struct.Struct('<6d20s20s')
+# spot_price, old_ratio, new_ratio, fee_a, fee_b, range_a_pct, range_b_pct, gas_used,
+# token_a_symbol[16], token_b_symbol[16]
+REBALANCE_BODY = struct.Struct('<7dQ16s16s')
+# tick_lower_a, tick_upper_a, tick_lower_b, tick_upper_b, range_a_pct, range_b_pct, spot_price
+BANDS_BODY = struct.Struct('<4i3d')
+# error_type[32], message[192]
+ERROR_BODY = struct.Struct('<32s192s')
+
+BODIES = {
+    MSG_INVENTORY: INVENTORY_BODY,
+    MSG_REBALANCE: REBALANCE_BODY,
+    MSG_BANDS: BANDS_BODY,
+    MSG_ERROR: ERROR_BODY,
+}
+
+MAX_MESSAGE_SIZE = HEADER.size + max(b.size for b in BODIES.values())
+
+
+@dataclass(frozen=True)
+class InventoryMessage:
+    token_a_balance: float
+    token_b_balance: float
+    spot_price: float = 0.0
+    volatility: float = 0.0
+    range_a_pct: float = 0.0
+    range_b_pct: float = 0.0
+    token_a_address: str = '0x' + '00' * 20
+    token_b_address: str = '0x' + '00' * 20
+    msg_type = MSG_INVENTORY
+
+
+@dataclass(frozen=True)
+class RebalanceMessage:
+    spot_price: float
+    old_ratio: float
+    new_ratio: float
+    fee_a: float = 0.0
+    fee_b: float = 0.0
+    range_a_pct: float = 0.0
+    range_b_pct: float = 0.0
+    gas_used: int = 0
+    token_a_symbol: str = ''
+    token_b_symbol: str = ''
+    msg_type = MSG_REBALANCE
+
+
+@dataclass(frozen=True)
+class BandsMessage:
+    tick_lower_a: int
+    tick_upper_a: int
+    tick_lower_b: int
+    tick_upper_b: int
+    range_a_pct: float = 0.0
+    range_b_pct: float = 0.0
+    spot_price: float = 0.0
+    msg_type = MSG_BANDS
+
+
+@dataclass(frozen=True)
+class ErrorMessage:
+    error_type: str
+    message: str
+    msg_type = MSG_ERROR
+
+
+Message = Union[InventoryMessage, RebalanceMessage, BandsMessage, ErrorMessage]
+
+
+@dataclass(frozen=True)
+class Envelope:
+    """Decoded header plus message"""
+    seq: int
+    publish_ts_ns: int
+    message: Message
+    schema_version: int = SCHEMA_VERSION
+
+
+def _address_bytes(address: str) -> bytes:
+    hex_part = address[2:] if address.startswith('0x') else address
+    return bytes.fromhex(hex_part.rjust(40, '0'))[-20:]
+
+
+def _fixed_str(value: str, width: int) -> bytes:
+    return value.encode('utf-8')[:width]
+
+
+def _read_str(raw: bytes) -> str:
+    return raw.rstrip(b'\x00').decode('utf-8', errors='replace')
+
+
+def encode_message(message: Message, seq: int, publish_ts_ns: int = None) -> bytes:
+    """
+    Serialize a message with its header
+
+    Args:
+        message: One of the message dataclasses
+        seq: Sequence number
+        publish_ts_ns: Publish timestamp (defaults to now)
+
+    Returns:
+        Wire bytes
+    """
+    if publish_ts_ns is None:
+        publish_ts_ns = time.time_ns()
+    header = HEADER.pack(MAGIC, SCHEMA_VERSION, message.msg_type, seq, publish_ts_ns)
+
+    if message.msg_type == MSG_INVENTORY:
+        body = INVENTORY_BODY.pack(
+            message.token_a_balance, message.token_b_balance, message.spot_price, message.volatility,
+            message.range_a_pct, message.range_b_pct,
+            _address_bytes(message.token_a_address), _address_bytes(message.token_b_address)
+        )
+    elif message.msg_type == MSG_REBALANCE:
+        body = REBALANCE_BODY.pack(
+            message.spot_price, message.old_ratio, message.new_ratio, message.fee_a, message.fee_b,
+            message.range_a_pct, message.range_b_pct, message.gas_used,
+            _fixed_str(message.token_a_symbol, 16), _fixed_str(message.token_b_symbol, 16)
+        )
+    elif message.msg_type == MSG_BANDS:
+        body = BANDS_BODY.pack(
+            message.tick_lower_a, message.tick_upper_a, message.tick_lower_b, message.tick_upper_b,
+            message.range_a_pct, message.range_b_pct, message.spot_price
+        )
+    else:
+        body = ERROR_BODY.pack(_fixed_str(message.error_type, 32), _fixed_str(message.message, 192))
+    return header + body
+
+
+def decode_message(data: bytes) -> Envelope:
+    """
+    Parse wire bytes back into a message
+
+    Args:
+        data: Header + body bytes
+
+    Returns:
+        Decoded envelope
+
+    Raises:
+        ValueError: On bad magic, unknown version/type or truncated data
+    """
+    magic, version, msg_type, seq, publish_ts_ns = HEADER.unpack_from(data, 0)
+    if magic != MAGIC:
+        raise ValueError(f"Bad magic 0x{magic:08x}")
+    if version != SCHEMA_VERSION:
+        raise ValueError(f"Unsupported schema version {version}")
+    body_struct = BODIES.get(msg_type)
+    if body_struct is None:
+        raise ValueError(f"Unknown message type {msg_type}")
+    fields = body_struct.unpack_from(data, HEADER.size)
+
+    if msg_type == MSG_INVENTORY:
+        message = InventoryMessage(*fields[:6], token_a_address='0x' + fields[6].hex(),
+                                   token_b_address='0x' + fields[7].hex())
+    elif msg_type == MSG_REBALANCE:
+        message = RebalanceMessage(*fields[:8], token_a_symbol=_read_str(fields[8]),
+                                   token_b_symbol=_read_str(fields[9]))
+    elif msg_type == MSG_BANDS:
+        message = BandsMessage(*fields)
+    else:
+        message = ErrorMessage(_read_str(fields[0]), _read_str(fields[1]))
+    return Envelope(seq=seq, publish_ts_ns=publish_ts_ns, message=message, schema_version=version)
@@ -0,0 +1,198 @@
+"""
+AsymmetricLP - Shared-Memory Inventory Snapshot
+Single-writer seqlock over a mmap'd file holding the LP's latest inventory,
+active bands and model outputs, so a market maker on the same host can read
+a consistent snapshot on every quote update without any syscall.
+
+Layout (little-endian, see README "CeFi MM Integration"):
+
+Header (64 bytes):
+    uint32 magic           'ALPS' (0x53504C41)
+    uint16 layout_version  bumped on any incompatible payload change
+    uint16 header_size     offset of the payload (64)
+    uint32 payload_size    readers must check this before copying
+    uint32 reserved
+    uint64 sequence        seqlock counter: odd while a write is in progress
+    (padding to 64 bytes so the payload starts on its own cache line)
+
+Payload (fields appended at the end only; older readers ignore the tail):
+    int64  update_ts_ns, uint64 block_number,
+    double token0_balance, token1_balance, spot_price, last_rebalance_price,
+    int64  last_rebalance_ts_ns,
+    double inventory_ratio, target_ratio, volatility, range_a_pct, range_b_pct,
+    int32  tick_lower_a, tick_upper_a, tick_lower_b, tick_upper_b,
+    uint32 position_count, uint32 flags
+"""
+import logging
+import mmap
+import os
+import struct
+import threading
+import time
+from typing import Any, Dict, Optional
+
+logger = logging.getLogger(__name__)
+
+SNAPSHOT_MAGIC = 0x53504C41  # b'ALPS' little-endian
+LAYOUT_VERSION = 1
+
+HEADER = struct.Struct('<IHHIIQ')
+HEADER_SIZE = 64
+SEQUENCE_OFFSET = 16
+_SEQUENCE = struct.Struct('<Q')
+
+PAYLOAD = struct.Struct('<qQ4dq5d4iII')
+PAYLOAD_FIELDS = (
+    'update_ts_ns', 'block_number',
+    'token0_balance', 'token1_balance', 'spot_price', 'last_rebalance_price',
+    'last_rebalance_ts_ns',
+    'inventory_ratio', 'target_ratio', 'volatility', 'range_a_pct', 'range_b_pct',
+    'tick_lower_a', 'tick_upper_a', 'tick_lower_b', 'tick_upper_b',
+    'position_count', 'flags'
+)
+_INTEGER_FIELDS = {
+    'update_ts_ns', 'block_number', 'last_rebalance_ts_ns',
+    'tick_lower_a', 'tick_upper_a', 'tick_lower_b', 'tick_upper_b',
+    'position_count', 'flags'
+}
+
+# flags
+FLAG_REBALANCING = 0x1   # a rebalance is in flight; bands may be stale
+FLAG_RECOVERED = 0x2     # state was restored from the WAL at startup
+
+
+class InventorySnapshotWriter:
+    """
+    Seqlock writer for the shared-memory snapshot.
+
+    The writer keeps the last value of every field, so callers update only
+    what they know (balances every tick, bands after a rebalance) and every
+    publish writes a complete, self-consistent payload.
+    """
+
+    def __init__(self, path: str):
+        """
+        Create (or reset) the snapshot file and map it
+
+        Args:
+            path: File path, typically under /dev/shm
+        """
+        self.path = path
+        self._lock = threading.Lock()
+        self._values: Dict[str, Any] = {name: 0 for name in PAYLOAD_FIELDS}
+        self._sequence = 0
+        self.writes = 0
+
+        size = HEADER_SIZE + PAYLOAD.size
+        directory = os.path.dirname(os.path.abspath(path))
+        os.makedirs(directory, exist_ok=True)
+        fd = os.open(path, os.O_RDWR | os.O_CREAT | os.O_TRUNC, 0o644)
+        try:
+            os.ftruncate(fd, size)
+            self._map = mmap.mmap(fd, size)
+        finally:
+            os.close(fd)
+        HEADER.pack_into(self._map, 0, SNAPSHOT_MAGIC, LAYOUT_VERSION, HEADER_SIZE, PAYLOAD.size, 0, 0)
+        logger.info(f"Inventory snapshot mapped at {path} ({size} bytes, layout v{LAYOUT_VERSION})")
+
+    def update(self, **fields):
+        """
+        Merge fields into the snapshot and publish it
+
+        Args:
+            **fields: Any of PAYLOAD_FIELDS (unknown names raise KeyError);
+                      None values leave the field unchanged
+        """
+        with self._lock:
+            self._update_locked(fields)
+
+    def _update_locked(self, fields: Dict[str, Any]):
+        """Merge and publish (lock held)"""
+        for name, value in fields.items():
+            if name not in self._values:
+                raise KeyError(f"Unknown snapshot field {name}")
+            if value is not None:
+                self._values[name] = value
+        self._values['update_ts_ns'] = time.time_ns()
+        payload = PAYLOAD.pack(*(self._coerce(name) for name in PAYLOAD_FIELDS))
+
+        # Seqlock: odd sequence -> payload -> even sequence
+        self._sequence += 1
+        _SEQUENCE.pack_into(self._map, SEQUENCE_OFFSET, self._sequence)
+        self._map[HEADER_SIZE:HEADER_SIZE + PAYLOAD.size] = payload
+        self._sequence += 1
+        _SEQUENCE.pack_into(self._map, SEQUENCE_OFFSET, self._sequence)
+        self.writes += 1
+
+    def set_flag(self, flag: int, enabled: bool):
+        """Set or clear one of the FLAG_* bits and publish"""
+        with self._lock:
+            # Read-modify-write under one acquisition so concurrent flags are not lost
+            flags = self._values['flags']
+            self._update_locked({'flags': (flags | flag) if enabled else (flags & ~flag)})
+
+    def _coerce(self, name: str):
+        value = self._values[name]
+        return int(value) if name in _INTEGER_FIELDS else float(value)
+
+    def close(self):
+        self._map.close()
+
+
+class InventorySnapshotReader:
+    """
+    Reader for the snapshot (reference implementation for the C++ side)
+    """
+
+    def __init__(self, path: str):
+        """
+        Map an existing snapshot read-only and validate its header
+
+        Args:
+            path: Snapshot file path
+
+        Raises:
+            ValueError: If the magic, layout version or payload size is incompatible
+        """
+        fd = os.open(path, os.O_RDONLY)
+        try:
+            self._map = mmap.mmap(fd, 0, prot=mmap.PROT_READ)
+        finally:
+            os.close(fd)
+        magic, version, header_size, payload_size, _, _ = HEADER.unpack_from(self._map, 0)
+        if magic != SNAPSHOT_MAGIC:
+            raise ValueError(f"Not an inventory snapshot: magic=0x{magic:08x}")
+        if version != LAYOUT_VERSION or payload_size < PAYLOAD.size:
+            raise ValueError(f"Incompatible snapshot layout v{version} ({payload_size} byte payload)")
+        self.header_size = header_size
+        self.retries = 0
+
+    def read(self, max_attempts: int = 1000) -> Optional[Dict[str, Any]]:
+        """
+        Take a consistent snapshot
+
+        Args:
+            max_attempts: Give up after this many torn reads
+
+        Returns:
+            Field dict (plus 'sequence'), or None if nothing was published yet
+        """
+        for _ in range(max_attempts):
+            (before,) = _SEQUENCE.unpack_from(self._map, SEQUENCE_OFFSET)
+            if before & 1:
+                self.retries += 1
+                continue
+            raw = self._map[self.header_size:self.header_size + PAYLOAD.size]
+            (after,) = _SEQUENCE.unpack_from(self._map, SEQUENCE_OFFSET)
+            if before != after:
+                self.retries += 1
+                continue
+            if before == 0:
+                return None
+            snapshot = dict(zip(PAYLOAD_FIELDS, PAYLOAD.unpack(raw)))
+            snapshot['sequence'] = before
+            return snapshot
+        raise TimeoutError('Snapshot writer did not settle')
+
+    def close(self):
+        self._map.close()
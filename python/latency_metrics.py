@@ -0,0 +1,301 @@
+"""
+AsymmetricLP - Latency Metrics
+Always-on latency spans for the monitoring tick and rebalance steps,
+recorded into log-linear (HDR-style) histograms and exported as
+Prometheus text plus periodic log summaries.
+
+Recording never takes a lock: every thread writes to its own histograms,
+and readers merge them. A merged snapshot taken while a thread is recording
+can be off by that one sample, which is fine for monitoring.
+"""
+import logging
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from typing import Dict, List, Optional, Tuple
+
+logger = logging.getLogger(__name__)
+
+# Values (nanoseconds) below 2**(SUB_BUCKET_BITS + 1) get exact buckets; above
+# that each power of two is split into 2**SUB_BUCKET_BITS buckets (~3% precision).
+SUB_BUCKET_BITS = 5
+SUB_BUCKETS = 1 << SUB_BUCKET_BITS
+LINEAR_LIMIT = SUB_BUCKETS << 1
+MAX_EXPONENT = 40  # ~18 minutes in ns; larger values land in the last bucket
+BUCKET_COUNT = SUB_BUCKETS * (MAX_EXPONENT + 2)
+
+SUMMARY_QUANTILES = (0.5, 0.9, 0.99, 0.999)
+
+
+def bucket_index(value_ns: int) -> int:
+    """Map a non-negative value to its histogram bucket"""
+    if value_ns < LINEAR_LIMIT:
+        return value_ns if value_ns > 0 else 0
+    exponent = value_ns.bit_length() - SUB_BUCKET_BITS - 1
+    index = SUB_BUCKETS * exponent + (value_ns >> exponent)
+    return index if index < BUCKET_COUNT else BUCKET_COUNT - 1
+
+
+def bucket_value(index: int) -> float:
+    """Representative (midpoint) value of a bucket in ns"""
+    if index < LINEAR_LIMIT:
+        return float(index)
+    exponent = index // SUB_BUCKETS - 1
+    lower = (index - SUB_BUCKETS * exponent) << exponent
+    return lower + ((1 << exponent) - 1) / 2.0
+
+
+class Histogram:
+    """Single-writer log-linear histogram"""
+
+    __slots__ = ('counts', 'count', 'total', 'max')
+
+    def __init__(self):
+        self.counts = [0] * BUCKET_COUNT
+        self.count = 0
+        self.total = 0
+        self.max = 0
+
+    def record(self, value_ns: int):
+        self.counts[bucket_index(value_ns)] += 1
+        self.count += 1
+        self.total += value_ns
+        if value_ns > self.max:
+            self.max = value_ns
+
+    def merge(self, other: 'Histogram'):
+        counts = self.counts
+        for i, c in enumerate(other.counts):
+            if c:
+                counts[i] += c
+        self.count += other.count
+        self.total += other.total
+        self.max = max(self.max, other.max)
+
+    def quantile(self, q: float) -> float:
+        """Value (ns) at quantile q, from bucket midpoints"""
+        if not self.count:
+            return 0.0
+        target = max(1, int(q * self.count + 0.5))
+        seen = 0
+        for i, c in enumerate(self.counts):
+            seen += c
+            if seen >= target:
+                return min(bucket_value(i), float(self.max))
+        return float(self.max)
+
+    @property
+    def mean(self) -> float:
+        return self.total / self.count if self.count else 0.0
+
+
+class Span:
+    """
+    Reusable timing context manager
+
+    Usage:
+        with metrics.span('rebalance.mint'):
+            ...
+    """
+
+    __slots__ = ('_registry', '_name', '_start')
+
+    def __init__(self, registry: 'LatencyRegistry', name: str):
+        self._registry = registry
+        self._name = name
+        self._start = 0
+
+    def __enter__(self):
+        self._start = time.perf_counter_ns()
+        return self
+
+    def __exit__(self, exc_type, exc, tb):
+        self._registry.record(self._name, time.perf_counter_ns() - self._start)
+        return False
+
+
+class LatencyRegistry:
+    """Named histograms with per-thread recording and merged reads"""
+
+    def __init__(self):
+        self._local = threading.local()
+        self._lock = threading.Lock()  # guards thread registration and reads, never record()
+        self._thread_histograms: List[Tuple[threading.Thread, Dict[str, Histogram]]] = []
+        self._retired: Dict[str, Histogram] = {}
+
+    def _histograms(self) -> Dict[str, Histogram]:
+        histograms = self._local.__dict__.get('histograms')
+        if histograms is None:
+            histograms = self._local.histograms = {}
+            with self._lock:
+                self._retire_dead_threads()
+                self._thread_histograms.append((threading.current_thread(), histograms))
+        return histograms
+
+    def _retire_dead_threads(self):
+        """Fold histograms of finished threads (e.g. receipt trackers) into one set (lock held)"""
+        alive = []
+        for thread, histograms in self._thread_histograms:
+            if thread.is_alive():
+                alive.append((thread, histograms))
+                continue
+            for name, histogram in histograms.items():
+                self._retired.setdefault(name, Histogram()).merge(histogram)
+        self._thread_histograms = alive
+
+    def record(self, name: str, value_ns: int):
+        """
+        Record one duration
+
+        Args:
+            name: Span name, e.g. 'rebalance.mint'
+            value_ns: Duration in nanoseconds (perf_counter_ns delta)
+        """
+        histograms = self._local.__dict__.get('histograms') or self._histograms()
+        histogram = histograms.get(name)
+        if histogram is None:
+            histogram = histograms[name] = Histogram()
+        histogram.record(value_ns)
+
+    def span(self, name: str) -> Span:
+        """Context manager that records its own duration under name"""
+        return Span(self, name)
+
+    def snapshot(self) -> Dict[str, Histogram]:
+        """
+        Merge every thread's histograms
+
+        Returns:
+            Span name -> merged histogram
+        """
+        merged: Dict[str, Histogram] = {}
+        with self._lock:
+            self._retire_dead_threads()
+            per_thread = [histograms for _, histograms in self._thread_histograms]
+            for name, histogram in self._retired.items():
+                merged.setdefault(name, Histogram()).merge(histogram)
+        for histograms in per_thread:
+            for name, histogram in list(histograms.items()):
+                merged.setdefault(name, Histogram()).merge(histogram)
+        return merged
+
+    def reset(self):
+        """Drop all recorded data (threads re-register on their next record)"""
+        with self._lock:
+            for _, histograms in self._thread_histograms:
+                histograms.clear()
+            self._retired.clear()
+
+    def summary(self) -> Dict[str, Dict[str, float]]:
+        """
+        Per-span count and latency quantiles in microseconds
+
+        Returns:
+            Span name -> {'count', 'mean_us', 'p50_us', 'p90_us', 'p99_us', 'p999_us', 'max_us'}
+        """
+        result = {}
+        for name, histogram in sorted(self.snapshot().items()):
+            entry = {'count': histogram.count, 'mean_us': histogram.mean / 1000}
+            for q in SUMMARY_QUANTILES:
+                entry[f"p{str(q)[2:].ljust(2, '0')}_us"] = histogram.quantile(q) / 1000
+            entry['max_us'] = histogram.max / 1000
+            result[name] = entry
+        return result
+
+    def render_prometheus(self, prefix: str = 'asymmetric_lp_latency') -> str:
+        """
+        Prometheus text exposition (one summary metric, labelled by span)
+
+        Returns:
+            Exposition text
+        """
+        lines = [
+            f"# HELP {prefix}_seconds Hot-path span latency",
+            f"# TYPE {prefix}_seconds summary"
+        ]
+        for name, histogram in sorted(self.snapshot().items()):
+            label = name.replace('\\', '\\\\').replace('"', '\\"')
+            for q in SUMMARY_QUANTILES:
+                lines.append(f'{prefix}_seconds{{span="{label}",quantile="{q}"}} {histogram.quantile(q) / 1e9:.9f}')
+            lines.append(f'{prefix}_seconds_sum{{span="{label}"}} {histogram.total / 1e9:.9f}')
+            lines.append(f'{prefix}_seconds_count{{span="{label}"}} {histogram.count}')
+        return '\n'.join(lines) + '\n'
+
+
+# Process-wide registry used by the rebalancer, executor and client
+metrics = LatencyRegistry()
+
+
+class MetricsExporter:
+    """Serves /metrics and logs periodic summaries for a registry"""
+
+    def __init__(self, registry: LatencyRegistry, port: int = 0, host: str = '127.0.0.1',
+                 summary_interval: float = 0):
+        """
+        Initialize the exporter
+
+        Args:
+            registry: Registry to export
+            port: HTTP port for /metrics (0 disables the endpoint)
+            host: Interface to bind
+            summary_interval: Seconds between log summaries (0 disables them)
+        """
+        self.registry = registry
+        self.port = port
+        self.host = host
+        self.summary_interval = summary_interval
+        self._server: Optional[ThreadingHTTPServer] = None
+        self._threads: List[threading.Thread] = []
+        self._stop = threading.Event()
+
+    def start(self):
+        """Start the HTTP endpoint and/or the summary logger"""
+        self._stop.clear()
+        if self.port:
+            registry = self.registry
+
+            class Handler(BaseHTTPRequestHandler):
+                def log_message(self, *args):
+                    pass
+
+                def do_GET(self):
+                    if self.path.split('?')[0] != '/metrics':
+                        self.send_error(404)
+                        return
+                    body = registry.render_prometheus().encode()
+                    self.send_response(200)
+                    self.send_header('Content-Type', 'text/plain; version=0.0.4')
+                    self.send_header('Content-Length', str(len(body)))
+                    self.end_headers()
+                    self.wfile.write(body)
+
+            self._server = ThreadingHTTPServer((self.host, self.port), Handler)
+            self.port = self._server.server_address[1]
+            thread = threading.Thread(target=self._server.serve_forever, name='metrics-http', daemon=True)
+            thread.start()
+            self._threads.append(thread)
+            logger.info(f"Latency metrics served at http://{self.host}:{self.port}/metrics")
+        if self.summary_interval:
+            thread = threading.Thread(target=self._summary_loop, name='metrics-summary', daemon=True)
+            thread.start()
+            self._threads.append(thread)
+
+    def _summary_loop(self):
+        while not self._stop.wait(self.summary_interval):
+            self.log_summary()
+
+    def log_summary(self):
+        """Log one line per span"""
+        for name, s in self.registry.summary().items():
+            logger.info(f"Latency {name}: n={s['count']} p50={s['p50_us']:.0f}µs "
+                        f"p99={s['p99_us']:.0f}µs max={s['max_us']:.0f}µs")
+
+    def stop(self):
+        self._stop.set()
+        if self._server:
+            self._server.shutdown()
+            self._server.server_close()
+            self._server = None
+        for thread in self._threads:
+            thread.join(timeout=2)
+        self._threads = []
@@ -8,6 +8,9 @@ from typing import Dict, Any, Optional, Tuple
 from web3 import Web3
 from uniswap_client import UniswapV3Client
 from config import Config
+from position_calldata import encode_mint, encode_decrease_liquidity
+from preflight import PreflightSimulator
+from receipt_decoder import decode_receipts
 
 logger = logging.getLogger(__name__)
 
@@ -19,6 +22,12 @@ class LPPositionManager:
         self.client = client or UniswapV3Client()
         self.w3 = self.client.w3
         self.config = self.client.config
+        # Shared with the TransactionExecutor (set by AutomatedRebalancer) so sequential
+        # sends and pipelined batches never hand out the same nonce
+        self.nonce_manager = None
+        
+        # eth_call simulation of mints before they are signed
+        self.preflight = PreflightSimulator(self.client, self.config) if self.config.PREFLIGHT_ENABLED else None
         
     def calculate_tick_range(self, current_tick: int, range_percentage: float = 0.1) -> Tuple[int, int]:
         """
@@ -126,37 +135,28 @@ class LPPositionManager:
             logger.info(f"Adding liquidity: {amount0_actual} token0, {amount1_actual} token1")
             logger.info(f"Tick range: {tick_lower} to {tick_upper} (current: {current_tick})")
             
-            # Prepare mint transaction
-            mint_params = {
-                'token0': token0,
-                'token1': token1,
-                'fee': fee,
-                'tickLower': tick_lower,
-                'tickUpper': tick_upper,
-                'amount0Desired': amount0_actual,
-                'amount1Desired': amount1_actual,
-                'amount0Min': amount0_min,
-                'amount1Min': amount1_min,
-                'recipient': self.client.wallet_address,
-                'deadline': deadline
-            }
+            # Simulate first: reject a mint that would revert, and bound it by what it would add
+            if self.preflight and amount0_min == 0 and amount1_min == 0:
+                plan = self.preflight.plan_mints([{
+                    'token0': token0, 'token1': token1, 'fee': fee,
+                    'tick_lower': tick_lower, 'tick_upper': tick_upper,
+                    'amount0_desired': amount0_actual, 'amount1_desired': amount1_actual,
+                    'amount0_min': 0, 'amount1_min': 0
+                }], self.client.wallet_address, deadline)
+                if not plan.ok:
+                    return {'success': False, 'error': f"Pre-flight rejected: {plan.reason}"}
+                amount0_min, amount1_min = plan.mints[0]['amount0_min'], plan.mints[0]['amount1_min']
             
-            # Build transaction
-            transaction = self.client.position_manager.functions.mint(**mint_params).build_transaction({
-                'from': self.client.wallet_address,
-                'gas': self.client.estimate_gas({
-                    'from': self.client.wallet_address,
-                    'to': self.config.UNISWAP_V3_POSITION_MANAGER,
-                    'data': self.client.position_manager.functions.mint(**mint_params).build_transaction()['data']
-                }),
-                'gasPrice': self.client.get_gas_price(),
-                'nonce': self.w3.eth.get_transaction_count(self.client.wallet_address),
-                'value': 0  # Add ETH value if needed for token0 = WETH
-            })
+            # Encode mint calldata once and reuse it for estimation and sending
+            data = '0x' + encode_mint(
+                token0, token1, fee, tick_lower, tick_upper,
+                amount0_actual, amount1_actual, amount0_min, amount1_min,
+                self.client.wallet_address, deadline
+            ).hex()
+            transaction = self.build_transaction(data)
             
             # Sign and send transaction
-            signed_txn = self.client.account.sign_transaction(transaction)
-            tx_hash = self.w3.eth.send_raw_transaction(signed_txn.rawTransaction)
+            tx_hash = self.send_transaction(transaction)
             
             logger.info(f"Transaction sent: {tx_hash.hex()}")
             
@@ -191,6 +191,97 @@ class LPPositionManager:
                 'error': str(e)
             }
     
+    def build_mint_step(
+        self,
+        executor,
+        token0: str,
+        token1: str,
+        fee: int,
+        amount0_desired: int,
+        amount1_desired: int,
+        tick_lower: int,
+        tick_upper: int,
+        current_tick: int,
+        deadline: int,
+        amount0_min: int = 0,
+        amount1_min: int = 0
+    ) -> Dict[str, Any]:
+        """
+        Build a mint step for a pipelined batch (no RPC calls)
+
+        Args:
+            executor: TransactionExecutor that will submit the step
+            token0: Address of token0
+            token1: Address of token1
+            fee: Fee tier (500, 3000, or 10000)
+            amount0_desired: Desired amount of token0
+            amount1_desired: Desired amount of token1
+            tick_lower: Lower tick bound
+            tick_upper: Upper tick bound
+            current_tick: Current pool tick (already read by the caller)
+            deadline: Transaction deadline (timestamp)
+            amount0_min: Minimum amount of token0 to add
+            amount1_min: Minimum amount of token1 to add
+
+        Returns:
+            Step dictionary for TransactionExecutor.submit_batch
+        """
+        amount0_actual, amount1_actual = self.calculate_liquidity_amounts(
+            amount0_desired, amount1_desired, tick_lower, tick_upper, current_tick
+        )
+
+        logger.info(f"Preparing mint: {amount0_actual} token0, {amount1_actual} token1, "
+                    f"ticks {tick_lower} to {tick_upper} (current: {current_tick})")
+
+        data = encode_mint(
+            token0, token1, fee, tick_lower, tick_upper,
+            amount0_actual, amount1_actual, amount0_min, amount1_min,
+            self.client.wallet_address, deadline
+        )
+        return executor.make_step(f'mint:{tick_lower}:{tick_upper}', data)
+    
+    def build_transaction(self, data: str, value: int = 0) -> Dict[str, Any]:
+        """
+        Build a position-manager transaction from pre-encoded calldata
+        
+        Args:
+            data: Hex-encoded calldata
+            value: ETH value to attach
+            
+        Returns:
+            Unsigned transaction dictionary (gas estimated once)
+        """
+        transaction = {
+            'from': self.client.wallet_address,
+            'to': self.config.UNISWAP_V3_POSITION_MANAGER,
+            'data': data,
+            'value': value,
+            'chainId': self.config.CHAIN_ID
+        }
+        transaction['gas'] = self.client.estimate_gas(transaction)
+        transaction.update(self.client.get_fee_params())
+        if self.nonce_manager is not None:
+            transaction['nonce'] = self.nonce_manager.allocate(1)[0]
+        else:
+            transaction['nonce'] = self.w3.eth.get_transaction_count(self.client.wallet_address, 'pending')
+        return transaction
+    
+    def send_transaction(self, transaction: Dict[str, Any]):
+        """
+        Sign and broadcast a transaction from build_transaction
+        
+        Returns:
+            Transaction hash
+        """
+        try:
+            signed_txn = self.client.account.sign_transaction(transaction)
+            return self.w3.eth.send_raw_transaction(signed_txn.rawTransaction)
+        except Exception:
+            # The nonce was not used (or is now uncertain); re-read it before the next send
+            if self.nonce_manager is not None:
+                self.nonce_manager.reset()
+            raise
+
     def remove_liquidity(
         self,
         token_id: int,
@@ -218,31 +309,14 @@ class LPPositionManager:
             
             logger.info(f"Removing {liquidity_amount} liquidity from position {token_id}")
             
-            # Prepare decrease liquidity transaction
-            decrease_params = {
-                'tokenId': token_id,
-                'liquidity': liquidity_amount,
-                'amount0Min': amount0_min,
-                'amount1Min': amount1_min,
-                'deadline': deadline
-            }
-            
-            # Build transaction
-            transaction = self.client.position_manager.functions.decreaseLiquidity(**decrease_params).build_transaction({
-                'from': self.client.wallet_address,
-                'gas': self.client.estimate_gas({
-                    'from': self.client.wallet_address,
-                    'to': self.config.UNISWAP_V3_POSITION_MANAGER,
-                    'data': self.client.position_manager.functions.decreaseLiquidity(**decrease_params).build_transaction()['data']
-                }),
-                'gasPrice': self.client.get_gas_price(),
-                'nonce': self.w3.eth.get_transaction_count(self.client.wallet_address),
-                'value': 0
-            })
+            # Encode decrease liquidity calldata once and reuse it for estimation and sending
+            data = '0x' + encode_decrease_liquidity(
+                token_id, liquidity_amount, amount0_min, amount1_min, deadline
+            ).hex()
+            transaction = self.build_transaction(data)
             
             # Sign and send transaction
-            signed_txn = self.client.account.sign_transaction(transaction)
-            tx_hash = self.w3.eth.send_raw_transaction(signed_txn.rawTransaction)
+            tx_hash = self.send_transaction(transaction)
             
             logger.info(f"Transaction sent: {tx_hash.hex()}")
             
@@ -315,21 +389,23 @@ class LPPositionManager:
             raise
     
     def _extract_position_from_receipt(self, receipt: Dict[str, Any]) -> Dict[str, Any]:
-        """Extract position details from transaction receipt"""
-        # This is a simplified extraction
-        # In practice, you'd parse the transaction logs to get the exact values
+        """Token ID, liquidity and amounts of the position minted in a receipt"""
+        minted = decode_receipts([receipt], self.config.UNISWAP_V3_POSITION_MANAGER).minted()
+        if not minted:
+            logger.warning("No minted position found in receipt logs")
+            return {'token_id': None, 'liquidity': 0, 'amount0': 0, 'amount1': 0}
+        position = minted[0]
         return {
-            'token_id': 'extracted_from_logs',
-            'liquidity': 'extracted_from_logs',
-            'amount0': 'extracted_from_logs',
-            'amount1': 'extracted_from_logs'
+            'token_id': position.token_id,
+            'liquidity': position.liquidity,
+            'amount0': position.amount0,
+            'amount1': position.amount1
         }
     
     def _extract_amounts_from_receipt(self, receipt: Dict[str, Any]) -> Dict[str, Any]:
-        """Extract amounts from transaction receipt"""
-        # This is a simplified extraction
-        # In practice, you'd parse the transaction logs to get the exact values
+        """Principal released by decreaseLiquidity in a receipt (owed until collected)"""
+        amount0, amount1 = decode_receipts([receipt], self.config.UNISWAP_V3_POSITION_MANAGER).removed()
         return {
-            'amount0': 'extracted_from_logs',
-            'amount1': 'extracted_from_logs'
+            'amount0': amount0,
+            'amount1': amount1
         }
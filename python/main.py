@@ -4,21 +4,20 @@ Main application for AsymmetricLP bot.
 Handles both live trading and backtesting modes.
 """
 import logging
+import os
 import signal
 import sys
 import time
 import argparse
 from datetime import datetime
 from config import Config
+from config_reload import ConfigStore
 try:
     from automated_rebalancer import AutomatedRebalancer
 except ImportError:
     AutomatedRebalancer = None  # Not needed for backtesting
 from backtest_engine import BacktestEngine
-from utils import Logger
 
-# Set up logging
-Logger.setup_logging(level="INFO", log_file="logs/rebalancer.log")
 logger = logging.getLogger(__name__)
 
 def generate_sample_ohlc_data(start_date: str, end_date: str, output_file: str):
@@ -91,7 +90,9 @@ class RebalancerApp:
     
     def __init__(self):
         """Initialize the application"""
-        self.config = Config()
+        # Strategy parameters can be reloaded from CONFIG_RELOAD_PATH (SIGHUP or file change)
+        self.config_store = ConfigStore(Config)
+        self.config = self.config_store.current()
         
         # Validate configuration
         try:
@@ -108,6 +109,7 @@ class RebalancerApp:
         # Set up signal handlers for graceful shutdown
         signal.signal(signal.SIGINT, self.signal_handler)
         signal.signal(signal.SIGTERM, self.signal_handler)
+        self.config_store.install_signal_handler()
         
         logger.info("RebalancerApp initialized")
     
@@ -120,6 +122,7 @@ class RebalancerApp:
             try:
                 signal_name = "SIGINT" if signum == 2 else "SIGTERM" if signum == 15 else f"Signal {signum}"
                 self.rebalancer.alert_manager.send_shutdown_notification(f"Received {signal_name}")
+                self.rebalancer.alert_manager.close(timeout=5)
             except Exception as alert_error:
                 logger.warning(f"Failed to send shutdown notification: {alert_error}")
         
@@ -143,6 +146,8 @@ class RebalancerApp:
             
             # Initialize rebalancer
             self.rebalancer = AutomatedRebalancer(self.config)
+            self.config_store.subscribe(self.rebalancer.apply_config)
+            self.config_store.start()
             
             # Send startup notification
             try:
@@ -186,21 +191,21 @@ class RebalancerApp:
             logger.info("Automated rebalancer is now running...")
             logger.info("Press Ctrl+C to stop")
             
-        # Keep the main thread alive
-        last_status_log_time = 0
-        STATUS_LOG_INTERVAL_SECONDS = 300  # 5 minutes - matches C++ constant
-        
-        while self.running:
-            time.sleep(1)
+            # Keep the main thread alive
+            last_status_log_time = 0
+            STATUS_LOG_INTERVAL_SECONDS = 300  # 5 minutes - matches C++ constant
             
-            # Log status periodically using elapsed time instead of modulo
-            current_time = time.time()
-            if current_time - last_status_log_time >= STATUS_LOG_INTERVAL_SECONDS:
-                status = self.rebalancer.get_status()
-                logger.info(f"Status: Running={status['is_running']}, "
-                          f"Last Price={status['last_spot_price']}, "
-                          f"Positions={status['current_positions']}")
-                last_status_log_time = current_time
+            while self.running:
+                time.sleep(1)
+                
+                # Log status periodically using elapsed time instead of modulo
+                current_time = time.time()
+                if current_time - last_status_log_time >= STATUS_LOG_INTERVAL_SECONDS:
+                    status = self.rebalancer.get_status()
+                    logger.info(f"Status: Running={status['is_running']}, "
+                              f"Last Price={status['last_spot_price']}, "
+                              f"Positions={status['current_positions']}")
+                    last_status_log_time = current_time
             
             return True
             
@@ -213,6 +218,7 @@ class RebalancerApp:
         if self.rebalancer and self.running:
             logger.info("Stopping automated rebalancer...")
             self.rebalancer.stop_monitoring()
+            self.config_store.stop()
             self.running = False
             logger.info("Automated rebalancer stopped")
     
@@ -257,7 +263,6 @@ def run_historical_mode(args):
     print(f"   Max Inventory Deviation: {config.MAX_INVENTORY_DEVIATION:.1%}")
     
     # Check if OHLC file exists
-    import os
     if not os.path.exists(args.ohlc_file):
         if args.generate_sample:
             print(f"\n📊 Generating sample OHLC data for verification...")
@@ -278,6 +283,10 @@ def run_historical_mode(args):
     # Initialize backtest engine with backtest config
     print(f"\n🔧 Initializing backtest engine...")
     engine = BacktestEngine(config, backtest_config)
+    if args.result_cache is not None:
+        from result_cache import ResultCache
+        engine.result_cache = ResultCache(args.result_cache or None)
+        print(f"✅ Result cache: {engine.result_cache.directory}")
     print("✅ Backtest engine initialized")
     
     # Parse dates
@@ -307,6 +316,8 @@ def run_historical_mode(args):
         )
         
         print("✅ Backtest completed successfully!")
+        if engine.result_cache is not None:
+            print(f"   Result cache: {'hit' if engine.result_cache.hits else 'miss, stored'}")
         
     except Exception as e:
         print(f"❌ Backtest failed: {e}")
@@ -396,8 +407,8 @@ def run_live_mode(args):
     print("👋 Goodbye!")
     return 0
 
-def main():
-    """Main function with mode selection"""
+def build_parser() -> argparse.ArgumentParser:
+    """Command line arguments for both modes"""
     parser = argparse.ArgumentParser(
         description='AsymmetricLP - Uniswap V3 LP Rebalancer with Asymmetric Range Allocation',
         formatter_class=argparse.RawDescriptionHelpFormatter,
@@ -445,6 +456,8 @@ Examples:
                        help=f'Initial token B balance (default: {_default_balance_1})')
     parser.add_argument('--output', default='backtest_results.json',
                        help='Output file for backtest results (default: backtest_results.json)')
+    parser.add_argument('--result-cache', nargs='?', const='', metavar='DIR',
+                       help='Reuse stored results of identical runs (default DIR: RESULT_CACHE_DIR)')
     
     # Backtest configuration overrides
     parser.add_argument('--fee-tier', type=int,
@@ -457,8 +470,16 @@ Examples:
     # Sample data generation (for verification only)
     parser.add_argument('--generate-sample', action='store_true',
                        help='Generate sample OHLC data for verification (not recommended for real backtesting)')
+    return parser
+
+def main():
+    """Main function with mode selection"""
+    args = build_parser().parse_args()
     
-    args = parser.parse_args()
+    # Set up logging here rather than at import, so tests and tools can import this module
+    from utils import Logger
+    os.makedirs('logs', exist_ok=True)
+    Logger.setup_logging(level="INFO", log_file="logs/rebalancer.log")
     
     print("🤖 AsymmetricLP")
     print("=" * 50)
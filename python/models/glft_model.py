@@ -10,11 +10,22 @@ from typing import Dict, Tuple, Optional, List, Any
 from decimal import Decimal, getcontext
 from config import Config
 from .base_model import BaseInventoryModel
+import fastlog
 
 # Set high precision for calculations
 getcontext().prec = 50
 
 logger = logging.getLogger(__name__)
+_log = fastlog.get_logger(__name__)
+
+MSG_RANGE_A_CONSTRAINED = fastlog.message("GLFT Range A constrained to {:.3f} by min/max limits")
+MSG_RANGE_B_CONSTRAINED = fastlog.message("GLFT Range B constrained to {:.3f} by min/max limits")
+MSG_RANGES = fastlog.message("GLFT ranges calculated: A={:.4f}, B={:.4f}, skew={:.4f}, volatility={:.4f}, "
+                             "execution_cost={:.4f}")
+MSG_FINITE_CONSTRAINT = fastlog.message("Applied inventory constraint: {:.4f} -> {:.4f}, inventory_level={:.4f}, "
+                                        "distance_from_limit={:.4f}")
+MSG_TOKEN0_LIMIT = fastlog.message("At token0 inventory limit, reducing range A to {:.4f}")
+MSG_TOKEN1_LIMIT = fastlog.message("At token1 inventory limit, reducing range B to {:.4f}")
 
 
 class GLFTModel(BaseInventoryModel):
@@ -137,9 +148,9 @@ class GLFTModel(BaseInventoryModel):
             
             # Log when constraints are applied
             if range_a == self.config.MIN_RANGE_PERCENTAGE / 100.0 or range_a == self.config.MAX_RANGE_PERCENTAGE / 100.0:
-                logger.info(f"GLFT Range A constrained to {range_a:.3f} by min/max limits")
+                _log.info(MSG_RANGE_A_CONSTRAINED, range_a)
             if range_b == self.config.MIN_RANGE_PERCENTAGE / 100.0 or range_b == self.config.MAX_RANGE_PERCENTAGE / 100.0:
-                logger.info(f"GLFT Range B constrained to {range_b:.3f} by min/max limits")
+                _log.info(MSG_RANGE_B_CONSTRAINED, range_b)
             
             return {
                 'range_a_percentage': range_a * 100.0,  # Convert to percentage
@@ -241,9 +252,7 @@ class GLFTModel(BaseInventoryModel):
                 range_a = self._apply_finite_inventory_constraint(range_a, normalized_inventory_0)
                 range_b = self._apply_finite_inventory_constraint(range_b, normalized_inventory_1)
             
-            logger.debug(f"GLFT ranges calculated: A={range_a:.4f}, B={range_b:.4f}, "
-                        f"skew={inventory_skew:.4f}, volatility={volatility:.4f}, "
-                        f"execution_cost={self.execution_cost:.4f}")
+            _log.debug(MSG_RANGES, range_a, range_b, inventory_skew, volatility, self.execution_cost)
             
             return range_a, range_b
             
@@ -276,8 +285,7 @@ class GLFTModel(BaseInventoryModel):
                 constraint_factor = distance_from_limit / self.max_position_size
                 adjusted_range = range_size * constraint_factor
                 
-                logger.debug(f"Applied inventory constraint: {range_size:.4f} -> {adjusted_range:.4f}, "
-                           f"inventory_level={inventory_level:.4f}, distance_from_limit={distance_from_limit:.4f}")
+                _log.debug(MSG_FINITE_CONSTRAINT, range_size, adjusted_range, inventory_level, distance_from_limit)
                 
                 return adjusted_range
             
@@ -315,12 +323,12 @@ class GLFTModel(BaseInventoryModel):
             if at_token0_limit:
                 # At token0 limit, reduce range A (selling token0)
                 range_a *= 0.5
-                logger.info(f"At token0 inventory limit, reducing range A to {range_a:.4f}")
+                _log.info(MSG_TOKEN0_LIMIT, range_a)
             
             if at_token1_limit:
                 # At token1 limit, reduce range B (selling token1)
                 range_b *= 0.5
-                logger.info(f"At token1 inventory limit, reducing range B to {range_b:.4f}")
+                _log.info(MSG_TOKEN1_LIMIT, range_b)
             
             return range_a, range_b
             
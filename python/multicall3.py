@@ -0,0 +1,92 @@
+"""
+AsymmetricLP - Multicall3 Batched Reads
+Packs many view calls into one eth_call against the Multicall3 contract
+(deployed at the same address on every major EVM chain).
+"""
+import logging
+from typing import Any, Dict, List, Optional, Sequence, Tuple
+from eth_abi import encode, decode
+from eth_utils import keccak, to_checksum_address
+
+logger = logging.getLogger(__name__)
+
+MULTICALL3_ADDRESS = '0xcA11bde05977b3631167028862bE2a173976CA11'
+
+# aggregate3((address,bool,bytes)[]) -> (bool,bytes)[]
+AGGREGATE3_SELECTOR = keccak(text='aggregate3((address,bool,bytes)[])')[:4]
+
+
+def encode_call(signature: str, arg_types: Sequence[str] = (), args: Sequence[Any] = ()) -> bytes:
+    """
+    Encode calldata for a view function
+
+    Args:
+        signature: Canonical signature, e.g. 'positions(uint256)'
+        arg_types: ABI types of the arguments
+        args: Argument values
+
+    Returns:
+        Calldata bytes
+    """
+    return keccak(text=signature)[:4] + (encode(list(arg_types), list(args)) if arg_types else b'')
+
+
+class Multicall3:
+    """Thin wrapper around Multicall3.aggregate3 for batched view calls"""
+
+    def __init__(self, w3, address: str = MULTICALL3_ADDRESS):
+        """
+        Initialize the batch reader
+
+        Args:
+            w3: Web3 instance
+            address: Multicall3 contract address
+        """
+        self.w3 = w3
+        self.address = to_checksum_address(address)
+
+    def aggregate3(self, calls: List[Tuple[str, bytes]], block_identifier='latest') -> List[Tuple[bool, bytes]]:
+        """
+        Execute view calls in a single eth_call; individual failures are allowed
+
+        Args:
+            calls: (target address, calldata) pairs
+            block_identifier: Block to read at
+
+        Returns:
+            (success, returnData) per call, in order
+        """
+        if not calls:
+            return []
+        data = AGGREGATE3_SELECTOR + encode(
+            ['(address,bool,bytes)[]'],
+            [[(to_checksum_address(target), True, calldata) for target, calldata in calls]]
+        )
+        raw = self.w3.eth.call({'to': self.address, 'data': '0x' + data.hex()}, block_identifier)
+        (results,) = decode(['(bool,bytes)[]'], bytes(raw))
+        return [(bool(success), bytes(ret)) for success, ret in results]
+
+    def read(self, calls: List[Tuple[str, bytes, Sequence[str]]],
+             block_identifier='latest') -> List[Optional[Tuple]]:
+        """
+        Execute view calls and ABI-decode each successful result
+
+        Args:
+            calls: (target, calldata, output types) triples
+            block_identifier: Block to read at
+
+        Returns:
+            Decoded output tuple per call, or None where the call reverted
+        """
+        raw = self.aggregate3([(target, data) for target, data, _ in calls], block_identifier)
+        decoded: List[Optional[Tuple]] = []
+        for (success, ret), (_, _, output_types) in zip(raw, calls):
+            if not success:
+                decoded.append(None)
+                continue
+            try:
+                decoded.append(decode(list(output_types), ret))
+            except Exception as e:
+                logger.warning(f"Could not decode multicall result: {e}")
+                decoded.append(None)
+        return decoded
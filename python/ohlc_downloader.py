@@ -12,12 +12,12 @@ from datetime import datetime, timedelta, timezone
 from typing import Dict, List, Optional, Tuple, Any
 from dataclasses import dataclass
 import json
-import time
 from web3 import Web3
 from web3.middleware import geth_poa_middleware
 import requests
 from config import Config
 from uniswap_client import UniswapV3Client
+from rpc_gateway import LANE_DOWNLOAD, make_web3
 
 # Set up logging
 logging.basicConfig(level=logging.INFO, format='%(asctime)s - %(name)s - %(levelname)s - %(message)s')
@@ -41,7 +41,13 @@ class OHLCDataDownloader:
     def __init__(self, config: Config = None):
         """Initialize the OHLC data downloader"""
         self.config = config or Config()
-        self.uniswap_client = UniswapV3Client(self.config, read_only=True)
+        
+        # Downloads share the process's RPC quota in the lowest-priority lane
+        w3 = make_web3(self.config, lane=LANE_DOWNLOAD)
+        if not w3.is_connected():
+            raise ConnectionError("Failed to connect to Ethereum network")
+        self.gateway = getattr(w3.provider, 'gateway', None)
+        self.uniswap_client = UniswapV3Client(self.config, read_only=True, w3=w3)
         self.w3 = self.uniswap_client.w3
         
         # Helper function to checksum addresses
@@ -171,25 +177,12 @@ class OHLCDataDownloader:
                 })
                 
                 all_events.extend(events)
-                
-                # Small delay to avoid rate limiting
-                time.sleep(0.02)
             
             logger.info(f"Total events fetched: {len(all_events)}")
 
             # Cache block timestamps to avoid one RPC per event
             unique_blocks = sorted({int(ev['blockNumber']) for ev in all_events})
-            block_ts_cache: Dict[int, int] = {}
-            for idx, bn in enumerate(unique_blocks, 1):
-                try:
-                    ts = self.w3.eth.get_block(bn)['timestamp']
-                except Exception as e:
-                    logger.warning(f"Failed to fetch block {bn}: {e}; retrying once...")
-                    time.sleep(0.05)
-                    ts = self.w3.eth.get_block(bn)['timestamp']
-                block_ts_cache[bn] = ts
-                if idx % 1000 == 0:
-                    logger.info(f"Cached timestamps for {idx}/{len(unique_blocks)} blocks...")
+            block_ts_cache = self.get_block_timestamps(unique_blocks)
 
             swap_data = []
             for idx, event in enumerate(all_events, 1):
@@ -235,6 +228,35 @@ class OHLCDataDownloader:
             logger.error(f"Error fetching swap events: {e}")
             return []
     
+    def get_block_timestamps(self, block_numbers: List[int], chunk_size: int = 500) -> Dict[int, int]:
+        """
+        Timestamps for many blocks, fetched as gateway batches (throttling and retries are the gateway's)
+        
+        Args:
+            block_numbers: Blocks to look up
+            chunk_size: Blocks queued at a time
+            
+        Returns:
+            Block number -> timestamp
+        """
+        timestamps: Dict[int, int] = {}
+        for start in range(0, len(block_numbers), chunk_size):
+            chunk = block_numbers[start:start + chunk_size]
+            if self.gateway is None:
+                for bn in chunk:
+                    timestamps[bn] = self.w3.eth.get_block(bn)['timestamp']
+            else:
+                responses = self.gateway.call_many(
+                    [('eth_getBlockByNumber', [hex(bn), False]) for bn in chunk], lane=LANE_DOWNLOAD)
+                for bn, response in zip(chunk, responses):
+                    block = response.get('result')
+                    if block is None:
+                        logger.warning(f"Failed to fetch block {bn}: {response.get('error')}")
+                        continue
+                    timestamps[bn] = int(block['timestamp'], 16)
+            logger.info(f"Cached timestamps for {len(timestamps)}/{len(block_numbers)} blocks...")
+        return timestamps
+    
     def get_block_range_for_timeframe(self, start_time: datetime, end_time: datetime) -> Tuple[int, int]:
         """Get block range for given timeframe"""
         # Convert to timestamps
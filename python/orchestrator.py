@@ -0,0 +1,467 @@
+"""
+AsymmetricLP - Multi-Pool Orchestrator
+Hosts many AutomatedRebalancer instances (one per pool/strategy) in one
+process. They share one Web3 connection pool, one block-versioned state
+cache, one fee oracle, one alert queue and one inventory publisher. Each
+pool trades from its own wallet: a rebalancer treats the whole wallet balance
+as its inventory, so two pools on one key would size mints from the same funds.
+
+Each cycle reads every pool's slot0 in a single Multicall3 call, then
+schedules monitoring ticks on a worker pool in priority order: pools closest
+to their rebalance trigger (AsymmetricLPStrategy.rebalance_urgency) first.
+Pools whose price has not moved are only ticked every
+ORCHESTRATOR_IDLE_TICK_SECONDS.
+"""
+import argparse
+import heapq
+import json
+import logging
+import os
+import signal
+import threading
+import time
+from concurrent.futures import ThreadPoolExecutor
+from dataclasses import dataclass, field
+from typing import Any, Callable, Dict, List, Optional, Tuple
+
+from config import Config
+from config_reload import ConfigStore
+from fee_oracle import FeeOracle
+from latency_metrics import metrics, MetricsExporter
+from multicall3 import Multicall3, encode_call
+from rpc_gateway import make_web3
+from state_cache import StateCache
+
+logger = logging.getLogger(__name__)
+
+SLOT0_CALL = encode_call('slot0()')
+SLOT0_TYPES = ['uint160', 'int24', 'uint16', 'uint16', 'uint16', 'uint8', 'bool']
+
+# Per-pool file settings; '{pool}' is replaced by the pool name, otherwise the name is appended
+PER_POOL_PATH_SETTINGS = ('REBALANCE_WAL_PATH', 'INVENTORY_SNAPSHOT_PATH')
+
+
+@dataclass
+class PoolSpec:
+    """One strategy instance: a pool plus its config overrides"""
+    name: str
+    token_a: str
+    token_b: str
+    fee: int
+    overrides: Dict[str, Any] = field(default_factory=dict)
+    private_key_env: Optional[str] = None  # env var holding this pool's wallet key (default PRIVATE_KEY)
+
+
+def load_pool_specs(path: str) -> List[PoolSpec]:
+    """
+    Load pool specs from a JSON list
+
+    Each entry: {"name", "token_a", "token_b", "fee", "config": {...}?, "private_key_env"?}
+
+    Raises:
+        ValueError: On duplicate or missing names, or pools sharing a key variable
+    """
+    with open(path) as f:
+        entries = json.load(f)
+    specs = [PoolSpec(name=e['name'], token_a=e['token_a'], token_b=e['token_b'], fee=int(e['fee']),
+                      overrides=dict(e.get('config', {})), private_key_env=e.get('private_key_env'))
+             for e in entries]
+    names = [s.name for s in specs]
+    if len(set(names)) != len(names):
+        raise ValueError(f"Duplicate pool names in {path}")
+    key_envs = [s.private_key_env or 'PRIVATE_KEY' for s in specs]
+    shared = sorted({env for env in key_envs if key_envs.count(env) > 1})
+    if shared:
+        raise ValueError(f"Pools in {path} share a wallet key ({', '.join(shared)}); "
+                         f"give each pool its own private_key_env")
+    return specs
+
+
+@dataclass
+class _Wallet:
+    """Client and executor for one pool's key"""
+    client: Any
+    executor: Any
+
+
+class PoolSlot:
+    """Scheduling state for one hosted rebalancer"""
+
+    def __init__(self, index: int, spec: PoolSpec, rebalancer: Any):
+        self.index = index
+        self.spec = spec
+        self.rebalancer = rebalancer
+        self.pool_address: Optional[str] = None
+        self.pool_token0: Optional[str] = None
+        self.pool_token1: Optional[str] = None
+        self.last_sqrt_price: Optional[int] = None
+        self.last_tick_at = 0.0
+        self.spot_price: Optional[float] = None
+        self.urgency = 0.0
+        self.ticks = 0
+        self.errors = 0
+        self._busy = threading.Lock()
+
+    def try_acquire(self) -> bool:
+        """Claim the slot for one tick; False while a previous tick/rebalance runs"""
+        return self._busy.acquire(blocking=False)
+
+    def release(self):
+        self._busy.release()
+
+    @property
+    def busy(self) -> bool:
+        return self._busy.locked()
+
+
+class Orchestrator:
+    """Runs N pools on a shared connection, cache and fee oracle"""
+
+    def __init__(self, config: Config, pools: List[PoolSpec], w3=None,
+                 rebalancer_factory: Optional[Callable[[type], Any]] = None):
+        """
+        Initialize the orchestrator
+
+        Args:
+            config: Base configuration (class or instance); pool overrides are layered on top
+            pools: Pool specs
+            w3: Shared Web3 instance (built with a pooled HTTP session if None)
+            rebalancer_factory: Builds a rebalancer from the pool's config class
+                                (AutomatedRebalancer on the shared components if None)
+        """
+        self.config = config
+        self.base_config = config if isinstance(config, type) else type(config)
+        self.pools = pools
+        self.cycle_seconds = config.ORCHESTRATOR_CYCLE_SECONDS
+        self.workers = config.ORCHESTRATOR_WORKERS
+        self.idle_tick_seconds = config.ORCHESTRATOR_IDLE_TICK_SECONDS
+        self.rebalancer_factory = rebalancer_factory
+
+        self.w3 = w3
+        self.state_cache: Optional[StateCache] = None
+        self.fee_oracle: Optional[FeeOracle] = None
+        self.alert_manager = None
+        self.inventory_publisher = None
+        self.metrics_exporter: Optional[MetricsExporter] = None
+        self._wallets: Dict[str, _Wallet] = {}
+
+        self.slots: List[PoolSlot] = []
+        self._pool: Optional[ThreadPoolExecutor] = None
+        self._thread: Optional[threading.Thread] = None
+        self.is_running = False
+
+        self.stats = {
+            'cycles': 0, 'overruns': 0, 'scheduled': 0, 'skipped_busy': 0,
+            'skipped_unchanged': 0, 'price_read_errors': 0, 'last_cycle_ms': 0.0
+        }
+
+    # ------------------------------------------------------------------ setup
+
+    def _build_w3(self):
+        """One Web3 for every pool: the shared RPC gateway, else a session whose pool fits every worker"""
+        import requests
+        from requests.adapters import HTTPAdapter
+        from web3 import Web3
+
+        if self.config.RPC_GATEWAY_ENABLED:
+            w3 = make_web3(self.config)
+            if not w3.is_connected():
+                raise ConnectionError("Failed to connect to Ethereum network")
+            return w3
+
+        session = requests.Session()
+        adapter = HTTPAdapter(pool_connections=1, pool_maxsize=self.workers + 4)
+        session.mount('http://', adapter)
+        session.mount('https://', adapter)
+        w3 = Web3(Web3.HTTPProvider(self.config.ETHEREUM_RPC_URL, session=session))
+        if not w3.is_connected():
+            raise ConnectionError("Failed to connect to Ethereum network")
+        return w3
+
+    def pool_config(self, spec: PoolSpec) -> type:
+        """
+        Config class for one pool: base config + pair/fee + the spec's overrides
+
+        Args:
+            spec: Pool spec
+
+        Returns:
+            Config subclass (validate_config and friends read class attributes)
+        """
+        overrides = {
+            'TOKEN_A_ADDRESS': spec.token_a,
+            'TOKEN_B_ADDRESS': spec.token_b,
+            'FEE_TIER': spec.fee
+        }
+        for setting in PER_POOL_PATH_SETTINGS:
+            path = spec.overrides.get(setting, getattr(self.base_config, setting, ''))
+            if path:
+                overrides[setting] = path.replace('{pool}', spec.name) if '{pool}' in path else f"{path}.{spec.name}"
+        if spec.private_key_env:
+            overrides['PRIVATE_KEY'] = os.getenv(spec.private_key_env)
+        overrides.update({k: v for k, v in spec.overrides.items() if k not in PER_POOL_PATH_SETTINGS})
+        return type(f"PoolConfig_{spec.name}", (self.base_config,), overrides)
+
+    def _wallet_for(self, pool_config: type) -> _Wallet:
+        """
+        Client/executor for the pool's key
+
+        Raises:
+            ValueError: If another pool already trades from the same key (two
+                        variables may hold one key, which load_pool_specs cannot see)
+        """
+        key = pool_config.PRIVATE_KEY or ''
+        if key in self._wallets:
+            raise ValueError("another pool already trades from this wallet key; "
+                             "each pool's wallet balances are its inventory")
+        from uniswap_client import UniswapV3Client
+        from tx_executor import TransactionExecutor
+        client = UniswapV3Client(pool_config(), w3=self.w3, state_cache=self.state_cache,
+                                 fee_oracle=self.fee_oracle)
+        wallet = self._wallets[key] = _Wallet(client, TransactionExecutor(client, pool_config()))
+        return wallet
+
+    def _build_rebalancer(self, pool_config: type):
+        if self.rebalancer_factory:
+            return self.rebalancer_factory(pool_config)
+        from automated_rebalancer import AutomatedRebalancer
+        wallet = self._wallet_for(pool_config)
+        return AutomatedRebalancer(pool_config(), client=wallet.client, executor=wallet.executor,
+                                   alert_manager=self.alert_manager,
+                                   inventory_publisher=self.inventory_publisher)
+
+    def setup(self):
+        """Build shared components and one rebalancer per pool (positions initialized)"""
+        if self.rebalancer_factory is None:
+            from alert_manager import TelegramAlertManager
+            from inventory_publisher import InventoryPublisher
+            self.w3 = self.w3 or self._build_w3()
+            self.state_cache = StateCache(self.w3, self.config)
+            self.fee_oracle = FeeOracle(self.w3, self.config) if self.config.FEE_ORACLE_ENABLED else None
+            self.alert_manager = TelegramAlertManager(self.config)
+            self.inventory_publisher = InventoryPublisher(self.config)
+
+        for spec in self.pools:
+            try:
+                rebalancer = self._build_rebalancer(self.pool_config(spec))
+                if not rebalancer.validate_token_ordering(spec.token_a, spec.token_b, spec.fee):
+                    logger.error(f"[{spec.name}] token ordering validation failed; pool not started")
+                    continue
+                if not rebalancer.initialize_positions():
+                    logger.error(f"[{spec.name}] failed to initialize positions; pool not started")
+                    continue
+                slot = PoolSlot(len(self.slots), spec, rebalancer)
+                slot.pool_address = rebalancer.client.get_pool_address(spec.token_a, spec.token_b, spec.fee)
+                pool_info = rebalancer.client.get_pool_info(slot.pool_address)
+                slot.pool_token0, slot.pool_token1 = pool_info['token0'], pool_info['token1']
+                self.slots.append(slot)
+            except Exception as e:
+                logger.error(f"[{spec.name}] setup failed: {e}")
+        logger.info(f"Orchestrator hosting {len(self.slots)}/{len(self.pools)} pools "
+                    f"({len(self._wallets)} wallets, {self.workers} workers)")
+
+    def apply_base_config(self, config: type):
+        """
+        Layer every pool's overrides on a reloaded base config (ConfigStore subscriber)
+
+        Each rebalancer switches at the start of its next tick; shared
+        components keep the config they were built with.
+
+        Args:
+            config: New base config class
+        """
+        self.base_config = config
+        for slot in self.slots:
+            if hasattr(slot.rebalancer, 'apply_config'):
+                slot.rebalancer.apply_config(self.pool_config(slot.spec))
+
+    # ------------------------------------------------------------------ cycle
+
+    def _read_sqrt_prices(self) -> Dict[int, int]:
+        """Every pool's sqrtPriceX96 in one aggregate3 call"""
+        calls = [(slot.pool_address, SLOT0_CALL, SLOT0_TYPES) for slot in self.slots]
+        results = Multicall3(self.w3, self.config.MULTICALL3_ADDRESS).read(calls)
+        return {slot.index: r[0] for slot, r in zip(self.slots, results) if r is not None}
+
+    def run_cycle(self, wait: bool = False) -> int:
+        """
+        One scheduling pass
+
+        Args:
+            wait: Block until the ticks scheduled by this cycle finish (tests, shutdown)
+
+        Returns:
+            Number of ticks scheduled
+        """
+        started = time.perf_counter()
+        if self._pool is None:
+            self._pool = ThreadPoolExecutor(max_workers=self.workers, thread_name_prefix='orchestrator')
+        if self.state_cache:
+            self.state_cache.current_block()
+
+        try:
+            with metrics.span('orchestrator.price_read'):
+                sqrt_prices = self._read_sqrt_prices()
+        except Exception as e:
+            self.stats['price_read_errors'] += 1
+            logger.error(f"Batched slot0 read failed: {e}")
+            return 0
+
+        now = time.time()
+        heap: List[Tuple[float, int, PoolSlot, int]] = []
+        for slot in self.slots:
+            sqrt_price = sqrt_prices.get(slot.index)
+            if sqrt_price is None:
+                continue
+            slot.spot_price = slot.rebalancer._sqrt_price_to_spot(sqrt_price, slot.pool_token0, slot.pool_token1)
+            slot.urgency = slot.rebalancer.rebalance_urgency(slot.spot_price)
+            idle = now - slot.last_tick_at < self.idle_tick_seconds
+            if sqrt_price == slot.last_sqrt_price and idle and slot.urgency < 1.0:
+                self.stats['skipped_unchanged'] += 1
+                continue
+            heapq.heappush(heap, (-slot.urgency, slot.index, slot, sqrt_price))
+
+        # The worker queue is FIFO, so submission order is service order
+        scheduled = []
+        while heap:
+            _, _, slot, sqrt_price = heapq.heappop(heap)
+            if not slot.try_acquire():
+                self.stats['skipped_busy'] += 1
+                continue
+            scheduled.append(self._pool.submit(self._tick, slot, sqrt_price, slot.spot_price))
+
+        self.stats['cycles'] += 1
+        self.stats['scheduled'] += len(scheduled)
+        if wait:
+            for future in scheduled:
+                future.result()
+        elapsed = time.perf_counter() - started
+        metrics.record('orchestrator.cycle', int(elapsed * 1e9))
+        self.stats['last_cycle_ms'] = elapsed * 1000
+        return len(scheduled)
+
+    def _tick(self, slot: PoolSlot, sqrt_price: int, spot_price: float):
+        try:
+            slot.rebalancer.monitoring_tick(slot.spec.token_a, slot.spec.token_b, slot.spec.fee,
+                                            spot_price=spot_price)
+            slot.last_sqrt_price = sqrt_price
+            slot.ticks += 1
+        except Exception as e:
+            slot.errors += 1
+            logger.error(f"[{slot.spec.name}] monitoring tick failed: {e}")
+        finally:
+            slot.last_tick_at = time.time()
+            slot.release()
+
+    def _run_loop(self):
+        next_cycle = time.monotonic()
+        while self.is_running:
+            try:
+                self.run_cycle()
+            except Exception as e:
+                logger.error(f"Orchestrator cycle failed: {e}")
+            next_cycle += self.cycle_seconds
+            delay = next_cycle - time.monotonic()
+            if delay < 0:
+                # Cycle (price read + scheduling) took longer than the cadence
+                self.stats['overruns'] += 1
+                next_cycle = time.monotonic()
+                continue
+            time.sleep(delay)
+
+    # ------------------------------------------------------------------ lifecycle
+
+    def start(self):
+        """Set up every pool and start the scheduling loop"""
+        if self.is_running:
+            logger.warning("Orchestrator is already running")
+            return
+        if not self.slots:
+            self.setup()
+        if self.fee_oracle:
+            self.fee_oracle.start()
+        if self.config.METRICS_PORT or self.config.METRICS_SUMMARY_INTERVAL_SECONDS:
+            self.metrics_exporter = MetricsExporter(
+                metrics, port=self.config.METRICS_PORT, host=self.config.METRICS_HOST,
+                summary_interval=self.config.METRICS_SUMMARY_INTERVAL_SECONDS
+            )
+            self.metrics_exporter.start()
+        self.is_running = True
+        self._thread = threading.Thread(target=self._run_loop, name='orchestrator', daemon=True)
+        self._thread.start()
+        logger.info(f"Orchestrator started ({self.cycle_seconds}s cycle)")
+
+    def stop(self):
+        """Stop scheduling, let in-flight ticks finish and close shared components"""
+        self.is_running = False
+        if self._thread:
+            self._thread.join(timeout=self.cycle_seconds + 5)
+            self._thread = None
+        if self._pool:
+            self._pool.shutdown(wait=True)
+            self._pool = None
+        if self.fee_oracle:
+            self.fee_oracle.stop()
+        if self.metrics_exporter:
+            self.metrics_exporter.log_summary()
+            self.metrics_exporter.stop()
+            self.metrics_exporter = None
+        for component in (self.inventory_publisher, self.alert_manager):
+            if component is not None:
+                try:
+                    component.close()
+                except Exception as e:
+                    logger.warning(f"Failed to close {type(component).__name__}: {e}")
+        logger.info("Orchestrator stopped")
+
+    def get_status(self) -> Dict[str, Any]:
+        """Scheduler counters, per-pool state and RPC gateway usage"""
+        gateway = getattr(getattr(self.w3, 'provider', None), 'gateway', None)
+        return {
+            'is_running': self.is_running,
+            'pools': [{
+                'name': slot.spec.name,
+                'spot_price': slot.spot_price,
+                'urgency': slot.urgency,
+                'busy': slot.busy,
+                'ticks': slot.ticks,
+                'errors': slot.errors,
+                'last_tick_at': slot.last_tick_at
+            } for slot in self.slots],
+            **self.stats,
+            'rpc': gateway.get_status() if gateway else None,
+            'latency': metrics.summary()
+        }
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Run many pools/strategies in one process')
+    parser.add_argument('--pools', default=Config.ORCHESTRATOR_POOLS_FILE, help='Pools JSON file')
+    args = parser.parse_args()
+
+    logging.basicConfig(level=logging.INFO)
+    config_store = ConfigStore(Config)
+    orchestrator = Orchestrator(config_store.current, load_pool_specs(args.pools))
+    config_store.subscribe(orchestrator.apply_base_config)
+    config_store.install_signal_handler()
+    stopped = threading.Event()
+
+    def handle_signal(signum, frame):
+        logger.info(f"Received signal {signum}, shutting down...")
+        stopped.set()
+
+    signal.signal(signal.SIGINT, handle_signal)
+    signal.signal(signal.SIGTERM, handle_signal)
+
+    orchestrator.start()
+    config_store.start()
+    while not stopped.wait(300):
+        status = orchestrator.get_status()
+        logger.info(f"Orchestrator: {len(status['pools'])} pools, cycles={status['cycles']}, "
+                    f"overruns={status['overruns']}, last cycle {status['last_cycle_ms']:.0f}ms")
+    config_store.stop()
+    orchestrator.stop()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,415 @@
+"""
+AsymmetricLP - Differential Parity Harness
+Runs two backtest engines over every data/*.csv file and every parameter
+set encoded in the checked-in backtest_results_*.json names, diffs the
+trade and rebalance streams event by event within tolerances, and reports
+the speed ratio. Used to prove that a faster implementation of
+AMMSimulator, AsymmetricLPStrategy or the models (native or otherwise)
+reproduces the reference results.
+
+An engine is a source tree plus an engine class with the BacktestEngine
+interface (constructor takes a config, run_backtest() returns a result
+with .trades and .rebalances). Trees are '.', a directory, or 'git:<rev>'
+(extracted with git archive). Each engine runs in its own pool of spawned
+worker processes, so both trees' same-named modules never mix.
+"""
+import argparse
+import dataclasses
+import glob
+import io
+import json
+import logging
+import math
+import os
+import re
+import subprocess
+import sys
+import tarfile
+import tempfile
+import time
+from collections.abc import Sequence
+from concurrent.futures import ProcessPoolExecutor
+from dataclasses import dataclass, field
+from datetime import date, datetime
+from typing import Any, Dict, List, Optional, Tuple
+
+logger = logging.getLogger(__name__)
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_ENGINE = 'backtest_engine:BacktestEngine'
+
+# Tokens of the backtest_results_*.json names and the settings they stand for
+PARAM_PATTERNS = (
+    (re.compile(r'^glft$'), lambda m: {'INVENTORY_MODEL': 'GLFTModel'}),
+    (re.compile(r'^min(\d+)$'), lambda m: {'MIN_RANGE_PERCENTAGE': float(m.group(1))}),
+    (re.compile(r'^max(\d+)$'), lambda m: {'MAX_RANGE_PERCENTAGE': float(m.group(1))}),
+    (re.compile(r'^spread(\d+)$'), lambda m: {'BASE_SPREAD': int(m.group(1)) / 100}),
+    (re.compile(r'^thresh(\d+)$'), lambda m: {'REBALANCE_THRESHOLD': int(m.group(1)) / 100}),
+)
+NAMED_PATTERNS = (
+    (re.compile(r'^base_spread_(\d+)pct$'), lambda m: {'BASE_SPREAD': int(m.group(1)) / 100}),
+    (re.compile(r'^range_(\d+)_(\d+)$'),
+     lambda m: {'MIN_RANGE_PERCENTAGE': float(m.group(1)), 'MAX_RANGE_PERCENTAGE': float(m.group(2))}),
+)
+
+
+def parse_param_name(name: str) -> Optional[Dict[str, Any]]:
+    """
+    Config overrides encoded in a results file name
+
+    Args:
+        name: e.g. 'glft_min10_max50_spread20_thresh25' (without prefix/extension)
+
+    Returns:
+        Overrides, or None if the name is not understood
+    """
+    for pattern, build in NAMED_PATTERNS:
+        match = pattern.match(name)
+        if match:
+            return build(match)
+    overrides = {}
+    for token in name.split('_'):
+        for pattern, build in PARAM_PATTERNS:
+            match = pattern.match(token)
+            if match:
+                overrides.update(build(match))
+                break
+        else:
+            return None
+    return overrides
+
+
+def discover_param_sets(directory: str = HERE) -> Dict[str, Dict[str, Any]]:
+    """Parameter sets from the backtest_results_*.json names in a directory"""
+    param_sets = {}
+    for path in sorted(glob.glob(os.path.join(directory, 'backtest_results_*.json'))):
+        name = os.path.basename(path)[len('backtest_results_'):-len('.json')]
+        overrides = parse_param_name(name)
+        if overrides is None:
+            logger.warning(f"Skipping {os.path.basename(path)}: parameters not encoded in the name")
+            continue
+        param_sets[name] = overrides
+    return param_sets
+
+
+def extract_tree(spec: str, workdir: str) -> str:
+    """
+    Source directory for an engine tree spec
+
+    Args:
+        spec: '.', a directory, or 'git:<rev>'
+        workdir: Where git revisions are extracted
+
+    Returns:
+        Directory containing the engine modules
+    """
+    if not spec.startswith('git:'):
+        return os.path.abspath(HERE if spec == '.' else spec)
+    rev = spec[len('git:'):]
+    top = subprocess.run(['git', 'rev-parse', '--show-toplevel'], cwd=HERE, check=True,
+                         capture_output=True, text=True).stdout.strip()
+    prefix = os.path.relpath(HERE, top)
+    archive = subprocess.run(['git', 'archive', '--format=tar', rev, '--', prefix], cwd=top, check=True,
+                             capture_output=True).stdout
+    target = os.path.join(workdir, re.sub(r'[^\w.-]', '_', rev))
+    with tarfile.open(fileobj=io.BytesIO(archive)) as tar:
+        tar.extractall(target)
+    return os.path.join(target, prefix)
+
+
+# ---------------------------------------------------------------- worker side
+
+def _init_worker(root: str):
+    sys.path.insert(0, root)
+    logging.disable(logging.INFO)
+
+
+def _plain(value: Any) -> Any:
+    """Result objects to comparable, picklable JSON-like values"""
+    if dataclasses.is_dataclass(value) and not isinstance(value, type):
+        return {k: _plain(v) for k, v in dataclasses.asdict(value).items()}
+    if isinstance(value, dict):
+        return {str(k): _plain(v) for k, v in value.items()}
+    if isinstance(value, Sequence) and not isinstance(value, (str, bytes)):
+        return [_plain(v) for v in value]
+    if isinstance(value, (datetime, date)) or hasattr(value, 'isoformat'):
+        return value.isoformat()
+    if isinstance(value, (bool, str, int)) or value is None:
+        return value
+    if hasattr(value, 'item'):  # numpy scalars
+        return value.item()
+    if isinstance(value, float):
+        return value
+    return str(value)
+
+
+def run_engine(engine: str, csv_path: str, overrides: Dict[str, Any],
+               balance0: float, balance1: float) -> Dict[str, Any]:
+    """
+    One backtest in a worker process
+
+    Returns:
+        {'trades', 'rebalances', 'final', 'seconds'} as plain values
+    """
+    import importlib
+    from config import Config
+
+    module_name, attr = engine.split(':')
+    engine_class = getattr(importlib.import_module(module_name), attr)
+    config = type('ParityConfig', (Config,), dict(overrides))()
+    started = time.perf_counter()
+    result = engine_class(config).run_backtest(csv_path, balance0, balance1)
+    seconds = time.perf_counter() - started
+    return {
+        'trades': _plain(result.trades),
+        'rebalances': _plain(result.rebalances),
+        'final': [float(result.final_balance_0), float(result.final_balance_1)],
+        'seconds': seconds
+    }
+
+
+# ---------------------------------------------------------------- diffing
+
+@dataclass
+class Mismatch:
+    """First difference between two event streams"""
+    stream: str
+    index: int
+    path: str
+    reference: Any
+    candidate: Any
+
+    def __str__(self):
+        return f"{self.stream}[{self.index}]{self.path}: {self.reference!r} != {self.candidate!r}"
+
+
+def _diff(reference: Any, candidate: Any, rtol: float, atol: float, path: str = '') -> Tuple[Optional[str], float]:
+    """First differing path under reference/candidate and the largest relative float error seen"""
+    if isinstance(reference, bool) or isinstance(candidate, bool) or \
+            not isinstance(reference, (int, float)) or not isinstance(candidate, (int, float)):
+        if isinstance(reference, dict) and isinstance(candidate, dict):
+            worst = 0.0
+            for key in sorted(set(reference) | set(candidate)):
+                if key not in reference or key not in candidate:
+                    return f"{path}.{key}", worst
+                where, error = _diff(reference[key], candidate[key], rtol, atol, f"{path}.{key}")
+                worst = max(worst, error)
+                if where is not None:
+                    return where, worst
+            return None, worst
+        if isinstance(reference, list) and isinstance(candidate, list):
+            if len(reference) != len(candidate):
+                return f"{path}.len", 0.0
+            worst = 0.0
+            for i, (a, b) in enumerate(zip(reference, candidate)):
+                where, error = _diff(a, b, rtol, atol, f"{path}[{i}]")
+                worst = max(worst, error)
+                if where is not None:
+                    return where, worst
+            return None, worst
+        return (None if reference == candidate else path), 0.0
+    if math.isnan(reference) and math.isnan(candidate):
+        return None, 0.0
+    error = abs(reference - candidate) / max(abs(reference), abs(candidate), 1e-300) if reference != candidate else 0.0
+    return (None if math.isclose(reference, candidate, rel_tol=rtol, abs_tol=atol) else path), error
+
+
+def _lookup(event: Any, path: str) -> Any:
+    for part in re.findall(r'\.([^.\[]+)|\[(\d+)\]', path):
+        key, index = part
+        try:
+            event = event[key] if key else event[int(index)]
+        except (KeyError, IndexError, TypeError):
+            return None
+    return event
+
+
+def diff_streams(stream: str, reference: List[Any], candidate: List[Any],
+                 rtol: float, atol: float) -> Tuple[Optional[Mismatch], float]:
+    """
+    Compare two event streams in order
+
+    Returns:
+        (first mismatch or None, max relative float error over the compared events)
+    """
+    worst = 0.0
+    for index, (a, b) in enumerate(zip(reference, candidate)):
+        where, error = _diff(a, b, rtol, atol)
+        worst = max(worst, error)
+        if where is not None:
+            return Mismatch(stream, index, where, _lookup(a, where), _lookup(b, where)), worst
+    if len(reference) != len(candidate):
+        index = min(len(reference), len(candidate))
+        return Mismatch(stream, index, '', f"{len(reference)} events", f"{len(candidate)} events"), worst
+    return None, worst
+
+
+@dataclass
+class ParityResult:
+    """Outcome of one (data file, parameter set) cell of the matrix"""
+    data_file: str
+    param_set: str
+    trades: int = 0
+    rebalances: int = 0
+    reference_seconds: float = 0.0
+    candidate_seconds: float = 0.0
+    max_rel_error: float = 0.0
+    mismatch: Optional[str] = None
+    error: Optional[str] = None
+
+    @property
+    def ok(self) -> bool:
+        return self.mismatch is None and self.error is None
+
+    @property
+    def speedup(self) -> float:
+        return self.reference_seconds / self.candidate_seconds if self.candidate_seconds else 0.0
+
+
+def compare_runs(result: ParityResult, reference: Dict[str, Any], candidate: Dict[str, Any],
+                 rtol: float, atol: float) -> ParityResult:
+    """Fill a ParityResult from the two engines' outputs"""
+    result.trades = len(reference['trades'])
+    result.rebalances = len(reference['rebalances'])
+    result.reference_seconds = reference['seconds']
+    result.candidate_seconds = candidate['seconds']
+    for stream in ('trades', 'rebalances', 'final'):
+        mismatch, error = diff_streams(stream, reference[stream], candidate[stream], rtol, atol)
+        result.max_rel_error = max(result.max_rel_error, error)
+        if mismatch is not None:
+            result.mismatch = str(mismatch)
+            break
+    return result
+
+
+# ---------------------------------------------------------------- driver
+
+@dataclass
+class ParityReport:
+    results: List[ParityResult] = field(default_factory=list)
+    elapsed_seconds: float = 0.0
+
+    @property
+    def ok(self) -> bool:
+        return all(r.ok for r in self.results)
+
+    @property
+    def speedup(self) -> float:
+        """Total reference time over total candidate time"""
+        candidate = sum(r.candidate_seconds for r in self.results)
+        return sum(r.reference_seconds for r in self.results) / candidate if candidate else 0.0
+
+    def to_dict(self) -> Dict[str, Any]:
+        return {
+            'ok': self.ok,
+            'cells': len(self.results),
+            'failed': sum(not r.ok for r in self.results),
+            'speedup': self.speedup,
+            'elapsed_seconds': self.elapsed_seconds,
+            'results': [dict(dataclasses.asdict(r), ok=r.ok, speedup=r.speedup) for r in self.results]
+        }
+
+    def format_table(self) -> str:
+        lines = [f"{'data':<40} {'params':<34} {'trades':>6} {'rebal':>5} {'ref s':>7} {'cand s':>7} "
+                 f"{'ratio':>6}  result"]
+        for r in self.results:
+            status = 'ok' if r.ok else f"DIFF {r.mismatch}" if r.mismatch else f"ERROR {r.error}"
+            lines.append(f"{r.data_file:<40} {r.param_set:<34} {r.trades:>6} {r.rebalances:>5} "
+                         f"{r.reference_seconds:>7.3f} {r.candidate_seconds:>7.3f} {r.speedup:>6.2f}  {status}")
+        failed = sum(not r.ok for r in self.results)
+        lines.append(f"{len(self.results) - failed}/{len(self.results)} cells match; "
+                     f"candidate speed ratio {self.speedup:.2f}x; wall {self.elapsed_seconds:.1f}s")
+        return '\n'.join(lines)
+
+
+def run_matrix(data_files: List[str], param_sets: Dict[str, Dict[str, Any]],
+               reference_root: str, candidate_root: str,
+               reference_engine: str = DEFAULT_ENGINE, candidate_engine: str = DEFAULT_ENGINE,
+               balances: Tuple[float, float] = (3000.0, 1.0), workers: Optional[int] = None,
+               rtol: float = 1e-9, atol: float = 1e-9) -> ParityReport:
+    """
+    Run both engines over data_files x param_sets and diff every cell
+
+    Args:
+        data_files: OHLC CSV paths
+        param_sets: Config overrides by parameter-set name
+        reference_root: Source directory of the reference engine
+        candidate_root: Source directory of the candidate engine
+        reference_engine: 'module:Class' of the reference engine
+        candidate_engine: 'module:Class' of the candidate engine
+        balances: Initial token0/token1 balances
+        workers: Processes per engine (default: half the CPUs, at least 1)
+        rtol: Relative float tolerance
+        atol: Absolute float tolerance
+
+    Returns:
+        ParityReport
+    """
+    import multiprocessing
+
+    workers = workers or max(1, (os.cpu_count() or 2) // 2)
+    context = multiprocessing.get_context('spawn')
+    cells = [(os.path.abspath(path), name) for path in data_files for name in param_sets]
+    started = time.perf_counter()
+    report = ParityReport()
+    with ProcessPoolExecutor(workers, mp_context=context, initializer=_init_worker,
+                             initargs=(reference_root,)) as reference_pool, \
+            ProcessPoolExecutor(workers, mp_context=context, initializer=_init_worker,
+                                initargs=(candidate_root,)) as candidate_pool:
+        futures = [(path, name,
+                    reference_pool.submit(run_engine, reference_engine, path, param_sets[name], *balances),
+                    candidate_pool.submit(run_engine, candidate_engine, path, param_sets[name], *balances))
+                   for path, name in cells]
+        for path, name, reference, candidate in futures:
+            result = ParityResult(os.path.basename(path), name)
+            try:
+                compare_runs(result, reference.result(), candidate.result(), rtol, atol)
+            except Exception as e:
+                result.error = f"{type(e).__name__}: {e}"
+            report.results.append(result)
+    report.elapsed_seconds = time.perf_counter() - started
+    return report
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Diff two backtest engines over every data file and parameter set')
+    parser.add_argument('--reference', default='git:HEAD', help="Reference tree: '.', a directory or git:<rev>")
+    parser.add_argument('--candidate', default='.', help="Candidate tree: '.', a directory or git:<rev>")
+    parser.add_argument('--reference-engine', default=DEFAULT_ENGINE, help='module:Class in the reference tree')
+    parser.add_argument('--candidate-engine', default=DEFAULT_ENGINE, help='module:Class in the candidate tree')
+    parser.add_argument('--data', nargs='*', help='OHLC CSV files (default: data/*.csv)')
+    parser.add_argument('--params', nargs='*', help='Parameter-set names (default: all backtest_results_*.json)')
+    parser.add_argument('--balance0', type=float, default=3000.0, help='Initial token0 balance')
+    parser.add_argument('--balance1', type=float, default=1.0, help='Initial token1 balance')
+    parser.add_argument('--workers', type=int, help='Processes per engine')
+    parser.add_argument('--rtol', type=float, default=1e-9, help='Relative float tolerance')
+    parser.add_argument('--atol', type=float, default=1e-9, help='Absolute float tolerance')
+    parser.add_argument('--json', help='Write the full report as JSON')
+    args = parser.parse_args()
+
+    logging.basicConfig(level=logging.WARNING)
+    param_sets = discover_param_sets()
+    if args.params:
+        param_sets = {name: param_sets[name] if name in param_sets else parse_param_name(name)
+                      for name in args.params}
+        unknown = [name for name, overrides in param_sets.items() if overrides is None]
+        if unknown:
+            parser.error(f"Cannot parse parameter sets: {', '.join(unknown)}")
+    data_files = args.data or sorted(glob.glob(os.path.join(HERE, 'data', '*.csv')))
+
+    with tempfile.TemporaryDirectory(prefix='parity_') as workdir:
+        report = run_matrix(
+            data_files, param_sets,
+            extract_tree(args.reference, workdir), extract_tree(args.candidate, workdir),
+            args.reference_engine, args.candidate_engine, (args.balance0, args.balance1),
+            args.workers, args.rtol, args.atol
+        )
+    print(report.format_table())
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump(report.to_dict(), f, indent=2)
+    return 0 if report.ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
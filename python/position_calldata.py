@@ -0,0 +1,184 @@
+"""
+AsymmetricLP - Position Manager Calldata Encoder
+Native ABI encoding for NonfungiblePositionManager calls, so a full
+burn-and-remint rebalance can be packed into a single multicall(bytes[])
+without round-tripping through web3 contract objects.
+"""
+from typing import List, Tuple
+from eth_abi import encode
+from eth_utils import keccak, to_checksum_address
+
+# Max value for uint128 amounts (collect everything owed to the position)
+MAX_UINT128 = 2 ** 128 - 1
+
+# Canonical signatures. The position manager takes its params as structs,
+# so the selectors are computed over the tuple form.
+DECREASE_LIQUIDITY_SIGNATURE = 'decreaseLiquidity((uint256,uint128,uint256,uint256,uint256))'
+COLLECT_SIGNATURE = 'collect((uint256,address,uint128,uint128))'
+BURN_SIGNATURE = 'burn(uint256)'
+MINT_SIGNATURE = ('mint((address,address,uint24,int24,int24,uint256,uint256,'
+                  'uint256,uint256,address,uint256))')
+MULTICALL_SIGNATURE = 'multicall(bytes[])'
+
+
+def function_selector(signature: str) -> bytes:
+    """
+    Compute the 4-byte function selector for a canonical signature
+
+    Args:
+        signature: Canonical function signature, e.g. 'burn(uint256)'
+
+    Returns:
+        4-byte selector
+    """
+    return keccak(text=signature)[:4]
+
+
+DECREASE_LIQUIDITY_SELECTOR = function_selector(DECREASE_LIQUIDITY_SIGNATURE)  # 0x0c49ccbe
+COLLECT_SELECTOR = function_selector(COLLECT_SIGNATURE)  # 0xfc6f7865
+BURN_SELECTOR = function_selector(BURN_SIGNATURE)  # 0x42966c68
+MINT_SELECTOR = function_selector(MINT_SIGNATURE)  # 0x88316456
+MULTICALL_SELECTOR = function_selector(MULTICALL_SIGNATURE)  # 0xac9650d8
+
+
+def encode_decrease_liquidity(token_id: int, liquidity: int, amount0_min: int,
+                              amount1_min: int, deadline: int) -> bytes:
+    """
+    Encode decreaseLiquidity calldata
+
+    Args:
+        token_id: NFT token ID of the position
+        liquidity: Amount of liquidity to remove
+        amount0_min: Minimum amount of token0 to receive
+        amount1_min: Minimum amount of token1 to receive
+        deadline: Transaction deadline (timestamp)
+
+    Returns:
+        Calldata bytes
+    """
+    return DECREASE_LIQUIDITY_SELECTOR + encode(
+        ['(uint256,uint128,uint256,uint256,uint256)'],
+        [(token_id, liquidity, amount0_min, amount1_min, deadline)]
+    )
+
+
+def encode_collect(token_id: int, recipient: str, amount0_max: int = MAX_UINT128,
+                   amount1_max: int = MAX_UINT128) -> bytes:
+    """
+    Encode collect calldata (defaults collect everything owed)
+
+    Args:
+        token_id: NFT token ID of the position
+        recipient: Address receiving the tokens
+        amount0_max: Maximum amount of token0 to collect
+        amount1_max: Maximum amount of token1 to collect
+
+    Returns:
+        Calldata bytes
+    """
+    return COLLECT_SELECTOR + encode(
+        ['(uint256,address,uint128,uint128)'],
+        [(token_id, to_checksum_address(recipient), amount0_max, amount1_max)]
+    )
+
+
+def encode_burn(token_id: int) -> bytes:
+    """
+    Encode burn calldata
+
+    Args:
+        token_id: NFT token ID of the position (must hold no liquidity or owed tokens)
+
+    Returns:
+        Calldata bytes
+    """
+    return BURN_SELECTOR + encode(['uint256'], [token_id])
+
+
+def encode_mint(token0: str, token1: str, fee: int, tick_lower: int, tick_upper: int,
+                amount0_desired: int, amount1_desired: int, amount0_min: int,
+                amount1_min: int, recipient: str, deadline: int) -> bytes:
+    """
+    Encode mint calldata
+
+    Args:
+        token0: Address of token0
+        token1: Address of token1
+        fee: Fee tier (500, 3000, or 10000)
+        tick_lower: Lower tick bound
+        tick_upper: Upper tick bound
+        amount0_desired: Desired amount of token0
+        amount1_desired: Desired amount of token1
+        amount0_min: Minimum amount of token0 to add
+        amount1_min: Minimum amount of token1 to add
+        recipient: Address receiving the position NFT
+        deadline: Transaction deadline (timestamp)
+
+    Returns:
+        Calldata bytes
+    """
+    return MINT_SELECTOR + encode(
+        ['(address,address,uint24,int24,int24,uint256,uint256,uint256,uint256,address,uint256)'],
+        [(to_checksum_address(token0), to_checksum_address(token1), fee, tick_lower, tick_upper,
+          amount0_desired, amount1_desired, amount0_min, amount1_min,
+          to_checksum_address(recipient), deadline)]
+    )
+
+
+def encode_multicall(calls: List[bytes]) -> bytes:
+    """
+    Wrap several position-manager calls into one multicall(bytes[])
+
+    Args:
+        calls: Individual calldata payloads, executed in order
+
+    Returns:
+        Calldata bytes
+    """
+    return MULTICALL_SELECTOR + encode(['bytes[]'], [list(calls)])
+
+
+def build_unwind_calls(token_id: int, liquidity: int, recipient: str, deadline: int) -> List[bytes]:
+    """
+    Build decreaseLiquidity -> collect -> burn calls for one position
+
+    Collect uses MAX_UINT128 so both the withdrawn principal and the fees are
+    transferred before the NFT is burned.
+
+    Args:
+        token_id: NFT token ID of the position
+        liquidity: Position liquidity to remove
+        recipient: Address receiving the tokens
+        deadline: Transaction deadline (timestamp)
+
+    Returns:
+        List of calldata payloads (decreaseLiquidity is skipped for empty positions)
+    """
+    calls = []
+    if liquidity > 0:
+        calls.append(encode_decrease_liquidity(token_id, liquidity, 0, 0, deadline))
+    calls.append(encode_collect(token_id, recipient))
+    calls.append(encode_burn(token_id))
+    return calls
+
+
+def build_rebalance_multicall(unwinds: List[Tuple[int, int]], mints: List[dict],
+                              recipient: str, deadline: int) -> bytes:
+    """
+    Build a single multicall that burns existing positions and mints new ones
+
+    Args:
+        unwinds: (token_id, liquidity) for each position to close
+        mints: Keyword arguments for encode_mint (without recipient/deadline)
+        recipient: Wallet receiving collected tokens and new position NFTs
+        deadline: Transaction deadline (timestamp)
+
+    Returns:
+        multicall(bytes[]) calldata bytes
+    """
+    calls: List[bytes] = []
+    for token_id, liquidity in unwinds:
+        calls.extend(build_unwind_calls(token_id, liquidity, recipient, deadline))
+    for mint in mints:
+        calls.append(encode_mint(recipient=recipient, deadline=deadline, **mint))
+    return encode_multicall(calls)
@@ -0,0 +1,219 @@
+"""
+AsymmetricLP - Pre-flight Transaction Simulation
+Runs the exact position-manager calldata through eth_call before anything is
+signed (on a local fork when PREFLIGHT_RPC_URL points at one, otherwise on the
+live node). A fork is rolled to the live head before each plan, because an
+anvil fork otherwise stays at the block it was started from. A plan that would revert is rejected without spending gas; a plan
+that succeeds gets its mint amounts quoted, and the quotes become the
+amount0Min/amount1Min slippage bounds of the transaction actually sent.
+"""
+import logging
+import time
+from dataclasses import dataclass, field
+from typing import Any, Dict, List, Optional, Sequence
+from eth_abi import decode
+from config import Config
+from latency_metrics import metrics
+from position_calldata import encode_mint, encode_multicall
+from rpc_gateway import RpcUnavailable
+from rpc_transport import TransportError
+
+logger = logging.getLogger(__name__)
+
+ERROR_SELECTOR = bytes.fromhex('08c379a0')  # Error(string)
+PANIC_SELECTOR = bytes.fromhex('4e487b71')  # Panic(uint256)
+
+MINT_RETURNS = ['uint256', 'uint128', 'uint256', 'uint256']  # tokenId, liquidity, amount0, amount1
+
+
+class PreflightRejected(Exception):
+    """The simulated transaction reverted"""
+
+    def __init__(self, reason: str):
+        self.reason = reason
+        super().__init__(reason)
+
+
+def decode_revert_reason(data: Any) -> Optional[str]:
+    """
+    Human-readable reason from revert data (Error(string) or Panic(uint256))
+
+    Args:
+        data: Revert data as bytes or 0x-hex
+
+    Returns:
+        Reason, or None if the data is empty or a custom error
+    """
+    if isinstance(data, str):
+        data = bytes.fromhex(data[2:] if data.startswith('0x') else data) if data else b''
+    if not data or len(data) < 4:
+        return None
+    try:
+        if data[:4] == ERROR_SELECTOR:
+            return decode(['string'], data[4:])[0]
+        if data[:4] == PANIC_SELECTOR:
+            return f"panic 0x{decode(['uint256'], data[4:])[0]:02x}"
+    except Exception:
+        return None
+    return None
+
+
+@dataclass
+class MintQuote:
+    """What one simulated mint returned"""
+    token_id: int
+    liquidity: int
+    amount0: int
+    amount1: int
+
+
+@dataclass
+class PreflightResult:
+    """Outcome of simulating a plan"""
+    ok: bool
+    mints: List[Dict[str, Any]] = field(default_factory=list)  # with amount0_min/amount1_min filled in
+    quotes: List[MintQuote] = field(default_factory=list)
+    reason: Optional[str] = None
+    skipped: bool = False  # simulation node unreachable; mints go out unbounded as before
+    elapsed_ms: float = 0.0
+
+
+class PreflightSimulator:
+    """
+    eth_call simulation of mint plans.
+
+    The whole plan (unwind calls + mints) is one position-manager
+    multicall(bytes[]), which delegatecalls, so msg.sender stays the wallet and
+    the simulation sees the same approvals, balances and unwind proceeds the
+    real transaction will. One round trip per rebalance.
+    """
+
+    def __init__(self, client, config: Config = None, w3=None):
+        """
+        Initialize the simulator
+
+        Args:
+            client: UniswapV3Client (wallet address, live Web3)
+            config: Configuration object
+            w3: Web3 to simulate on (a local fork at PREFLIGHT_RPC_URL, else the client's)
+        """
+        self.client = client
+        self.config = config or client.config
+        self.slippage_bps = self.config.PREFLIGHT_SLIPPAGE_BPS
+        if w3 is None and self.config.PREFLIGHT_RPC_URL:
+            from web3 import Web3
+            from rpc_transport import TransportProvider
+
+            # The fork is local: talk to it directly rather than through the shared quota
+            w3 = Web3(TransportProvider(self.config.PREFLIGHT_RPC_URL, config=self.config))
+        self.w3 = w3 or client.w3
+
+    def sync_fork(self):
+        """
+        Web3 to simulate the next plan on: the fork, rolled to the live head
+
+        The fork is rolled with anvil_rollFork whenever its head is behind the
+        live one (StateCache.current_block()). If it cannot be rolled (not anvil,
+        or the roll did not take), the plan is simulated on the live node rather
+        than against stale prices, balances and positions.
+        """
+        if self.w3 is self.client.w3:
+            return self.w3
+        state_cache = getattr(self.client, 'state_cache', None)
+        live = state_cache.current_block() if state_cache is not None else int(self.client.w3.eth.block_number)
+        try:
+            if int(self.w3.eth.block_number) >= live:
+                return self.w3
+            response = self.w3.provider.make_request('anvil_rollFork', [live])
+            if isinstance(response, dict) and response.get('error'):
+                raise RuntimeError(response['error'])
+            if int(self.w3.eth.block_number) >= live:
+                return self.w3
+        except Exception as e:
+            logger.warning(f"Could not roll the pre-flight fork to block {live}: {e}")
+        logger.warning(f"Pre-flight fork lags block {live}; simulating on the live node")
+        return self.client.w3
+
+    def simulate(self, data: bytes, to: Optional[str] = None, value: int = 0, w3=None) -> bytes:
+        """
+        eth_call calldata from the wallet
+
+        Args:
+            data: Calldata
+            to: Target (defaults to the position manager)
+            value: ETH value
+            w3: Web3 to call on (defaults to the simulation node)
+
+        Returns:
+            Return data
+
+        Raises:
+            PreflightRejected: If the call reverts
+            TransportError, RpcUnavailable, ConnectionError, TimeoutError: If the node
+                could not be asked (and any other error that is not a revert)
+        """
+        tx = {
+            'from': self.client.wallet_address,
+            'to': to or self.config.UNISWAP_V3_POSITION_MANAGER,
+            'data': '0x' + data.hex(),
+            'value': value
+        }
+        try:
+            return bytes((w3 or self.w3).eth.call(tx, 'latest'))
+        except (TransportError, RpcUnavailable, ConnectionError, TimeoutError):
+            raise
+        except Exception as e:
+            # Only a revert means the plan is bad: it carries revert data (web3's
+            # ContractLogicError, an RpcError with data) or says so plainly
+            data = getattr(e, 'data', None)
+            if data is None and 'revert' not in str(e).lower():
+                raise
+            reason = decode_revert_reason(data) or str(e)
+            raise PreflightRejected(reason) from e
+
+    def min_amount(self, quoted: int) -> int:
+        """Slippage floor for a quoted amount"""
+        return quoted * (10_000 - self.slippage_bps) // 10_000
+
+    def plan_mints(self, mints: Sequence[Dict[str, Any]], recipient: str, deadline: int,
+                   prefix_calls: Sequence[bytes] = ()) -> PreflightResult:
+        """
+        Simulate mints (after any prefix calls) and bound them by what they would add
+
+        Args:
+            mints: Keyword arguments for encode_mint (without recipient/deadline)
+            recipient: Position owner
+            deadline: Transaction deadline
+            prefix_calls: Position-manager calls that run first in the same transaction
+
+        Returns:
+            PreflightResult; ok=False with a reason if the plan would revert
+        """
+        started = time.perf_counter()
+        calls = list(prefix_calls) + [encode_mint(recipient=recipient, deadline=deadline, **m) for m in mints]
+        result = PreflightResult(ok=True, mints=[dict(m) for m in mints])
+        try:
+            with metrics.span('rebalance.preflight'):
+                (returns,) = decode(['bytes[]'], self.simulate(encode_multicall(calls), w3=self.sync_fork()))
+        except PreflightRejected as e:
+            result.ok, result.reason = False, e.reason
+        except Exception as e:
+            logger.warning(f"Pre-flight simulation unavailable ({e}); sending without slippage bounds")
+            result.skipped = True
+        else:
+            for mint, raw in zip(result.mints, returns[len(prefix_calls):]):
+                quote = MintQuote(*decode(MINT_RETURNS, bytes(raw)))
+                if quote.liquidity == 0:
+                    result.ok, result.reason = False, 'mint would add zero liquidity'
+                    break
+                result.quotes.append(quote)
+                mint['amount0_min'] = max(mint.get('amount0_min', 0), self.min_amount(quote.amount0))
+                mint['amount1_min'] = max(mint.get('amount1_min', 0), self.min_amount(quote.amount1))
+        result.elapsed_ms = (time.perf_counter() - started) * 1000
+
+        if result.ok and not result.skipped:
+            logger.info(f"Pre-flight ok in {result.elapsed_ms:.1f}ms: " + ', '.join(
+                f"{q.amount0}/{q.amount1} (L={q.liquidity})" for q in result.quotes))
+        elif not result.ok:
+            logger.error(f"Pre-flight rejected plan in {result.elapsed_ms:.1f}ms: {result.reason}")
+        return result
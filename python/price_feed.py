@@ -0,0 +1,358 @@
+"""
+AsymmetricLP - Event-Driven Pool Price Feed
+Websocket subscription to newHeads and the pool's Swap logs. Keeps an
+in-memory pool state (sqrtPrice, tick, liquidity) and notifies the
+rebalancer only when that state actually changes. A reorged-out Swap log
+rolls the state back; when no earlier state is known (or a reconnect gap is
+too long to replay) the state is re-read from slot0.
+"""
+import asyncio
+import itertools
+import json
+import logging
+import threading
+from collections import deque
+from dataclasses import dataclass
+from typing import Dict, Any, Optional, Callable, List
+import websockets
+from eth_abi import decode
+from config import Config
+from multicall3 import encode_call
+
+logger = logging.getLogger(__name__)
+
+# keccak('Swap(address,address,int256,int256,uint160,uint128,int24)')
+SWAP_TOPIC = '0xc42079f94a6350d7e6235f29174924f928cc2ac818eb64fed8004e115fbcca67'
+
+SLOT0_CALL = '0x' + encode_call('slot0()').hex()
+LIQUIDITY_CALL = '0x' + encode_call('liquidity()').hex()
+SLOT0_TYPES = ['uint160', 'int24', 'uint16', 'uint16', 'uint16', 'uint8', 'bool']
+
+# Applied states kept to roll back a reorg without re-reading slot0
+REORG_HISTORY = 256
+# Log index of a state read at the end of a block (after all of its logs)
+END_OF_BLOCK = 2 ** 31
+
+
+@dataclass(frozen=True)
+class PoolState:
+    """Pool state as of a specific log (or seed read)"""
+    block_number: int
+    log_index: int
+    sqrt_price_x96: int
+    tick: int
+    liquidity: int
+
+    def same_price_state(self, other: Optional['PoolState']) -> bool:
+        """Whether two states describe the same pool price and liquidity"""
+        return other is not None and (self.sqrt_price_x96, self.tick, self.liquidity) == \
+            (other.sqrt_price_x96, other.tick, other.liquidity)
+
+
+def _hex_to_int(value) -> int:
+    return int(value, 16) if isinstance(value, str) else int(value)
+
+
+def decode_swap_log(log: Dict[str, Any]) -> PoolState:
+    """
+    Decode a Uniswap V3 Swap log into a pool state
+
+    Args:
+        log: JSON-RPC log object
+
+    Returns:
+        PoolState after the swap
+    """
+    data = log['data']
+    raw = bytes.fromhex(data[2:] if data.startswith('0x') else data)
+    _, _, sqrt_price_x96, liquidity, tick = decode(
+        ['int256', 'int256', 'uint160', 'uint128', 'int24'], raw
+    )
+    return PoolState(
+        block_number=_hex_to_int(log['blockNumber']),
+        log_index=_hex_to_int(log['logIndex']),
+        sqrt_price_x96=sqrt_price_x96,
+        tick=tick,
+        liquidity=liquidity
+    )
+
+
+class PoolPriceFeed:
+    """
+    Websocket newHeads + Swap log subscriber for a single pool.
+
+    Runs its own asyncio loop in a background thread. On disconnect it
+    reconnects with exponential backoff, resubscribes, and backfills any
+    Swap logs missed since the last processed block via eth_getLogs (or
+    re-reads slot0 if more than PRICE_FEED_BACKFILL_MAX_BLOCKS were missed).
+    A log delivered with removed=true rolls the state back to the last one
+    below its block; the replacement chain's logs then apply as usual.
+    """
+
+    def __init__(self, ws_url: str, pool_address: str,
+                 on_state_change: Callable[[PoolState], None],
+                 on_new_head: Optional[Callable[[Dict[str, Any]], None]] = None,
+                 initial_state: Optional[PoolState] = None,
+                 config: Config = None):
+        """
+        Initialize the price feed
+
+        Args:
+            ws_url: Websocket JSON-RPC endpoint
+            pool_address: Pool contract address
+            on_state_change: Called with the new PoolState whenever price/tick/liquidity change
+            on_new_head: Optional callback for each new block header (e.g. the fee oracle)
+            initial_state: Seed state (e.g. from slot0/liquidity reads)
+            config: Configuration object
+        """
+        self.ws_url = ws_url
+        self.pool_address = pool_address.lower()
+        self.on_state_change = on_state_change
+        self.on_new_head = on_new_head
+        self.config = config or Config()
+        self.max_backoff = self.config.PRICE_FEED_MAX_BACKOFF_SECONDS
+        self.backfill_max_blocks = self.config.PRICE_FEED_BACKFILL_MAX_BLOCKS
+
+        self.state: Optional[PoolState] = initial_state
+        self.head_block: Optional[int] = None
+        self.last_block: Optional[int] = initial_state.block_number if initial_state else None
+        self._history: deque = deque([initial_state] if initial_state else [], maxlen=REORG_HISTORY)
+        self._resync_task: Optional[asyncio.Future] = None
+
+        self.stats = {'connects': 0, 'swaps': 0, 'state_changes': 0, 'backfilled': 0, 'heads': 0,
+                      'reorgs': 0, 'resyncs': 0}
+
+        self._ids = itertools.count(1)
+        self._pending: Dict[int, asyncio.Future] = {}
+        self._subscriptions: Dict[str, str] = {}
+        self._loop: Optional[asyncio.AbstractEventLoop] = None
+        self._thread: Optional[threading.Thread] = None
+        self._stop: Optional[asyncio.Event] = None
+        self._ws = None
+        self.connected = threading.Event()
+
+    # ------------------------------------------------------------------ lifecycle
+
+    def start(self):
+        """Start the feed in a background thread"""
+        if self._thread and self._thread.is_alive():
+            return
+        self._loop = asyncio.new_event_loop()
+        self._thread = threading.Thread(target=self._run_loop, name='price-feed', daemon=True)
+        self._thread.start()
+        logger.info(f"Price feed started for pool {self.pool_address} via {self.ws_url}")
+
+    def stop(self, timeout: float = 5.0):
+        """Stop the feed and close the websocket"""
+        if not self._loop or not self._thread:
+            return
+        if self._stop is not None:
+            self._loop.call_soon_threadsafe(self._stop.set)
+        self._thread.join(timeout=timeout)
+        self._thread = None
+        logger.info("Price feed stopped")
+
+    def _run_loop(self):
+        asyncio.set_event_loop(self._loop)
+        try:
+            self._loop.run_until_complete(self._run())
+        finally:
+            self._loop.close()
+
+    async def _run(self):
+        """Connect, subscribe and consume until stopped, reconnecting on failure"""
+        self._stop = asyncio.Event()
+        backoff = 0.5
+        while not self._stop.is_set():
+            try:
+                async with websockets.connect(self.ws_url) as ws:
+                    self._ws = ws
+                    self.stats['connects'] += 1
+                    backoff = 0.5
+                    await self._session(ws)
+            except Exception as e:
+                if self._stop.is_set():
+                    break
+                logger.warning(f"Price feed connection lost ({e}); reconnecting in {backoff:.1f}s")
+            finally:
+                self._ws = None
+                self.connected.clear()
+                for future in self._pending.values():
+                    if not future.done():
+                        future.cancel()
+                self._pending.clear()
+                self._subscriptions.clear()
+            if self._stop.is_set():
+                break
+            try:
+                await asyncio.wait_for(self._stop.wait(), timeout=backoff)
+            except asyncio.TimeoutError:
+                pass
+            backoff = min(backoff * 2, self.max_backoff)
+
+    async def _session(self, ws):
+        """One connection: subscribe, backfill the gap, then process notifications"""
+        reader = asyncio.ensure_future(self._reader(ws))
+        stopper = asyncio.ensure_future(self._stop.wait())
+        try:
+            heads_id = await self._request('eth_subscribe', ['newHeads'])
+            logs_id = await self._request('eth_subscribe', [
+                'logs', {'address': self.pool_address, 'topics': [SWAP_TOPIC]}
+            ])
+            self._subscriptions = {heads_id: 'newHeads', logs_id: 'logs'}
+            await self._backfill()
+            self.connected.set()
+
+            done, _ = await asyncio.wait({reader, stopper}, return_when=asyncio.FIRST_COMPLETED)
+            if reader in done:
+                reader.result()  # re-raise the disconnect
+        finally:
+            reader.cancel()
+            stopper.cancel()
+
+    # ------------------------------------------------------------------ JSON-RPC
+
+    async def _request(self, method: str, params: List[Any], timeout: float = 10.0):
+        """Send a JSON-RPC request over the websocket and await its result"""
+        request_id = next(self._ids)
+        future = asyncio.get_event_loop().create_future()
+        self._pending[request_id] = future
+        await self._ws.send(json.dumps({'jsonrpc': '2.0', 'id': request_id, 'method': method, 'params': params}))
+        try:
+            return await asyncio.wait_for(future, timeout=timeout)
+        finally:
+            self._pending.pop(request_id, None)
+
+    async def _reader(self, ws):
+        """Dispatch responses to waiting requests and notifications to handlers"""
+        async for message in ws:
+            payload = json.loads(message)
+            if 'id' in payload and payload['id'] in self._pending:
+                future = self._pending[payload['id']]
+                if 'error' in payload:
+                    future.set_exception(RuntimeError(payload['error']))
+                else:
+                    future.set_result(payload.get('result'))
+            elif payload.get('method') == 'eth_subscription':
+                params = payload['params']
+                kind = self._subscriptions.get(params['subscription'])
+                if kind == 'newHeads':
+                    self._handle_head(params['result'])
+                elif kind == 'logs':
+                    self._handle_log(params['result'])
+        raise ConnectionError('Websocket closed by server')
+
+    async def _backfill(self):
+        """Replay Swap logs missed while disconnected"""
+        if self.last_block is None:
+            return
+        latest = _hex_to_int(await self._request('eth_blockNumber', []))
+        from_block = self.last_block
+        if from_block > latest:
+            return
+        if latest - from_block > self.backfill_max_blocks:
+            logger.warning(f"Missed {latest - from_block} blocks, more than PRICE_FEED_BACKFILL_MAX_BLOCKS="
+                           f"{self.backfill_max_blocks}; re-reading slot0 instead of replaying Swap logs")
+            await self._resync()
+            return
+        logs = await self._request('eth_getLogs', [{
+            'address': self.pool_address,
+            'topics': [SWAP_TOPIC],
+            'fromBlock': hex(from_block),
+            'toBlock': hex(latest)
+        }])
+        applied = 0
+        for log in sorted(logs or [], key=lambda l: (_hex_to_int(l['blockNumber']), _hex_to_int(l['logIndex']))):
+            if self._handle_log(log):
+                applied += 1
+        self.stats['backfilled'] += applied
+        if applied:
+            logger.info(f"Backfilled {applied} Swap logs from blocks {from_block}-{latest}")
+
+    # ------------------------------------------------------------------ handlers
+
+    def _handle_head(self, header: Dict[str, Any]):
+        block_number = _hex_to_int(header['number'])
+        self.head_block = block_number
+        self.stats['heads'] += 1
+        if self.on_new_head:
+            try:
+                self.on_new_head(dict(header, number=block_number))
+            except Exception as e:
+                logger.warning(f"New-head callback failed: {e}")
+
+    def _handle_log(self, log: Dict[str, Any]) -> bool:
+        """
+        Apply a Swap log if it is newer than the current state
+
+        Returns:
+            True if the log was applied
+        """
+        if log.get('removed'):
+            # Reorged-out log; the replacement chain's logs follow as new notifications
+            self._roll_back(_hex_to_int(log['blockNumber']))
+            return False
+
+        new_state = decode_swap_log(log)
+        current = self.state
+        if current is not None and (new_state.block_number, new_state.log_index) <= \
+                (current.block_number, current.log_index):
+            return False  # duplicate (live + backfill overlap) or out of order
+
+        self.stats['swaps'] += 1
+        self._history.append(new_state)
+        self._set_state(new_state)
+        return True
+
+    def _set_state(self, new_state: Optional[PoolState]):
+        """Adopt a state and notify if price, tick or liquidity changed"""
+        current = self.state
+        self.state = new_state
+        if new_state is None:
+            return
+        self.last_block = new_state.block_number
+        if not new_state.same_price_state(current):
+            self.stats['state_changes'] += 1
+            try:
+                self.on_state_change(new_state)
+            except Exception as e:
+                logger.error(f"Pool state callback failed: {e}")
+
+    def _roll_back(self, block_number: int):
+        """Drop every state from block_number on; re-read slot0 if no earlier one is kept"""
+        if self.state is None or self.state.block_number < block_number:
+            return  # never applied, or already rolled back by an earlier removed log
+        self.stats['reorgs'] += 1
+        while self._history and self._history[-1].block_number >= block_number:
+            self._history.pop()
+        if self._history:
+            logger.warning(f"Swap logs from block {block_number} reorged out; "
+                           f"rolled back to block {self._history[-1].block_number}")
+            self._set_state(self._history[-1])
+            return
+        logger.warning(f"Swap logs from block {block_number} reorged out past the kept history; "
+                       f"re-reading slot0")
+        self.state = None
+        self.last_block = block_number - 1
+        if self._resync_task is None or self._resync_task.done():
+            self._resync_task = asyncio.ensure_future(self._resync())
+
+    async def _resync(self):
+        """Seed the state from slot0 and liquidity at the current head"""
+        try:
+            block = _hex_to_int(await self._request('eth_blockNumber', []))
+            at = hex(block)
+            slot0 = await self._request('eth_call', [{'to': self.pool_address, 'data': SLOT0_CALL}, at])
+            liquidity = await self._request('eth_call', [{'to': self.pool_address, 'data': LIQUIDITY_CALL}, at])
+            sqrt_price_x96, tick = decode(SLOT0_TYPES, bytes.fromhex(slot0[2:]))[:2]
+            (liquidity,) = decode(['uint128'], bytes.fromhex(liquidity[2:]))
+        except Exception as e:
+            logger.error(f"Pool state re-read failed: {e}")
+            return
+        seeded = PoolState(block, END_OF_BLOCK, sqrt_price_x96, tick, liquidity)
+        current = self.state
+        if current is not None and (current.block_number, current.log_index) >= (block, END_OF_BLOCK):
+            return  # newer logs arrived while reading
+        self.stats['resyncs'] += 1
+        self._history.append(seeded)
+        self._set_state(seeded)
@@ -0,0 +1,254 @@
+"""
+AsymmetricLP - Rebalance Write-Ahead Log
+Append-only, fsync'd JSONL record of rebalance intents, submitted
+transactions, baselines and the rolling price window, so a restarted
+rebalancer can recover its state without rescanning the chain and can
+resume a rebalance interrupted between burn and mint.
+"""
+import json
+import logging
+import os
+import threading
+import time
+from dataclasses import dataclass, field
+from typing import Any, Dict, List, Optional
+
+logger = logging.getLogger(__name__)
+
+# Rebalance state machine (one 'rebalance' record per transition)
+STATE_INTENT = 'intent'          # planned, nothing sent yet
+STATE_SUBMITTED = 'submitted'    # transactions broadcast (hashes recorded)
+STATE_UNWOUND = 'unwound'        # old positions burned, new ones not yet minted
+STATE_COMPLETE = 'complete'      # new positions minted, baselines updated
+STATE_ABORTED = 'aborted'        # gave up; old positions (if any) remain
+TERMINAL_STATES = (STATE_COMPLETE, STATE_ABORTED)
+
+
+@dataclass
+class RecoveredState:
+    """State reconstructed from the log"""
+    positions: List[Any] = field(default_factory=list)
+    last_rebalance_token0: Optional[float] = None
+    last_rebalance_token1: Optional[float] = None
+    last_rebalance_price: Optional[float] = None
+    last_rebalance_time: float = 0
+    price_history: List[Dict[str, float]] = field(default_factory=list)
+    in_flight: Optional[Dict[str, Any]] = None
+    records: int = 0
+    last_seq: int = 0
+
+    @property
+    def empty(self) -> bool:
+        return self.records == 0
+
+
+class RebalanceWAL:
+    """
+    Append-only rebalance journal.
+
+    Every append is flushed and fsync'd before returning. The log is
+    periodically compacted into a single checkpoint record via an atomic
+    rename so replay time stays bounded.
+    """
+
+    def __init__(self, path: str, price_window: int = 100, compact_every: int = 1000, fsync: bool = True):
+        """
+        Initialize the WAL
+
+        Args:
+            path: Log file path
+            price_window: Number of price points kept on replay
+            compact_every: Compact after this many appended records
+            fsync: fsync after every append (disable only in tests)
+        """
+        self.path = path
+        self.price_window = price_window
+        self.compact_every = compact_every
+        self.fsync = fsync
+        self._lock = threading.Lock()
+        self._seq = 0
+        self._appended_since_compact = 0
+        self._state = RecoveredState()
+
+        directory = os.path.dirname(os.path.abspath(path))
+        os.makedirs(directory, exist_ok=True)
+        self._state = self._replay_file()
+        self._seq = self._state.last_seq
+        self._file = open(self.path, 'a', encoding='utf-8')
+
+    # ------------------------------------------------------------------ writing
+
+    def append(self, record_type: str, **fields) -> Dict[str, Any]:
+        """
+        Durably append a record
+
+        Args:
+            record_type: 'price', 'baseline', 'positions', 'rebalance' or 'checkpoint'
+            **fields: Record payload
+
+        Returns:
+            The record written
+        """
+        with self._lock:
+            self._seq += 1
+            record = {'seq': self._seq, 'ts': time.time(), 'type': record_type, **fields}
+            self._file.write(json.dumps(record, separators=(',', ':')) + '\n')
+            self._file.flush()
+            if self.fsync:
+                os.fsync(self._file.fileno())
+            self._apply(self._state, record)
+            self._appended_since_compact += 1
+            if self._appended_since_compact >= self.compact_every:
+                self._compact_locked()
+            return record
+
+    def record_price(self, price: float, timestamp: float):
+        self.append('price', price=price, timestamp=timestamp)
+
+    def record_baseline(self, token0: float, token1: float, price: float):
+        self.append('baseline', token0=token0, token1=token1, price=price)
+
+    def record_positions(self, positions: List[Any]):
+        self.append('positions', positions=positions)
+
+    def record_rebalance(self, rebalance_id: str, state: str, **fields):
+        self.append('rebalance', id=rebalance_id, state=state, **fields)
+
+    # ------------------------------------------------------------------ replay
+
+    @staticmethod
+    def _apply(state: RecoveredState, record: Dict[str, Any]):
+        """Fold one record into the recovered state"""
+        kind = record.get('type')
+        state.records += 1
+        state.last_seq = max(state.last_seq, record.get('seq', 0))
+        if kind == 'checkpoint':
+            snapshot = record['state']
+            state.positions = snapshot.get('positions', [])
+            state.last_rebalance_token0 = snapshot.get('last_rebalance_token0')
+            state.last_rebalance_token1 = snapshot.get('last_rebalance_token1')
+            state.last_rebalance_price = snapshot.get('last_rebalance_price')
+            state.last_rebalance_time = snapshot.get('last_rebalance_time', 0)
+            state.price_history = snapshot.get('price_history', [])
+            state.in_flight = snapshot.get('in_flight')
+        elif kind == 'price':
+            state.price_history.append({'timestamp': record['timestamp'], 'price': record['price']})
+        elif kind == 'baseline':
+            state.last_rebalance_token0 = record['token0']
+            state.last_rebalance_token1 = record['token1']
+            state.last_rebalance_price = record['price']
+            state.last_rebalance_time = record['ts']
+        elif kind == 'positions':
+            state.positions = record['positions']
+        elif kind == 'rebalance':
+            if record['state'] == STATE_INTENT:
+                state.in_flight = {k: v for k, v in record.items() if k not in ('seq', 'type')}
+                state.in_flight.setdefault('tx_hashes', [])
+            elif state.in_flight and state.in_flight.get('id') == record['id']:
+                if record['state'] in TERMINAL_STATES:
+                    state.in_flight = None
+                else:
+                    # Later transitions carry the current phase and its tx hashes
+                    state.in_flight.update({k: v for k, v in record.items() if k not in ('seq', 'type', 'ts')})
+
+    def _trim(self, state: RecoveredState):
+        if len(state.price_history) > self.price_window:
+            state.price_history = state.price_history[-self.price_window:]
+
+    def _replay_file(self) -> RecoveredState:
+        """Rebuild state from the log on disk, tolerating a torn final line"""
+        state = RecoveredState()
+        if not os.path.exists(self.path):
+            return state
+        started = time.time()
+        with open(self.path, 'rb') as f:
+            data = f.read()
+        # Only the last record can be torn by a crash mid-write. Cut it off so the
+        # next append starts on a fresh line instead of being glued onto it.
+        complete = data.rfind(b'\n') + 1
+        if complete < len(data):
+            logger.warning(f"Truncating torn WAL tail ({len(data) - complete} bytes)")
+            os.truncate(self.path, complete)
+        for line_number, line in enumerate(data[:complete].decode('utf-8').splitlines(), 1):
+            line = line.strip()
+            if not line:
+                continue
+            try:
+                record = json.loads(line)
+            except json.JSONDecodeError:
+                logger.warning(f"Ignoring unreadable WAL record at line {line_number}")
+                continue
+            self._apply(state, record)
+            self._trim(state)
+        logger.info(f"Replayed {state.records} WAL records in {(time.time() - started) * 1000:.1f}ms")
+        return state
+
+    def replay(self) -> RecoveredState:
+        """
+        Current state as reconstructed from the log
+
+        Returns:
+            Copy of the recovered state
+        """
+        with self._lock:
+            self._trim(self._state)
+            s = self._state
+            return RecoveredState(
+                positions=list(s.positions),
+                last_rebalance_token0=s.last_rebalance_token0,
+                last_rebalance_token1=s.last_rebalance_token1,
+                last_rebalance_price=s.last_rebalance_price,
+                last_rebalance_time=s.last_rebalance_time,
+                price_history=list(s.price_history),
+                in_flight=dict(s.in_flight) if s.in_flight else None,
+                records=s.records,
+                last_seq=s.last_seq
+            )
+
+    # ------------------------------------------------------------------ compaction
+
+    def compact(self):
+        """Rewrite the log as a single checkpoint record"""
+        with self._lock:
+            self._compact_locked()
+
+    def _compact_locked(self):
+        self._trim(self._state)
+        s = self._state
+        checkpoint = {
+            'seq': self._seq, 'ts': time.time(), 'type': 'checkpoint',
+            'state': {
+                'positions': s.positions,
+                'last_rebalance_token0': s.last_rebalance_token0,
+                'last_rebalance_token1': s.last_rebalance_token1,
+                'last_rebalance_price': s.last_rebalance_price,
+                'last_rebalance_time': s.last_rebalance_time,
+                'price_history': s.price_history,
+                'in_flight': s.in_flight
+            }
+        }
+        tmp_path = self.path + '.tmp'
+        with open(tmp_path, 'w', encoding='utf-8') as f:
+            f.write(json.dumps(checkpoint, separators=(',', ':')) + '\n')
+            f.flush()
+            os.fsync(f.fileno())
+        self._file.close()
+        os.replace(tmp_path, self.path)
+        self._fsync_directory()
+        self._file = open(self.path, 'a', encoding='utf-8')
+        self._appended_since_compact = 0
+        logger.debug(f"Compacted WAL at seq {self._seq}")
+
+    def _fsync_directory(self):
+        """Make the rename itself durable"""
+        if not self.fsync or not hasattr(os, 'O_DIRECTORY'):
+            return
+        fd = os.open(os.path.dirname(os.path.abspath(self.path)), os.O_DIRECTORY)
+        try:
+            os.fsync(fd)
+        finally:
+            os.close(fd)
+
+    def close(self):
+        with self._lock:
+            self._file.close()
@@ -0,0 +1,171 @@
+"""
+AsymmetricLP - Receipt Log Decoder
+Decodes NonfungiblePositionManager receipt logs (IncreaseLiquidity,
+DecreaseLiquidity, Collect and the ERC721 Transfer of the position NFT) into
+typed events, so token IDs, liquidity and amounts come straight from the
+receipt instead of follow-up reads. Words are sliced directly from the log
+data; every field of these events is a fixed 32-byte word.
+"""
+import logging
+from dataclasses import dataclass, field
+from typing import Any, Dict, Iterable, List, Optional, Tuple
+from eth_utils import keccak, to_checksum_address
+
+logger = logging.getLogger(__name__)
+
+TRANSFER_TOPIC = keccak(text='Transfer(address,address,uint256)')
+INCREASE_LIQUIDITY_TOPIC = keccak(text='IncreaseLiquidity(uint256,uint128,uint256,uint256)')
+DECREASE_LIQUIDITY_TOPIC = keccak(text='DecreaseLiquidity(uint256,uint128,uint256,uint256)')
+COLLECT_TOPIC = keccak(text='Collect(uint256,address,uint256,uint256)')
+
+ZERO_ADDRESS = '0x' + '00' * 20
+
+
+@dataclass
+class LiquidityEvent:
+    """IncreaseLiquidity or DecreaseLiquidity"""
+    token_id: int
+    liquidity: int
+    amount0: int
+    amount1: int
+    log_index: int
+
+
+@dataclass
+class CollectEvent:
+    token_id: int
+    recipient: str
+    amount0: int
+    amount1: int
+    log_index: int
+
+
+@dataclass
+class NftTransfer:
+    """ERC721 Transfer of a position NFT (from zero = mint, to zero = burn)"""
+    sender: str
+    recipient: str
+    token_id: int
+    log_index: int
+
+
+@dataclass
+class MintedPosition:
+    token_id: int
+    liquidity: int
+    amount0: int
+    amount1: int
+    owner: Optional[str] = None
+
+
+@dataclass
+class ReceiptEvents:
+    """Position-manager events of one or more receipts, in log order"""
+    increases: List[LiquidityEvent] = field(default_factory=list)
+    decreases: List[LiquidityEvent] = field(default_factory=list)
+    collects: List[CollectEvent] = field(default_factory=list)
+    transfers: List[NftTransfer] = field(default_factory=list)
+
+    def minted(self) -> List[MintedPosition]:
+        """Positions created here: IncreaseLiquidity for a token ID whose NFT was minted here"""
+        owners = {t.token_id: t.recipient for t in self.transfers if t.sender == ZERO_ADDRESS}
+        return [MintedPosition(e.token_id, e.liquidity, e.amount0, e.amount1, owners[e.token_id])
+                for e in self.increases if e.token_id in owners]
+
+    def burned(self) -> List[int]:
+        """Token IDs whose NFT was burned here"""
+        return [t.token_id for t in self.transfers if t.recipient == ZERO_ADDRESS]
+
+    def removed(self) -> Tuple[int, int]:
+        """Principal released by DecreaseLiquidity (owed, not yet transferred)"""
+        return sum(e.amount0 for e in self.decreases), sum(e.amount1 for e in self.decreases)
+
+    def collected(self) -> Tuple[int, int]:
+        """Tokens actually transferred out by Collect (principal + fees)"""
+        return sum(e.amount0 for e in self.collects), sum(e.amount1 for e in self.collects)
+
+
+def _bytes(value: Any) -> bytes:
+    if isinstance(value, (bytes, bytearray)):
+        return bytes(value)
+    if isinstance(value, str):
+        return bytes.fromhex(value[2:] if value.startswith('0x') else value)
+    raise TypeError(f"Cannot read {type(value).__name__} as bytes")
+
+
+def _int(value: Any) -> int:
+    if isinstance(value, int):
+        return value
+    if isinstance(value, str):
+        return int(value, 16)
+    return int.from_bytes(_bytes(value), 'big')
+
+
+def _word(data: bytes, index: int) -> int:
+    return int.from_bytes(data[32 * index:32 * (index + 1)], 'big')
+
+
+def _address_word(word: bytes) -> str:
+    return to_checksum_address(word[-20:])
+
+
+def decode_logs(logs: Iterable[Dict[str, Any]], position_manager: Optional[str] = None,
+                events: Optional[ReceiptEvents] = None) -> ReceiptEvents:
+    """
+    Decode position-manager events from receipt logs
+
+    Args:
+        logs: Receipt logs (web3 AttributeDicts or raw JSON-RPC dicts)
+        position_manager: Only decode logs emitted by this address (all logs if None)
+        events: Accumulate into an existing result
+
+    Returns:
+        ReceiptEvents
+    """
+    events = events or ReceiptEvents()
+    manager = position_manager.lower() if position_manager else None
+    for log in logs:
+        if manager and str(log['address']).lower() != manager:
+            continue
+        topics = [_bytes(t) for t in log['topics']]
+        if not topics:
+            continue
+        topic, data = topics[0], _bytes(log.get('data') or b'')
+        log_index = _int(log.get('logIndex', 0) or 0)
+        try:
+            if topic == INCREASE_LIQUIDITY_TOPIC:
+                events.increases.append(LiquidityEvent(
+                    _int(topics[1]), _word(data, 0), _word(data, 1), _word(data, 2), log_index))
+            elif topic == DECREASE_LIQUIDITY_TOPIC:
+                events.decreases.append(LiquidityEvent(
+                    _int(topics[1]), _word(data, 0), _word(data, 1), _word(data, 2), log_index))
+            elif topic == COLLECT_TOPIC:
+                events.collects.append(CollectEvent(
+                    _int(topics[1]), _address_word(data[:32]), _word(data, 1), _word(data, 2), log_index))
+            elif topic == TRANSFER_TOPIC and len(topics) == 4:
+                # ERC721 indexes the token ID; an ERC20 Transfer (3 topics) is not a position
+                events.transfers.append(NftTransfer(
+                    _address_word(topics[1]), _address_word(topics[2]), _int(topics[3]), log_index))
+        except (IndexError, ValueError) as e:
+            logger.warning(f"Skipping malformed position-manager log {log_index}: {e}")
+    return events
+
+
+def decode_receipts(receipts: Iterable[Optional[Dict[str, Any]]],
+                    position_manager: Optional[str] = None) -> ReceiptEvents:
+    """
+    Decode every successful receipt of a batch into one ReceiptEvents
+
+    Args:
+        receipts: Receipts (None and reverted receipts are skipped)
+        position_manager: Only decode logs emitted by this address
+
+    Returns:
+        ReceiptEvents
+    """
+    events = ReceiptEvents()
+    for receipt in receipts:
+        if receipt is None or _int(receipt.get('status', 1)) != 1:
+            continue
+        decode_logs(receipt.get('logs') or [], position_manager, events)
+    return events
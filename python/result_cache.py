@@ -0,0 +1,341 @@
+"""
+AsymmetricLP - Backtest Result Cache
+Content-addressed store of BacktestResults so identical runs are computed
+once. The key is a SHA-256 over:
+
+- the dataset: the OHLC file's bytes (or a DataFrame's row hashes);
+- the canonicalized parameters: every public setting of the Config the
+  engine runs with (secrets, endpoints and TARGET_INVENTORY_RATIO, which
+  run_backtest overwrites from the starting balances, are left out), an
+  optional BacktestConfig, and the run arguments;
+- the engine version: the source of the modules that determine a result
+  (ENGINE_SOURCES) plus CACHE_FORMAT.
+
+Caching is switched on per engine, like profiling (main.py --historical-mode
+does it with --result-cache [DIR]; other drivers set it themselves):
+
+    engine.result_cache = ResultCache()
+    result = engine.run_backtest(...)   # computed and stored, or loaded
+
+parity_harness.py deliberately runs uncached: it times both engines.
+
+A hit returns the stored result without touching the engine's state.
+Dataset digests are memoized by (path, size, mtime, inode) and engine
+digests per process, and results already loaded stay in memory, so a
+repeated lookup costs a stat and one SHA-256 over the canonical JSON.
+Entries are written to a temporary file and renamed into place, so
+concurrent writers (sweep workers, separate processes) never leave a
+partial entry; a race on one key stores the same result twice and the
+last rename wins.
+"""
+import argparse
+import hashlib
+import json
+import logging
+import os
+import pickle
+import re
+import sys
+import tempfile
+import threading
+import time
+from collections import OrderedDict
+from typing import Any, Dict, Optional, Tuple
+
+logger = logging.getLogger(__name__)
+
+# Bump when the stored layout or BacktestResult changes incompatibly
+CACHE_FORMAT = 1
+# Modules (and model package) whose source determines a backtest result
+ENGINE_SOURCES = ('backtest_engine.py', 'backtest_summary.py', 'amm.py', 'strategy.py', 'models')
+# Settings that must never reach the key or the stored parameters
+SECRET_SETTING = re.compile(r'KEY|TOKEN|SECRET|PASSWORD|MNEMONIC|_URL$|RPC_ENDPOINTS')
+# Settings that cannot change a result (run_backtest overwrites the ratio)
+IGNORED_SETTINGS = frozenset({'TARGET_INVENTORY_RATIO', 'RESULT_CACHE_DIR'})
+
+_HERE = os.path.dirname(os.path.abspath(__file__))
+_digest_lock = threading.Lock()
+_file_digests: Dict[Tuple[str, int, int, int], str] = {}
+_engine_digest: Optional[str] = None
+_setting_names: Dict[type, Tuple[str, ...]] = {}
+
+
+def _sha256_file(path: str) -> str:
+    h = hashlib.sha256()
+    with open(path, 'rb') as f:
+        for chunk in iter(lambda: f.read(1 << 20), b''):
+            h.update(chunk)
+    return h.hexdigest()
+
+
+def dataset_digest(dataset) -> str:
+    """
+    Digest of an OHLC dataset
+
+    Args:
+        dataset: Path to the OHLC CSV, or a DataFrame from load_ohlc_data
+
+    Returns:
+        Hex SHA-256 (of the file bytes, or of the frame's columns and row hashes)
+    """
+    if isinstance(dataset, (str, os.PathLike)):
+        path = os.path.realpath(dataset)
+        st = os.stat(path)
+        stamp = (path, st.st_size, st.st_mtime_ns, st.st_ino)
+        digest = _file_digests.get(stamp)
+        if digest is None:
+            digest = _sha256_file(path)
+            with _digest_lock:
+                _file_digests[stamp] = digest
+        return digest
+    import pandas as pd
+    h = hashlib.sha256(json.dumps([str(c) for c in dataset.columns]).encode())
+    h.update(pd.util.hash_pandas_object(dataset, index=False).values.tobytes())
+    return h.hexdigest()
+
+
+def engine_digest() -> str:
+    """Digest of CACHE_FORMAT and the ENGINE_SOURCES files (computed once per process)"""
+    global _engine_digest
+    if _engine_digest is None:
+        h = hashlib.sha256(f'format={CACHE_FORMAT}'.encode())
+        for source in ENGINE_SOURCES:
+            path = os.path.join(_HERE, source)
+            files = ([os.path.join(path, name) for name in sorted(os.listdir(path)) if name.endswith('.py')]
+                     if os.path.isdir(path) else [path])
+            for file in files:
+                h.update(os.path.relpath(file, _HERE).encode() + b'\0')
+                with open(file, 'rb') as f:
+                    h.update(f.read())
+        _engine_digest = h.hexdigest()
+    return _engine_digest
+
+
+def _canonical(value: Any) -> Any:
+    """value as plain JSON data (tuples become lists, unknown types their repr)"""
+    if value is None or isinstance(value, (bool, int, str)):
+        return value
+    if isinstance(value, float):
+        return value if value == value else 'nan'
+    if isinstance(value, (list, tuple)):
+        return [_canonical(v) for v in value]
+    if isinstance(value, dict):
+        return {str(k): _canonical(v) for k, v in value.items()}
+    if hasattr(value, 'isoformat'):
+        return value.isoformat()
+    return repr(value)
+
+
+def canonical_parameters(config, backtest_config=None, **run_args) -> Dict[str, Any]:
+    """
+    The parameters that identify a run, as sorted plain data
+
+    Args:
+        config: Config instance the engine runs with
+        backtest_config: Optional BacktestConfig
+        **run_args: run_backtest arguments (balances, dates, summary_only)
+
+    Returns:
+        Dict of config, backtest_config and run sections
+    """
+    names = _setting_names.get(type(config))
+    if names is None:
+        names = _setting_names[type(config)] = tuple(
+            name for name in dir(type(config))
+            if name.isupper() and name not in IGNORED_SETTINGS and not SECRET_SETTING.search(name))
+    settings = {}
+    for name in names + tuple(name for name in vars(config) if name not in names and name.isupper()
+                              and name not in IGNORED_SETTINGS and not SECRET_SETTING.search(name)):
+        value = getattr(config, name)
+        if not callable(value):
+            settings[name] = _canonical(value)
+    params = {'config': settings, 'run': {k: _canonical(v) for k, v in run_args.items()}}
+    if backtest_config is not None:
+        params['backtest_config'] = _canonical(backtest_config.to_dict())
+    return params
+
+
+def cache_key(dataset, config, backtest_config=None, **run_args) -> str:
+    """
+    Content address of a backtest run
+
+    Args:
+        dataset: OHLC file path or DataFrame
+        config: Config instance
+        backtest_config: Optional BacktestConfig
+        **run_args: run_backtest arguments
+
+    Returns:
+        Hex SHA-256 key
+    """
+    return _key(dataset, canonical_parameters(config, backtest_config, **run_args))
+
+
+def _key(dataset, params: Dict[str, Any]) -> str:
+    blob = json.dumps([dataset_digest(dataset), engine_digest(), params], sort_keys=True,
+                      separators=(',', ':'))
+    return hashlib.sha256(blob.encode()).hexdigest()
+
+
+class ResultCache:
+    """Directory of pickled BacktestResults addressed by cache_key"""
+
+    def __init__(self, directory: Optional[str] = None, memory_entries: int = 64):
+        """
+        Args:
+            directory: Cache root (default Config.RESULT_CACHE_DIR)
+            memory_entries: Results also kept in memory for repeat hits
+        """
+        if directory is None:
+            from config import Config
+            directory = Config.RESULT_CACHE_DIR
+        self.directory = directory
+        self.memory_entries = memory_entries
+        self._memory: 'OrderedDict[str, Any]' = OrderedDict()
+        self._lock = threading.Lock()
+        self.hits = 0
+        self.misses = 0
+
+    def path(self, key: str) -> str:
+        return os.path.join(self.directory, key[:2], key + '.pkl')
+
+    def _remember(self, key: str, result):
+        with self._lock:
+            self._memory[key] = result
+            self._memory.move_to_end(key)
+            while len(self._memory) > self.memory_entries:
+                self._memory.popitem(last=False)
+
+    def get(self, key: str):
+        """
+        Stored result for key
+
+        Returns:
+            BacktestResult, or None on a miss. Results loaded earlier by this
+            cache are returned from memory and shared between hits, so treat
+            them as read-only.
+        """
+        result = self._memory.get(key)
+        if result is None:
+            try:
+                with open(self.path(key), 'rb') as f:
+                    result = pickle.load(f)['result']
+            except FileNotFoundError:
+                self.misses += 1
+                return None
+            except Exception as e:
+                # Written by an incompatible engine or damaged on disk: recompute
+                logger.warning(f"Dropping unreadable cache entry {key[:12]}: {e}")
+                self.misses += 1
+                return None
+        self._remember(key, result)
+        self.hits += 1
+        return result
+
+    def put(self, key: str, result, params: Optional[Dict[str, Any]] = None):
+        """
+        Store result under key (atomic: temp file, then rename)
+
+        Args:
+            key: cache_key of the run
+            result: BacktestResult
+            params: canonical_parameters of the run, kept for inspection
+        """
+        blob = pickle.dumps({'key': key, 'created': time.time(), 'params': params, 'result': result},
+                            protocol=pickle.HIGHEST_PROTOCOL)
+        path = self.path(key)
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        fd, tmp = tempfile.mkstemp(dir=os.path.dirname(path), prefix='.' + key[:12], suffix='.tmp')
+        try:
+            with os.fdopen(fd, 'wb') as f:
+                f.write(blob)
+            os.replace(tmp, path)
+        except BaseException:
+            try:
+                os.unlink(tmp)
+            except OSError:
+                pass
+            raise
+
+    def run(self, engine, run, ohlc_file, initial_balance_0: float, initial_balance_1: float,
+            start_date=None, end_date=None, summary_only: bool = False):
+        """
+        Cached result of engine's run, computing and storing it on a miss
+
+        Args:
+            engine: BacktestEngine (its config and backtest_config are part of the key)
+            run: Zero-argument callable computing the result
+            ohlc_file .. summary_only: run_backtest arguments
+        """
+        run_args = dict(initial_balance_0=initial_balance_0, initial_balance_1=initial_balance_1,
+                        start_date=start_date, end_date=end_date, summary_only=summary_only)
+        # Key before running: run_backtest writes to the config
+        params = canonical_parameters(engine.config, getattr(engine, 'backtest_config', None), **run_args)
+        key = _key(ohlc_file, params)
+        result = self.get(key)
+        if result is not None:
+            logger.info(f"Backtest result cache hit {key[:12]}")
+            return result
+        result = run()
+        self.put(key, result, params)
+        return result
+
+    def entries(self):
+        """(key, path, size) of every stored entry"""
+        if not os.path.isdir(self.directory):
+            return
+        for shard in sorted(os.listdir(self.directory)):
+            shard_dir = os.path.join(self.directory, shard)
+            if not os.path.isdir(shard_dir):
+                continue
+            for name in sorted(os.listdir(shard_dir)):
+                if name.endswith('.pkl'):
+                    path = os.path.join(shard_dir, name)
+                    yield name[:-4], path, os.path.getsize(path)
+
+    def prune(self, max_bytes: int) -> int:
+        """
+        Delete least recently written entries until the cache fits max_bytes
+
+        Returns:
+            Number of entries removed
+        """
+        entries = sorted(self.entries(), key=lambda e: os.path.getmtime(e[1]))
+        total = sum(size for _, _, size in entries)
+        removed = 0
+        for key, path, size in entries:
+            if total <= max_bytes:
+                break
+            try:
+                os.unlink(path)
+            except FileNotFoundError:
+                pass
+            self._memory.pop(key, None)
+            total -= size
+            removed += 1
+        return removed
+
+    def clear(self) -> int:
+        return self.prune(0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Inspect or trim the backtest result cache')
+    parser.add_argument('command', choices=('stats', 'prune', 'clear'))
+    parser.add_argument('--dir', default=None, help='Cache directory (default RESULT_CACHE_DIR)')
+    parser.add_argument('--max-mb', type=float, default=1024.0, help='Size to prune down to')
+    args = parser.parse_args()
+
+    cache = ResultCache(args.dir)
+    if args.command == 'stats':
+        entries = list(cache.entries())
+        print(f"{cache.directory}: {len(entries)} entries, {sum(e[2] for e in entries) / 1e6:.1f} MB")
+    elif args.command == 'prune':
+        print(f"Removed {cache.prune(int(args.max_mb * 1e6))} entries")
+    else:
+        print(f"Removed {cache.clear()} entries")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
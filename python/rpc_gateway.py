@@ -0,0 +1,562 @@
+"""
+AsymmetricLP - Shared RPC Gateway
+Every JSON-RPC call in the process (monitoring reads, transaction sends,
+OHLC downloads) goes through one gateway so the provider quota is spent
+deliberately: a token bucket per endpoint, priority lanes (execution before
+monitoring before downloads), identical in-flight reads coalesced, compatible
+calls packed into JSON-RPC batches, and failover to the next endpoint on
+connection errors, HTTP 429 and 5xx. Transaction sends only fail over when
+the node refused them (rate limited); after a connection error the send may
+have gone out, so it fails with SendOutcomeUnknown instead of going out twice.
+"""
+import contextvars
+import heapq
+import itertools
+import logging
+import threading
+import time
+from contextlib import contextmanager
+from typing import Any, Callable, Dict, List, Optional, Sequence, Tuple
+from config import Config
+from latency_metrics import metrics
+from rpc_transport import Transport, TransportError, TransportProvider, encode_json
+
+logger = logging.getLogger(__name__)
+
+LANE_EXECUTION = 0
+LANE_MONITORING = 1
+LANE_DOWNLOAD = 2
+LANE_NAMES = ('execution', 'monitoring', 'download')
+
+# Share of each endpoint's burst a lane must leave untouched for the lanes above it
+LANE_RESERVE = (0.0, 0.1, 0.5)
+
+# Calls that belong to a transaction in flight run in the execution lane wherever they come from
+EXECUTION_METHODS = frozenset({
+    'eth_sendRawTransaction', 'eth_getTransactionCount', 'eth_getTransactionReceipt', 'eth_estimateGas'
+})
+
+# Sent on their own so a retry never re-sends a batch around them
+UNBATCHED_METHODS = frozenset({'eth_sendRawTransaction'})
+
+# Not failed over once the request may have reached a node: a resend elsewhere
+# answers "already known" or "nonce too low" for a transaction that went out
+NON_IDEMPOTENT_METHODS = frozenset({'eth_sendRawTransaction'})
+
+# Reads whose result is the same for every caller asking at the same moment
+COALESCED_METHODS = frozenset({
+    'eth_call', 'eth_blockNumber', 'eth_chainId', 'eth_gasPrice', 'eth_maxPriorityFeePerGas',
+    'eth_feeHistory', 'eth_getBlockByNumber', 'eth_getBalance', 'eth_getCode', 'eth_getLogs',
+    'eth_getTransactionReceipt', 'net_version', 'web3_clientVersion'
+})
+
+# JSON-RPC error codes providers use for "over quota" (treated like HTTP 429)
+RATE_LIMIT_CODES = frozenset({-32005, 429})
+
+MAX_COOLDOWN_SECONDS = 60.0
+
+_current_lane: contextvars.ContextVar = contextvars.ContextVar('rpc_lane', default=None)
+
+
+@contextmanager
+def rpc_lane(lane: int):
+    """Run the enclosed calls (on this thread) in the given lane"""
+    token = _current_lane.set(lane)
+    try:
+        yield
+    finally:
+        _current_lane.reset(token)
+
+
+class RpcError(Exception):
+    """A JSON-RPC error object returned by the node"""
+
+    def __init__(self, error: Dict[str, Any]):
+        self.code = error.get('code')
+        self.message = error.get('message', '')
+        self.data = error.get('data')
+        super().__init__(f"RPC error {self.code}: {self.message}")
+
+
+class RpcUnavailable(ConnectionError):
+    """No endpoint answered within the call's attempts/deadline"""
+
+
+class SendOutcomeUnknown(RpcUnavailable):
+    """A transaction send failed after it may have reached the node (it was not retried)"""
+
+
+class TokenBucket:
+    """Requests-per-second limiter with a burst allowance"""
+
+    def __init__(self, rate: float, burst: float, clock: Callable[[], float] = time.monotonic):
+        self.rate = float(rate)
+        self.capacity = float(max(burst, 1))
+        self.tokens = self.capacity
+        self.clock = clock
+        self.updated = clock()
+
+    def _refill(self):
+        now = self.clock()
+        self.tokens = min(self.capacity, self.tokens + (now - self.updated) * self.rate)
+        self.updated = now
+
+    def take(self, count: int, reserve: float = 0.0) -> int:
+        """
+        Take up to count tokens, leaving reserve * capacity in the bucket
+
+        Returns:
+            Number of tokens taken (0 if the lane must wait)
+        """
+        self._refill()
+        available = int(self.tokens - reserve * self.capacity)
+        taken = max(0, min(count, available))
+        self.tokens -= taken
+        return taken
+
+    def wait_time(self, reserve: float = 0.0) -> float:
+        """Seconds until one token is available above the reserve"""
+        self._refill()
+        missing = 1 + reserve * self.capacity - self.tokens
+        if missing <= 0:
+            return 0.0
+        return missing / self.rate if self.rate > 0 else MAX_COOLDOWN_SECONDS
+
+
+class Endpoint:
+    """One provider URL with its own quota and health"""
+
+    def __init__(self, url: str, rate: float, burst: float, cooldown: float):
+        self.url = url
+        self.bucket = TokenBucket(rate, burst)
+        self.cooldown = cooldown
+        self.cooldown_until = 0.0
+        self.failures = 0
+        self.requests = 0
+        self.batches = 0
+        self.errors = 0
+
+    def healthy(self, now: float) -> bool:
+        return now >= self.cooldown_until
+
+    def mark_failed(self, now: float):
+        self.failures += 1
+        self.errors += 1
+        self.cooldown_until = now + min(self.cooldown * 2 ** (self.failures - 1), MAX_COOLDOWN_SECONDS)
+
+    def mark_ok(self):
+        self.failures = 0
+
+
+class _Call:
+    """One queued request; coalesced callers share it"""
+
+    __slots__ = ('method', 'params', 'lane', 'key', 'deadline', 'submitted', 'seq', 'attempts', 'queued',
+                 'done', 'response', 'error')
+
+    def __init__(self, method: str, params: Any, lane: int, key: Optional[str], deadline: float):
+        self.method = method
+        self.params = params
+        self.lane = lane
+        self.key = key
+        self.deadline = deadline
+        self.submitted = time.perf_counter_ns()
+        self.seq = 0
+        self.attempts = 0
+        self.queued = False
+        self.done = threading.Event()
+        self.response: Optional[Dict[str, Any]] = None
+        self.error: Optional[BaseException] = None
+
+
+class RpcGateway:
+    """
+    Process-wide JSON-RPC dispatcher.
+
+    Callers block on request()/call(); RPC_CONCURRENCY sender threads pull the
+    highest-priority calls off one heap, pack up to RPC_BATCH_MAX of them into
+    a batch, take that many tokens from the first healthy endpoint that has
+    them, and post. A failed post puts the endpoint in cooldown and requeues
+    the calls for the next one.
+    """
+
+    def __init__(self, config: Config = None, urls: Optional[Sequence[str]] = None,
+                 transport: Optional[Callable[[str, bytes, float], Any]] = None):
+        """
+        Initialize the gateway
+
+        Args:
+            config: Configuration object
+            urls: Endpoints in failover order (RPC_ENDPOINTS, else ETHEREUM_RPC_URL)
+            transport: post(url, body, timeout) -> decoded JSON (persistent HTTP/websocket Transport if None)
+        """
+        self.config = config or Config()
+        urls = list(urls or self.config.RPC_ENDPOINTS or [self.config.ETHEREUM_RPC_URL])
+        self.endpoints = [Endpoint(url, self.config.RPC_RATE_LIMIT_PER_SECOND, self.config.RPC_BURST,
+                                   self.config.RPC_FAILOVER_COOLDOWN_SECONDS) for url in urls]
+        self.batch_max = max(1, self.config.RPC_BATCH_MAX)
+        self.batch_window = self.config.RPC_BATCH_WINDOW_MS / 1000.0
+        self.timeout = self.config.RPC_TIMEOUT_SECONDS
+        self.max_attempts = max(1, self.config.RPC_MAX_ATTEMPTS)
+        self.concurrency = max(1, self.config.RPC_CONCURRENCY)
+        self.transport = transport or Transport(self.config, self.concurrency + 2)
+
+        self._cond = threading.Condition()
+        self._heap: List[Tuple[int, int, _Call]] = []
+        self._seq = itertools.count()
+        self._ids = itertools.count(1)
+        self._inflight: Dict[str, _Call] = {}
+        self._threads: List[threading.Thread] = []
+        self._running = False
+        self.stats = {'calls': 0, 'coalesced': 0, 'batches': 0, 'retries': 0, 'failed': 0}
+
+    # ------------------------------------------------------------------ lifecycle
+
+    def start(self):
+        with self._cond:
+            if self._running:
+                return
+            self._running = True
+        for i in range(self.concurrency):
+            thread = threading.Thread(target=self._worker, name=f"rpc-gateway-{i}", daemon=True)
+            thread.start()
+            self._threads.append(thread)
+        logger.info(f"RPC gateway started: {len(self.endpoints)} endpoint(s), "
+                    f"{self.config.RPC_RATE_LIMIT_PER_SECOND}/s each, {self.concurrency} senders")
+
+    def stop(self):
+        with self._cond:
+            self._running = False
+            pending = [entry[2] for entry in self._heap]
+            self._heap.clear()
+            self._cond.notify_all()
+        for call in pending:
+            self._finish(call, error=RpcUnavailable("RPC gateway stopped"))
+        for thread in self._threads:
+            thread.join(timeout=self.timeout + 1)
+        self._threads = []
+
+    @property
+    def running(self) -> bool:
+        return self._running
+
+    # ------------------------------------------------------------------ callers
+
+    def call(self, method: str, params: Any = None, lane: Optional[int] = None) -> Dict[str, Any]:
+        """
+        Send one request and wait for its JSON-RPC response object
+
+        Args:
+            method: JSON-RPC method
+            params: Params list
+            lane: Priority lane (rpc_lane() context, else by method, else monitoring)
+
+        Returns:
+            Response dict with 'result' or 'error'
+        """
+        call = self._submit(method, params or [], lane)
+        return self._wait(call)
+
+    def request(self, method: str, params: Any = None, lane: Optional[int] = None) -> Any:
+        """Like call() but returns the result and raises RpcError on an error object"""
+        response = self.call(method, params, lane)
+        if response.get('error'):
+            raise RpcError(response['error'])
+        return response.get('result')
+
+    def call_many(self, requests: Sequence[Tuple[str, Any]], lane: Optional[int] = None) -> List[Dict[str, Any]]:
+        """
+        Queue several requests at once (so they share batches) and wait for all
+
+        Args:
+            requests: (method, params) pairs
+            lane: Priority lane for all of them
+
+        Returns:
+            Response dicts in request order
+        """
+        calls = [self._submit(method, params or [], lane) for method, params in requests]
+        return [self._wait(call) for call in calls]
+
+    def _resolve_lane(self, method: str, lane: Optional[int]) -> int:
+        if method in EXECUTION_METHODS:
+            return LANE_EXECUTION
+        if lane is None:
+            lane = _current_lane.get()
+        return LANE_MONITORING if lane is None else lane
+
+    def _submit(self, method: str, params: Any, lane: Optional[int]) -> _Call:
+        if not self._running:
+            self.start()
+        lane = self._resolve_lane(method, lane)
+        key = method + encode_json(params).decode() if method in COALESCED_METHODS else None
+        deadline = time.monotonic() + self.timeout * self.max_attempts
+        with self._cond:
+            self.stats['calls'] += 1
+            if key is not None:
+                existing = self._inflight.get(key)
+                if existing is not None:
+                    self.stats['coalesced'] += 1
+                    if lane < existing.lane and existing.queued:
+                        # A more urgent caller joined; re-push at its priority (the stale entry is skipped)
+                        existing.lane = lane
+                        self._push(existing)
+                    return existing
+            call = _Call(method, params, lane, key, deadline)
+            call.seq = next(self._seq)
+            if key is not None:
+                self._inflight[key] = call
+            self._push(call)
+        return call
+
+    def _push(self, call: _Call):
+        # Requeued calls keep their original sequence, so FIFO order within a lane survives
+        call.queued = True
+        heapq.heappush(self._heap, (call.lane, call.seq, call))
+        self._cond.notify()
+
+    def _wait(self, call: _Call) -> Dict[str, Any]:
+        if not call.done.wait(max(0.0, call.deadline - time.monotonic()) + self.timeout):
+            raise RpcUnavailable(f"{call.method} timed out in the RPC gateway")
+        if call.error is not None:
+            raise call.error
+        return call.response
+
+    def _finish(self, call: _Call, response: Optional[Dict[str, Any]] = None,
+                error: Optional[BaseException] = None):
+        with self._cond:
+            if call.key is not None and self._inflight.get(call.key) is call:
+                del self._inflight[call.key]
+            if error is not None:
+                self.stats['failed'] += 1
+        call.response = response
+        call.error = error
+        call.done.set()
+        # Queueing + network time per method, e.g. rpc.eth_call
+        metrics.record(f"rpc.{call.method}", time.perf_counter_ns() - call.submitted)
+
+    # ------------------------------------------------------------------ senders
+
+    def _pop_batch(self) -> Tuple[List[_Call], List[_Call]]:
+        """Highest-priority calls up to batch_max, and any found past their deadline (lock held)"""
+        batch: List[_Call] = []
+        expired: List[_Call] = []
+        now = time.monotonic()
+        while self._heap and len(batch) < self.batch_max:
+            lane, _, call = self._heap[0]
+            if not call.queued or lane != call.lane:
+                heapq.heappop(self._heap)  # superseded by a higher-priority re-push
+                continue
+            if call.method in UNBATCHED_METHODS and batch:
+                break
+            heapq.heappop(self._heap)
+            call.queued = False
+            if now > call.deadline:
+                expired.append(call)
+                continue
+            batch.append(call)
+            if call.method in UNBATCHED_METHODS:
+                break
+        return batch, expired
+
+    def _reserve(self, batch: List[_Call]) -> Tuple[Optional[Endpoint], int, float]:
+        """Pick the first healthy endpoint with tokens for the batch's lane"""
+        now = time.monotonic()
+        reserve = LANE_RESERVE[batch[0].lane]
+        wait = None
+        for endpoint in self.endpoints:
+            if not endpoint.healthy(now):
+                remaining = endpoint.cooldown_until - now
+                wait = remaining if wait is None else min(wait, remaining)
+                continue
+            taken = endpoint.bucket.take(len(batch), reserve)
+            if taken:
+                return endpoint, taken, 0.0
+            remaining = endpoint.bucket.wait_time(reserve)
+            wait = remaining if wait is None else min(wait, remaining)
+        return None, 0, max(wait or 0.0, 0.001)
+
+    def _worker(self):
+        while True:
+            with self._cond:
+                while self._running and not self._heap:
+                    self._cond.wait()
+                if not self._running:
+                    return
+                lane = self._heap[0][0]
+                if (self.batch_window and lane != LANE_EXECUTION and len(self._heap) < self.batch_max):
+                    # Give concurrent callers a moment to fill the batch
+                    self._cond.wait(self.batch_window)
+                batch, expired = self._pop_batch()
+                endpoint, taken, wait = self._reserve(batch) if batch else (None, 0, 0.0)
+                for call in batch[taken:]:
+                    self._push(call)
+                if batch and endpoint is None:
+                    self._cond.wait(wait)
+            for call in expired:
+                self._finish(call, error=RpcUnavailable(f"{call.method} exceeded its deadline"))
+            if endpoint is not None:
+                self._send(endpoint, batch[:taken])
+
+    def _send(self, endpoint: Endpoint, batch: List[_Call]):
+        ids = {}
+        payload = []
+        for call in batch:
+            request_id = next(self._ids)
+            ids[request_id] = call
+            payload.append({'jsonrpc': '2.0', 'id': request_id, 'method': call.method, 'params': call.params})
+        body = encode_json(payload if len(payload) > 1 else payload[0])
+
+        started = time.perf_counter_ns()
+        try:
+            decoded = self.transport(endpoint.url, body, self.timeout)
+        except Exception as e:
+            logger.warning(f"RPC endpoint {endpoint.url} failed ({e}); failing over")
+            with self._cond:
+                endpoint.mark_failed(time.monotonic())
+            self._retry(self._settle_ambiguous(batch, e), e)
+            return
+        finally:
+            metrics.record('rpc.batch', time.perf_counter_ns() - started)
+
+        responses = decoded if isinstance(decoded, list) else [decoded]
+        by_id = {response.get('id'): response for response in responses if isinstance(response, dict)}
+        retry = []
+        with self._cond:
+            endpoint.requests += len(batch)
+            endpoint.batches += 1
+            self.stats['batches'] += 1
+            rate_limited = any((r.get('error') or {}).get('code') in RATE_LIMIT_CODES for r in by_id.values())
+            if rate_limited:
+                endpoint.mark_failed(time.monotonic())
+            else:
+                endpoint.mark_ok()
+        dropped = []
+        for request_id, call in ids.items():
+            response = by_id.get(request_id)
+            if response is None:
+                dropped.append(call)
+            elif (response.get('error') or {}).get('code') in RATE_LIMIT_CODES:
+                retry.append(call)  # refused by the node, so safe to send again
+            else:
+                self._finish(call, response=response)
+        cause = TransportError(f"{endpoint.url} rate limited or dropped {len(retry) + len(dropped)} call(s)")
+        retry += self._settle_ambiguous(dropped, cause)
+        if retry:
+            self._retry(retry, cause)
+
+    def _settle_ambiguous(self, batch: List[_Call], cause: BaseException) -> List[_Call]:
+        """Fail non-idempotent calls whose request may have been delivered; return the rest for retry"""
+        retry = []
+        for call in batch:
+            if call.method in NON_IDEMPOTENT_METHODS:
+                self._finish(call, error=SendOutcomeUnknown(f"{call.method} may have been delivered: {cause}"))
+            else:
+                retry.append(call)
+        return retry
+
+    def _retry(self, batch: List[_Call], cause: BaseException):
+        requeue = []
+        for call in batch:
+            call.attempts += 1
+            if call.attempts >= self.max_attempts or time.monotonic() > call.deadline:
+                self._finish(call, error=RpcUnavailable(f"{call.method} failed on every endpoint: {cause}"))
+            else:
+                requeue.append(call)
+        with self._cond:
+            self.stats['retries'] += len(requeue)
+            for call in requeue:
+                self._push(call)
+
+    def get_status(self) -> Dict[str, Any]:
+        """Per-endpoint health/usage and per-lane queue depth"""
+        now = time.monotonic()
+        with self._cond:
+            queued = [0, 0, 0]
+            for lane, _, call in self._heap:
+                if call.queued and lane == call.lane:
+                    queued[lane] += 1
+            return {
+                **self.stats,
+                'queued': dict(zip(LANE_NAMES, queued)),
+                'endpoints': [{
+                    'url': endpoint.url,
+                    'healthy': endpoint.healthy(now),
+                    'requests': endpoint.requests,
+                    'batches': endpoint.batches,
+                    'errors': endpoint.errors,
+                } for endpoint in self.endpoints]
+            }
+
+
+try:
+    from web3.providers.base import JSONBaseProvider as _ProviderBase
+except ImportError:  # the gateway itself has no web3 dependency
+    _ProviderBase = object
+
+
+class GatewayProvider(_ProviderBase):
+    """web3 provider that sends every request through an RpcGateway"""
+
+    def __init__(self, gateway: RpcGateway, lane: int = LANE_MONITORING):
+        super().__init__()
+        self.gateway = gateway
+        self.lane = lane
+
+    def make_request(self, method, params):
+        lane = _current_lane.get()
+        return self.gateway.call(str(method), params, self.lane if lane is None else lane)
+
+    def is_connected(self, show_traceback: bool = False) -> bool:
+        try:
+            return 'result' in self.gateway.call('web3_clientVersion', [], self.lane)
+        except Exception as e:
+            if show_traceback:
+                raise
+            logger.debug(f"RPC gateway connectivity check failed: {e}")
+            return False
+
+    def __str__(self):
+        return f"RPC gateway {[endpoint.url for endpoint in self.gateway.endpoints]}"
+
+
+_shared: Dict[Tuple[str, ...], RpcGateway] = {}
+_shared_lock = threading.Lock()
+
+
+def shared_gateway(config: Config = None) -> RpcGateway:
+    """The process-wide gateway for config's endpoints (created on first use)"""
+    config = config or Config()
+    key = tuple(config.RPC_ENDPOINTS or [config.ETHEREUM_RPC_URL])
+    with _shared_lock:
+        gateway = _shared.get(key)
+        if gateway is None:
+            gateway = _shared[key] = RpcGateway(config, urls=key)
+        return gateway
+
+
+def release_shared_gateway(config: Config = None):
+    """Stop and forget the shared gateway for config's endpoints (short-lived nodes, tests)"""
+    config = config or Config()
+    key = tuple(config.RPC_ENDPOINTS or [config.ETHEREUM_RPC_URL])
+    with _shared_lock:
+        gateway = _shared.pop(key, None)
+    if gateway is not None:
+        gateway.stop()
+
+
+def make_web3(config: Config = None, lane: int = LANE_MONITORING):
+    """
+    Web3 for one component: through the shared gateway, or straight over a
+    persistent transport when RPC_GATEWAY_ENABLED is off
+
+    Args:
+        config: Configuration object
+        lane: Default lane for this component's calls
+    """
+    from web3 import Web3
+
+    config = config or Config()
+    if not config.RPC_GATEWAY_ENABLED:
+        return Web3(TransportProvider(config.ETHEREUM_RPC_URL, config=config))
+    return Web3(GatewayProvider(shared_gateway(config), lane))
@@ -0,0 +1,265 @@
+"""
+AsymmetricLP - Persistent RPC Transports
+Keep-alive HTTP (HTTP/2 when httpx with h2 is installed) and pipelined
+websocket transports behind one post(url, body, timeout) -> decoded JSON
+interface, used by the RPC gateway and by TransportProvider when the gateway
+is off. Responses are parsed with orjson when available.
+"""
+import itertools
+import json
+import logging
+import threading
+import time
+from typing import Any, Callable, Dict, Optional
+from config import Config
+from latency_metrics import metrics
+
+try:
+    import orjson
+
+    def decode_json(raw: bytes) -> Any:
+        return orjson.loads(raw)
+except ImportError:  # stdlib fallback
+    def decode_json(raw: bytes) -> Any:
+        return json.loads(raw)
+
+logger = logging.getLogger(__name__)
+
+
+class TransportError(Exception):
+    """Connection failure, timeout, HTTP 429 or 5xx from one endpoint"""
+
+
+def _json_default(value):
+    if isinstance(value, (bytes, bytearray)):
+        return '0x' + bytes(value).hex()
+    if hasattr(value, 'items'):
+        return dict(value.items())
+    raise TypeError(f"Cannot JSON-encode {type(value).__name__}")
+
+
+def encode_json(payload: Any) -> bytes:
+    """Compact JSON-RPC body; bytes (HexBytes) become 0x-hex, mappings (AttributeDict) dicts"""
+    return json.dumps(payload, default=_json_default, separators=(',', ':')).encode()
+
+
+def _http2_client(pool_size: int):
+    """httpx client with HTTP/2 multiplexing, or None if httpx/h2 are not installed"""
+    try:
+        import h2  # noqa: F401  (httpx only negotiates HTTP/2 when h2 is present)
+        import httpx
+    except ImportError:
+        return None
+    limits = httpx.Limits(max_connections=pool_size, max_keepalive_connections=pool_size)
+    return httpx.Client(http2=True, limits=limits)
+
+
+class HttpTransport:
+    """
+    Pooled keep-alive HTTP POSTs.
+
+    One client per process: connections are reused across calls and threads
+    (HTTP/2 multiplexes concurrent calls over one connection per host).
+    """
+
+    def __init__(self, pool_size: int = 8, http2: bool = False):
+        self.client = _http2_client(pool_size) if http2 else None
+        self.http2 = self.client is not None
+        if http2 and not self.http2:
+            logger.warning("RPC_HTTP2 is set but httpx[http2] is not installed; using HTTP/1.1 keep-alive")
+        if self.client is None:
+            import requests
+            from requests.adapters import HTTPAdapter
+
+            self.session = requests.Session()
+            adapter = HTTPAdapter(pool_connections=4, pool_maxsize=pool_size)
+            self.session.mount('http://', adapter)
+            self.session.mount('https://', adapter)
+            self._errors = (requests.RequestException,)
+        else:
+            import httpx
+            self._errors = (httpx.HTTPError,)
+
+    def __call__(self, url: str, body: bytes, timeout: float) -> Any:
+        started = time.perf_counter_ns()
+        try:
+            if self.client is not None:
+                response = self.client.post(url, content=body, timeout=timeout,
+                                            headers={'Content-Type': 'application/json'})
+                raw = response.content
+            else:
+                response = self.session.post(url, data=body, timeout=timeout,
+                                             headers={'Content-Type': 'application/json'})
+                raw = response.content
+        except self._errors as e:
+            raise TransportError(str(e)) from e
+        finally:
+            metrics.record('rpc.http', time.perf_counter_ns() - started)
+        if response.status_code == 429 or response.status_code >= 500:
+            raise TransportError(f"HTTP {response.status_code}")
+        try:
+            return decode_json(raw)
+        except ValueError as e:
+            raise TransportError(f"Invalid JSON from {url}: {e}") from e
+
+    def close(self):
+        if self.client is not None:
+            self.client.close()
+        else:
+            self.session.close()
+
+
+class _Pending:
+    __slots__ = ('done', 'value')
+
+    def __init__(self):
+        self.done = threading.Event()
+        self.value: Any = None
+
+
+class WebSocketTransport:
+    """
+    One persistent websocket per endpoint with pipelining.
+
+    Any number of threads send without waiting for earlier responses; a reader
+    thread hands each response (or batch, keyed by its first id) back to its
+    caller. A dropped connection fails the calls in flight and is reopened on
+    the next call.
+    """
+
+    def __init__(self, url: str, connect: Optional[Callable[[str], Any]] = None):
+        self.url = url
+        self._connect = connect
+        self._ws = None
+        self._lock = threading.Lock()
+        self._send_lock = threading.Lock()
+        self._pending: Dict[Any, _Pending] = {}
+        self.stats = {'connects': 0, 'in_flight_max': 0}
+
+    def _open(self):
+        with self._lock:
+            if self._ws is not None:
+                return self._ws
+            if self._connect is not None:
+                ws = self._connect(self.url)
+            else:
+                from websockets.sync.client import connect
+                ws = connect(self.url, max_size=None)
+            self._ws = ws
+            self.stats['connects'] += 1
+            threading.Thread(target=self._read, args=(ws,), name='rpc-ws-reader', daemon=True).start()
+            return ws
+
+    def _read(self, ws):
+        try:
+            for message in ws:
+                decoded = decode_json(message)
+                first = decoded[0] if isinstance(decoded, list) and decoded else decoded
+                key = first.get('id') if isinstance(first, dict) else None
+                with self._lock:
+                    pending = self._pending.pop(key, None)
+                if pending is not None:
+                    pending.value = decoded
+                    pending.done.set()
+        except Exception as e:
+            logger.warning(f"RPC websocket {self.url} closed: {e}")
+        finally:
+            with self._lock:
+                if self._ws is ws:
+                    self._ws = None
+                dropped = list(self._pending.values())
+                self._pending.clear()
+            for pending in dropped:
+                pending.done.set()  # value None -> TransportError in the caller
+
+    def __call__(self, url: str, body: bytes, timeout: float) -> Any:
+        started = time.perf_counter_ns()
+        payload = decode_json(body)
+        first = payload[0] if isinstance(payload, list) else payload
+        pending = _Pending()
+        try:
+            ws = self._open()
+            with self._lock:
+                self._pending[first['id']] = pending
+                self.stats['in_flight_max'] = max(self.stats['in_flight_max'], len(self._pending))
+            with self._send_lock:
+                ws.send(body.decode())
+        except Exception as e:
+            with self._lock:
+                self._pending.pop(first['id'], None)
+            raise TransportError(f"websocket send to {self.url} failed: {e}") from e
+        try:
+            if not pending.done.wait(timeout):
+                with self._lock:
+                    self._pending.pop(first['id'], None)
+                raise TransportError(f"websocket {self.url} timed out")
+            if pending.value is None:
+                raise TransportError(f"websocket {self.url} dropped the connection")
+            return pending.value
+        finally:
+            metrics.record('rpc.ws', time.perf_counter_ns() - started)
+
+    def close(self):
+        with self._lock:
+            ws, self._ws = self._ws, None
+        if ws is not None:
+            ws.close()
+
+
+class Transport:
+    """Routes each endpoint to a shared HTTP transport or its own websocket by URL scheme"""
+
+    def __init__(self, config: Config = None, pool_size: Optional[int] = None):
+        self.config = config or Config()
+        self.http = HttpTransport(pool_size or self.config.RPC_CONCURRENCY + 2, self.config.RPC_HTTP2)
+        self._websockets: Dict[str, WebSocketTransport] = {}
+        self._lock = threading.Lock()
+
+    def __call__(self, url: str, body: bytes, timeout: float) -> Any:
+        if url.startswith(('ws://', 'wss://')):
+            with self._lock:
+                ws = self._websockets.get(url)
+                if ws is None:
+                    ws = self._websockets[url] = WebSocketTransport(url)
+            return ws(url, body, timeout)
+        return self.http(url, body, timeout)
+
+    def close(self):
+        self.http.close()
+        for ws in self._websockets.values():
+            ws.close()
+
+
+try:
+    from web3.providers.base import JSONBaseProvider as _ProviderBase
+except ImportError:  # transports themselves have no web3 dependency
+    _ProviderBase = object
+
+
+class TransportProvider(_ProviderBase):
+    """web3 provider over a persistent Transport (used when the RPC gateway is off)"""
+
+    def __init__(self, url: str, transport: Optional[Transport] = None, config: Config = None,
+                 timeout: Optional[float] = None):
+        super().__init__()
+        self.url = url
+        self.transport = transport or Transport(config)
+        self.timeout = timeout or (config or Config()).RPC_TIMEOUT_SECONDS
+        self._ids = itertools.count(1)
+
+    def make_request(self, method, params):
+        body = encode_json({'jsonrpc': '2.0', 'id': next(self._ids), 'method': str(method), 'params': params})
+        with metrics.span(f"rpc.{method}"):
+            return self.transport(self.url, body, self.timeout)
+
+    def is_connected(self, show_traceback: bool = False) -> bool:
+        try:
+            return 'result' in self.make_request('web3_clientVersion', [])
+        except Exception as e:
+            if show_traceback:
+                raise
+            logger.debug(f"RPC connectivity check failed: {e}")
+            return False
+
+    def __str__(self):
+        return f"Persistent RPC transport {self.url}"
@@ -87,15 +87,11 @@ def run_coverage_report():
 
 
 def run_performance_tests():
-    """Run performance tests (if available)."""
+    """Run the microbenchmarks and fail on throughput regressions against benchmarks/baseline.json."""
     cmd = [
-        sys.executable, "-m", "pytest",
-        "tests/",
-        "-v",
-        "-m", "slow",
-        "--durations=10"
+        sys.executable, "benchmarks/run_benchmarks.py"
     ]
-    return run_command(cmd, "Running Performance Tests")
+    return run_command(cmd, "Running Benchmarks")
 
 
 def lint_code():
@@ -124,7 +120,7 @@ def main():
     parser.add_argument("--unit", action="store_true", help="Run unit tests only")
     parser.add_argument("--integration", action="store_true", help="Run integration tests only")
     parser.add_argument("--coverage", action="store_true", help="Generate coverage report")
-    parser.add_argument("--performance", action="store_true", help="Run performance tests")
+    parser.add_argument("--performance", action="store_true", help="Run benchmarks and check for regressions")
     parser.add_argument("--lint", action="store_true", help="Run code linting")
     parser.add_argument("--install", action="store_true", help="Install dependencies")
     parser.add_argument("--all", action="store_true", help="Run all tests and checks")
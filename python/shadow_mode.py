@@ -0,0 +1,1219 @@
+"""
+AsymmetricLP - Shadow / Paper-Trading Mode
+Replays a recorded newHeads + Swap stream through the real AutomatedRebalancer,
+which talks to a local mock JSON-RPC node instead of a live chain. Every
+monitoring tick is timed and every decision (and the transactions it would
+have sent) is recorded, so decision latency, throughput and rebalance counts
+can be checked offline before a deploy.
+
+The mock node is a paper chain: pool price, tick and liquidity follow the
+stream, and minted positions hold real V3 liquidity. Every recorded swap
+fills the ranges it crosses (principal moves between the two tokens at the
+range's curve and the fee tier accrues to tokensOwed), mints pull tokens
+from the paper wallet and collects pay them back, as on a live chain.
+
+compare_with_backtest runs BacktestEngine over the same OHLC file a replay
+was synthesized from (stream_from_ohlc) and diffs rebalance timestamps and
+ranges, so a deploy can check that live decisions track the backtest.
+
+Timing caveat: the rebalancer keeps wall-clock timestamps for its price
+history, so at speed-ups above 1x its volatility window covers a compressed
+slice of stream time. Decisions stay comparable to live, not to the backtest's
+per-candle clock, so band widths in a parity report can differ for that reason
+alone.
+"""
+import argparse
+import csv
+import json
+import logging
+import math
+import sys
+import threading
+import time
+from dataclasses import dataclass, field
+from datetime import datetime, timezone
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from typing import Any, Callable, Dict, Iterable, List, Optional, Tuple
+
+import rlp
+from eth_abi import decode, encode
+from eth_account import Account
+from eth_utils import keccak, to_checksum_address
+
+from config import Config
+from latency_metrics import Histogram, metrics
+from multicall3 import AGGREGATE3_SELECTOR, MULTICALL3_ADDRESS
+from position_calldata import (
+    function_selector, BURN_SELECTOR, COLLECT_SELECTOR, DECREASE_LIQUIDITY_SELECTOR,
+    MINT_SELECTOR, MULTICALL_SELECTOR
+)
+from price_feed import decode_swap_log
+from receipt_decoder import COLLECT_TOPIC, DECREASE_LIQUIDITY_TOPIC, INCREASE_LIQUIDITY_TOPIC, TRANSFER_TOPIC
+from rpc_gateway import release_shared_gateway
+
+logger = logging.getLogger(__name__)
+
+# Throwaway key for the paper wallet (never funded anywhere)
+SHADOW_PRIVATE_KEY = '0x' + '5a' * 32
+SHADOW_CHAIN_ID = 31337
+
+MINT_PARAMS = '(address,address,uint24,int24,int24,uint256,uint256,uint256,uint256,address,uint256)'
+
+Q96 = 1 << 96
+
+
+TX_NAMES = {
+    MINT_SELECTOR: 'mint',
+    DECREASE_LIQUIDITY_SELECTOR: 'decreaseLiquidity',
+    COLLECT_SELECTOR: 'collect',
+    BURN_SELECTOR: 'burn',
+    MULTICALL_SELECTOR: 'multicall'
+}
+
+SHADOW_GAS_USED = 180000
+
+ERROR_SELECTOR = keccak(text='Error(string)')[:4]
+
+
+class ShadowRevert(Exception):
+    """eth_call / transaction the paper chain does not implement"""
+
+
+def _address(n: int) -> str:
+    return to_checksum_address(f'0x{n:040x}')
+
+
+def _hex(value: int) -> str:
+    return hex(int(value))
+
+
+def _word(value: int) -> str:
+    return '0x' + int(value).to_bytes(32, 'big').hex()
+
+
+def _topic_address(address: str) -> str:
+    return '0x' + '00' * 12 + address.lower()[2:]
+
+
+def sqrt_price_x96_from_price(price: float, token0_decimals: int, token1_decimals: int) -> int:
+    """
+    Pool sqrtPriceX96 for a decimal-adjusted price (token1 per token0)
+
+    Args:
+        price: Human price, as in the backtest OHLC data
+        token0_decimals: Pool token0 decimals
+        token1_decimals: Pool token1 decimals
+
+    Returns:
+        sqrtPriceX96
+    """
+    raw = price / (10 ** (token0_decimals - token1_decimals))
+    return int(math.sqrt(raw) * (1 << 96))
+
+
+def tick_from_sqrt_price_x96(sqrt_price_x96: int) -> int:
+    """Tick at or below a sqrtPriceX96"""
+    return math.floor(math.log((sqrt_price_x96 / (1 << 96)) ** 2, 1.0001))
+
+
+def sqrt_price_x96_at_tick(tick: int) -> int:
+    """sqrtPriceX96 at a tick (same rounding as Utils.get_amounts_for_liquidity)"""
+    return int(math.sqrt(1.0001 ** tick) * Q96)
+
+
+def liquidity_for_amounts(sqrt_price_x96: int, tick_lower: int, tick_upper: int,
+                          amount0: int, amount1: int) -> int:
+    """
+    Largest liquidity the desired amounts can fund at the pool price (LiquidityAmounts)
+
+    Args:
+        sqrt_price_x96: Current pool sqrtPriceX96
+        tick_lower: Lower tick bound
+        tick_upper: Upper tick bound
+        amount0: Desired token0 (raw units)
+        amount1: Desired token1 (raw units)
+
+    Returns:
+        Position liquidity
+    """
+    sqrt_lower, sqrt_upper = sqrt_price_x96_at_tick(tick_lower), sqrt_price_x96_at_tick(tick_upper)
+
+    def from_amount0(lower: int, upper: int) -> int:
+        return amount0 * lower * upper // Q96 // (upper - lower)
+
+    def from_amount1(lower: int, upper: int) -> int:
+        return amount1 * Q96 // (upper - lower)
+
+    if sqrt_price_x96 <= sqrt_lower:
+        return from_amount0(sqrt_lower, sqrt_upper)
+    if sqrt_price_x96 < sqrt_upper:
+        return min(from_amount0(sqrt_price_x96, sqrt_upper), from_amount1(sqrt_lower, sqrt_price_x96))
+    return from_amount1(sqrt_lower, sqrt_upper)
+
+
+def amounts_for_liquidity(liquidity: int, sqrt_price_x96: int, tick_lower: int,
+                          tick_upper: int) -> Tuple[int, int]:
+    """Token amounts a position's liquidity is worth at a pool price (rounded down)"""
+    sqrt_lower, sqrt_upper = sqrt_price_x96_at_tick(tick_lower), sqrt_price_x96_at_tick(tick_upper)
+    sqrt_price = min(max(sqrt_price_x96, sqrt_lower), sqrt_upper)
+    amount0 = amount1 = 0
+    if sqrt_price < sqrt_upper:
+        amount0 = liquidity * Q96 * (sqrt_upper - sqrt_price) // (sqrt_upper * sqrt_price)
+    if sqrt_price > sqrt_lower:
+        amount1 = liquidity * (sqrt_price - sqrt_lower) // Q96
+    return amount0, amount1
+
+
+def price_at_tick(tick: int, token0_decimals: int, token1_decimals: int) -> float:
+    """Decimal-adjusted price (token1 per token0, as in OHLC data) at a raw pool tick"""
+    return 1.0001 ** tick * 10 ** (token0_decimals - token1_decimals)
+
+
+@dataclass
+class ShadowToken:
+    """ERC20 on the paper chain"""
+    address: str
+    symbol: str
+    decimals: int
+    balance: int = 0  # paper wallet balance in raw units
+
+
+@dataclass
+class ShadowTransaction:
+    """Transaction the rebalancer sent to the paper chain"""
+    tx_hash: str
+    nonce: int
+    to: str
+    names: List[str]
+    block_number: int
+    timestamp: float
+
+
+class ShadowChain:
+    """
+    In-memory chain state served by MockRpcServer
+
+    Holds one pool, its two tokens, the paper wallet's balances and the
+    positions minted during the replay. Positions carry V3 liquidity, so their
+    token amounts follow the pool price and recorded swaps through their range
+    accrue fees; mints and collects move tokens between them and the wallet.
+    All access goes through the lock because the RPC server answers from
+    multiple threads.
+    """
+
+    def __init__(self, token0: Optional[ShadowToken] = None, token1: Optional[ShadowToken] = None,
+                 fee: int = 500, wallet: Optional[str] = None, chain_id: int = SHADOW_CHAIN_ID,
+                 liquidity: int = 10 ** 18, base_fee: int = 10 ** 9):
+        """
+        Initialize the paper chain
+
+        Args:
+            token0: Pool token0 (defaults to a 6-decimal USDC stand-in)
+            token1: Pool token1 (defaults to an 18-decimal WETH stand-in)
+            fee: Pool fee tier
+            wallet: Paper wallet address (the rebalancer's account)
+            chain_id: Chain ID reported by eth_chainId
+            liquidity: Initial pool liquidity
+            base_fee: Initial base fee in wei
+        """
+        # token0 must sort below token1, as in a real pool
+        self.token0 = token0 or ShadowToken(_address(0xA0), 'USDC', 6, 3000 * 10 ** 6)
+        self.token1 = token1 or ShadowToken(_address(0xA1), 'WETH', 18, 10 ** 18)
+        if int(self.token0.address, 16) > int(self.token1.address, 16):
+            raise ValueError("token0 address must sort below token1")
+        self.tokens = {t.address.lower(): t for t in (self.token0, self.token1)}
+        self.fee = fee
+        self.wallet = to_checksum_address(wallet or Account.from_key(SHADOW_PRIVATE_KEY).address)
+        self.chain_id = chain_id
+
+        self.factory = _address(0xF0)
+        self.pool = _address(0xF1)
+        self.position_manager = _address(0xF2)
+        self.router = _address(0xF3)
+        self.multicall = to_checksum_address(MULTICALL3_ADDRESS)
+
+        self.block_number = 1
+        self.timestamp = int(time.time())
+        self.base_fee = base_fee
+        self.sqrt_price_x96 = 1 << 96
+        self.tick = 0
+        self.liquidity = liquidity
+
+        self.positions: Dict[int, Dict[str, Any]] = {}
+        self._next_token_id = 1
+        self.transactions: List[ShadowTransaction] = []
+        self.receipts: Dict[str, Dict[str, Any]] = {}
+        self.nonce = 0
+        self.swaps = 0
+        self._lock = threading.RLock()
+
+        self._views = {
+            self.factory.lower(): {function_selector('getPool(address,address,uint24)'): self._get_pool},
+            self.pool.lower(): {
+                function_selector('slot0()'): self._slot0,
+                function_selector('liquidity()'): lambda _: encode(['uint128'], [self.liquidity]),
+                function_selector('token0()'): lambda _: encode(['address'], [self.token0.address]),
+                function_selector('token1()'): lambda _: encode(['address'], [self.token1.address]),
+                function_selector('fee()'): lambda _: encode(['uint24'], [self.fee])
+            },
+            self.position_manager.lower(): {
+                function_selector('balanceOf(address)'): self._nft_balance,
+                function_selector('tokenOfOwnerByIndex(address,uint256)'): self._token_of_owner,
+                function_selector('positions(uint256)'): self._position
+            },
+            self.multicall.lower(): {AGGREGATE3_SELECTOR: self._aggregate3}
+        }
+        self._token_views = {
+            function_selector('decimals()'): lambda t, _: encode(['uint8'], [t.decimals]),
+            function_selector('symbol()'): lambda t, _: encode(['string'], [t.symbol]),
+            function_selector('name()'): lambda t, _: encode(['string'], [t.symbol]),
+            function_selector('balanceOf(address)'): self._token_balance
+        }
+
+    # ---- stream input ----
+
+    def set_price(self, price: float):
+        """Seed the pool at a decimal-adjusted price"""
+        with self._lock:
+            self.sqrt_price_x96 = sqrt_price_x96_from_price(price, self.token0.decimals, self.token1.decimals)
+            self.tick = tick_from_sqrt_price_x96(self.sqrt_price_x96)
+
+    def apply_head(self, number: int, timestamp: Optional[float] = None, base_fee: Optional[int] = None):
+        """Advance to a recorded block header"""
+        with self._lock:
+            self.block_number = max(self.block_number, int(number))
+            if timestamp is not None:
+                self.timestamp = int(timestamp)
+            if base_fee is not None:
+                self.base_fee = int(base_fee)
+
+    def apply_swap(self, event: Dict[str, Any]):
+        """Apply a recorded Swap (pool state after the swap) and fill the ranges it crossed"""
+        with self._lock:
+            self._fill_positions(self.sqrt_price_x96, int(event['sqrt_price_x96']))
+            self.sqrt_price_x96 = int(event['sqrt_price_x96'])
+            self.tick = int(event['tick'])
+            self.liquidity = int(event['liquidity'])
+            if event.get('block_number'):
+                self.block_number = max(self.block_number, int(event['block_number']))
+            self.swaps += 1
+
+    def _fill_positions(self, sqrt_from: int, sqrt_to: int):
+        """
+        Fill our positions along a price move (lock held)
+
+        Principal needs no bookkeeping: a position's amounts are a function of
+        its liquidity and the pool price. The swap input that crossed each
+        range pays the fee tier on top, which accrues to that position's
+        tokensOwed (a price rise is paid in token1, a fall in token0).
+        """
+        if sqrt_to == sqrt_from:
+            return
+        low, high = min(sqrt_from, sqrt_to), max(sqrt_from, sqrt_to)
+        for position in self.positions.values():
+            liquidity = position['liquidity']
+            a = max(low, sqrt_price_x96_at_tick(position['tick_lower']))
+            b = min(high, sqrt_price_x96_at_tick(position['tick_upper']))
+            if not liquidity or a >= b:
+                continue
+            if sqrt_to > sqrt_from:
+                amount_in = liquidity * (b - a) // Q96
+                position['owed1'] += amount_in * self.fee // (10 ** 6 - self.fee)
+            else:
+                amount_in = liquidity * Q96 * (b - a) // (a * b)
+                position['owed0'] += amount_in * self.fee // (10 ** 6 - self.fee)
+
+    def position_amounts(self, token_id: int) -> Tuple[int, int]:
+        """Principal (amount0, amount1) of a position at the current pool price"""
+        with self._lock:
+            position = self._require_position(token_id)
+            return amounts_for_liquidity(position['liquidity'], self.sqrt_price_x96,
+                                         position['tick_lower'], position['tick_upper'])
+
+    def position_ranges(self) -> List[List[int]]:
+        """[tick_lower, tick_upper] of every live position, lowest first"""
+        with self._lock:
+            return sorted([p['tick_lower'], p['tick_upper']] for p in self.positions.values())
+
+    # ---- eth_call ----
+
+    def call(self, to: str, data: bytes) -> bytes:
+        """
+        Execute a view call
+
+        Raises:
+            ShadowRevert: If the target or selector is not implemented
+        """
+        selector, args = data[:4], data[4:]
+        with self._lock:
+            if to.lower() == self.position_manager.lower() and selector in TX_NAMES:
+                return self._simulate(data)
+            token = self.tokens.get(to.lower())
+            if token is not None and selector in self._token_views:
+                return self._token_views[selector](token, args)
+            handler = self._views.get(to.lower(), {}).get(selector)
+            if handler is None:
+                raise ShadowRevert(f"no paper implementation for {to} selector 0x{selector.hex()}")
+            return handler(args)
+
+    def _simulate(self, data: bytes) -> bytes:
+        """eth_call of position-manager writes: run them, keep the return data, discard the effects"""
+        saved = self._snapshot()
+        try:
+            return self._execute(data, [])[1]
+        finally:
+            self._restore(saved)
+
+    def _snapshot(self) -> Tuple[Dict[int, Dict[str, Any]], int, int, int]:
+        return ({token_id: dict(p) for token_id, p in self.positions.items()}, self._next_token_id,
+                self.token0.balance, self.token1.balance)
+
+    def _restore(self, saved: Tuple[Dict[int, Dict[str, Any]], int, int, int]):
+        self.positions, self._next_token_id, self.token0.balance, self.token1.balance = saved
+
+    def _get_pool(self, args: bytes) -> bytes:
+        a, b, fee = decode(['address', 'address', 'uint24'], args)
+        pair = {a.lower(), b.lower()}
+        if pair == set(self.tokens) and fee == self.fee:
+            return encode(['address'], [self.pool])
+        return encode(['address'], ['0x' + '00' * 20])
+
+    def _slot0(self, _args: bytes) -> bytes:
+        return encode(['uint160', 'int24', 'uint16', 'uint16', 'uint16', 'uint8', 'bool'],
+                      [self.sqrt_price_x96, self.tick, 0, 1, 1, 0, True])
+
+    def _token_balance(self, token: ShadowToken, args: bytes) -> bytes:
+        (owner,) = decode(['address'], args)
+        return encode(['uint256'], [token.balance if owner.lower() == self.wallet.lower() else 0])
+
+    def _owned_positions(self, owner: str) -> List[int]:
+        return sorted(self.positions) if owner.lower() == self.wallet.lower() else []
+
+    def _nft_balance(self, args: bytes) -> bytes:
+        (owner,) = decode(['address'], args)
+        return encode(['uint256'], [len(self._owned_positions(owner))])
+
+    def _token_of_owner(self, args: bytes) -> bytes:
+        owner, index = decode(['address', 'uint256'], args)
+        owned = self._owned_positions(owner)
+        if index >= len(owned):
+            raise ShadowRevert('ERC721Enumerable: owner index out of bounds')
+        return encode(['uint256'], [owned[index]])
+
+    def _position(self, args: bytes) -> bytes:
+        (token_id,) = decode(['uint256'], args)
+        position = self.positions.get(token_id)
+        if position is None:
+            raise ShadowRevert('Invalid token ID')
+        return encode(
+            ['uint96', 'address', 'address', 'address', 'uint24', 'int24', 'int24', 'uint128',
+             'uint256', 'uint256', 'uint128', 'uint128'],
+            [0, '0x' + '00' * 20, self.token0.address, self.token1.address, self.fee,
+             position['tick_lower'], position['tick_upper'], position['liquidity'],
+             0, 0, position['owed0'], position['owed1']]
+        )
+
+    def _aggregate3(self, args: bytes) -> bytes:
+        (calls,) = decode(['(address,bool,bytes)[]'], args)
+        results = []
+        for target, allow_failure, calldata in calls:
+            try:
+                results.append((True, self.call(target, bytes(calldata))))
+            except ShadowRevert:
+                if not allow_failure:
+                    raise
+                results.append((False, b''))
+        return encode(['(bool,bytes)[]'], [results])
+
+    # ---- transactions ----
+
+    def send_raw_transaction(self, raw: bytes) -> str:
+        """
+        Include a signed transaction in the next block and build its receipt
+
+        Returns:
+            Transaction hash
+        """
+        nonce, to, data = decode_raw_transaction(raw)
+        tx_hash = '0x' + keccak(raw).hex()
+        with self._lock:
+            block_number = self.block_number + 1
+            logs: List[Dict[str, Any]] = []
+            status = 1
+            if to and to.lower() == self.position_manager.lower():
+                saved = self._snapshot()
+                try:
+                    names = self._execute(data, logs)[0]
+                except ShadowRevert as e:
+                    # Reverted transactions are still mined, with no effects
+                    logger.warning(f"Shadow transaction {tx_hash} reverted: {e}")
+                    self._restore(saved)
+                    names, logs, status = [TX_NAMES.get(data[:4], '0x' + data[:4].hex())], [], 0
+            else:
+                names = ['0x' + data[:4].hex()]
+            block_hash = _word(block_number)
+            for index, log in enumerate(logs):
+                log.update({
+                    'blockNumber': _hex(block_number), 'blockHash': block_hash,
+                    'transactionHash': tx_hash, 'transactionIndex': '0x0',
+                    'logIndex': _hex(index), 'removed': False
+                })
+            self.receipts[tx_hash] = {
+                'transactionHash': tx_hash, 'transactionIndex': '0x0',
+                'blockHash': block_hash, 'blockNumber': _hex(block_number),
+                'from': self.wallet, 'to': to, 'contractAddress': None,
+                'cumulativeGasUsed': _hex(SHADOW_GAS_USED), 'gasUsed': _hex(SHADOW_GAS_USED),
+                'effectiveGasPrice': _hex(self.base_fee + 10 ** 9),
+                'logs': logs, 'logsBloom': '0x' + '00' * 256, 'status': _hex(status), 'type': '0x2'
+            }
+            self.nonce = max(self.nonce, nonce + 1)
+            self.transactions.append(ShadowTransaction(tx_hash, nonce, to, names, block_number, time.time()))
+        return tx_hash
+
+    def _execute(self, data: bytes, logs: List[Dict[str, Any]]) -> Tuple[List[str], bytes]:
+        """
+        Apply position-manager calldata to the paper positions (lock held)
+
+        Returns:
+            (operation names, ABI-encoded return data)
+        """
+        selector, args = data[:4], data[4:]
+        if selector == MULTICALL_SELECTOR:
+            (calls,) = decode(['bytes[]'], args)
+            names, results = [], []
+            for call in calls:
+                call_names, result = self._execute(bytes(call), logs)
+                names.extend(call_names)
+                results.append(result)
+            return names, encode(['bytes[]'], [results])
+
+        result = b''
+        if selector == MINT_SELECTOR:
+            (params,) = decode([MINT_PARAMS], args)
+            _, _, _, tick_lower, tick_upper, desired0, desired1, amount0_min, amount1_min, recipient, _ = params
+            if tick_lower >= tick_upper:
+                raise ShadowRevert('TLU')
+            liquidity = liquidity_for_amounts(self.sqrt_price_x96, tick_lower, tick_upper, desired0, desired1)
+            if liquidity == 0:
+                raise ShadowRevert('zero liquidity')
+            amount0, amount1 = amounts_for_liquidity(liquidity, self.sqrt_price_x96, tick_lower, tick_upper)
+            if amount0 < amount0_min or amount1 < amount1_min:
+                raise ShadowRevert('Price slippage check')
+            if amount0 > self.token0.balance or amount1 > self.token1.balance:
+                raise ShadowRevert('STF')
+            self.token0.balance -= amount0
+            self.token1.balance -= amount1
+            token_id = self._next_token_id
+            self._next_token_id += 1
+            self.positions[token_id] = {
+                'tick_lower': tick_lower, 'tick_upper': tick_upper, 'liquidity': liquidity,
+                'owed0': 0, 'owed1': 0
+            }
+            logs.append(self._log([TRANSFER_TOPIC, b'\x00' * 32, bytes.fromhex(_topic_address(recipient)[2:]),
+                                   token_id.to_bytes(32, 'big')], b''))
+            logs.append(self._log([INCREASE_LIQUIDITY_TOPIC, token_id.to_bytes(32, 'big')],
+                                  encode(['uint128', 'uint256', 'uint256'], [liquidity, amount0, amount1])))
+            result = encode(['uint256', 'uint128', 'uint256', 'uint256'], [token_id, liquidity, amount0, amount1])
+        elif selector == DECREASE_LIQUIDITY_SELECTOR:
+            ((token_id, liquidity, _, _, _),) = decode(['(uint256,uint128,uint256,uint256,uint256)'], args)
+            position = self._require_position(token_id)
+            liquidity = min(liquidity, position['liquidity'])
+            amount0, amount1 = amounts_for_liquidity(liquidity, self.sqrt_price_x96,
+                                                     position['tick_lower'], position['tick_upper'])
+            position['liquidity'] -= liquidity
+            position['owed0'] += amount0
+            position['owed1'] += amount1
+            logs.append(self._log([DECREASE_LIQUIDITY_TOPIC, token_id.to_bytes(32, 'big')],
+                                  encode(['uint128', 'uint256', 'uint256'], [liquidity, amount0, amount1])))
+            result = encode(['uint256', 'uint256'], [amount0, amount1])
+        elif selector == COLLECT_SELECTOR:
+            ((token_id, recipient, max0, max1),) = decode(['(uint256,address,uint128,uint128)'], args)
+            position = self._require_position(token_id)
+            amount0, amount1 = min(max0, position['owed0']), min(max1, position['owed1'])
+            position['owed0'] -= amount0
+            position['owed1'] -= amount1
+            if recipient.lower() == self.wallet.lower():
+                self.token0.balance += amount0
+                self.token1.balance += amount1
+            logs.append(self._log([COLLECT_TOPIC, token_id.to_bytes(32, 'big')],
+                                  encode(['address', 'uint256', 'uint256'], [recipient, amount0, amount1])))
+            result = encode(['uint256', 'uint256'], [amount0, amount1])
+        elif selector == BURN_SELECTOR:
+            (token_id,) = decode(['uint256'], args)
+            position = self._require_position(token_id)
+            if position['liquidity'] or position['owed0'] or position['owed1']:
+                raise ShadowRevert('Not cleared')
+            del self.positions[token_id]
+            logs.append(self._log([TRANSFER_TOPIC, bytes.fromhex(_topic_address(self.wallet)[2:]),
+                                   b'\x00' * 32, token_id.to_bytes(32, 'big')], b''))
+        return [TX_NAMES.get(selector, '0x' + selector.hex())], result
+
+    def _require_position(self, token_id: int) -> Dict[str, Any]:
+        position = self.positions.get(token_id)
+        if position is None:
+            raise ShadowRevert('Invalid token ID')
+        return position
+
+    def _log(self, topics: List[bytes], data: bytes) -> Dict[str, Any]:
+        return {
+            'address': self.position_manager,
+            'topics': ['0x' + bytes(t).hex() for t in topics],
+            'data': '0x' + data.hex()
+        }
+
+    # ---- blocks ----
+
+    def block(self, number: Optional[int] = None) -> Dict[str, Any]:
+        """Header-only block in JSON-RPC form"""
+        with self._lock:
+            number = self.block_number if number is None else number
+            return {
+                'number': _hex(number), 'hash': _word(number), 'parentHash': _word(max(number - 1, 0)),
+                'timestamp': _hex(self.timestamp), 'baseFeePerGas': _hex(self.base_fee),
+                'gasLimit': _hex(30_000_000), 'gasUsed': _hex(15_000_000),
+                'miner': '0x' + '00' * 20, 'difficulty': '0x0', 'totalDifficulty': '0x0',
+                'extraData': '0x', 'logsBloom': '0x' + '00' * 256, 'mixHash': _word(0),
+                'nonce': '0x0000000000000000', 'receiptsRoot': _word(0), 'sha3Uncles': _word(0),
+                'stateRoot': _word(0), 'transactionsRoot': _word(0), 'size': '0x0',
+                'transactions': [], 'uncles': []
+            }
+
+
+def decode_raw_transaction(raw: bytes) -> Tuple[int, Optional[str], bytes]:
+    """
+    Extract (nonce, to, data) from a signed legacy, EIP-2930 or EIP-1559 transaction
+
+    Raises:
+        ShadowRevert: For other transaction types
+    """
+    if raw[0] == 2:
+        fields = rlp.decode(raw[1:])
+        nonce, to, data = fields[1], fields[5], fields[7]
+    elif raw[0] == 1:
+        fields = rlp.decode(raw[1:])
+        nonce, to, data = fields[1], fields[4], fields[6]
+    elif raw[0] >= 0xc0:
+        fields = rlp.decode(raw)
+        nonce, to, data = fields[0], fields[3], fields[5]
+    else:
+        raise ShadowRevert(f"unsupported transaction type {raw[0]}")
+    return (int.from_bytes(nonce, 'big'),
+            to_checksum_address(to) if to else None,
+            bytes(data))
+
+
+class MockRpcServer:
+    """
+    Local JSON-RPC node over HTTP backed by a ShadowChain
+
+    Implements the subset of methods the rebalancer, executor and fee
+    oracle use; anything else returns -32601 so gaps show up in the logs.
+    """
+
+    def __init__(self, chain: ShadowChain, host: str = '127.0.0.1', port: int = 0):
+        self.chain = chain
+        self.host = host
+        self.port = port
+        self.requests = 0
+        self._server: Optional[ThreadingHTTPServer] = None
+        self._thread: Optional[threading.Thread] = None
+        self._methods: Dict[str, Callable[[List[Any]], Any]] = {
+            'web3_clientVersion': lambda p: 'AsymmetricLP-shadow/1.0',
+            'net_version': lambda p: str(chain.chain_id),
+            'eth_chainId': lambda p: _hex(chain.chain_id),
+            'eth_blockNumber': lambda p: _hex(chain.block_number),
+            'eth_getBlockByNumber': self._get_block,
+            'eth_call': self._call,
+            'eth_estimateGas': lambda p: _hex(SHADOW_GAS_USED),
+            'eth_gasPrice': lambda p: _hex(chain.base_fee + 10 ** 9),
+            'eth_maxPriorityFeePerGas': lambda p: _hex(10 ** 9),
+            'eth_feeHistory': self._fee_history,
+            'eth_getBalance': self._get_balance,
+            'eth_getTransactionCount': lambda p: _hex(chain.nonce),
+            'eth_sendRawTransaction': self._send_raw_transaction,
+            'eth_getTransactionReceipt': lambda p: chain.receipts.get(p[0])
+        }
+
+    @property
+    def url(self) -> str:
+        return f'http://{self.host}:{self.port}'
+
+    def start(self):
+        server = self
+
+        class Handler(BaseHTTPRequestHandler):
+            protocol_version = 'HTTP/1.1'  # keep-alive, like a real provider
+
+            def log_message(self, *args):
+                pass
+
+            def do_POST(self):
+                length = int(self.headers.get('Content-Length', 0))
+                request = json.loads(self.rfile.read(length))
+                if isinstance(request, list):
+                    response = [server.handle(r) for r in request]
+                else:
+                    response = server.handle(request)
+                body = json.dumps(response).encode()
+                self.send_response(200)
+                self.send_header('Content-Type', 'application/json')
+                self.send_header('Content-Length', str(len(body)))
+                self.end_headers()
+                self.wfile.write(body)
+
+        self._server = ThreadingHTTPServer((self.host, self.port), Handler)
+        self.port = self._server.server_address[1]
+        self._thread = threading.Thread(target=self._server.serve_forever, name='shadow-rpc', daemon=True)
+        self._thread.start()
+        logger.info(f"Shadow RPC listening at {self.url}")
+
+    def stop(self):
+        if self._server:
+            self._server.shutdown()
+            self._server.server_close()
+            self._server = None
+        if self._thread:
+            self._thread.join(timeout=2)
+            self._thread = None
+
+    def handle(self, request: Dict[str, Any]) -> Dict[str, Any]:
+        """Answer one JSON-RPC request object"""
+        self.requests += 1
+        response = {'jsonrpc': '2.0', 'id': request.get('id')}
+        method = self._methods.get(request.get('method'))
+        if method is None:
+            response['error'] = {'code': -32601, 'message': f"method {request.get('method')} not supported"}
+            return response
+        try:
+            response['result'] = method(request.get('params') or [])
+        except ShadowRevert as e:
+            revert_data = ERROR_SELECTOR + encode(['string'], [str(e)])
+            response['error'] = {'code': 3, 'message': f'execution reverted: {e}', 'data': '0x' + revert_data.hex()}
+        except Exception as e:
+            logger.error(f"Shadow RPC {request.get('method')} failed: {e}")
+            response['error'] = {'code': -32603, 'message': str(e)}
+        return response
+
+    def _get_block(self, params: List[Any]) -> Dict[str, Any]:
+        tag = params[0] if params else 'latest'
+        number = None if tag in ('latest', 'pending', 'safe', 'finalized') else int(tag, 16)
+        return self.chain.block(number)
+
+    def _call(self, params: List[Any]) -> str:
+        tx = params[0]
+        data = tx.get('data') or tx.get('input') or '0x'
+        return '0x' + self.chain.call(tx['to'], bytes.fromhex(data[2:])).hex()
+
+    def _fee_history(self, params: List[Any]) -> Dict[str, Any]:
+        count = int(params[0], 16) if isinstance(params[0], str) else int(params[0])
+        percentiles = params[2] if len(params) > 2 else []
+        oldest = max(self.chain.block_number - count + 1, 0)
+        return {
+            'oldestBlock': _hex(oldest),
+            'baseFeePerGas': [_hex(self.chain.base_fee)] * (count + 1),
+            'gasUsedRatio': [0.5] * count,
+            'reward': [[_hex(10 ** 9)] * len(percentiles) for _ in range(count)]
+        }
+
+    def _get_balance(self, params: List[Any]) -> str:
+        # The paper wallet's native balance mirrors its WETH (token1) balance
+        owner = params[0]
+        return _hex(self.chain.token1.balance if owner.lower() == self.chain.wallet.lower() else 0)
+
+    def _send_raw_transaction(self, params: List[Any]) -> str:
+        raw = params[0]
+        return self.chain.send_raw_transaction(bytes.fromhex(raw[2:] if raw.startswith('0x') else raw))
+
+
+# ---- streams ----
+
+def normalize_event(event: Dict[str, Any]) -> Dict[str, Any]:
+    """
+    Normalize one recorded event to a 'head' or 'swap' dict
+
+    Accepted forms:
+        {'type': 'head', 'number', 'timestamp', 'base_fee'?}
+        {'type': 'swap', 'block_number', 'log_index', 'timestamp', 'sqrt_price_x96', 'tick', 'liquidity'}
+        {'type': 'log', 'timestamp', 'log': <raw JSON-RPC Swap log>}
+    """
+    kind = event.get('type')
+    if kind == 'log':
+        state = decode_swap_log(event['log'])
+        return {
+            'type': 'swap', 'timestamp': float(event['timestamp']),
+            'block_number': state.block_number, 'log_index': state.log_index,
+            'sqrt_price_x96': state.sqrt_price_x96, 'tick': state.tick, 'liquidity': state.liquidity
+        }
+    if kind == 'head':
+        number = event['number']
+        return {
+            'type': 'head', 'timestamp': float(event['timestamp']),
+            'number': int(number, 16) if isinstance(number, str) else int(number),
+            'base_fee': event.get('base_fee')
+        }
+    if kind == 'swap':
+        return dict(event, timestamp=float(event['timestamp']))
+    raise ValueError(f"Unknown stream event type: {kind}")
+
+
+def load_stream(path: str) -> List[Dict[str, Any]]:
+    """
+    Load a recorded JSONL stream (one event per line, in stream order)
+
+    Args:
+        path: JSONL file
+
+    Returns:
+        Normalized events
+    """
+    with open(path) as f:
+        return [normalize_event(json.loads(line)) for line in f if line.strip()]
+
+
+def stream_from_ohlc(csv_path: str, token0_decimals: int = 6, token1_decimals: int = 18,
+                     liquidity: int = 10 ** 18, start_block: int = 1,
+                     block_time: int = 12) -> List[Dict[str, Any]]:
+    """
+    Synthesize a head + swap per candle from backtest OHLC data
+
+    The close price becomes the pool price, so a replay sees the same price
+    path as the backtest for that file.
+
+    Args:
+        csv_path: Backtest CSV (timestamp, open, high, low, close, volume)
+        token0_decimals: Pool token0 decimals
+        token1_decimals: Pool token1 decimals
+        liquidity: Pool liquidity reported with every swap
+        start_block: Block number of the first candle
+        block_time: Seconds per block, used to space block numbers
+
+    Returns:
+        Normalized events
+    """
+    events = []
+    first_ts = None
+    with open(csv_path) as f:
+        for index, row in enumerate(csv.DictReader(f)):
+            ts = datetime.fromisoformat(row['timestamp']).replace(tzinfo=timezone.utc).timestamp()
+            first_ts = ts if first_ts is None else first_ts
+            block_number = start_block + int((ts - first_ts) // block_time) + index
+            sqrt_price_x96 = sqrt_price_x96_from_price(float(row['close']), token0_decimals, token1_decimals)
+            events.append({'type': 'head', 'timestamp': ts, 'number': block_number, 'base_fee': None})
+            events.append({
+                'type': 'swap', 'timestamp': ts, 'block_number': block_number, 'log_index': 0,
+                'sqrt_price_x96': sqrt_price_x96, 'tick': tick_from_sqrt_price_x96(sqrt_price_x96),
+                'liquidity': liquidity
+            })
+    return events
+
+
+# ---- runner ----
+
+@dataclass
+class ShadowReport:
+    """Outcome of one replay"""
+    decisions: List[Dict[str, Any]] = field(default_factory=list)
+    heads: int = 0
+    ticks: int = 0
+    rebalances: int = 0
+    transactions: int = 0
+    errors: int = 0
+    rpc_requests: int = 0
+    stream_seconds: float = 0.0
+    wall_seconds: float = 0.0
+    speedup: float = 0.0
+    max_lag_ms: float = 0.0
+    latency: Dict[str, float] = field(default_factory=dict)
+    spans: Dict[str, Dict[str, float]] = field(default_factory=dict)
+    # Timestamp and [tick_lower, tick_upper] ranges of the mint before the first tick
+    initial_mint: Optional[Dict[str, Any]] = None
+
+    @property
+    def achieved_speedup(self) -> float:
+        return self.stream_seconds / self.wall_seconds if self.wall_seconds else 0.0
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Summary without the per-tick decisions"""
+        return {
+            'heads': self.heads, 'ticks': self.ticks, 'rebalances': self.rebalances,
+            'transactions': self.transactions, 'errors': self.errors,
+            'rpc_requests': self.rpc_requests,
+            'stream_seconds': self.stream_seconds, 'wall_seconds': self.wall_seconds,
+            'speedup': self.speedup, 'achieved_speedup': self.achieved_speedup,
+            'max_lag_ms': self.max_lag_ms, 'tick_latency': self.latency, 'spans': self.spans,
+            'initial_mint': self.initial_mint
+        }
+
+    def write_decisions(self, path: str):
+        """Write one JSON line per monitoring tick"""
+        with open(path, 'w') as f:
+            for decision in self.decisions:
+                f.write(json.dumps(decision) + '\n')
+
+
+class ShadowRunner:
+    """Replays a stream through a rebalancer wired to the paper chain"""
+
+    def __init__(self, events: Iterable[Dict[str, Any]], speedup: float = 1.0,
+                 chain: Optional[ShadowChain] = None,
+                 config_overrides: Optional[Dict[str, Any]] = None,
+                 rebalancer_factory: Optional[Callable[[type], Any]] = None):
+        """
+        Initialize the runner
+
+        Args:
+            events: Normalized stream events (see normalize_event)
+            speedup: Stream seconds per wall second (0 replays as fast as possible)
+            chain: Paper chain (a default USDC/WETH chain if None)
+            config_overrides: Extra Config attributes (model, thresholds, ...)
+            rebalancer_factory: Builds the rebalancer from the shadow Config class
+                                (AutomatedRebalancer if None)
+        """
+        self.events = list(events)
+        self.speedup = speedup
+        self.chain = chain or ShadowChain()
+        self.config_overrides = config_overrides or {}
+        self.rebalancer_factory = rebalancer_factory
+        self.server = MockRpcServer(self.chain)
+
+    def build_config(self) -> type:
+        """Config subclass pointing the live stack at the paper chain with side effects off"""
+        chain = self.chain
+        overrides = {
+            'ETHEREUM_RPC_URL': self.server.url,
+            'PRIVATE_KEY': SHADOW_PRIVATE_KEY,
+            'CHAIN_ID': chain.chain_id,
+            'CHAIN_NAME': 'Shadow',
+            'TOKEN_A_ADDRESS': chain.token0.address,
+            'TOKEN_B_ADDRESS': chain.token1.address,
+            'FEE_TIER': chain.fee,
+            'UNISWAP_V3_FACTORY': chain.factory,
+            'UNISWAP_V3_POSITION_MANAGER': chain.position_manager,
+            'UNISWAP_V3_ROUTER': chain.router,
+            'WETH_ADDRESS': chain.token1.address,
+            'MULTICALL3_ADDRESS': chain.multicall,
+            'PRICE_FEED_WS_URL': '',
+            'REBALANCE_WAL_PATH': '',
+            'ZMQ_ENABLED': False,
+            'INVENTORY_SHM_RING_PATH': '',
+            'INVENTORY_SNAPSHOT_PATH': '',
+            'TELEGRAM_ENABLED': False,
+            'FEE_ORACLE_ENABLED': False,
+            'METRICS_PORT': 0,
+            'METRICS_SUMMARY_INTERVAL_SECONDS': 0,
+            'RECEIPT_POLL_INTERVAL_SECONDS': 0.01,
+            # The paper node has no quota; keep the gateway in the path without throttling it
+            'RPC_ENDPOINTS': [],
+            'RPC_RATE_LIMIT_PER_SECOND': 1e6,
+            'RPC_BURST': 1e6,
+            'RPC_BATCH_WINDOW_MS': 0
+        }
+        overrides.update(self.config_overrides)
+        return type('ShadowConfig', (Config,), overrides)
+
+    def _build_rebalancer(self, config: type):
+        if self.rebalancer_factory:
+            return self.rebalancer_factory(config)
+        from automated_rebalancer import AutomatedRebalancer
+        return AutomatedRebalancer(config())
+
+    def run(self) -> ShadowReport:
+        """
+        Replay the stream
+
+        Returns:
+            ShadowReport with per-tick decisions and latency
+        """
+        report = ShadowReport(speedup=self.speedup)
+        if not self.events:
+            return report
+
+        first_swap = next((e for e in self.events if e['type'] == 'swap'), None)
+        if first_swap:
+            self.chain.apply_swap(first_swap)
+        first_head = next((e for e in self.events if e['type'] == 'head'), None)
+        if first_head:
+            self.chain.apply_head(first_head['number'], first_head['timestamp'], first_head.get('base_fee'))
+
+        self.server.start()
+        rebalancer = None
+        config = self.build_config()
+        try:
+            rebalancer = self._build_rebalancer(config)
+            token0, token1, fee = self.chain.token0.address, self.chain.token1.address, self.chain.fee
+            if not rebalancer.initialize_positions():
+                raise RuntimeError("Shadow rebalancer failed to initialize positions")
+            report.initial_mint = {'timestamp': self.events[0]['timestamp'],
+                                   'ranges': self.chain.position_ranges()}
+            metrics.reset()
+            report = self._replay(rebalancer, token0, token1, fee, report)
+        finally:
+            self._close_rebalancer(rebalancer)
+            release_shared_gateway(config)
+            report.rpc_requests = self.server.requests
+            self.server.stop()
+        return report
+
+    def _replay(self, rebalancer, token0: str, token1: str, fee: int, report: ShadowReport) -> ShadowReport:
+        latency = Histogram()
+        t0 = self.events[0]['timestamp']
+        started = time.perf_counter()
+
+        for event in self.events:
+            offset = event['timestamp'] - t0
+            if self.speedup:
+                deadline = started + offset / self.speedup
+                delay = deadline - time.perf_counter()
+                if delay > 0:
+                    time.sleep(delay)
+                else:
+                    report.max_lag_ms = max(report.max_lag_ms, -delay * 1000)
+
+            if event['type'] == 'head':
+                self.chain.apply_head(event['number'], event['timestamp'], event.get('base_fee'))
+                rebalancer.client.on_new_head({'number': event['number'], 'timestamp': int(event['timestamp'])})
+                report.heads += 1
+                continue
+
+            self.chain.apply_swap(event)
+            spot_price = rebalancer._sqrt_price_to_spot(event['sqrt_price_x96'], token0, token1)
+            tx_before = len(self.chain.transactions)
+            last_rebalance = rebalancer.last_rebalance_time
+
+            tick_start = time.perf_counter_ns()
+            try:
+                rebalancer.monitoring_tick(token0, token1, fee, spot_price=spot_price)
+                error = None
+            except Exception as e:
+                logger.error(f"Shadow tick failed at block {event.get('block_number')}: {e}")
+                report.errors += 1
+                error = str(e)
+            elapsed_ns = time.perf_counter_ns() - tick_start
+            latency.record(elapsed_ns)
+
+            sent = self.chain.transactions[tx_before:]
+            rebalanced = rebalancer.last_rebalance_time != last_rebalance
+            report.ticks += 1
+            report.rebalances += int(rebalanced)
+            report.transactions += len(sent)
+            decision = {
+                'timestamp': event['timestamp'],
+                'block_number': event.get('block_number'),
+                'spot_price': spot_price,
+                'rebalanced': rebalanced,
+                'transactions': [name for tx in sent for name in tx.names],
+                'latency_us': elapsed_ns / 1000
+            }
+            if rebalanced:
+                decision['ranges'] = self.chain.position_ranges()
+            if error:
+                decision['error'] = error
+            report.decisions.append(decision)
+
+        report.wall_seconds = time.perf_counter() - started
+        report.stream_seconds = self.events[-1]['timestamp'] - t0
+        report.latency = {
+            'count': latency.count, 'mean_us': latency.mean / 1000,
+            'p50_us': latency.quantile(0.5) / 1000, 'p99_us': latency.quantile(0.99) / 1000,
+            'max_us': latency.max / 1000
+        }
+        report.spans = metrics.summary()
+        logger.info(f"Shadow replay: {report.ticks} ticks, {report.rebalances} rebalances, "
+                    f"p50={report.latency['p50_us']:.0f}µs p99={report.latency['p99_us']:.0f}µs, "
+                    f"{report.achieved_speedup:.1f}x")
+        return report
+
+    @staticmethod
+    def _close_rebalancer(rebalancer):
+        if rebalancer is None:
+            return
+        for name in ('alert_manager', 'inventory_publisher'):
+            component = getattr(rebalancer, name, None)
+            close = getattr(component, 'close', None)
+            if callable(close):
+                try:
+                    close()
+                except Exception as e:
+                    logger.warning(f"Failed to close {name}: {e}")
+
+
+# ---- backtest parity ----
+
+@dataclass
+class ParityReport:
+    """Shadow rebalances diffed against a backtest over the same OHLC data"""
+    shadow: int = 0
+    backtest: int = 0
+    matched: int = 0
+    only_shadow: List[float] = field(default_factory=list)
+    only_backtest: List[float] = field(default_factory=list)
+    range_mismatches: List[Dict[str, Any]] = field(default_factory=list)
+
+    @property
+    def ok(self) -> bool:
+        return not (self.only_shadow or self.only_backtest or self.range_mismatches)
+
+    def to_dict(self) -> Dict[str, Any]:
+        return {
+            'ok': self.ok, 'shadow_rebalances': self.shadow, 'backtest_rebalances': self.backtest,
+            'matched': self.matched, 'only_shadow': self.only_shadow, 'only_backtest': self.only_backtest,
+            'range_mismatches': self.range_mismatches
+        }
+
+
+def shadow_rebalances(report: ShadowReport, token0_decimals: int = 6,
+                      token1_decimals: int = 18) -> List[Tuple[float, List[List[float]]]]:
+    """
+    Initial mint and rebalances of a replay as (timestamp, price bands)
+
+    Bands are [lower, upper] decimal-adjusted prices (the OHLC data's units),
+    lowest first.
+    """
+    def bands(ranges):
+        return [[price_at_tick(lower, token0_decimals, token1_decimals),
+                 price_at_tick(upper, token0_decimals, token1_decimals)] for lower, upper in ranges]
+
+    events = []
+    if report.initial_mint and report.initial_mint['ranges']:
+        events.append((report.initial_mint['timestamp'], bands(report.initial_mint['ranges'])))
+    events.extend((d['timestamp'], bands(d.get('ranges', []))) for d in report.decisions if d['rebalanced'])
+    return events
+
+
+def backtest_rebalances(ohlc_path: str, initial_balance_0: float, initial_balance_1: float,
+                        config) -> List[Tuple[float, List[List[float]]]]:
+    """
+    Run BacktestEngine over an OHLC file and return its rebalances as (timestamp, price bands)
+
+    Args:
+        ohlc_path: Backtest CSV
+        initial_balance_0: Starting token0 balance
+        initial_balance_1: Starting token1 balance
+        config: Config instance for the engine (FEE_TIER in bps)
+    """
+    from backtest_engine import BacktestEngine
+    engine = BacktestEngine(config)
+    bands: List[List[List[float]]] = []
+    rebalance = engine.rebalance_positions
+
+    # Rebalance records carry percentages only; the bands are on the positions
+    def recording(current_price, timestamp, amm_simulator):
+        result = rebalance(current_price, timestamp, amm_simulator)
+        bands.append(sorted([p.tick_lower, p.tick_upper] for p in engine.positions))
+        return result
+
+    engine.rebalance_positions = recording
+    result = engine.run_backtest(ohlc_path, initial_balance_0, initial_balance_1)
+    return [(r['timestamp'].replace(tzinfo=timezone.utc).timestamp(), b)
+            for r, b in zip(result.rebalances, bands) if b]
+
+
+def diff_rebalances(shadow: List[Tuple[float, List[List[float]]]],
+                    backtest: List[Tuple[float, List[List[float]]]],
+                    tick_tolerance: float = 10) -> ParityReport:
+    """
+    Pair rebalances by timestamp and compare their bands
+
+    Args:
+        shadow: shadow_rebalances output
+        backtest: backtest_rebalances output
+        tick_tolerance: Allowed band edge difference in ticks (live ranges are
+                        aligned to the pool's tick spacing, the backtest's are not)
+
+    Returns:
+        ParityReport
+    """
+    parity = ParityReport(shadow=len(shadow), backtest=len(backtest))
+    backtest_bands = dict(backtest)
+    shadow_bands = dict(shadow)
+    parity.only_shadow = [ts for ts, _ in shadow if ts not in backtest_bands]
+    parity.only_backtest = [ts for ts, _ in backtest if ts not in shadow_bands]
+    for ts, bands in shadow:
+        expected = backtest_bands.get(ts)
+        if expected is None:
+            continue
+        if len(bands) != len(expected):
+            worst = float('inf')
+        else:
+            worst = max((abs(math.log(a / b, 1.0001)) for band, other in zip(bands, expected)
+                         for a, b in zip(band, other)), default=0.0)
+        if worst > tick_tolerance:
+            parity.range_mismatches.append({'timestamp': ts, 'shadow': bands, 'backtest': expected,
+                                            'max_ticks': worst})
+        else:
+            parity.matched += 1
+    return parity
+
+
+def compare_with_backtest(report: ShadowReport, ohlc_path: str, initial_balance_0: float,
+                          initial_balance_1: float, config_overrides: Optional[Dict[str, Any]] = None,
+                          fee: int = 500, token0_decimals: int = 6, token1_decimals: int = 18,
+                          tick_tolerance: float = 10) -> ParityReport:
+    """
+    Backtest the OHLC file a replay was synthesized from and diff the rebalances
+
+    Args:
+        report: ShadowReport of a replay of stream_from_ohlc(ohlc_path)
+        ohlc_path: Backtest CSV
+        initial_balance_0: Starting token0 balance (the paper wallet's)
+        initial_balance_1: Starting token1 balance (the paper wallet's)
+        config_overrides: Config attributes the replay ran with (model, thresholds, ...)
+        fee: Pool fee in hundredths of a bip (the backtest takes bps)
+        token0_decimals: Pool token0 decimals
+        token1_decimals: Pool token1 decimals
+        tick_tolerance: Allowed band edge difference in ticks
+
+    Returns:
+        ParityReport
+    """
+    config = type('ParityConfig', (Config,), dict(config_overrides or {}, FEE_TIER=fee // 100))()
+    backtest = backtest_rebalances(ohlc_path, initial_balance_0, initial_balance_1, config)
+    parity = diff_rebalances(shadow_rebalances(report, token0_decimals, token1_decimals), backtest,
+                             tick_tolerance)
+    logger.info(f"Backtest parity: {parity.matched} matched, {len(parity.only_shadow)} shadow-only, "
+                f"{len(parity.only_backtest)} backtest-only, {len(parity.range_mismatches)} range mismatches")
+    return parity
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Replay a recorded swap stream through the live rebalancer')
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument('--stream', help='Recorded JSONL stream of head/swap/log events')
+    source.add_argument('--ohlc', help='Backtest OHLC CSV to synthesize a stream from')
+    parser.add_argument('--speedup', type=float, default=1.0,
+                        help='Stream seconds per wall second (0 = as fast as possible)')
+    parser.add_argument('--model', help='Inventory model (overrides INVENTORY_MODEL)')
+    parser.add_argument('--token0-balance', type=float, default=3000.0, help='Paper token0 balance')
+    parser.add_argument('--token1-balance', type=float, default=1.0, help='Paper token1 balance')
+    parser.add_argument('--out', help='Write per-tick decisions as JSONL')
+    parser.add_argument('--parity', action='store_true',
+                        help='Backtest the --ohlc file and diff rebalance timestamps and ranges (exit 1 on a difference)')
+    parser.add_argument('--tick-tolerance', type=float, default=10,
+                        help='Allowed band edge difference in ticks for --parity')
+    args = parser.parse_args()
+    if args.parity and not args.ohlc:
+        parser.error('--parity needs --ohlc')
+
+    logging.basicConfig(level=logging.WARNING)
+    events = load_stream(args.stream) if args.stream else stream_from_ohlc(args.ohlc)
+    chain = ShadowChain()
+    chain.token0.balance = int(args.token0_balance * 10 ** chain.token0.decimals)
+    chain.token1.balance = int(args.token1_balance * 10 ** chain.token1.decimals)
+    overrides = {'INVENTORY_MODEL': args.model} if args.model else {}
+
+    report = ShadowRunner(events, speedup=args.speedup, chain=chain, config_overrides=overrides).run()
+    if args.out:
+        report.write_decisions(args.out)
+    summary = report.to_dict()
+    parity = None
+    if args.parity:
+        parity = compare_with_backtest(report, args.ohlc, args.token0_balance, args.token1_balance, overrides,
+                                       fee=chain.fee, token0_decimals=chain.token0.decimals,
+                                       token1_decimals=chain.token1.decimals, tick_tolerance=args.tick_tolerance)
+        summary['parity'] = parity.to_dict()
+    print(json.dumps(summary, indent=2))
+    return 0 if parity is None or parity.ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,196 @@
+"""
+AsymmetricLP - Block-Versioned State Cache
+Caches on-chain reads keyed by (contract, call, args, block). Immutable data
+(pool addresses, decimals, token order) is pinned for the life of the process;
+mutable data is valid only for the block it was read at. Concurrent identical
+reads are collapsed into one RPC (single-flight).
+"""
+import logging
+import threading
+import time
+from typing import Any, Callable, Dict, Hashable, Optional, Tuple
+from config import Config
+
+logger = logging.getLogger(__name__)
+
+
+class _Flight:
+    """An in-progress load shared by every caller asking for the same key"""
+
+    def __init__(self):
+        self.done = threading.Event()
+        self.value: Any = None
+        self.error: Optional[BaseException] = None
+
+
+class StateCache:
+    """
+    Per-block cache for contract reads.
+
+    The current block comes from new-head notifications (on_new_block) when a
+    subscription is running; otherwise eth_blockNumber is read at most once
+    per STATE_CACHE_BLOCK_POLL_SECONDS.
+    """
+
+    def __init__(self, w3, config: Config = None):
+        """
+        Initialize the state cache
+
+        Args:
+            w3: Web3 instance (used only to read the block number)
+            config: Configuration object
+        """
+        self.w3 = w3
+        self.config = config or Config()
+        self.block_poll_interval = self.config.STATE_CACHE_BLOCK_POLL_SECONDS
+
+        self._lock = threading.Lock()
+        self._pinned: Dict[Hashable, Any] = {}
+        self._mutable: Dict[Hashable, Tuple[int, Any]] = {}
+        self._flights: Dict[Hashable, _Flight] = {}
+
+        self._block: Optional[int] = None
+        self._block_checked_at = 0.0
+        self._head_pushed_at = 0.0
+
+        self.stats = {'hits': 0, 'misses': 0, 'coalesced': 0, 'invalidations': 0}
+
+    # ------------------------------------------------------------------ blocks
+
+    def on_new_block(self, block_number: int):
+        """
+        New-head hook: advance the cache to a new block
+
+        Args:
+            block_number: Number of the new head
+        """
+        with self._lock:
+            self._head_pushed_at = time.time()
+            if self._block is None or block_number > self._block:
+                self._advance(block_number)
+
+    def _advance(self, block_number: int):
+        """Move to a new block and drop entries read at older blocks (lock held)"""
+        self._block = block_number
+        self._block_checked_at = time.time()
+        self._mutable = {k: v for k, v in self._mutable.items() if v[0] >= block_number}
+
+    def current_block(self) -> int:
+        """
+        Block number mutable entries are currently keyed by
+
+        Returns:
+            Latest known block number
+        """
+        now = time.time()
+        with self._lock:
+            # Pushed heads are authoritative while they keep arriving
+            fresh = now - max(self._block_checked_at, self._head_pushed_at) < self.block_poll_interval
+            if self._block is not None and fresh:
+                return self._block
+        block_number = self.get('eth', 'blockNumber', (), lambda: int(self.w3.eth.block_number), mutable=None)
+        with self._lock:
+            if self._block is None or block_number > self._block:
+                self._advance(block_number)
+            else:
+                self._block_checked_at = now
+            return self._block
+
+    # ------------------------------------------------------------------ reads
+
+    def get(self, contract: str, call: str, args: Tuple, loader: Callable[[], Any],
+            mutable: Optional[bool] = True) -> Any:
+        """
+        Read through the cache
+
+        Args:
+            contract: Contract address (or namespace)
+            call: Function name
+            args: Hashable call arguments
+            loader: Performs the actual read on a miss
+            mutable: True for per-block state, False to pin forever,
+                     None for an uncached but still single-flight read
+
+        Returns:
+            Cached or freshly loaded value
+        """
+        key = (contract.lower() if isinstance(contract, str) else contract, call, args)
+
+        if mutable is None:
+            return self._single_flight(('uncached',) + key, loader)
+
+        if not mutable:
+            with self._lock:
+                if key in self._pinned:
+                    self.stats['hits'] += 1
+                    return self._pinned[key]
+            value = self._single_flight(key, loader)
+            with self._lock:
+                self._pinned[key] = value
+            return value
+
+        block_number = self.current_block()
+        with self._lock:
+            entry = self._mutable.get(key)
+            if entry is not None and entry[0] == block_number:
+                self.stats['hits'] += 1
+                return entry[1]
+        value = self._single_flight(key + (block_number,), loader)
+        with self._lock:
+            # A newer block may have arrived while loading; never overwrite a newer entry
+            entry = self._mutable.get(key)
+            if entry is None or entry[0] <= block_number:
+                self._mutable[key] = (block_number, value)
+        return value
+
+    def _single_flight(self, flight_key: Hashable, loader: Callable[[], Any]) -> Any:
+        """Run loader once per key even when several threads ask concurrently"""
+        with self._lock:
+            flight = self._flights.get(flight_key)
+            leader = flight is None
+            if leader:
+                flight = _Flight()
+                self._flights[flight_key] = flight
+                self.stats['misses'] += 1
+            else:
+                self.stats['coalesced'] += 1
+
+        if leader:
+            try:
+                flight.value = loader()
+            except BaseException as e:
+                flight.error = e
+            finally:
+                with self._lock:
+                    self._flights.pop(flight_key, None)
+                flight.done.set()
+        else:
+            flight.done.wait()
+
+        if flight.error is not None:
+            raise flight.error
+        return flight.value
+
+    # ------------------------------------------------------------------ invalidation
+
+    def invalidate(self, contract: Optional[str] = None):
+        """
+        Drop mutable entries (e.g. after our own transaction was mined)
+
+        Args:
+            contract: Only drop entries for this contract (all if None)
+        """
+        with self._lock:
+            if contract is None:
+                self._mutable.clear()
+            else:
+                contract = contract.lower()
+                self._mutable = {k: v for k, v in self._mutable.items() if k[0] != contract}
+            # Force the next read to re-check a polled head (pushed heads stay authoritative)
+            self._block_checked_at = 0.0
+            self.stats['invalidations'] += 1
+
+    def get_stats(self) -> Dict[str, Any]:
+        """Cache counters and sizes"""
+        with self._lock:
+            return dict(self.stats, pinned=len(self._pinned), mutable=len(self._mutable), block=self._block)
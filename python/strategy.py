@@ -57,6 +57,54 @@ class AsymmetricLPStrategy:
         if last_rebalance_token0 is None or last_rebalance_token1 is None or last_rebalance_price is None:
             return False
         
+        dev0, dev1, price_dev = self._trigger_deviations(
+            current_price, current_token0, current_token1,
+            last_rebalance_token0, last_rebalance_token1, last_rebalance_price
+        )
+        
+        thresh = self.config.REBALANCE_THRESHOLD
+        
+        # Rebalance if any threshold is exceeded
+        return (dev0 > thresh) or (dev1 > thresh) or (price_dev > thresh)
+
+    def rebalance_urgency(
+        self,
+        current_price: Optional[float],
+        current_token0: Optional[float],
+        current_token1: Optional[float],
+        last_rebalance_token0: Optional[float] = None,
+        last_rebalance_token1: Optional[float] = None,
+        last_rebalance_price: Optional[float] = None,
+        has_positions: bool = True,
+    ) -> float:
+        """
+        How close the should_rebalance trigger is, for scheduling many pools.
+
+        Returns:
+            Largest trigger deviation divided by REBALANCE_THRESHOLD (above 1.0
+            means should_rebalance would fire); inf when the first mint is due,
+            0.0 while there is no baseline yet
+        """
+        if not has_positions:
+            return math.inf
+        if current_price is None or last_rebalance_price is None \
+                or last_rebalance_token0 is None or last_rebalance_token1 is None:
+            return 0.0
+        # Unknown balances (not read yet) only count the price leg
+        dev0, dev1, price_dev = self._trigger_deviations(
+            current_price,
+            last_rebalance_token0 if current_token0 is None else current_token0,
+            last_rebalance_token1 if current_token1 is None else current_token1,
+            last_rebalance_token0, last_rebalance_token1, last_rebalance_price
+        )
+        thresh = self.config.REBALANCE_THRESHOLD
+        return max(dev0, dev1, price_dev) / thresh if thresh > 0 else math.inf
+
+    @staticmethod
+    def _trigger_deviations(current_price: float, current_token0: float, current_token1: float,
+                            last_rebalance_token0: float, last_rebalance_token1: float,
+                            last_rebalance_price: float) -> Tuple[float, float, float]:
+        """Per-token depletion and price deviation from the last rebalance baselines"""
         # Edge-triggered per-token depletion from last rebalance baselines
         cur0 = max(current_token0, 0.0)
         cur1 = max(current_token1, 0.0)
@@ -69,11 +117,7 @@ class AsymmetricLPStrategy:
         
         # Price deviation from last rebalance price
         price_dev = abs(current_price - last_rebalance_price) / last_rebalance_price if last_rebalance_price else 0.0
-        
-        thresh = self.config.REBALANCE_THRESHOLD
-        
-        # Rebalance if any threshold is exceeded
-        return (dev0 > thresh) or (dev1 > thresh) or (price_dev > thresh)
+        return dev0, dev1, price_dev
 
     def plan_rebalance(
         self,
@@ -0,0 +1,198 @@
+"""Unit tests for the non-blocking Telegram alert queue."""
+import json
+import sys
+import os
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from unittest.mock import Mock
+from urllib.parse import parse_qs
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from alert_manager import TelegramAlertManager
+
+
+class FakeTelegram:
+    """Local stand-in for the Bot API that records sendMessage calls"""
+
+    def __init__(self):
+        self.messages = []
+        self.delay = 0.0
+        self.responses = []  # queued (status, body) overrides for sendMessage
+        self.gate = threading.Event()
+        self.gate.set()
+        fake = self
+
+        class Handler(BaseHTTPRequestHandler):
+            def log_message(self, *args):
+                pass
+
+            def _reply(self, status, body):
+                payload = json.dumps(body).encode()
+                self.send_response(status)
+                self.send_header('Content-Type', 'application/json')
+                self.send_header('Content-Length', str(len(payload)))
+                self.end_headers()
+                self.wfile.write(payload)
+
+            def do_GET(self):
+                self._reply(200, {'ok': True, 'result': {'username': 'test_bot'}})
+
+            def do_POST(self):
+                length = int(self.headers.get('Content-Length', 0))
+                form = parse_qs(self.rfile.read(length).decode())
+                fake.gate.wait(5)
+                time.sleep(fake.delay)
+                if fake.responses:
+                    status, body = fake.responses.pop(0)
+                    self._reply(status, body)
+                    return
+                fake.messages.append(form['text'][0])
+                self._reply(200, {'ok': True})
+
+        self.server = ThreadingHTTPServer(('127.0.0.1', 0), Handler)
+        self.url = f'http://127.0.0.1:{self.server.server_address[1]}'
+        self.thread = threading.Thread(target=self.server.serve_forever, daemon=True)
+        self.thread.start()
+
+    def close(self):
+        self.gate.set()
+        self.server.shutdown()
+        self.server.server_close()
+
+
+def make_config(api_url, **overrides):
+    config = Mock()
+    config.TELEGRAM_BOT_TOKEN = 'token'
+    config.TELEGRAM_CHAT_ID = '42'
+    config.TELEGRAM_ENABLED = True
+    config.TELEGRAM_API_URL = api_url
+    config.ALERT_QUEUE_SIZE = 16
+    config.ALERT_COALESCE_WINDOW_SECONDS = 0.0
+    config.ALERT_RATE_LIMIT_PER_MINUTE = 600
+    config.ALERT_SEND_TIMEOUT_SECONDS = 2.0
+    for key, value in overrides.items():
+        setattr(config, key, value)
+    return config
+
+
+class TestTelegramAlertManager:
+    """Test queueing, coalescing, rate limiting and drop policy."""
+
+    def setup_method(self):
+        self.telegram = FakeTelegram()
+        self.managers = []
+
+    def teardown_method(self):
+        for manager in self.managers:
+            manager.close(timeout=1)
+        self.telegram.close()
+
+    def make_manager(self, **overrides):
+        manager = TelegramAlertManager(make_config(self.telegram.url, **overrides))
+        self.managers.append(manager)
+        return manager
+
+    def test_disabled_does_not_queue(self):
+        config = make_config(self.telegram.url, TELEGRAM_ENABLED=False)
+        manager = TelegramAlertManager(config)
+        assert manager.send_error_notification('RPC', 'down') is False
+        assert manager.get_stats()['queued'] == 0
+
+    def test_enqueue_does_not_wait_for_slow_api(self):
+        self.telegram.delay = 0.3
+        manager = self.make_manager()
+        started = time.perf_counter()
+        for i in range(5):
+            assert manager.send_critical_alert(f'Alert {i}', 'slow api')
+        elapsed = time.perf_counter() - started
+        assert elapsed < 0.05
+        assert manager.get_stats()['queued'] == 5
+
+    def test_messages_delivered_in_order(self):
+        manager = self.make_manager()
+        manager.send_startup_notification('WETH', 'USDC', 'mainnet', '0x' + 'ab' * 20)
+        manager.send_rebalance_notification('WETH', 'USDC', 2000.0, 0.5,
+                                             {'token_a_range': 5.0, 'token_b_range': 7.0}, {}, 210000)
+        assert manager.flush(timeout=5)
+        assert len(self.telegram.messages) == 2
+        assert 'Rebalancer Started' in self.telegram.messages[0]
+        assert 'Rebalance Completed' in self.telegram.messages[1]
+        assert manager.get_stats()['sent'] == 2
+
+    def test_repeated_errors_are_coalesced(self):
+        self.telegram.gate.clear()
+        manager = self.make_manager()
+        manager.send_error_notification('RPC', 'first')  # picked up, blocked in flight
+        time.sleep(0.1)
+        for i in range(10):
+            manager.send_error_notification('RPC', f'repeat {i}')
+        manager.send_error_notification('Other', 'distinct')
+        self.telegram.gate.set()
+        assert manager.flush(timeout=5)
+
+        assert len(self.telegram.messages) == 3
+        assert 'Repeated 10×' in self.telegram.messages[1]
+        assert 'distinct' in self.telegram.messages[2]
+        assert manager.get_stats()['coalesced'] == 9
+
+    def test_coalesce_window_delays_repeat(self):
+        manager = self.make_manager(ALERT_COALESCE_WINDOW_SECONDS=0.5)
+        manager.send_error_notification('RPC', 'first')
+        assert manager.flush(timeout=5)
+        sent_at = time.monotonic()
+        manager.send_error_notification('RPC', 'second')
+        assert manager.flush(timeout=5)
+        assert time.monotonic() - sent_at >= 0.4
+        assert len(self.telegram.messages) == 2
+
+    def test_full_queue_drops_oldest_non_critical(self):
+        self.telegram.gate.clear()
+        manager = self.make_manager(ALERT_QUEUE_SIZE=2)
+        manager.send_shutdown_notification('in flight')  # occupies the sender
+        time.sleep(0.1)
+        manager.send_error_notification('Error A', 'first')
+        manager.send_critical_alert('Critical 1', 'kept')
+        manager.send_error_notification('Error B', 'evicts A')
+        manager.send_critical_alert('Critical 2', 'kept, evicts B')
+        assert manager.send_error_notification('Error C', 'rejected') is False
+        assert manager.send_critical_alert('Critical 3', 'kept beyond the bound')
+        self.telegram.gate.set()
+        assert manager.flush(timeout=5)
+
+        assert manager.get_stats()['dropped'] == 3
+        joined = '\n'.join(self.telegram.messages)
+        assert 'Error A' not in joined and 'Error B' not in joined and 'Error C' not in joined
+        assert all(f'Critical {i}' in joined for i in (1, 2, 3))
+
+    def test_rate_limit_defers_sends(self):
+        manager = self.make_manager(ALERT_RATE_LIMIT_PER_MINUTE=2)
+        for i in range(3):
+            manager.send_critical_alert(f'Alert {i}', 'burst', action_required=False)
+        assert not manager.flush(timeout=0.5)
+        assert len(self.telegram.messages) == 2
+        assert manager.get_stats()['rate_limited'] >= 1
+
+    def test_zero_rate_limit_disables_limit(self):
+        manager = self.make_manager(ALERT_RATE_LIMIT_PER_MINUTE=0)
+        for i in range(5):
+            manager.send_critical_alert(f'Alert {i}', 'burst', action_required=False)
+        assert manager.flush(timeout=5)
+        assert len(self.telegram.messages) == 5
+        assert manager.get_stats()['rate_limited'] == 0
+
+    def test_retry_after_is_honoured(self):
+        self.telegram.responses = [(429, {'ok': False, 'parameters': {'retry_after': 0}})]
+        manager = self.make_manager()
+        manager.send_error_notification('RPC', 'retried')
+        assert manager.flush(timeout=5)
+        assert len(self.telegram.messages) == 1
+        assert manager.get_stats()['failed'] == 0
+
+    def test_close_drains_queue(self):
+        manager = self.make_manager(ALERT_COALESCE_WINDOW_SECONDS=60)
+        manager.send_error_notification('RPC', 'one')
+        assert manager.flush(timeout=5)
+        manager.send_error_notification('RPC', 'held by window')
+        manager.close(timeout=5)
+        assert len(self.telegram.messages) == 2
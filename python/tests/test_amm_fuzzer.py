@@ -0,0 +1,79 @@
+"""Unit tests for the AMM invariant fuzzer."""
+import importlib.util
+import os
+import sys
+
+import pytest
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from amm import UniswapV3SingleSidedRange
+from amm_fuzzer import fuzz, run_sequence, shrink, write_reproducer
+
+
+def _double_fees(monkeypatch):
+    """Break the AMM: credit every swap fee twice"""
+    settle = UniswapV3SingleSidedRange.settle
+
+    def broken_settle(self, record):
+        self.fees_token0 *= 2
+        self.fees_token1 *= 2
+        return settle(self, record)
+    monkeypatch.setattr(UniswapV3SingleSidedRange, 'settle', broken_settle)
+
+
+class TestInvariants:
+    """Test the invariants against hand-written sequences."""
+
+    def test_round_trip_through_both_bands(self):
+        steps = [('mint', 3000.0, 0.05, 0.05, 1000.0, 0.5),
+                 ('swap', 3100.0), ('swap', 3200.0), ('swap', 3000.0),
+                 ('swap', 2900.0), ('swap', 2500.0), ('swap', 3000.0), ('swap', 3000.0)]
+        for fee_tier in (1, 5, 30, 100):
+            assert run_sequence(steps, fee_tier) is None
+
+    def test_remint_and_edges(self):
+        steps = [('mint', 1.0, 1e-6, 0.95, 0.0, 1e12), ('swap', 0.05), ('swap', 1e-9),
+                 ('mint', 1e-9, 0.5, 0.5, 1e-9, 0.0), ('swap', 1.5e-9), ('swap', 1e-3)]
+        assert run_sequence(steps) is None
+
+    def test_short_fuzz_run_is_clean(self):
+        stats = fuzz(seed=7, seconds=30, max_sequences=200)
+        assert stats.sequences == 200
+        assert stats.failures == 0
+
+
+class TestShrinking:
+    """Test that a broken AMM is caught, shrunk and written out."""
+
+    def test_broken_fees_are_caught_and_shrunk(self, monkeypatch, tmp_path):
+        _double_fees(monkeypatch)
+        found = []
+        stats = fuzz(seed=3, seconds=30, max_sequences=500,
+                     on_failure=lambda steps, violation, fee: found.append((steps, violation, fee)))
+        assert stats.failures == 1
+        steps, violation, fee_tier = found[0]
+        assert violation.invariant in ('fee_growth', 'conservation')
+        assert len(steps) <= 3
+        assert steps[0][0] == 'mint'
+
+        path = write_reproducer(str(tmp_path), steps, violation, fee_tier, seed=3)
+        assert os.path.basename(path).startswith(f"test_amm_repro_{violation.invariant}_")
+        spec = importlib.util.spec_from_file_location('repro', path)
+        repro = importlib.util.module_from_spec(spec)
+        spec.loader.exec_module(repro)
+        test = getattr(repro, f"test_{violation.invariant}")
+        with pytest.raises(AssertionError):
+            test()
+        monkeypatch.undo()
+        test()
+
+    def test_shrink_keeps_the_same_invariant(self, monkeypatch):
+        _double_fees(monkeypatch)
+        steps = [('mint', 3123.456789, 0.0712345, 0.1234567, 1234.5678, 0.87654321)]
+        steps += [('swap', 3123.456789 * (1 + 0.001 * i)) for i in range(1, 40)]
+        violation = run_sequence(steps)
+        assert violation is not None
+        shrunk, shrunk_violation = shrink(steps, violation)
+        assert shrunk_violation.invariant == violation.invariant
+        assert len(shrunk) == 2
+        assert run_sequence(shrunk).invariant == violation.invariant
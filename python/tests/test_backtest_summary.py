@@ -0,0 +1,75 @@
+"""Unit tests for summary-only (streaming) backtests."""
+import os
+import sys
+import tracemalloc
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from backtest_engine import BacktestEngine
+from backtest_summary import DownsampledSeries, StreamingSummary
+from config import Config
+
+HERE = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DATA_3DAYS = os.path.join(HERE, 'data', 'eth_usdc_3days_real_fixed.csv')
+DATA_3WEEKS = os.path.join(HERE, 'data', 'eth_usdc_3weeks_real_fixed.csv')
+
+
+def _engine():
+    return BacktestEngine(type('TestConfig', (Config,), {'INVENTORY_MODEL': 'GLFTModel'})())
+
+
+class TestStreamingAggregates:
+    """Test the fixed-size aggregates."""
+
+    def test_downsampled_series_stays_bounded_and_even(self):
+        series = DownsampledSeries(max_points=8)
+        for i in range(1000):
+            series.add(i, float(i))
+        times = [t for t, _ in series.points()]
+        assert 4 <= len(times) <= 8
+        assert times[0] == 0
+        assert len({b - a for a, b in zip(times, times[1:])}) == 1
+
+    def test_drawdown_and_range_histogram(self):
+        summary = StreamingSummary(range_bins=4)
+        pool = type('Pool', (), {})()
+        pool.token1_range = type('R', (), {'range_lower': 90.0, 'range_upper': 100.0})()
+        pool.token0_range = type('R', (), {'range_lower': 100.0, 'range_upper': 110.0})()
+        for price, value in ((100.0, 10.0), (104.0, 12.0), (91.0, 9.0), (120.0, 11.0)):
+            summary.record_bar(price, price, value, pool)
+        summary.record_bar(0, 100.0, 11.0, None)
+        assert summary.max_drawdown == (12.0 - 9.0) / 12.0
+        assert summary.range_histogram == [1, 0, 2, 0]
+        assert (summary.bars_above_range, summary.bars_without_position) == (1, 1)
+        assert summary.time_in_range == 0.75
+
+
+class TestSummaryBacktest:
+    """Test summary_only runs against full runs."""
+
+    def test_summary_matches_full_run(self):
+        full = _engine().run_backtest(DATA_3DAYS, 3000.0, 1.0)
+        engine = _engine()
+        result = engine.run_backtest(engine.load_ohlc_data(DATA_3DAYS), 3000.0, 1.0, summary_only=True)
+        summary = result.summary
+        assert (result.total_trades, result.total_rebalances) == (full.total_trades, full.total_rebalances)
+        assert (result.final_balance_0, result.final_balance_1) == (full.final_balance_0, full.final_balance_1)
+        assert result.token0_drawdown == full.token0_drawdown
+        assert len(result.trades) == 0 and result.rebalances == [] and not engine.portfolio_values
+        assert summary.buys == sum(t.trade_type == 'buy' for t in full.trades)
+        fees = sum(t.fees_earned for t in full.trades)
+        assert abs(summary.fees_token0 + summary.fees_token1 - fees) <= 1e-9 * fees
+        assert summary.bars == len(engine.load_ohlc_data(DATA_3DAYS))
+        assert 0 < len(summary.equity.values) <= 512
+        assert summary.to_dict()['equity_curve'][0][0].startswith('20')
+
+    def test_memory_does_not_grow_with_bars(self):
+        engine = _engine()
+        frames = [engine.load_ohlc_data(DATA_3DAYS), engine.load_ohlc_data(DATA_3WEEKS)]
+        peaks = []
+        for df in frames:
+            tracemalloc.start()
+            _engine().run_backtest(df, 3000.0, 1.0, summary_only=True)
+            peaks.append(tracemalloc.get_traced_memory()[1])
+            tracemalloc.stop()
+        assert len(frames[1]) > 5 * len(frames[0])
+        assert peaks[1] < 1.5 * peaks[0]
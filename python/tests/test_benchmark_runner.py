@@ -0,0 +1,39 @@
+"""Unit tests for the benchmark runner's measurement and regression check."""
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from benchmarks.cases import CASES
+from benchmarks.run_benchmarks import compare, measure, same_environment
+
+
+class TestBenchmarkRunner:
+    """Test timing output and baseline comparison."""
+
+    def test_every_case_runs(self):
+        for name, factory in CASES.items():
+            if name.startswith('backtest.'):
+                continue  # full 3-week run; covered by the parity harness
+            fn, ops = factory()
+            fn()
+            assert ops > 0
+
+    def test_measure(self):
+        result = measure('volatility.realized', rounds=2, min_time=0.01)
+        assert result['ops_per_sec'] > 0
+        assert abs(result['ns_per_op'] * result['ops_per_sec'] - 1e9) < 1e-3
+
+    def test_flags_throughput_drop_beyond_threshold(self):
+        baseline = {'git_revision': 'abc123', 'benchmarks': {
+            'a': {'ops_per_sec': 1000.0}, 'b': {'ops_per_sec': 1000.0}, 'c': {'ops_per_sec': 1000.0}}}
+        results = {'benchmarks': {
+            'a': {'ops_per_sec': 850.0}, 'b': {'ops_per_sec': 700.0}, 'c': {'ops_per_sec': 2000.0},
+            'new': {'ops_per_sec': 5.0}}}
+        regressions = compare(results, baseline, threshold=0.2)
+        assert len(regressions) == 1 and regressions[0].startswith('b: -30.0%')
+
+    def test_foreign_baseline_is_not_comparable(self):
+        baseline = {'machine': 'Linux x86_64 (1 cpus)', 'python': '3.11.7'}
+        assert same_environment(dict(baseline), baseline) == []
+        mismatches = same_environment({'machine': 'Darwin arm64 (10 cpus)', 'python': '3.11.7'}, baseline)
+        assert mismatches == ['machine: Linux x86_64 (1 cpus) -> Darwin arm64 (10 cpus)']
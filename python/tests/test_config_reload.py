@@ -0,0 +1,195 @@
+"""Unit tests for hot-reloadable strategy configuration."""
+import json
+import os
+import signal
+import sys
+import tempfile
+import threading
+import time
+from types import SimpleNamespace
+
+import pytest
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+import main
+from config import Config
+from config_reload import ConfigStore, read_settings
+from orchestrator import Orchestrator, PoolSpec
+
+BaseConfig = type('TestConfig', (Config,), {'INVENTORY_MODEL': 'GLFTModel', 'REBALANCE_THRESHOLD': 0.1,
+                                            'CONFIG_RELOAD_POLL_SECONDS': 0.0})
+
+
+class TestConfigStore:
+    """Test parsing, validation, versioning and reload triggers."""
+
+    def setup_method(self):
+        self.tmpdir = tempfile.mkdtemp()
+        self.path = os.path.join(self.tmpdir, 'strategy.env')
+
+    def write(self, text, path=None):
+        with open(path or self.path, 'w') as f:
+            f.write(text)
+
+    def test_env_file_is_applied_at_startup_and_reload(self):
+        self.write("REBALANCE_THRESHOLD=0.25\nINVENTORY_CONSTRAINT_ACTIVE=true  # comment\n")
+        store = ConfigStore(BaseConfig, path=self.path)
+        assert store.version == 1 and store.current.CONFIG_VERSION == 1
+        assert store.current.REBALANCE_THRESHOLD == 0.25
+        assert store.current.INVENTORY_CONSTRAINT_ACTIVE is True
+        assert BaseConfig.REBALANCE_THRESHOLD == 0.1
+
+        first = store.current
+        published = []
+        store.subscribe(published.append)
+        self.write("REBALANCE_THRESHOLD=0.3\nVOLATILITY_WINDOW_SIZE=50\n")
+        assert store.reload()
+        assert published == [store.current] and store.version == 2
+        assert store.current.VOLATILITY_WINDOW_SIZE == 50
+        assert store.current.INVENTORY_CONSTRAINT_ACTIVE is False  # dropped from the file -> base value
+        assert first.REBALANCE_THRESHOLD == 0.25  # readers holding the old snapshot are unaffected
+
+    def test_invalid_values_keep_the_running_snapshot(self):
+        store = ConfigStore(BaseConfig, path=self.path)
+        for text in ("REBALANCE_THRESHOLD=abc\n", "MIN_RANGE_PERCENTAGE=60\nMAX_RANGE_PERCENTAGE=50\n",
+                     "INVENTORY_MODEL=NoSuchModel\n", "NOT_A_SETTING=1\n"):
+            self.write(text)
+            assert not store.reload()
+        assert store.version == 0 and store.stats['rejected'] == 4
+        assert store.current.REBALANCE_THRESHOLD == 0.1
+
+    def test_restart_only_settings_are_ignored(self):
+        store = ConfigStore(BaseConfig, path=self.path)
+        assert store.reload({'ETHEREUM_RPC_URL': 'http://elsewhere', 'BASE_SPREAD': '0.3'})
+        assert store.current.ETHEREUM_RPC_URL == BaseConfig.ETHEREUM_RPC_URL
+        assert store.current.BASE_SPREAD == 0.3
+
+    def test_json_file_and_change_detection(self):
+        path = os.path.join(self.tmpdir, 'strategy.json')
+        with open(path, 'w') as f:
+            json.dump({'MAX_RANGE_PERCENTAGE': 40, 'INVENTORY_MODEL': 'AvellanedaStoikovModel'}, f)
+        assert read_settings(path)['MAX_RANGE_PERCENTAGE'] == 40
+        store = ConfigStore(BaseConfig, path=path)
+        assert store.current.MAX_RANGE_PERCENTAGE == 40.0
+        assert not store.check_file()
+
+        with open(path, 'w') as f:
+            json.dump({'MAX_RANGE_PERCENTAGE': 30}, f)
+        os.utime(path, (time.time() + 10, time.time() + 10))
+        assert store.check_file() and store.current.MAX_RANGE_PERCENTAGE == 30.0
+
+    @pytest.mark.skipif(not hasattr(signal, 'SIGHUP'), reason='no SIGHUP')
+    def test_sighup_reloads(self):
+        self.write("REBALANCE_THRESHOLD=0.2\n")
+        store = ConfigStore(BaseConfig, path=self.path)
+        self.write("REBALANCE_THRESHOLD=0.4\n")
+        previous = signal.getsignal(signal.SIGHUP)
+        try:
+            store.install_signal_handler()
+            os.kill(os.getpid(), signal.SIGHUP)
+            deadline = time.time() + 5
+            while store.version < 2 and time.time() < deadline:
+                time.sleep(0.01)
+        finally:
+            signal.signal(signal.SIGHUP, previous)
+        assert store.current.REBALANCE_THRESHOLD == 0.4
+
+
+class TestOrchestratorReload:
+    """Test that reloads reach every hosted pool with its own overrides on top."""
+
+    def test_pool_overrides_win_over_reloaded_base(self):
+        store = ConfigStore(BaseConfig, path='')
+        pools = [PoolSpec('a', '0x' + '01' * 20, '0x' + '02' * 20, 500),
+                 PoolSpec('b', '0x' + '03' * 20, '0x' + '04' * 20, 500, overrides={'REBALANCE_THRESHOLD': 0.05})]
+        orchestrator = Orchestrator(store.current, pools, rebalancer_factory=lambda c: None)
+        store.subscribe(orchestrator.apply_base_config)
+        applied = {}
+        for spec in pools:
+            rebalancer = SimpleNamespace(apply_config=lambda c, name=spec.name: applied.__setitem__(name, c))
+            orchestrator.slots.append(SimpleNamespace(spec=spec, rebalancer=rebalancer))
+
+        assert store.reload({'REBALANCE_THRESHOLD': '0.3'})
+        assert applied['a'].REBALANCE_THRESHOLD == 0.3 and applied['a'].CONFIG_VERSION == 1
+        assert applied['b'].REBALANCE_THRESHOLD == 0.05
+
+
+class FakeRebalancer:
+    """Ticks on a thread and, like AutomatedRebalancer, adopts a published config at the next tick"""
+
+    def __init__(self, config):
+        self.config = config
+        self._pending_config = None
+        self.thresholds = []
+        self.client = SimpleNamespace(get_token_info=lambda address: {'symbol': address[-4:]})
+        self.alert_manager = SimpleNamespace(send_startup_notification=lambda **kwargs: None)
+        self._stop = threading.Event()
+        self._thread = None
+
+    def apply_config(self, config):
+        self._pending_config = config() if isinstance(config, type) else config
+
+    def initialize_positions(self):
+        return True
+
+    def get_position_ranges(self):
+        return []
+
+    def start_monitoring(self, token0, token1, fee):
+        def loop():
+            while not self._stop.wait(0.01):
+                if self._pending_config is not None:
+                    self.config, self._pending_config = self._pending_config, None
+                self.thresholds.append(self.config.REBALANCE_THRESHOLD)
+        self._thread = threading.Thread(target=loop, daemon=True)
+        self._thread.start()
+
+    def stop_monitoring(self):
+        self._stop.set()
+        self._thread.join(timeout=5)
+
+    def get_status(self):
+        return {'is_running': not self._stop.is_set(), 'last_spot_price': None, 'current_positions': 0}
+
+
+@pytest.mark.skipif(not hasattr(signal, 'SIGHUP'), reason='no SIGHUP')
+class TestRebalancerAppReload:
+    """Test that main.RebalancerApp routes a SIGHUP reload into the running rebalancer."""
+
+    def test_sighup_changes_threshold_of_next_tick(self, tmp_path, monkeypatch):
+        path = tmp_path / 'strategy.env'
+        path.write_text("REBALANCE_THRESHOLD=0.2\n")
+        # Startup validation needs web3 and a full .env; this test is about the reload wiring
+        app_config = type('TestConfig', (BaseConfig,), {
+            'CONFIG_RELOAD_PATH': str(path), 'validate_config': classmethod(lambda cls: True),
+            'validate_token_addresses': classmethod(lambda cls: True)})
+        monkeypatch.setattr(main, 'Config', app_config)
+        monkeypatch.setattr(main, 'AutomatedRebalancer', FakeRebalancer)
+        handlers = {signum: signal.getsignal(signum) for signum in (signal.SIGINT, signal.SIGTERM, signal.SIGHUP)}
+
+        def wait_for(condition):
+            deadline = time.time() + 5
+            while not condition() and time.time() < deadline:
+                time.sleep(0.01)
+            assert condition()
+
+        try:
+            app = main.RebalancerApp()
+            started = []
+            runner = threading.Thread(target=lambda: started.append(app.start('0xA', '0xB', 500)))
+            runner.start()
+            wait_for(lambda: app.rebalancer is not None and app.rebalancer.thresholds)
+            assert app.rebalancer.thresholds[-1] == 0.2
+
+            path.write_text("REBALANCE_THRESHOLD=0.35\n")
+            os.kill(os.getpid(), signal.SIGHUP)
+            wait_for(lambda: app.rebalancer.thresholds[-1] == 0.35)
+            assert app.config_store.version == 2
+            app.stop()
+            runner.join(timeout=5)
+        finally:
+            for signum, handler in handlers.items():
+                signal.signal(signum, handler)
+        assert started == [True]
+        seen = app.rebalancer.thresholds
+        assert seen[seen.index(0.35):] == [0.35] * (len(seen) - seen.index(0.35))
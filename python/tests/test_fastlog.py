@@ -0,0 +1,97 @@
+"""Unit tests for deferred hot-path logging."""
+import io
+import logging
+import os
+import sys
+import tempfile
+import threading
+
+import pandas as pd
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+import fastlog
+
+MSG_PRICE = fastlog.message("price {:.2f} side {}")
+MSG_AT = fastlog.message("rebalanced at {}")
+
+
+class _Capture(logging.Handler):
+    def __init__(self):
+        super().__init__(logging.DEBUG)
+        self.records = []
+
+    def emit(self, record):
+        self.records.append(record)
+
+
+class TestFastLog:
+    """Test recording, draining and decoding deferred log entries."""
+
+    def setup_method(self):
+        fastlog.configure(ring_size=1024, flush_interval=0, binary_path='')
+        self.sink = logging.getLogger('test_fastlog.sink')
+        self.sink.setLevel(logging.DEBUG)
+        self.sink.propagate = False
+        self.capture = _Capture()
+        self.sink.addHandler(self.capture)
+        self.log = fastlog.get_logger('test_fastlog.sink')
+
+    def teardown_method(self):
+        fastlog.flush()
+        self.sink.removeHandler(self.capture)
+        fastlog.configure()
+
+    def test_formatting_is_deferred_until_drained(self):
+        self.log.debug(MSG_PRICE, 3012.3456, 'buy')
+        self.log.info(MSG_AT, pd.Timestamp('2024-01-02 03:04:05'))
+        assert self.capture.records == []
+        fastlog.flush()
+        messages = [r.getMessage() for r in self.capture.records]
+        assert messages == ['price 3012.35 side buy', 'rebalanced at 2024-01-02 03:04:05']
+        assert [r.levelno for r in self.capture.records] == [logging.DEBUG, logging.INFO]
+        assert self.capture.records[0].threadName == threading.current_thread().name
+
+    def test_disabled_level_records_nothing(self):
+        self.sink.setLevel(logging.INFO)
+        self.log.debug(MSG_PRICE, 1.0, 'sell')
+        assert fastlog.flush() == 0
+        assert self.capture.records == []
+
+    def test_full_ring_drops_oldest_and_reports(self):
+        fastlog.configure(ring_size=4, flush_interval=0, binary_path='')
+        dropped_before = fastlog._drainer.dropped
+
+        def burst():
+            for i in range(10):
+                self.log.info(MSG_PRICE, float(i), 'x')
+        worker = threading.Thread(target=burst, name='burst')
+        worker.start()
+        worker.join()
+        fastlog.flush()
+        assert [r.getMessage() for r in self.capture.records] == [f"price {i}.00 side x" for i in range(6, 10)]
+        assert all(r.threadName == 'burst' for r in self.capture.records)
+        assert fastlog._drainer.dropped - dropped_before == 6
+
+    def test_rings_of_finished_threads_are_pruned(self):
+        workers = [threading.Thread(target=self.log.info, args=(MSG_PRICE, float(i), 'x')) for i in range(20)]
+        for worker in workers:
+            worker.start()
+            worker.join()
+        assert fastlog.flush() == 20
+        assert len(self.capture.records) == 20
+        assert not any(ring.owner in workers for ring in fastlog._drainer.rings)
+
+    def test_binary_file_decodes_offline(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, 'hot.bin')
+            fastlog.configure(ring_size=1024, flush_interval=0, binary_path=path)
+            self.log.debug(MSG_PRICE, 2999.999, 'sell')
+            self.log.info(MSG_AT, pd.Timestamp('2024-01-02'))
+            fastlog.flush()
+            fastlog.configure(binary_path='')
+            assert self.capture.records == []
+            out = io.StringIO()
+            assert fastlog.decode(path, out) == 2
+        lines = out.getvalue().splitlines()
+        assert lines[0].endswith('test_fastlog.sink - DEBUG - [MainThread] price 3000.00 side sell')
+        assert lines[1].endswith('INFO - [MainThread] rebalanced at 2024-01-02 00:00:00')
@@ -0,0 +1,87 @@
+"""Unit tests for the EIP-1559 fee oracle."""
+import pytest
+import sys
+import os
+from unittest.mock import Mock
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from fee_oracle import FeeOracle, forecast_base_fee
+
+GWEI = 10**9
+
+
+def make_config():
+    config = Mock()
+    config.FEE_HISTORY_BLOCKS = 3
+    config.FEE_PRIORITY_PERCENTILE = 50
+    config.FEE_BASE_FEE_HORIZON_BLOCKS = 2
+    config.FEE_ORACLE_POLL_INTERVAL_SECONDS = 60
+    return config
+
+
+def make_w3(base_fees, rewards, oldest_block=100):
+    w3 = Mock()
+    w3.eth.fee_history.return_value = {
+        'oldestBlock': oldest_block,
+        'baseFeePerGas': base_fees,
+        'gasUsedRatio': [0.5] * (len(base_fees) - 1),
+        'reward': rewards
+    }
+    w3.eth.block_number = oldest_block + len(base_fees) - 2
+    return w3
+
+
+class TestFeeOracle:
+    """Test fee snapshots built from eth_feeHistory."""
+
+    def test_forecast_base_fee(self):
+        """Full blocks raise the base fee by 1/8, empty blocks lower it by 1/8."""
+        assert forecast_base_fee(800, 1.0) == 900
+        assert forecast_base_fee(800, 0.5) == 800
+        assert forecast_base_fee(800, 0.0) == 700
+
+    def test_snapshot_from_fee_history(self):
+        """Priority fee is the median of the configured percentile; max fee covers base-fee growth."""
+        # Percentiles requested are [10, 50, 90]
+        rewards = [[1 * GWEI, 2 * GWEI, 5 * GWEI], [1 * GWEI, 3 * GWEI, 6 * GWEI], [1 * GWEI, 4 * GWEI, 7 * GWEI]]
+        oracle = FeeOracle(make_w3([10 * GWEI, 11 * GWEI, 12 * GWEI, 16 * GWEI], rewards), make_config())
+
+        snapshot = oracle.refresh()
+        assert snapshot.block_number == 102
+        assert snapshot.base_fee == 12 * GWEI
+        assert snapshot.next_base_fee == 16 * GWEI
+        assert snapshot.max_priority_fee_per_gas == 3 * GWEI
+        # 16 gwei grown at 12.5% for two blocks, plus the tip
+        assert snapshot.max_fee_per_gas == 16 * GWEI + 2 * GWEI + 2250000000 + 3 * GWEI
+        assert oracle.fee_params() == {
+            'maxFeePerGas': snapshot.max_fee_per_gas,
+            'maxPriorityFeePerGas': 3 * GWEI
+        }
+
+    def test_reads_do_not_hit_rpc(self):
+        """Repeated reads are served from the published snapshot."""
+        oracle = FeeOracle(make_w3([GWEI, GWEI, GWEI, GWEI], [[0, 0, 0]] * 3), make_config())
+        first = oracle.snapshot()
+        for _ in range(100):
+            assert oracle.snapshot() is first
+        assert oracle.w3.eth.fee_history.call_count == 1
+
+    def test_new_head_replaces_snapshot(self):
+        """A newer head publishes a new snapshot object."""
+        w3 = make_w3([GWEI, GWEI, GWEI, GWEI], [[0, 0, 0]] * 3)
+        oracle = FeeOracle(w3, make_config())
+        first = oracle.refresh()
+
+        oracle.on_new_head({'number': first.block_number})
+        assert oracle.snapshot() is first
+
+        w3.eth.fee_history.return_value = dict(w3.eth.fee_history.return_value, oldestBlock=101)
+        oracle.on_new_head({'number': first.block_number + 1})
+        assert oracle.snapshot().block_number == first.block_number + 1
+
+    def test_legacy_chain(self):
+        """Chains without a base fee fall back to gasPrice."""
+        w3 = make_w3([0, 0, 0, 0], [])
+        w3.eth.gas_price = 7 * GWEI
+        oracle = FeeOracle(w3, make_config())
+        assert oracle.fee_params() == {'gasPrice': 7 * GWEI}
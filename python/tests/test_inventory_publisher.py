@@ -1,41 +1,248 @@
-"""Unit tests for InventoryPublisher stub."""
+"""Unit tests for the binary inventory publisher and its transports."""
 import pytest
+import socket
 import sys
 import os
+import time
 from unittest.mock import Mock
 
 sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
-from inventory_publisher import InventoryPublisher
+from inventory_publisher import InventoryPublisher, ShmRingTransport, ShmRingReader, ZmqTransport
+from inventory_schema import (
+    encode_message, decode_message, InventoryMessage, RebalanceMessage, BandsMessage, ErrorMessage,
+    HEADER, MSG_INVENTORY, MSG_BANDS, MSG_REBALANCE
+)
+
+
+def make_config(**overrides):
+    config = Mock()
+    config.ZMQ_ENABLED = False
+    config.ZMQ_PUBLISHER_HOST = '127.0.0.1'
+    config.ZMQ_PUBLISHER_PORT = 5555
+    config.INVENTORY_SHM_RING_PATH = ''
+    config.INVENTORY_SHM_RING_SLOTS = 16
+    for key, value in overrides.items():
+        setattr(config, key, value)
+    return config
+
+
+class RecordingTransport:
+    """Transport that keeps every payload it was asked to send"""
+    name = 'recording'
+
+    def __init__(self, delay: float = 0.0):
+        self.sent = []
+        self.delay = delay
+
+    def send(self, msg_type, payload):
+        if self.delay:
+            time.sleep(self.delay)
+        self.sent.append(decode_message(payload))
+
+    def close(self):
+        pass
+
+
+class TestInventorySchema:
+    """Test binary message encoding."""
+
+    def test_round_trip_all_types(self):
+        messages = [
+            InventoryMessage(1.5, 3000.25, 2000.0, 0.02, 5.0, 7.5,
+                             '0x' + 'ab' * 20, '0x' + 'cd' * 20),
+            RebalanceMessage(2000.0, 0.4, 0.5, 0.01, 12.5, 5.0, 7.5, 210000, 'WETH', 'USDC'),
+            BandsMessage(-200, -100, -400, -210, 5.0, 7.5, 2000.0),
+            ErrorMessage('Rebalance Failed', 'execution reverted')
+        ]
+        for seq, message in enumerate(messages, 1):
+            envelope = decode_message(encode_message(message, seq, 123456789))
+            assert envelope.seq == seq
+            assert envelope.publish_ts_ns == 123456789
+            assert envelope.message == message
+
+    def test_fixed_sizes(self):
+        inventory = encode_message(InventoryMessage(1.0, 2.0), 1)
+        bands = encode_message(BandsMessage(0, 1, 2, 3), 2)
+        assert HEADER.size == 24
+        assert len(inventory) == 24 + 88
+        assert len(bands) == 24 + 40
+
+    def test_long_strings_truncated(self):
+        envelope = decode_message(encode_message(ErrorMessage('x' * 50, 'y' * 500), 1))
+        assert envelope.message.error_type == 'x' * 32
+        assert envelope.message.message == 'y' * 192
+
+    def test_bad_magic_rejected(self):
+        data = bytearray(encode_message(BandsMessage(0, 1, 2, 3), 1))
+        data[0] ^= 0xFF
+        with pytest.raises(ValueError):
+            decode_message(bytes(data))
 
 
 class TestInventoryPublisher:
-    """Test the inventory publisher stub."""
-    
-    def test_initialization(self):
-        """Test publisher initialization."""
-        config = Mock()
-        publisher = InventoryPublisher(config)
-        assert publisher.config == config
-    
-    def test_update_inventory_data_noop(self):
-        """Test update_inventory_data is a no-op."""
-        publisher = InventoryPublisher(Mock())
+    """Test sequencing, conflation and the publisher API."""
+
+    def test_disabled_without_transports(self):
+        publisher = InventoryPublisher(make_config())
         publisher.update_inventory_data('0xA', '0xB', 1.0, 0.5)
-    
-    def test_publish_rebalance_event_noop(self):
-        """Test publish_rebalance_event is a no-op."""
-        publisher = InventoryPublisher(Mock())
-        publisher.publish_rebalance_event('ETH', 'USDC', 2000.0, 0.5, 0.6, {}, 100000, {})
-    
-    def test_publish_error_event_noop(self):
-        """Test publish_error_event is a no-op."""
-        publisher = InventoryPublisher(Mock())
-        publisher.publish_error_event('Error', 'msg', {})
-    
-    def test_get_publisher_stats(self):
-        """Test get_publisher_stats returns stub info."""
-        publisher = InventoryPublisher(Mock())
         stats = publisher.get_publisher_stats()
-        assert stats['enabled'] == False
-        assert 'stub' in stats['status'].lower()
+        assert stats['enabled'] is False
+        assert stats['transports'] == []
+        assert stats['seq'] == 0
+        publisher.close()
+
+    def test_publishes_all_message_types_in_sequence(self):
+        transport = RecordingTransport()
+        publisher = InventoryPublisher(make_config(), transports=[transport])
+        publisher.publish_rebalance_event('ETH', 'USDC', 2000.0, 0.4, 0.5,
+                                          {'ETH': 0.01, 'USDC': 20.0}, 100000,
+                                          {'token_a_range': 5.0, 'token_b_range': 7.0})
+        assert publisher.flush()
+        publisher.update_inventory_data('0x' + '11' * 20, '0x' + '22' * 20, 1.0, 2000.0,
+                                        spot_price=2000.0, volatility=0.03)
+        assert publisher.flush()
+        publisher.publish_bands(1, 2, -2, -1, 5.0, 7.0, 2000.0)
+        publisher.publish_error_event('RPC', 'timeout', {'chain': 'mainnet'})
+        assert publisher.flush()
+        publisher.close()
+
+        assert [e.seq for e in transport.sent] == list(range(1, len(transport.sent) + 1))
+        by_type = {e.message.msg_type: e.message for e in transport.sent}
+        rebalance = by_type[MSG_REBALANCE]
+        assert rebalance.fee_a == 0.01 and rebalance.fee_b == 20.0
+        assert rebalance.range_b_pct == 7.0
+        assert by_type[MSG_INVENTORY].volatility == 0.03
+        assert by_type[MSG_BANDS].tick_lower_b == -2
+        assert any('chain=mainnet' in e.message.message for e in transport.sent
+                   if isinstance(e.message, ErrorMessage))
+
+    def test_inventory_updates_are_conflated(self):
+        transport = RecordingTransport(delay=0.05)
+        publisher = InventoryPublisher(make_config(), transports=[transport])
+        # The first update occupies the sender; the rest pile up and conflate
+        for i in range(20):
+            publisher.update_inventory_data('0xA', '0xB', float(i), 0.0)
+        publisher.publish_error_event('E', 'kept', {})
+        assert publisher.flush(timeout=3)
+        publisher.close()
+
+        inventory = [e.message for e in transport.sent if e.message.msg_type == MSG_INVENTORY]
+        assert len(inventory) < 20
+        assert inventory[-1].token_a_balance == 19.0
+        stats = publisher.get_publisher_stats()
+        assert stats['conflated'] >= 20 - len(inventory)
+        assert stats['published']['error'] == 1
+
+    def test_conflation_is_per_pool(self):
+        transport = RecordingTransport(delay=0.05)
+        publisher = InventoryPublisher(make_config(), transports=[transport])
+        pool_1, pool_2 = ('0x' + '11' * 20, '0x' + '22' * 20), ('0x' + '33' * 20, '0x' + '44' * 20)
+        publisher.publish_error_event('E', 'occupies the sender', {})
+        for i in range(1, 6):
+            publisher.update_inventory_data(*pool_1, float(i), 0.0)
+            publisher.update_inventory_data(*pool_2, float(-i), 0.0)
+            publisher.publish_bands(i, i, 0, 0, pool='pool-1')
+            publisher.publish_bands(-i, -i, 0, 0, pool='pool-2')
+        assert publisher.flush(timeout=3)
+        publisher.close()
+
+        inventory = [e.message.token_a_balance for e in transport.sent if e.message.msg_type == MSG_INVENTORY]
+        bands = [e.message.tick_lower_a for e in transport.sent if e.message.msg_type == MSG_BANDS]
+        # Both pools' final values survive conflation
+        assert 5.0 in inventory and -5.0 in inventory
+        assert 5 in bands and -5 in bands
+
+    def test_stats_report_latency_in_microseconds(self):
+        publisher = InventoryPublisher(make_config(), transports=[RecordingTransport()])
+        publisher.update_inventory_data('0xA', '0xB', 1.0, 2.0)
+        assert publisher.flush()
+        publisher.close()
+        stats = publisher.get_publisher_stats()
+        assert stats['published']['inventory'] == 1
+        assert 0 < stats['latency_us_avg'] < 1_000_000
+
+    def test_failing_transport_does_not_stop_others(self):
+        broken = Mock()
+        broken.name = 'broken'
+        broken.send.side_effect = OSError('boom')
+        good = RecordingTransport()
+        publisher = InventoryPublisher(make_config(), transports=[broken, good])
+        publisher.update_inventory_data('0xA', '0xB', 1.0, 2.0)
+        assert publisher.flush()
+        publisher.close()
+        assert len(good.sent) == 1
+        assert publisher.get_publisher_stats()['send_errors'] == 1
+
+
+class TestShmRing:
+    """Test the shared-memory ring transport."""
+
+    def test_reader_sees_messages_in_order(self, tmp_path):
+        path = str(tmp_path / 'ring')
+        ring = ShmRingTransport(path, slot_count=8)
+        reader = ShmRingReader(path)
+        for seq in range(1, 6):
+            ring.send(MSG_BANDS, encode_message(BandsMessage(seq, seq + 1, -seq, 0), seq))
+        payloads = reader.poll()
+        assert [decode_message(p).seq for p in payloads] == [1, 2, 3, 4, 5]
+        assert reader.poll() == []
+        reader.close()
+        ring.close()
+
+    def test_lapped_reader_counts_lost_messages(self, tmp_path):
+        path = str(tmp_path / 'ring')
+        ring = ShmRingTransport(path, slot_count=4)
+        reader = ShmRingReader(path)
+        for seq in range(1, 11):
+            ring.send(MSG_BANDS, encode_message(BandsMessage(seq, 0, 0, 0), seq))
+        payloads = reader.poll()
+        assert [decode_message(p).seq for p in payloads] == [7, 8, 9, 10]
+        assert reader.lost == 6
+        reader.close()
+        ring.close()
+
+    def test_publisher_from_config(self, tmp_path):
+        path = str(tmp_path / 'ring')
+        publisher = InventoryPublisher(make_config(INVENTORY_SHM_RING_PATH=path))
+        reader = ShmRingReader(path)
+        publisher.update_inventory_data('0xA', '0xB', 4.0, 5.0)
+        assert publisher.flush()
+        publisher.close()
+        (payload,) = reader.poll()
+        assert decode_message(payload).message.token_b_balance == 5.0
+        reader.close()
+
+
+class TestZmqTransport:
+    """Test the ZMQ PUB transport end to end."""
+
+    def test_subscriber_receives_binary_frames(self):
+        zmq = pytest.importorskip('zmq')
+        with socket.socket() as s:
+            s.bind(('127.0.0.1', 0))
+            port = s.getsockname()[1]
+        publisher = InventoryPublisher(make_config(ZMQ_ENABLED=True, ZMQ_PUBLISHER_PORT=port))
+        assert publisher.get_publisher_stats()['transports'] == ['zmq']
 
+        context = zmq.Context.instance()
+        sub = context.socket(zmq.SUB)
+        sub.setsockopt(zmq.SUBSCRIBE, b'bands')
+        sub.setsockopt(zmq.RCVTIMEO, 200)
+        sub.connect(f'tcp://127.0.0.1:{port}')
+        try:
+            # PUB drops messages until the subscription has propagated
+            received = None
+            for _ in range(25):
+                publisher.publish_bands(10, 20, -20, -10)
+                try:
+                    received = sub.recv_multipart()
+                    break
+                except zmq.Again:
+                    continue
+            assert received is not None
+            topic, payload = received
+            assert topic == b'bands'
+            assert decode_message(payload).message.tick_upper_a == 20
+        finally:
+            sub.close()
+            publisher.close()
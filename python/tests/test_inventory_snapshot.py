@@ -0,0 +1,134 @@
+"""Unit tests for the shared-memory inventory snapshot."""
+import mmap
+import os
+import struct
+import sys
+import threading
+import pytest
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from inventory_snapshot import (
+    InventorySnapshotWriter, InventorySnapshotReader, FLAG_REBALANCING, FLAG_RECOVERED,
+    PAYLOAD, SEQUENCE_OFFSET
+)
+
+
+class TestInventorySnapshot:
+    """Test the seqlock writer and reader."""
+
+    def make_writer(self, tmp_path):
+        path = str(tmp_path / 'snapshot')
+        return path, InventorySnapshotWriter(path)
+
+    def test_empty_snapshot_reads_none(self, tmp_path):
+        path, writer = self.make_writer(tmp_path)
+        reader = InventorySnapshotReader(path)
+        assert reader.read() is None
+        reader.close()
+        writer.close()
+
+    def test_round_trip_and_merge(self, tmp_path):
+        path, writer = self.make_writer(tmp_path)
+        reader = InventorySnapshotReader(path)
+
+        writer.update(token0_balance=3000.5, token1_balance=1.25, spot_price=2400.0,
+                      tick_lower_a=100, tick_upper_a=500, tick_lower_b=-500, tick_upper_b=-100)
+        writer.update(spot_price=2410.0, tick_lower_a=None)
+        snapshot = reader.read()
+
+        assert snapshot['sequence'] == 4
+        assert snapshot['token0_balance'] == 3000.5
+        assert snapshot['spot_price'] == 2410.0
+        assert snapshot['tick_lower_a'] == 100
+        assert snapshot['tick_lower_b'] == -500
+        assert snapshot['update_ts_ns'] > 0
+        reader.close()
+        writer.close()
+
+    def test_unknown_field_rejected(self, tmp_path):
+        _, writer = self.make_writer(tmp_path)
+        with pytest.raises(KeyError):
+            writer.update(not_a_field=1)
+        writer.close()
+
+    def test_flags(self, tmp_path):
+        path, writer = self.make_writer(tmp_path)
+        reader = InventorySnapshotReader(path)
+        writer.set_flag(FLAG_RECOVERED, True)
+        writer.set_flag(FLAG_REBALANCING, True)
+        assert reader.read()['flags'] == FLAG_RECOVERED | FLAG_REBALANCING
+        writer.set_flag(FLAG_REBALANCING, False)
+        assert reader.read()['flags'] == FLAG_RECOVERED
+        reader.close()
+        writer.close()
+
+    def test_concurrent_flags_are_not_lost(self, tmp_path):
+        path, writer = self.make_writer(tmp_path)
+        reader = InventorySnapshotReader(path)
+        bits = [1 << i for i in range(2, 18)]
+        start = threading.Barrier(len(bits))
+
+        def toggle(bit):
+            start.wait()
+            for _ in range(200):
+                writer.set_flag(bit, False)
+                writer.set_flag(bit, True)
+
+        threads = [threading.Thread(target=toggle, args=(bit,)) for bit in bits]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        assert reader.read()['flags'] == sum(bits)
+        reader.close()
+        writer.close()
+
+    def test_reader_rejects_foreign_file(self, tmp_path):
+        path = str(tmp_path / 'other')
+        with open(path, 'wb') as f:
+            f.write(b'\x00' * 256)
+        with pytest.raises(ValueError):
+            InventorySnapshotReader(path)
+
+    def test_reader_waits_out_a_write_in_progress(self, tmp_path):
+        path, writer = self.make_writer(tmp_path)
+        writer.update(token0_balance=1.0)
+        reader = InventorySnapshotReader(path)
+
+        # Simulate a writer stuck mid-update (odd sequence)
+        with open(path, 'r+b') as f:
+            raw = mmap.mmap(f.fileno(), 0)
+            struct.pack_into('<Q', raw, SEQUENCE_OFFSET, 3)
+            with pytest.raises(TimeoutError):
+                reader.read(max_attempts=10)
+            assert reader.retries == 10
+            struct.pack_into('<Q', raw, SEQUENCE_OFFSET, 4)
+            raw.close()
+        assert reader.read()['token0_balance'] == 1.0
+        reader.close()
+        writer.close()
+
+    def test_concurrent_reads_are_never_torn(self, tmp_path):
+        path, writer = self.make_writer(tmp_path)
+        reader = InventorySnapshotReader(path)
+        done = threading.Event()
+
+        def write():
+            for i in range(1, 3001):
+                writer.update(token0_balance=float(i), token1_balance=float(i), block_number=i)
+            done.set()
+
+        thread = threading.Thread(target=write)
+        thread.start()
+        reads = 0
+        while not done.is_set() or reads == 0:
+            snapshot = reader.read(max_attempts=100000)
+            if snapshot is None:
+                continue
+            assert snapshot['token0_balance'] == snapshot['token1_balance'] == snapshot['block_number']
+            reads += 1
+        thread.join()
+        assert reader.read()['block_number'] == 3000
+        assert PAYLOAD.size == 120
+        reader.close()
+        writer.close()
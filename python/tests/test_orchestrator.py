@@ -0,0 +1,196 @@
+"""Unit tests for the multi-pool orchestrator."""
+import json
+import os
+import sys
+import threading
+import time
+from types import SimpleNamespace
+
+import pytest
+from eth_abi import decode, encode
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from config import Config
+from orchestrator import Orchestrator, PoolSpec, load_pool_specs, SLOT0_TYPES
+
+
+class FakeEth:
+    """eth.call that answers Multicall3 aggregate3 with per-pool slot0"""
+
+    def __init__(self):
+        self.sqrt_prices = {}
+        self.calls = 0
+
+    def call(self, tx, block_identifier='latest'):
+        self.calls += 1
+        (calls,) = decode(['(address,bool,bytes)[]'], bytes.fromhex(tx['data'][2:])[4:])
+        results = [(True, encode(SLOT0_TYPES, [self.sqrt_prices[target.lower()], 0, 0, 1, 1, 0, True]))
+                   for target, _, _ in calls]
+        return encode(['(bool,bytes)[]'], [results])
+
+
+class FakeRebalancer:
+    """Records ticks; urgency is set by the test"""
+
+    def __init__(self, config, log, gate=None):
+        self.config = config
+        self.log = log
+        self.gate = gate
+        self.urgency = 0.0
+        self.spots = []
+        pool = '0x' + config.TOKEN_A_ADDRESS[-2:] * 20
+        self.client = SimpleNamespace(
+            get_pool_address=lambda a, b, fee: pool,
+            get_pool_info=lambda address: {'token0': config.TOKEN_A_ADDRESS, 'token1': config.TOKEN_B_ADDRESS}
+        )
+
+    def validate_token_ordering(self, token_a, token_b, fee):
+        return True
+
+    def initialize_positions(self):
+        return True
+
+    def _sqrt_price_to_spot(self, sqrt_price_x96, token0, token1):
+        return sqrt_price_x96 / 2 ** 96
+
+    def rebalance_urgency(self, spot_price):
+        return self.urgency
+
+    def monitoring_tick(self, token0, token1, fee, spot_price=None):
+        if self.gate:
+            self.gate.wait(5)
+        self.spots.append(spot_price)
+        self.log.append(self.config.TOKEN_A_ADDRESS)
+
+
+def make_config(**overrides):
+    values = {'ORCHESTRATOR_CYCLE_SECONDS': 0.05, 'ORCHESTRATOR_WORKERS': 1,
+              'ORCHESTRATOR_IDLE_TICK_SECONDS': 60.0, 'REBALANCE_WAL_PATH': '',
+              'INVENTORY_SNAPSHOT_PATH': '', 'METRICS_PORT': 0, 'METRICS_SUMMARY_INTERVAL_SECONDS': 0,
+              'FEE_ORACLE_ENABLED': False}
+    values.update(overrides)
+    return type('TestConfig', (Config,), values)
+
+
+def token(i):
+    return '0x' + f'{i:02x}' * 20
+
+
+class TestOrchestrator:
+    """Test config layering, priority scheduling and skipping."""
+
+    def setup_method(self):
+        self.eth = FakeEth()
+        self.log = []
+        self.rebalancers = {}
+
+    def make(self, count, gate=None, **config):
+        specs = [PoolSpec(f'pool{i}', token(i + 1), token(0xF0), 500) for i in range(count)]
+
+        def factory(pool_config):
+            rebalancer = FakeRebalancer(pool_config, self.log, gate)
+            self.rebalancers[pool_config.TOKEN_A_ADDRESS] = rebalancer
+            return rebalancer
+
+        orchestrator = Orchestrator(make_config(**config), specs, w3=SimpleNamespace(eth=self.eth),
+                                    rebalancer_factory=factory)
+        orchestrator.setup()
+        for i, slot in enumerate(orchestrator.slots):
+            self.eth.sqrt_prices[slot.pool_address.lower()] = (i + 1) * 2 ** 96
+        return orchestrator
+
+    def test_pool_config_layers_overrides(self, monkeypatch):
+        monkeypatch.setenv('DESK2_KEY', '0x' + '11' * 32)
+        base_threshold = Config.REBALANCE_THRESHOLD
+        orchestrator = Orchestrator(make_config(REBALANCE_WAL_PATH='/var/lib/alp/wal',
+                                                INVENTORY_SNAPSHOT_PATH='/dev/shm/alp_{pool}'), [])
+        spec = PoolSpec('weth-usdc', token(1), token(2), 3000, {'REBALANCE_THRESHOLD': 0.25}, 'DESK2_KEY')
+        config = orchestrator.pool_config(spec)
+        assert config.TOKEN_A_ADDRESS == token(1) and config.FEE_TIER == 3000
+        assert config.REBALANCE_THRESHOLD == 0.25
+        assert config.REBALANCE_WAL_PATH == '/var/lib/alp/wal.weth-usdc'
+        assert config.INVENTORY_SNAPSHOT_PATH == '/dev/shm/alp_weth-usdc'
+        assert config.PRIVATE_KEY == '0x' + '11' * 32
+        assert Config.REBALANCE_THRESHOLD == base_threshold  # base class untouched
+
+    def test_load_pool_specs(self, tmp_path):
+        path = tmp_path / 'pools.json'
+        path.write_text(json.dumps([
+            {'name': 'a', 'token_a': token(1), 'token_b': token(2), 'fee': 500, 'config': {'INVENTORY_MODEL': 'GLFTModel'}},
+            {'name': 'b', 'token_a': token(3), 'token_b': token(4), 'fee': '3000', 'private_key_env': 'DESK2_KEY'}
+        ]))
+        a, b = load_pool_specs(str(path))
+        assert a.overrides == {'INVENTORY_MODEL': 'GLFTModel'} and b.fee == 3000
+        path.write_text(json.dumps([{'name': 'a', 'token_a': token(1), 'token_b': token(2), 'fee': 500}] * 2))
+        with pytest.raises(ValueError):
+            load_pool_specs(str(path))
+
+    def test_pools_sharing_a_wallet_key_are_rejected(self, tmp_path):
+        path = tmp_path / 'pools.json'
+        entries = [{'name': 'a', 'token_a': token(1), 'token_b': token(2), 'fee': 500},
+                   {'name': 'b', 'token_a': token(3), 'token_b': token(4), 'fee': 500}]
+        path.write_text(json.dumps(entries))
+        with pytest.raises(ValueError, match='PRIVATE_KEY'):
+            load_pool_specs(str(path))
+        entries[1]['private_key_env'] = 'DESK2_KEY'
+        path.write_text(json.dumps(entries))
+        assert [s.private_key_env for s in load_pool_specs(str(path))] == [None, 'DESK2_KEY']
+
+        # Two variables holding one key are caught when the wallets are built
+        orchestrator = Orchestrator(make_config(PRIVATE_KEY='0x' + '11' * 32), [])
+        orchestrator._wallets['0x' + '11' * 32] = SimpleNamespace()
+        with pytest.raises(ValueError, match='same|already'):
+            orchestrator._wallet_for(orchestrator.pool_config(PoolSpec('b', token(3), token(4), 500)))
+
+    def test_most_urgent_pools_served_first(self):
+        orchestrator = self.make(4)
+        for address, urgency in zip([token(1), token(2), token(3), token(4)], [0.2, float('inf'), 0.9, 0.5]):
+            self.rebalancers[address].urgency = urgency
+        assert orchestrator.run_cycle(wait=True) == 4
+        assert self.log == [token(2), token(3), token(4), token(1)]
+        assert self.eth.calls == 1  # one batched slot0 read for every pool
+        assert self.rebalancers[token(3)].spots == [3.0]
+        orchestrator.stop()
+
+    def test_unchanged_price_skipped_until_idle_or_urgent(self):
+        orchestrator = self.make(2)
+        orchestrator.run_cycle(wait=True)
+        assert orchestrator.run_cycle(wait=True) == 0
+        assert orchestrator.stats['skipped_unchanged'] == 2
+
+        self.eth.sqrt_prices[orchestrator.slots[0].pool_address.lower()] += 1
+        self.rebalancers[token(2)].urgency = 1.5
+        assert orchestrator.run_cycle(wait=True) == 2
+
+        orchestrator.idle_tick_seconds = 0
+        assert orchestrator.run_cycle(wait=True) == 2
+        orchestrator.stop()
+
+    def test_busy_pool_is_not_ticked_twice(self):
+        gate = threading.Event()
+        orchestrator = self.make(1, gate=gate, ORCHESTRATOR_IDLE_TICK_SECONDS=0.0)
+        assert orchestrator.run_cycle() == 1
+        time.sleep(0.05)
+        assert orchestrator.run_cycle() == 0
+        assert orchestrator.stats['skipped_busy'] == 1
+        gate.set()
+        orchestrator.stop()
+        assert orchestrator.slots[0].ticks == 1
+
+    def test_hundred_pools_within_one_cycle(self):
+        orchestrator = self.make(100, ORCHESTRATOR_WORKERS=16)
+        started = time.perf_counter()
+        assert orchestrator.run_cycle(wait=True) == 100
+        assert time.perf_counter() - started < 1.0
+        assert len(self.log) == 100
+        orchestrator.stop()
+
+    def test_background_loop(self):
+        orchestrator = self.make(3, ORCHESTRATOR_IDLE_TICK_SECONDS=0.0)
+        orchestrator.start()
+        time.sleep(0.3)
+        orchestrator.stop()
+        status = orchestrator.get_status()
+        assert status['cycles'] >= 3
+        assert all(pool['ticks'] >= 3 for pool in status['pools'])
+        assert 'orchestrator.cycle' in status['latency']
@@ -0,0 +1,87 @@
+"""Unit tests for the differential parity harness."""
+import os
+import subprocess
+import sys
+import tempfile
+import textwrap
+
+import pytest
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from parity_harness import (
+    HERE, diff_streams, discover_param_sets, extract_tree, parse_param_name, run_matrix
+)
+
+
+def _in_git_checkout() -> bool:
+    try:
+        return subprocess.run(['git', 'rev-parse', 'HEAD'], cwd=HERE, capture_output=True).returncode == 0
+    except OSError:
+        return False
+
+
+class TestParamSets:
+    """Test decoding parameter sets from results file names."""
+
+    def test_parse_names(self):
+        assert parse_param_name('glft_min10_max50_spread20_thresh25') == {
+            'INVENTORY_MODEL': 'GLFTModel', 'MIN_RANGE_PERCENTAGE': 10.0, 'MAX_RANGE_PERCENTAGE': 50.0,
+            'BASE_SPREAD': 0.2, 'REBALANCE_THRESHOLD': 0.25}
+        assert parse_param_name('base_spread_2pct') == {'BASE_SPREAD': 0.02}
+        assert parse_param_name('range_1_5') == {'MIN_RANGE_PERCENTAGE': 1.0, 'MAX_RANGE_PERCENTAGE': 5.0}
+        assert parse_param_name('glft_fancy') is None
+
+    def test_checked_in_results_are_all_understood(self):
+        param_sets = discover_param_sets()
+        assert len(param_sets) >= 15
+        assert param_sets['min2_max5_spread2']['MAX_RANGE_PERCENTAGE'] == 5.0
+
+
+class TestDiff:
+    """Test event-by-event comparison."""
+
+    def test_tolerance_and_first_mismatch(self):
+        reference = [{'price': 1.0, 'type': 'buy', 'ranges': {'a': 2.0}}, {'price': 2.0, 'type': 'sell'}]
+        close = [{'price': 1.0 + 1e-12, 'type': 'buy', 'ranges': {'a': 2.0}}, {'price': 2.0, 'type': 'sell'}]
+        mismatch, error = diff_streams('trades', reference, close, rtol=1e-9, atol=0.0)
+        assert mismatch is None and 0 < error < 1e-11
+
+        skewed = [{'price': 1.0, 'type': 'buy', 'ranges': {'a': 2.1}}, {'price': 2.0, 'type': 'buy'}]
+        mismatch, _ = diff_streams('trades', reference, skewed, rtol=1e-9, atol=0.0)
+        assert (mismatch.index, mismatch.path, mismatch.reference, mismatch.candidate) == (0, '.ranges.a', 2.0, 2.1)
+
+    def test_stream_length(self):
+        mismatch, _ = diff_streams('rebalances', [1.0, 2.0], [1.0], rtol=0.0, atol=0.0)
+        assert mismatch.index == 1 and mismatch.reference == '2 events'
+
+
+class TestRunMatrix:
+    """End to end: same engine matches, a perturbed engine is caught."""
+
+    def test_detects_divergent_candidate(self):
+        with tempfile.TemporaryDirectory() as candidate_root:
+            with open(os.path.join(candidate_root, 'skewed_engine.py'), 'w') as f:
+                f.write(textwrap.dedent('''
+                    from backtest_engine import BacktestEngine
+
+                    class SkewedEngine(BacktestEngine):
+                        def run_backtest(self, *args, **kwargs):
+                            result = super().run_backtest(*args, **kwargs)
+                            if self.config.MIN_RANGE_PERCENTAGE == 1.0:
+                                result.trades[3].fees_earned *= 1.001
+                            return result
+                '''))
+            param_sets = {name: parse_param_name(name) for name in ('glft_min10_max50_spread20', 'range_1_5')}
+            report = run_matrix([os.path.join(HERE, 'data', 'eth_usdc_3days_real_fixed.csv')], param_sets,
+                                HERE, candidate_root, candidate_engine='skewed_engine:SkewedEngine', workers=1)
+        ok, skewed = report.results
+        assert ok.ok and ok.trades > 0 and ok.reference_seconds > 0 and ok.speedup > 0
+        assert not skewed.ok and skewed.mismatch.startswith('trades[3].fees_earned')
+        assert not report.ok
+
+    @pytest.mark.skipif(not _in_git_checkout(), reason='needs git and a git checkout')
+    def test_extract_git_revision(self):
+        with tempfile.TemporaryDirectory() as workdir:
+            root = extract_tree('git:HEAD', workdir)
+            assert os.path.exists(os.path.join(root, 'backtest_engine.py'))
+            assert os.path.exists(os.path.join(root, 'amm.py'))
@@ -0,0 +1,54 @@
+"""Unit tests for native position-manager calldata encoding."""
+import pytest
+import sys
+import os
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from eth_abi import decode
+from position_calldata import (
+    MAX_UINT128, encode_decrease_liquidity, encode_collect, encode_burn, encode_mint,
+    encode_multicall, build_rebalance_multicall
+)
+
+WALLET = '0x' + '33' * 20
+TOKEN0 = '0x' + '11' * 20
+TOKEN1 = '0x' + '22' * 20
+
+
+class TestPositionCalldata:
+    """Test selectors and argument encoding."""
+
+    def test_selectors_match_position_manager(self):
+        """Selectors are computed over the struct-param signatures."""
+        assert encode_decrease_liquidity(1, 2, 0, 0, 3)[:4].hex() == '0c49ccbe'
+        assert encode_collect(1, WALLET)[:4].hex() == 'fc6f7865'
+        assert encode_burn(1)[:4].hex() == '42966c68'
+        assert encode_mint(TOKEN0, TOKEN1, 3000, -60, 60, 1, 0, 0, 0, WALLET, 9)[:4].hex() == '88316456'
+        assert encode_multicall([])[:4].hex() == 'ac9650d8'
+
+    def test_collect_defaults_to_everything_owed(self):
+        """Collect without explicit maxima sweeps principal and fees."""
+        (args,) = decode(['(uint256,address,uint128,uint128)'], encode_collect(7, WALLET)[4:])
+        assert args == (7, WALLET.lower(), MAX_UINT128, MAX_UINT128)
+
+    def test_mint_encodes_negative_ticks(self):
+        """Signed ticks round-trip through the int24 encoding."""
+        data = encode_mint(TOKEN0, TOKEN1, 500, -887220, -600, 10, 0, 0, 0, WALLET, 9)
+        (args,) = decode(['(address,address,uint24,int24,int24,uint256,uint256,uint256,uint256,address,uint256)'],
+                         data[4:])
+        assert args[3:5] == (-887220, -600)
+
+    def test_rebalance_multicall_orders_unwinds_before_mints(self):
+        """Burn-and-remint calls are packed in execution order."""
+        data = build_rebalance_multicall(
+            unwinds=[(1, 1000), (2, 0)],
+            mints=[dict(token0=TOKEN0, token1=TOKEN1, fee=3000, tick_lower=60, tick_upper=600,
+                        amount0_desired=5, amount1_desired=0, amount0_min=0, amount1_min=0)],
+            recipient=WALLET, deadline=9
+        )
+        (calls,) = decode(['bytes[]'], data[4:])
+        assert [c[:4].hex() for c in calls] == [
+            '0c49ccbe', 'fc6f7865', '42966c68',  # position 1
+            'fc6f7865', '42966c68',  # position 2 (no liquidity left)
+            '88316456'
+        ]
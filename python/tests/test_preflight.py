@@ -0,0 +1,159 @@
+"""Unit tests for pre-flight mint simulation."""
+import os
+import sys
+from types import SimpleNamespace
+
+from eth_abi import encode
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from config import Config
+from position_calldata import build_unwind_calls
+from preflight import PreflightSimulator, decode_revert_reason, ERROR_SELECTOR, PANIC_SELECTOR
+from rpc_gateway import RpcError
+from rpc_transport import TransportError
+from shadow_mode import ShadowChain, ShadowRevert, amounts_for_liquidity, liquidity_for_amounts
+
+
+class RevertError(Exception):
+    """Shaped like web3's ContractLogicError"""
+
+    def __init__(self, message, data):
+        super().__init__(message)
+        self.data = data
+
+
+class FakeEth:
+    """eth.call against the paper chain"""
+
+    def __init__(self, chain, down=None):
+        self.chain = chain
+        self.down = down  # exception to raise instead of answering
+        self.calls = 0
+
+    def call(self, tx, block_identifier='latest'):
+        self.calls += 1
+        if self.down is not None:
+            raise self.down
+        try:
+            return self.chain.call(tx['to'], bytes.fromhex(tx['data'][2:]))
+        except ShadowRevert as e:
+            raise RevertError(f'execution reverted: {e}', '0x' + (ERROR_SELECTOR + encode(['string'], [str(e)])).hex())
+
+
+class FakeFork:
+    """A fork node whose head only moves on anvil_rollFork (or not at all when it is not anvil)"""
+
+    def __init__(self, chain, block_number, anvil=True):
+        self.eth = FakeEth(chain)
+        self.eth.block_number = block_number
+        self.anvil = anvil
+        self.provider = self
+        self.requests = []
+
+    def make_request(self, method, params):
+        self.requests.append((method, params))
+        if not self.anvil:
+            return {'jsonrpc': '2.0', 'id': 1, 'error': {'code': -32601, 'message': 'Method not found'}}
+        self.eth.block_number = params[0]
+        return {'jsonrpc': '2.0', 'id': 1, 'result': None}
+
+
+class TestPreflight:
+    """Test quoting, min bounds and rejection."""
+
+    def setup_method(self):
+        self.chain = ShadowChain()
+        self.chain.set_price(0.0004)
+        self.eth = FakeEth(self.chain)
+        config = type('TestConfig', (Config,), {
+            'PREFLIGHT_SLIPPAGE_BPS': 50, 'PREFLIGHT_RPC_URL': '',
+            'UNISWAP_V3_POSITION_MANAGER': self.chain.position_manager
+        })
+        client = SimpleNamespace(wallet_address=self.chain.wallet, config=config, w3=SimpleNamespace(eth=self.eth))
+        self.simulator = PreflightSimulator(client, config)
+
+    def mint(self, amount0, amount1, tick_lower=100, tick_upper=200):
+        """Mint ticks are relative to the pool tick (above it: token0 only)"""
+        return {'token0': self.chain.token0.address, 'token1': self.chain.token1.address, 'fee': self.chain.fee,
+                'tick_lower': self.chain.tick + tick_lower, 'tick_upper': self.chain.tick + tick_upper,
+                'amount0_desired': amount0, 'amount1_desired': amount1, 'amount0_min': 0, 'amount1_min': 0}
+
+    def quote(self, mint):
+        args = (self.chain.sqrt_price_x96, mint['tick_lower'], mint['tick_upper'])
+        liquidity = liquidity_for_amounts(*args, mint['amount0_desired'], mint['amount1_desired'])
+        return amounts_for_liquidity(liquidity, *args)
+
+    def test_mints_are_quoted_and_bounded(self):
+        mints = [self.mint(10 ** 9, 0), self.mint(0, 2 * 10 ** 17, -200, -100)]
+        expected = [self.quote(mint) for mint in mints]
+        plan = self.simulator.plan_mints(mints, self.chain.wallet, 2 ** 32)
+        assert plan.ok and not plan.skipped and self.eth.calls == 1
+        assert [(q.amount0, q.amount1) for q in plan.quotes] == expected
+        assert expected[0][0] > 10 ** 9 * 0.999 and expected[1][1] > 2 * 10 ** 17 * 0.999
+        assert plan.mints[0]['amount0_min'] == expected[0][0] * 9_950 // 10_000 and plan.mints[0]['amount1_min'] == 0
+        assert plan.mints[1]['amount1_min'] == expected[1][1] * 9_950 // 10_000
+        assert self.chain.positions == {}  # simulation left no trace
+        assert self.chain.token0.balance == 3000 * 10 ** 6
+
+    def test_unwind_prefix_runs_in_the_same_simulation(self):
+        self.chain.positions[7] = {'tick_lower': self.chain.tick - 30, 'tick_upper': self.chain.tick + 30,
+                                   'liquidity': 50, 'owed0': 0, 'owed1': 0}
+        self.chain._next_token_id = 8
+        plan = self.simulator.plan_mints([self.mint(10 ** 6, 0)], self.chain.wallet, 2 ** 32,
+                                         prefix_calls=build_unwind_calls(7, 50, self.chain.wallet, 2 ** 32))
+        assert plan.ok and plan.quotes[0].token_id == 8
+        assert 7 in self.chain.positions and self.chain._next_token_id == 8
+
+    def test_reverting_plan_is_rejected(self):
+        plan = self.simulator.plan_mints([self.mint(10 ** 6, 0)], self.chain.wallet, 2 ** 32,
+                                         prefix_calls=build_unwind_calls(99, 1, self.chain.wallet, 2 ** 32))
+        assert not plan.ok and plan.reason == 'Invalid token ID'
+
+        too_tight = dict(self.mint(10 ** 6, 0), amount0_min=2 * 10 ** 6)
+        plan = self.simulator.plan_mints([too_tight], self.chain.wallet, 2 ** 32)
+        assert not plan.ok and plan.reason == 'Price slippage check'
+
+        beyond_wallet = self.mint(10 ** 10, 0)
+        plan = self.simulator.plan_mints([beyond_wallet], self.chain.wallet, 2 ** 32)
+        assert not plan.ok and plan.reason == 'STF'
+
+    def test_unreachable_node_skips_without_bounds(self):
+        for error in (ConnectionError('fork not running'), TransportError('HTTP 502 from fork'),
+                      RpcError({'code': -32603, 'message': 'internal error'})):
+            self.eth.down = error
+            plan = self.simulator.plan_mints([self.mint(10 ** 6, 0)], self.chain.wallet, 2 ** 32)
+            assert plan.ok and plan.skipped, error
+            assert plan.mints[0]['amount0_min'] == 0
+
+    def test_node_revert_error_is_a_rejection(self):
+        data = '0x' + (ERROR_SELECTOR + encode(['string'], ['STF'])).hex()
+        self.eth.down = RpcError({'code': 3, 'message': 'execution reverted: STF', 'data': data})
+        plan = self.simulator.plan_mints([self.mint(10 ** 6, 0)], self.chain.wallet, 2 ** 32)
+        assert not plan.ok and not plan.skipped and plan.reason == 'STF'
+
+    def test_fork_is_rolled_to_the_live_head(self):
+        client = self.simulator.client
+        client.state_cache = SimpleNamespace(current_block=lambda: 120)
+        fork = FakeFork(self.chain, 100)
+        simulator = PreflightSimulator(client, self.simulator.config, w3=fork)
+        assert simulator.plan_mints([self.mint(10 ** 6, 0)], self.chain.wallet, 2 ** 32).ok
+        assert fork.requests == [('anvil_rollFork', [120])] and fork.eth.calls == 1 and self.eth.calls == 0
+
+        # Already at the head: no roll
+        assert simulator.plan_mints([self.mint(10 ** 6, 0)], self.chain.wallet, 2 ** 32).ok
+        assert len(fork.requests) == 1 and fork.eth.calls == 2
+
+    def test_fork_that_cannot_roll_falls_back_to_the_live_node(self):
+        client = self.simulator.client
+        client.state_cache = SimpleNamespace(current_block=lambda: 120)
+        fork = FakeFork(self.chain, 100, anvil=False)
+        plan = PreflightSimulator(client, self.simulator.config, w3=fork).plan_mints(
+            [self.mint(10 ** 6, 0)], self.chain.wallet, 2 ** 32)
+        assert plan.ok and not plan.skipped
+        assert fork.eth.calls == 0 and self.eth.calls == 1
+
+    def test_decode_revert_reason(self):
+        assert decode_revert_reason('0x' + (ERROR_SELECTOR + encode(['string'], ['STF'])).hex()) == 'STF'
+        assert decode_revert_reason(PANIC_SELECTOR + encode(['uint256'], [0x11])) == 'panic 0x11'
+        assert decode_revert_reason('0x') is None
+        assert decode_revert_reason(b'\x12\x34\x56\x78') is None
@@ -0,0 +1,218 @@
+"""Tests for the websocket pool price feed against a local JSON-RPC stand-in."""
+import pytest
+import sys
+import os
+import asyncio
+import json
+import threading
+import time
+from unittest.mock import Mock
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+import websockets
+from eth_abi import encode
+from price_feed import PoolPriceFeed, PoolState, SWAP_TOPIC, SLOT0_CALL, SLOT0_TYPES, decode_swap_log
+
+POOL = '0x' + 'ab' * 20
+
+
+def swap_log(block, index, sqrt_price, tick, liquidity=10**18):
+    data = encode(['int256', 'int256', 'uint160', 'uint128', 'int24'], [1, -1, sqrt_price, liquidity, tick])
+    return {'address': POOL, 'topics': [SWAP_TOPIC], 'data': '0x' + data.hex(),
+            'blockNumber': hex(block), 'logIndex': hex(index), 'removed': False}
+
+
+class FakeNode:
+    """Minimal eth_subscribe / eth_getLogs websocket node running on its own loop."""
+
+    def __init__(self):
+        self.logs = []
+        self.block = 100
+        self.slot0 = (2**96, 0)
+        self.liquidity = 10**18
+        self.connections = []
+        self.subscribe_count = 0
+        self.loop = asyncio.new_event_loop()
+        self.ready = threading.Event()
+        self.thread = threading.Thread(target=self._run, daemon=True)
+        self.thread.start()
+        self.ready.wait(5)
+
+    def _run(self):
+        asyncio.set_event_loop(self.loop)
+        self.loop.run_until_complete(self._serve())
+
+    async def _serve(self):
+        self.stopped = asyncio.Event()
+        async with websockets.serve(self._handler, '127.0.0.1', 0) as server:
+            self.port = server.sockets[0].getsockname()[1]
+            self.ready.set()
+            await self.stopped.wait()
+
+    async def _handler(self, ws):
+        subs = {}
+        self.connections.append((ws, subs))
+        async for message in ws:
+            request = json.loads(message)
+            method, params = request['method'], request['params']
+            if method == 'eth_subscribe':
+                self.subscribe_count += 1
+                sub_id = hex(self.subscribe_count)
+                subs[params[0]] = sub_id
+                result = sub_id
+            elif method == 'eth_blockNumber':
+                result = hex(self.block)
+            elif method == 'eth_getLogs':
+                lo, hi = int(params[0]['fromBlock'], 16), int(params[0]['toBlock'], 16)
+                result = [l for l in self.logs if lo <= int(l['blockNumber'], 16) <= hi]
+            elif method == 'eth_call':
+                raw = (encode(SLOT0_TYPES, [*self.slot0, 0, 1, 1, 0, True]) if params[0]['data'] == SLOT0_CALL
+                       else encode(['uint128'], [self.liquidity]))
+                result = '0x' + raw.hex()
+            else:
+                result = None
+            await ws.send(json.dumps({'jsonrpc': '2.0', 'id': request['id'], 'result': result}))
+
+    def push(self, kind, payload):
+        async def _push():
+            for ws, subs in list(self.connections):
+                if kind in subs:
+                    await ws.send(json.dumps({'jsonrpc': '2.0', 'method': 'eth_subscription',
+                                              'params': {'subscription': subs[kind], 'result': payload}}))
+        asyncio.run_coroutine_threadsafe(_push(), self.loop).result(5)
+
+    def emit_swap(self, log, live=True):
+        self.logs.append(log)
+        self.block = max(self.block, int(log['blockNumber'], 16))
+        if live:
+            self.push('logs', log)
+
+    def drop_connections(self):
+        async def _drop():
+            for ws, _ in list(self.connections):
+                await ws.close()
+            self.connections.clear()
+        asyncio.run_coroutine_threadsafe(_drop(), self.loop).result(5)
+
+    def stop(self):
+        self.loop.call_soon_threadsafe(self.stopped.set)
+        self.thread.join(5)
+
+
+def wait_for(predicate, timeout=5.0):
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        if predicate():
+            return True
+        time.sleep(0.01)
+    return False
+
+
+def make_config(backfill_max_blocks=1000):
+    config = Mock()
+    config.PRICE_FEED_MAX_BACKOFF_SECONDS = 0.2
+    config.PRICE_FEED_BACKFILL_MAX_BLOCKS = backfill_max_blocks
+    return config
+
+
+class TestPoolPriceFeed:
+    """Test subscription handling, change detection, resubscribe and backfill."""
+
+    def setup_method(self):
+        self.node = FakeNode()
+        self.changes = []
+        self.heads = []
+        self.feed = PoolPriceFeed(
+            f'ws://127.0.0.1:{self.node.port}', POOL, self.changes.append,
+            on_new_head=self.heads.append,
+            initial_state=PoolState(100, -1, 2**96, 0, 10**18),
+            config=make_config()
+        )
+        self.feed.start()
+        assert self.feed.connected.wait(5)
+
+    def teardown_method(self):
+        self.feed.stop()
+        self.node.stop()
+
+    def test_decode_swap_log(self):
+        """Swap data decodes to sqrtPrice, liquidity and a signed tick."""
+        state = decode_swap_log(swap_log(5, 2, 123, -887000, 42))
+        assert (state.block_number, state.log_index, state.sqrt_price_x96, state.tick, state.liquidity) == \
+            (5, 2, 123, -887000, 42)
+
+    def test_notifies_only_on_state_change(self):
+        """Swaps that leave price, tick and liquidity unchanged do not trigger a callback."""
+        self.node.emit_swap(swap_log(101, 0, 2**96 + 1, 1))
+        self.node.emit_swap(swap_log(101, 1, 2**96 + 1, 1))  # no change
+        self.node.emit_swap(swap_log(102, 0, 2**96 + 2, 2))
+        assert wait_for(lambda: self.feed.stats['swaps'] == 3)
+        assert [s.tick for s in self.changes] == [1, 2]
+
+    def test_new_heads_forwarded(self):
+        """Block headers reach the new-head hook with a decoded number."""
+        self.node.push('newHeads', {'number': hex(105), 'baseFeePerGas': hex(10)})
+        assert wait_for(lambda: self.heads)
+        assert self.heads[0]['number'] == 105
+
+    def test_resubscribe_and_backfill_gap(self):
+        """Logs emitted while disconnected are replayed once, in order, after reconnect."""
+        self.node.emit_swap(swap_log(101, 0, 2**96 + 1, 1))
+        assert wait_for(lambda: len(self.changes) == 1)
+
+        self.feed.connected.clear()
+        self.node.drop_connections()
+        self.node.emit_swap(swap_log(103, 0, 2**96 + 3, 3), live=False)
+        self.node.emit_swap(swap_log(103, 1, 2**96 + 4, 4), live=False)
+
+        assert wait_for(lambda: self.feed.connected.is_set() and self.feed.stats['connects'] == 2)
+        assert wait_for(lambda: len(self.changes) == 3)
+        assert [s.tick for s in self.changes] == [1, 3, 4]
+        assert self.feed.stats['backfilled'] == 2
+        assert self.node.subscribe_count == 4  # newHeads + logs, twice
+
+    def test_removed_log_rolls_back_and_replacement_applies(self):
+        """A reorged-out swap restores the state below its block; the replacement chain's swap applies."""
+        self.node.emit_swap(swap_log(101, 0, 2**96 + 1, 1))
+        self.node.emit_swap(swap_log(102, 0, 2**96 + 2, 2))
+        assert wait_for(lambda: len(self.changes) == 2)
+
+        self.node.push('logs', dict(swap_log(102, 0, 2**96 + 2, 2), removed=True))
+        assert wait_for(lambda: len(self.changes) == 3)
+        assert self.feed.state.tick == 1 and self.feed.stats['reorgs'] == 1
+
+        self.node.push('logs', swap_log(102, 0, 2**96 + 5, 5))
+        assert wait_for(lambda: len(self.changes) == 4)
+        assert [s.tick for s in self.changes] == [1, 2, 1, 5]
+
+    def test_reorg_past_history_rereads_slot0(self):
+        """With no state left below the reorged block, the state is re-read from slot0."""
+        self.node.emit_swap(swap_log(101, 0, 2**96 + 1, 1))
+        assert wait_for(lambda: len(self.changes) == 1)
+        self.node.slot0 = (2**96 + 7, 7)
+        self.node.push('logs', dict(swap_log(100, 0, 2**96, 0), removed=True))
+        assert wait_for(lambda: self.feed.stats['resyncs'] == 1)
+        assert self.feed.state.tick == 7 and self.changes[-1].tick == 7
+
+
+class TestBackfillGap:
+    """Test a reconnect gap longer than PRICE_FEED_BACKFILL_MAX_BLOCKS."""
+
+    def test_long_gap_rereads_slot0(self):
+        node = FakeNode()
+        changes = []
+        feed = PoolPriceFeed(f'ws://127.0.0.1:{node.port}', POOL, changes.append,
+                             initial_state=PoolState(100, -1, 2**96, 0, 10**18), config=make_config(10))
+        feed.start()
+        try:
+            assert feed.connected.wait(5)
+            feed.connected.clear()
+            node.drop_connections()
+            node.emit_swap(swap_log(150, 0, 2**96 + 3, 3), live=False)
+            node.slot0 = (2**96 + 3, 3)
+            assert wait_for(lambda: feed.connected.is_set() and feed.stats['connects'] == 2)
+            assert feed.stats['resyncs'] == 1 and feed.stats['backfilled'] == 0
+            assert feed.state.block_number == 150 and [s.tick for s in changes] == [3]
+        finally:
+            feed.stop()
+            node.stop()
@@ -0,0 +1,61 @@
+"""Unit tests for the backtest phase profiler."""
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from backtest_engine import BacktestEngine
+from config import Config
+from profiler import PhaseProfiler
+
+HERE = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DATA = os.path.join(HERE, 'data', 'eth_usdc_3days_real_fixed.csv')
+
+
+class TestPhaseProfiler:
+    """Test nested phase attribution."""
+
+    def test_nested_paths_split_self_time(self):
+        profiler = PhaseProfiler(allocations=True)
+        leaf = profiler.wrap('leaf', lambda n: sum(range(n)))
+        outer = profiler.wrap('outer', lambda: [leaf(20000) for _ in range(3)])
+        with profiler.phase('root'):
+            outer()
+            leaf(10)
+        assert {path: stat.calls for path, stat in profiler.paths.items()} == {
+            ('root',): 1, ('root', 'outer'): 1, ('root', 'outer', 'leaf'): 3, ('root', 'leaf'): 1}
+        outer_stat = profiler.paths[('root', 'outer')]
+        assert 0 <= outer_stat.self_wall_ns < outer_stat.wall_ns
+        rows = {row['phase']: row for row in profiler.phases()}
+        assert rows['leaf']['calls'] == 4
+        assert abs(sum(row['self_pct'] for row in rows.values()) - 100.0) < 1e-6
+        assert all(line.startswith('root') and line.rsplit(' ', 1)[1].isdigit() for line in profiler.folded())
+        assert 'net blocks' in profiler.format_table()
+
+
+class TestBacktestProfiling:
+    """Test profiling a real backtest run."""
+
+    def _engine(self):
+        return BacktestEngine(type('TestConfig', (Config,), {'INVENTORY_MODEL': 'GLFTModel'})())
+
+    def test_phases_are_attributed_and_removed(self):
+        plain = self._engine().run_backtest(DATA, 3000.0, 1.0)
+        engine = self._engine()
+        engine.profiler = PhaseProfiler()
+        result = engine.run_backtest(DATA, 3000.0, 1.0)
+        assert (result.total_trades, result.final_balance_0) == (plain.total_trades, plain.final_balance_0)
+
+        rows = {row['phase']: row for row in engine.profiler.phases()}
+        assert rows['run_backtest']['calls'] == 1
+        assert rows['amm.compute_into']['calls'] == rows['should_rebalance']['calls'] > result.total_trades
+        assert rows['rebalance_positions']['calls'] == result.total_rebalances
+        assert rows['model.calculate_lp_ranges']['calls'] == result.total_rebalances
+        assert ('run_backtest', 'rebalance_positions', 'strategy.plan_rebalance',
+                'model.calculate_lp_ranges') in engine.profiler.paths
+        # Wrappers only live for the run
+        assert 'should_rebalance' not in vars(engine)
+        assert 'calculate_lp_ranges' not in vars(engine.inventory_model)
+
+        engine.profiler = None
+        engine.run_backtest(DATA, 3000.0, 1.0)
+        assert 'should_rebalance' not in vars(engine)
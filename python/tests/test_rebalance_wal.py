@@ -0,0 +1,129 @@
+"""Unit tests for the rebalance write-ahead log and Multicall3 batched reads."""
+import pytest
+import sys
+import os
+from unittest.mock import Mock
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from eth_abi import encode, decode
+from rebalance_wal import RebalanceWAL, STATE_INTENT, STATE_SUBMITTED, STATE_UNWOUND, STATE_COMPLETE
+from multicall3 import Multicall3, AGGREGATE3_SELECTOR, encode_call
+
+
+class TestRebalanceWAL:
+    """Test journaling, replay and compaction."""
+
+    def setup_method(self):
+        self.path = None
+
+    def open_wal(self, tmp_path, **kwargs):
+        self.path = str(tmp_path / 'wal.jsonl')
+        return RebalanceWAL(self.path, fsync=False, **kwargs)
+
+    def test_replay_restores_baselines_positions_and_prices(self, tmp_path):
+        """A fresh WAL instance sees everything the previous one journaled."""
+        wal = self.open_wal(tmp_path, price_window=3)
+        for i in range(5):
+            wal.record_price(2000.0 + i, timestamp=i)
+        wal.record_baseline(1000.0, 0.5, 2004.0)
+        wal.record_positions([11, 12])
+        wal.close()
+
+        state = RebalanceWAL(self.path, price_window=3, fsync=False).replay()
+        assert [p['price'] for p in state.price_history] == [2002.0, 2003.0, 2004.0]
+        assert (state.last_rebalance_token0, state.last_rebalance_token1, state.last_rebalance_price) == \
+            (1000.0, 0.5, 2004.0)
+        assert state.positions == [11, 12]
+        assert state.in_flight is None
+
+    def test_in_flight_rebalance_tracks_latest_phase(self, tmp_path):
+        """An unfinished rebalance is replayed with its current state, phase and tx hashes."""
+        wal = self.open_wal(tmp_path)
+        wal.record_rebalance('r1', STATE_INTENT, token_ids=[11], mode='pipelined')
+        wal.record_rebalance('r1', STATE_SUBMITTED, phase='unwind', tx_hashes=['0xa', '0xb'])
+        wal.record_rebalance('r1', STATE_UNWOUND)
+        wal.record_rebalance('r1', STATE_SUBMITTED, phase='mint', tx_hashes=['0xc'])
+        wal.close()
+
+        in_flight = RebalanceWAL(self.path, fsync=False).replay().in_flight
+        assert in_flight['id'] == 'r1'
+        assert in_flight['state'] == STATE_SUBMITTED
+        assert in_flight['phase'] == 'mint'
+        assert in_flight['tx_hashes'] == ['0xc']
+        assert in_flight['token_ids'] == [11]
+
+    def test_completed_rebalance_is_not_in_flight(self, tmp_path):
+        """Terminal states clear the in-flight record."""
+        wal = self.open_wal(tmp_path)
+        wal.record_rebalance('r1', STATE_INTENT, token_ids=[], mode='multicall')
+        wal.record_rebalance('r1', STATE_COMPLETE)
+        assert wal.replay().in_flight is None
+
+    def test_torn_tail_is_ignored(self, tmp_path):
+        """A partially written final record does not prevent recovery."""
+        wal = self.open_wal(tmp_path)
+        wal.record_positions([7])
+        wal.close()
+        with open(self.path, 'a') as f:
+            f.write('{"seq": 2, "type": "posi')
+
+        assert RebalanceWAL(self.path, fsync=False).replay().positions == [7]
+
+    def test_append_after_torn_tail_survives_restart(self, tmp_path):
+        """Records journaled after a torn line are not glued onto it and lost."""
+        wal = self.open_wal(tmp_path)
+        wal.record_positions([7])
+        wal.close()
+        with open(self.path, 'a') as f:
+            f.write('{"seq": 2, "type": "posi')
+
+        wal = RebalanceWAL(self.path, fsync=False)
+        wal.record_rebalance('r1', STATE_INTENT, token_ids=[7], mode='pipelined')
+        wal.record_rebalance('r1', STATE_SUBMITTED, phase='unwind', tx_hashes=['0xa'])
+        wal.close()
+
+        state = RebalanceWAL(self.path, fsync=False).replay()
+        assert state.positions == [7]
+        assert state.in_flight['state'] == STATE_SUBMITTED and state.in_flight['tx_hashes'] == ['0xa']
+        with open(self.path) as f:
+            assert all(line.startswith('{"seq"') for line in f.read().splitlines())
+
+    def test_compaction_preserves_state(self, tmp_path):
+        """Compaction rewrites the log as one checkpoint with identical state."""
+        wal = self.open_wal(tmp_path, compact_every=4)
+        wal.record_rebalance('r1', STATE_INTENT, token_ids=[1], mode='pipelined')
+        for i in range(5):
+            wal.record_price(float(i), timestamp=i)
+        wal.close()
+
+        with open(self.path) as f:
+            lines = f.read().splitlines()
+        assert len(lines) == 3  # checkpoint (records 1-4) + records 5 and 6
+        state = RebalanceWAL(self.path, fsync=False).replay()
+        assert state.in_flight['id'] == 'r1'
+        assert [p['price'] for p in state.price_history] == [0.0, 1.0, 2.0, 3.0, 4.0]
+        assert state.last_seq == 6
+
+
+class TestMulticall3:
+    """Test aggregate3 encoding and per-call decoding."""
+
+    def test_read_decodes_successes_and_failures(self):
+        """Reverted sub-calls come back as None; the rest are ABI-decoded."""
+        w3 = Mock()
+        w3.eth.call.return_value = encode(['(bool,bytes)[]'], [[
+            (True, encode(['uint256'], [2])),
+            (False, b''),
+        ]])
+        target = '0x' + '11' * 20
+        results = Multicall3(w3).read([
+            (target, encode_call('balanceOf(address)', ['address'], [target]), ['uint256']),
+            (target, encode_call('positions(uint256)', ['uint256'], [5]), ['uint96']),
+        ])
+        assert results == [(2,), None]
+
+        data = bytes.fromhex(w3.eth.call.call_args[0][0]['data'][2:])
+        assert data[:4] == AGGREGATE3_SELECTOR
+        (calls,) = decode(['(address,bool,bytes)[]'], data[4:])
+        assert [c[2][:4].hex() for c in calls] == ['70a08231', '99fbab88']
+        assert all(c[1] for c in calls)  # allowFailure
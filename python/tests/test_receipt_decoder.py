@@ -0,0 +1,83 @@
+"""Unit tests for the position-manager receipt log decoder."""
+import os
+import sys
+
+from eth_abi import encode
+from eth_account import Account
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from position_calldata import build_rebalance_multicall, encode_mint
+from receipt_decoder import (
+    decode_logs, decode_receipts, TRANSFER_TOPIC, INCREASE_LIQUIDITY_TOPIC, ZERO_ADDRESS
+)
+from shadow_mode import ShadowChain, SHADOW_PRIVATE_KEY, amounts_for_liquidity, liquidity_for_amounts
+
+
+def send(chain, nonce, data):
+    tx = {'to': chain.position_manager, 'data': '0x' + data.hex(), 'value': 0, 'gas': 500000,
+          'maxFeePerGas': 2 * 10 ** 9, 'maxPriorityFeePerGas': 10 ** 9, 'nonce': nonce,
+          'chainId': chain.chain_id, 'type': 2}
+    raw = Account.sign_transaction(tx, SHADOW_PRIVATE_KEY).rawTransaction
+    return chain.receipts[chain.send_raw_transaction(bytes(raw))]
+
+
+class TestReceiptDecoder:
+    """Test decoding mint and unwind receipts from the paper chain."""
+
+    def setup_method(self):
+        self.chain = ShadowChain()
+        self.npm = self.chain.position_manager
+
+    def mint(self, amount0, amount1, tick_lower=100, tick_upper=200):
+        return dict(token0=self.chain.token0.address, token1=self.chain.token1.address, fee=self.chain.fee,
+                    tick_lower=tick_lower, tick_upper=tick_upper, amount0_desired=amount0, amount1_desired=amount1,
+                    amount0_min=0, amount1_min=0)
+
+    def expected(self, mint):
+        """(liquidity, amount0, amount1) the paper chain mints at its price (tick 0)"""
+        args = (self.chain.sqrt_price_x96, mint['tick_lower'], mint['tick_upper'])
+        liquidity = liquidity_for_amounts(*args, mint['amount0_desired'], mint['amount1_desired'])
+        return (liquidity,) + amounts_for_liquidity(liquidity, *args)
+
+    def test_minted_positions_from_multicall_receipt(self):
+        mints = [self.mint(700 * 10 ** 6, 0), self.mint(0, 3 * 10 ** 17, -200, -100)]
+        data = build_rebalance_multicall([], mints, self.chain.wallet, 2 ** 32)
+        events = decode_receipts([send(self.chain, 0, data)], self.npm)
+        minted = events.minted()
+        assert [(m.token_id, m.liquidity, m.amount0, m.amount1) for m in minted] == [
+            (1,) + self.expected(mints[0]), (2,) + self.expected(mints[1])]
+        assert minted[0].amount1 == 0 and minted[1].amount0 == 0
+        assert minted[0].owner == self.chain.wallet
+        assert events.burned() == []
+
+    def test_unwind_receipt(self):
+        mint = self.mint(800 * 10 ** 6, 2 * 10 ** 17, -100, 100)
+        liquidity, amount0, amount1 = self.expected(mint)
+        send(self.chain, 0, encode_mint(recipient=self.chain.wallet, deadline=2 ** 32, **mint))
+        receipt = send(self.chain, 1, build_rebalance_multicall([(1, liquidity)], [], self.chain.wallet, 2 ** 32))
+        events = decode_receipts([receipt], self.npm)
+        assert amount0 > 0 and amount1 > 0
+        assert events.removed() == (amount0, amount1)
+        assert events.collected() == (amount0, amount1)
+        assert events.collects[0].recipient == self.chain.wallet
+        assert events.burned() == [1] and events.minted() == []
+
+    def test_ignores_erc20_transfers_foreign_logs_and_reverts(self):
+        wallet_topic = b'\x00' * 12 + bytes.fromhex(self.chain.wallet[2:])
+        logs = [
+            # ERC20 Transfer from the token contract: 3 topics, value in data
+            {'address': self.chain.token0.address, 'topics': [TRANSFER_TOPIC, b'\x00' * 32, wallet_topic],
+             'data': encode(['uint256'], [5]), 'logIndex': 0},
+            # Same event from another contract, web3-style bytes topics
+            {'address': self.chain.pool, 'topics': [INCREASE_LIQUIDITY_TOPIC, (9).to_bytes(32, 'big')],
+             'data': encode(['uint128', 'uint256', 'uint256'], [1, 2, 3]), 'logIndex': 1},
+            {'address': self.npm, 'topics': [TRANSFER_TOPIC, b'\x00' * 32, wallet_topic, (4).to_bytes(32, 'big')],
+             'data': b'', 'logIndex': 2}
+        ]
+        events = decode_logs(logs, self.npm)
+        assert events.increases == [] and len(events.transfers) == 1
+        assert events.transfers[0].sender == ZERO_ADDRESS and events.transfers[0].token_id == 4
+        assert events.minted() == []  # NFT minted but no IncreaseLiquidity from the manager
+
+        reverted = {'status': '0x0', 'logs': logs}
+        assert decode_receipts([reverted, None], self.npm).transfers == []
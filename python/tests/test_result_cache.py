@@ -0,0 +1,129 @@
+"""Unit tests for the content-addressed backtest result cache."""
+import os
+import shutil
+import sys
+import threading
+from concurrent.futures import ProcessPoolExecutor
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+import main
+from backtest_config import BacktestConfig
+from backtest_engine import BacktestEngine
+from config import Config
+from result_cache import ResultCache, cache_key, canonical_parameters
+
+HERE = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DATA = os.path.join(HERE, 'data', 'eth_usdc_3days_real_fixed.csv')
+
+
+def _config(**overrides):
+    return type('TestConfig', (Config,), {'INVENTORY_MODEL': 'GLFTModel', **overrides})()
+
+
+def _write_entry(args):
+    directory, key, payload = args
+    ResultCache(directory).put(key, payload)
+    return ResultCache(directory).get(key) == payload
+
+
+class TestCacheKey:
+    """Test what the key covers."""
+
+    def test_key_tracks_data_parameters_and_run_arguments(self, tmp_path):
+        base = cache_key(DATA, _config(), initial_balance_0=3000.0)
+        assert cache_key(DATA, _config(), initial_balance_0=3000.0) == base
+        assert cache_key(DATA, _config(BASE_SPREAD=0.15), initial_balance_0=3000.0) != base
+        assert cache_key(DATA, _config(), initial_balance_0=2500.0) != base
+        # A byte-identical copy is the same dataset; one changed byte is not
+        copy = tmp_path / 'copy.csv'
+        shutil.copy(DATA, copy)
+        assert cache_key(str(copy), _config(), initial_balance_0=3000.0) == base
+        copy.write_bytes(copy.read_bytes().replace(b'.', b'.1', 1))
+        assert cache_key(str(copy), _config(), initial_balance_0=3000.0) != base
+
+    def test_engine_backtest_config_is_part_of_the_key(self, tmp_path):
+        cache = ResultCache(str(tmp_path))
+        calls = []
+        for backtest_config in (BacktestConfig(), BacktestConfig(), BacktestConfig(risk_free_rate=0.05)):
+            engine = BacktestEngine(_config(), backtest_config)
+            cache.run(engine, lambda: calls.append(1) or {'run': len(calls)}, DATA, 3000.0, 1.0)
+        assert (len(calls), cache.hits, cache.misses) == (2, 1, 2)
+
+    def test_ignored_and_secret_settings(self):
+        params = canonical_parameters(_config(PRIVATE_KEY='0xabc'))['config']
+        assert 'PRIVATE_KEY' not in params and 'TELEGRAM_BOT_TOKEN' not in params
+        assert 'ETHEREUM_RPC_URL' not in params and params['BASE_SPREAD'] == Config.BASE_SPREAD
+        assert cache_key(DATA, _config(TARGET_INVENTORY_RATIO=0.9)) == cache_key(DATA, _config())
+
+
+class TestResultCache:
+    """Test cached runs and concurrent writers."""
+
+    def test_hit_returns_stored_result(self, tmp_path):
+        engine = BacktestEngine(_config())
+        engine.result_cache = ResultCache(str(tmp_path))
+        computed = engine.run_backtest(DATA, 3000.0, 1.0)
+        assert (engine.result_cache.hits, engine.result_cache.misses) == (0, 1)
+
+        cache = ResultCache(str(tmp_path))
+        other = BacktestEngine(_config())
+        other.result_cache = cache
+        loaded = other.run_backtest(DATA, 3000.0, 1.0)
+        assert cache.hits == 1 and other.balance_0 == 0.0
+        assert (loaded.final_balance_0, loaded.total_rebalances) == (computed.final_balance_0, computed.total_rebalances)
+        assert list(loaded.trades) == list(computed.trades)
+        assert other.run_backtest(DATA, 3000.0, 1.0) is loaded
+
+        summary = other.run_backtest(DATA, 3000.0, 1.0, summary_only=True)
+        assert cache.misses == 1 and summary.summary.trades == computed.total_trades
+
+    def test_unreadable_entry_is_a_miss(self, tmp_path):
+        cache = ResultCache(str(tmp_path))
+        cache.put('ab' * 32, {'value': 1})
+        with open(cache.path('ab' * 32), 'wb') as f:
+            f.write(b'not a pickle')
+        assert ResultCache(str(tmp_path)).get('ab' * 32) is None
+
+    def test_concurrent_writers_leave_complete_entries(self, tmp_path):
+        key = 'cd' * 32
+        payload = {'trades': list(range(200000))}
+        with ProcessPoolExecutor(max_workers=4) as pool:
+            assert all(pool.map(_write_entry, [(str(tmp_path), key, payload)] * 8))
+        seen = []
+        threads = [threading.Thread(target=lambda: seen.append(ResultCache(str(tmp_path)).get(key) == payload))
+                   for _ in range(4)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        assert seen == [True] * 4
+        assert [name for name in os.listdir(tmp_path / key[:2])] == [key + '.pkl']
+
+
+class TestCommandLine:
+    """Test the cache through main.py --historical-mode --result-cache."""
+
+    def run_cli(self, tmp_path, *extra):
+        args = main.build_parser().parse_args([
+            '--historical-mode', '--ohlc-file', DATA, '--output', str(tmp_path / 'results.json'),
+            '--initial-balance-0', '3000', '--initial-balance-1', '1', *extra])
+        return main.run_historical_mode(args)
+
+    def test_second_identical_run_is_a_hit(self, tmp_path, capsys):
+        cache_dir = tmp_path / 'cache'
+        assert self.run_cli(tmp_path, '--result-cache', str(cache_dir)) == 0
+        first = capsys.readouterr().out
+        assert 'Result cache: miss, stored' in first and len(list(ResultCache(str(cache_dir)).entries())) == 1
+
+        assert self.run_cli(tmp_path, '--result-cache', str(cache_dir)) == 0
+        second = capsys.readouterr().out
+        assert 'Result cache: hit' in second
+        assert first[first.index('Backtest Results'):] == second[second.index('Backtest Results'):]
+
+        assert self.run_cli(tmp_path, '--result-cache', str(cache_dir), '--fee-tier', '30') == 0
+        assert 'Result cache: miss, stored' in capsys.readouterr().out
+        assert len(list(ResultCache(str(cache_dir)).entries())) == 2
+
+    def test_cache_is_off_by_default(self, tmp_path, capsys):
+        assert self.run_cli(tmp_path) == 0
+        assert 'Result cache' not in capsys.readouterr().out
@@ -0,0 +1,240 @@
+"""Unit tests for the shared RPC gateway."""
+import json
+import os
+import sys
+import threading
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+import pytest
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from config import Config
+from rpc_gateway import (
+    RpcGateway, RpcError, RpcUnavailable, SendOutcomeUnknown, TokenBucket, TransportError, GatewayProvider,
+    LANE_DOWNLOAD, LANE_MONITORING, rpc_lane
+)
+from shadow_mode import ShadowChain, MockRpcServer
+
+
+def make_config(**overrides):
+    values = {'RPC_ENDPOINTS': [], 'RPC_RATE_LIMIT_PER_SECOND': 1000.0, 'RPC_BURST': 1000.0,
+              'RPC_BATCH_MAX': 20, 'RPC_BATCH_WINDOW_MS': 0.0, 'RPC_CONCURRENCY': 1,
+              'RPC_TIMEOUT_SECONDS': 2.0, 'RPC_MAX_ATTEMPTS': 3, 'RPC_FAILOVER_COOLDOWN_SECONDS': 5.0}
+    values.update(overrides)
+    return type('TestConfig', (Config,), values)
+
+
+class FakeTransport:
+    """Answers every request with its method name; records what each endpoint received"""
+
+    def __init__(self, fail=(), gate=None):
+        self.fail = dict.fromkeys(fail, TransportError('connection refused'))
+        self.gate = gate
+        self.posts = []
+        self.lock = threading.Lock()
+
+    def __call__(self, url, body, timeout):
+        payload = json.loads(body)
+        with self.lock:
+            self.posts.append((url, payload))
+        if self.gate is not None:
+            self.gate.wait(5)
+        if url in self.fail:
+            raise self.fail[url]
+        requests = payload if isinstance(payload, list) else [payload]
+        responses = [self.answer(url, r) for r in requests]
+        return responses if isinstance(payload, list) else responses[0]
+
+    def answer(self, url, request):
+        if request['method'] == 'eth_call' and request['params'][0].get('data') == '0xdead':
+            return {'jsonrpc': '2.0', 'id': request['id'], 'error': {'code': 3, 'message': 'execution reverted'}}
+        return {'jsonrpc': '2.0', 'id': request['id'], 'result': request['method']}
+
+    def methods(self, url=None):
+        found = []
+        for post_url, payload in self.posts:
+            if url is None or post_url == url:
+                found.extend(r['method'] for r in (payload if isinstance(payload, list) else [payload]))
+        return found
+
+
+class FakeClock:
+    def __init__(self):
+        self.now = 0.0
+
+    def __call__(self):
+        return self.now
+
+
+class TestTokenBucket:
+    """Test refill, burst and per-lane reserve."""
+
+    def test_burst_then_refill(self):
+        clock = FakeClock()
+        bucket = TokenBucket(rate=10, burst=5, clock=clock)
+        assert bucket.take(8) == 5
+        assert bucket.take(1) == 0
+        assert bucket.wait_time() == pytest.approx(0.1)
+        clock.now = 0.35
+        assert bucket.take(5) == 3
+
+    def test_reserve_is_left_for_higher_lanes(self):
+        bucket = TokenBucket(rate=1, burst=10, clock=FakeClock())
+        assert bucket.take(10, reserve=0.5) == 5
+        assert bucket.take(1, reserve=0.5) == 0
+        assert bucket.take(10) == 5
+
+
+class TestRpcGateway:
+    """Test batching, coalescing, priority lanes and failover."""
+
+    def setup_method(self):
+        self.gateways = []
+
+    def teardown_method(self):
+        for gateway in self.gateways:
+            gateway.stop()
+
+    def make(self, transport, urls=('http://a',), **config):
+        gateway = RpcGateway(make_config(**config), urls=list(urls), transport=transport)
+        self.gateways.append(gateway)
+        return gateway
+
+    def test_concurrent_reads_share_a_batch(self):
+        transport = FakeTransport()
+        gateway = self.make(transport, RPC_BATCH_WINDOW_MS=50.0)
+        responses = gateway.call_many([('eth_getBlockByNumber', [hex(n), False]) for n in range(10)])
+        assert [r['result'] for r in responses] == ['eth_getBlockByNumber'] * 10
+        assert len(transport.posts) == 1 and len(transport.posts[0][1]) == 10
+        assert gateway.stats['batches'] == 1
+
+    def test_identical_reads_are_coalesced(self):
+        gate = threading.Event()
+        transport = FakeTransport(gate=gate)
+        gateway = self.make(transport)
+        results = []
+        threads = [threading.Thread(target=lambda: results.append(gateway.request('eth_blockNumber')))
+                   for _ in range(5)]
+        for thread in threads:
+            thread.start()
+        gate.set()
+        for thread in threads:
+            thread.join(5)
+        assert results == ['eth_blockNumber'] * 5
+        assert transport.methods().count('eth_blockNumber') == 1
+        assert gateway.stats['coalesced'] == 4
+
+    def test_execution_lane_jumps_the_queue(self):
+        gate = threading.Event()
+        transport = FakeTransport(gate=gate)
+        gateway = self.make(transport, RPC_BATCH_MAX=1)
+        blocker = threading.Thread(target=gateway.request, args=('eth_chainId',))
+        blocker.start()
+        while not transport.posts:
+            pass
+
+        threads = [threading.Thread(target=gateway.request, args=('eth_getLogs', [{'fromBlock': hex(i)}]),
+                                    kwargs={'lane': LANE_DOWNLOAD}) for i in range(3)]
+        threads.append(threading.Thread(target=gateway.request, args=('eth_call', [{'data': '0x01'}])))
+
+        def send():
+            with rpc_lane(LANE_MONITORING):
+                gateway.request('eth_sendRawTransaction', ['0x02'])
+        threads.append(threading.Thread(target=send))
+        for thread in threads:
+            thread.start()
+        while gateway.get_status()['queued']['download'] < 3 or sum(gateway.get_status()['queued'].values()) < 5:
+            pass
+        gate.set()
+        for thread in threads + [blocker]:
+            thread.join(5)
+        assert transport.methods() == ['eth_chainId', 'eth_sendRawTransaction', 'eth_call',
+                                       'eth_getLogs', 'eth_getLogs', 'eth_getLogs']
+
+    def test_send_raw_transaction_is_never_batched(self):
+        transport = FakeTransport()
+        gateway = self.make(transport, RPC_BATCH_WINDOW_MS=50.0)
+        gateway.call_many([('eth_blockNumber', []), ('eth_sendRawTransaction', ['0x01']), ('eth_gasPrice', [])])
+        sent = [payload for _, payload in transport.posts if not isinstance(payload, list)]
+        assert any(p['method'] == 'eth_sendRawTransaction' for p in sent)
+        assert all('eth_sendRawTransaction' not in [r['method'] for r in payload]
+                   for _, payload in transport.posts if isinstance(payload, list))
+
+    def test_failover_on_transport_error(self):
+        transport = FakeTransport(fail=['http://a'])
+        gateway = self.make(transport, urls=('http://a', 'http://b'))
+        assert gateway.request('eth_chainId') == 'eth_chainId'
+        assert transport.methods('http://b') == ['eth_chainId']
+        status = gateway.get_status()
+        assert status['endpoints'][0]['healthy'] is False and status['endpoints'][0]['errors'] == 1
+        # The failed endpoint is skipped while cooling down
+        gateway.request('eth_gasPrice')
+        assert transport.methods('http://a') == ['eth_chainId']
+
+    def test_rate_limit_error_fails_over_and_node_errors_do_not(self):
+        transport = FakeTransport()
+        original = transport.answer
+        transport.answer = lambda url, r: ({'jsonrpc': '2.0', 'id': r['id'],
+                                             'error': {'code': -32005, 'message': 'limit exceeded'}}
+                                            if url == 'http://a' else original(url, r))
+        gateway = self.make(transport, urls=('http://a', 'http://b'))
+        assert gateway.request('eth_blockNumber') == 'eth_blockNumber'
+        assert gateway.stats['retries'] == 1
+
+        with pytest.raises(RpcError) as raised:
+            gateway.request('eth_call', [{'data': '0xdead'}, 'latest'])
+        assert raised.value.code == 3
+        assert transport.methods().count('eth_call') == 1
+
+    def test_send_is_not_failed_over_once_it_may_have_gone_out(self):
+        transport = FakeTransport(fail=['http://a'])
+        gateway = self.make(transport, urls=('http://a', 'http://b'))
+        with pytest.raises(SendOutcomeUnknown):
+            gateway.request('eth_sendRawTransaction', ['0x01'])
+        assert transport.methods() == ['eth_sendRawTransaction'] and gateway.stats['retries'] == 0
+
+        # A send the node refused for quota never went out, so it may move on
+        transport = FakeTransport()
+        original = transport.answer
+        transport.answer = lambda url, r: ({'jsonrpc': '2.0', 'id': r['id'],
+                                             'error': {'code': 429, 'message': 'too many requests'}}
+                                            if url == 'http://a' else original(url, r))
+        gateway = self.make(transport, urls=('http://a', 'http://b'))
+        assert gateway.request('eth_sendRawTransaction', ['0x01']) == 'eth_sendRawTransaction'
+        assert transport.methods('http://b') == ['eth_sendRawTransaction']
+
+    def test_all_endpoints_down(self):
+        gateway = self.make(FakeTransport(fail=['http://a', 'http://b']), urls=('http://a', 'http://b'),
+                            RPC_FAILOVER_COOLDOWN_SECONDS=0.0)
+        with pytest.raises(RpcUnavailable):
+            gateway.request('eth_chainId')
+        assert gateway.stats['failed'] == 1
+
+    def test_web3_provider_and_http_failover(self):
+        """Real HTTP: a 503 endpoint, then the paper-chain node"""
+        class Unavailable(BaseHTTPRequestHandler):
+            def log_message(self, *args):
+                pass
+
+            def do_POST(self):
+                self.rfile.read(int(self.headers['Content-Length']))
+                self.send_response(503)
+                self.end_headers()
+
+        down = ThreadingHTTPServer(('127.0.0.1', 0), Unavailable)
+        threading.Thread(target=down.serve_forever, daemon=True).start()
+        chain = ShadowChain()
+        node = MockRpcServer(chain)
+        node.start()
+        try:
+            gateway = RpcGateway(make_config(), urls=[f'http://127.0.0.1:{down.server_port}', node.url])
+            self.gateways.append(gateway)
+            provider = GatewayProvider(gateway, lane=LANE_DOWNLOAD)
+            assert provider.is_connected()
+            response = provider.make_request('eth_chainId', [])
+            assert int(response['result'], 16) == chain.chain_id
+            assert gateway.get_status()['endpoints'][0]['errors'] == 1
+        finally:
+            node.stop()
+            down.shutdown()
+            down.server_close()
@@ -0,0 +1,149 @@
+"""Unit tests for the persistent RPC transports."""
+import json
+import os
+import sys
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+import pytest
+from websockets.sync.server import serve
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from config import Config
+from rpc_transport import HttpTransport, Transport, TransportError, TransportProvider, encode_json
+
+
+class CountingServer:
+    """HTTP/1.1 JSON-RPC echo server that counts TCP connections"""
+
+    def __init__(self, status=200):
+        server = self
+        self.connections = set()
+
+        class Handler(BaseHTTPRequestHandler):
+            protocol_version = 'HTTP/1.1'
+
+            def log_message(self, *args):
+                pass
+
+            def do_POST(self):
+                server.connections.add(self.client_address)
+                request = json.loads(self.rfile.read(int(self.headers['Content-Length'])))
+                body = json.dumps({'jsonrpc': '2.0', 'id': request['id'],
+                                   'result': request['params']}).encode()
+                self.send_response(status)
+                self.send_header('Content-Type', 'application/json')
+                self.send_header('Content-Length', str(len(body)))
+                self.end_headers()
+                self.wfile.write(body)
+
+        self.httpd = ThreadingHTTPServer(('127.0.0.1', 0), Handler)
+        self.url = f'http://127.0.0.1:{self.httpd.server_port}'
+        threading.Thread(target=self.httpd.serve_forever, daemon=True).start()
+
+    def close(self):
+        self.httpd.shutdown()
+        self.httpd.server_close()
+
+
+def body(request_id, method='eth_call', params=None):
+    return encode_json({'jsonrpc': '2.0', 'id': request_id, 'method': method, 'params': params or []})
+
+
+class TestHttpTransport:
+    """Test keep-alive reuse and error mapping."""
+
+    def test_connection_is_reused(self):
+        server = CountingServer()
+        transport = HttpTransport(pool_size=2, http2=False)
+        try:
+            for i in range(20):
+                assert transport(server.url, body(i, params=[i]), 2)['result'] == [i]
+            assert len(server.connections) == 1
+        finally:
+            transport.close()
+            server.close()
+
+    def test_server_error_raises_transport_error(self):
+        server = CountingServer(status=503)
+        transport = HttpTransport(http2=False)
+        try:
+            with pytest.raises(TransportError):
+                transport(server.url, body(1), 2)
+        finally:
+            transport.close()
+            server.close()
+
+    def test_provider_encodes_bytes_params(self):
+        server = CountingServer()
+        config = type('TestConfig', (Config,), {'RPC_HTTP2': False})
+        provider = TransportProvider(server.url, config=config)
+        try:
+            response = provider.make_request('eth_call', [{'data': b'\x12\x34'}, 'latest'])
+            assert response['result'] == [{'data': '0x1234'}, 'latest']
+            assert provider.is_connected()
+        finally:
+            provider.transport.close()
+            server.close()
+
+
+class TestWebSocketTransport:
+    """Test pipelining and reconnects over one socket."""
+
+    def setup_method(self):
+        self.connections = 0
+        self.drop_next = False
+
+        def handler(ws):
+            self.connections += 1
+            for message in ws:
+                request = json.loads(message)
+                if self.drop_next:
+                    self.drop_next = False
+                    ws.close()
+                    return
+                first = request[0] if isinstance(request, list) else request
+                # Answer the first request last so responses come back out of order
+                delay = 0.2 if first['id'] == 1 else 0.0
+                threading.Thread(target=self.reply, args=(ws, request, delay), daemon=True).start()
+
+        self.server = serve(handler, '127.0.0.1', 0)
+        threading.Thread(target=self.server.serve_forever, daemon=True).start()
+        self.url = f'ws://127.0.0.1:{self.server.socket.getsockname()[1]}'
+        self.transport = Transport(type('TestConfig', (Config,), {'RPC_HTTP2': False}))
+
+    def teardown_method(self):
+        self.transport.close()
+        self.server.shutdown()
+
+    @staticmethod
+    def reply(ws, request, delay):
+        time.sleep(delay)
+        answer = lambda r: {'jsonrpc': '2.0', 'id': r['id'], 'result': r['method']}
+        ws.send(json.dumps([answer(r) for r in request] if isinstance(request, list) else answer(request)))
+
+    def test_pipelined_calls_share_one_socket(self):
+        results = {}
+        slow = threading.Thread(target=lambda: results.update(slow=self.transport(self.url, body(1, 'slow'), 2)))
+        slow.start()
+        time.sleep(0.05)
+        started = time.perf_counter()
+        fast = self.transport(self.url, body(2, 'fast'), 2)
+        assert fast['result'] == 'fast'
+        assert time.perf_counter() - started < 0.15  # not queued behind the slow call
+        slow.join(2)
+        assert results['slow']['result'] == 'slow'
+
+        batch = encode_json([{'jsonrpc': '2.0', 'id': i, 'method': f'm{i}', 'params': []} for i in (3, 4)])
+        assert [r['result'] for r in self.transport(self.url, batch, 2)] == ['m3', 'm4']
+        ws = self.transport._websockets[self.url]
+        assert self.connections == 1 and ws.stats['in_flight_max'] == 2
+
+    def test_dropped_socket_fails_call_then_reconnects(self):
+        assert self.transport(self.url, body(5, 'first'), 2)['result'] == 'first'
+        self.drop_next = True
+        with pytest.raises(TransportError):
+            self.transport(self.url, body(6, 'dropped'), 2)
+        assert self.transport(self.url, body(7, 'again'), 2)['result'] == 'again'
+        assert self.connections == 2
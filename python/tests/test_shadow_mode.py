@@ -0,0 +1,303 @@
+"""Unit tests for the shadow/paper-trading replay."""
+import json
+import math
+import os
+import sys
+import time
+from types import SimpleNamespace
+from urllib.request import Request, urlopen
+
+import pytest
+from eth_abi import decode, encode
+from eth_account import Account
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from multicall3 import AGGREGATE3_SELECTOR, encode_call
+from position_calldata import build_rebalance_multicall, encode_mint
+from shadow_mode import (
+    ShadowChain, MockRpcServer, ShadowReport, ShadowRunner, SHADOW_PRIVATE_KEY, INCREASE_LIQUIDITY_TOPIC,
+    backtest_rebalances, compare_with_backtest, diff_rebalances, liquidity_for_amounts, load_stream,
+    normalize_event, shadow_rebalances, stream_from_ohlc, sqrt_price_x96_from_price, sqrt_price_x96_at_tick
+)
+from config import Config
+
+HERE = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DATA = os.path.join(HERE, 'data', 'eth_usdc_3days_real_fixed.csv')
+
+
+def rpc(url, method, params):
+    body = json.dumps({'jsonrpc': '2.0', 'id': 1, 'method': method, 'params': params}).encode()
+    request = Request(url, data=body, headers={'Content-Type': 'application/json'})
+    with urlopen(request, timeout=5) as response:
+        return json.loads(response.read())
+
+
+def call(url, to, data: bytes):
+    return bytes.fromhex(rpc(url, 'eth_call', [{'to': to, 'data': '0x' + data.hex()}, 'latest'])['result'][2:])
+
+
+def sign(chain, nonce, data: bytes) -> str:
+    tx = {'to': chain.position_manager, 'data': '0x' + data.hex(), 'value': 0, 'gas': 500000,
+          'maxFeePerGas': 2 * 10 ** 9, 'maxPriorityFeePerGas': 10 ** 9, 'nonce': nonce,
+          'chainId': chain.chain_id, 'type': 2}
+    return '0x' + Account.sign_transaction(tx, SHADOW_PRIVATE_KEY).rawTransaction.hex().removeprefix('0x')
+
+
+class TestMockRpc:
+    """Test the paper chain through raw JSON-RPC."""
+
+    def setup_method(self):
+        self.chain = ShadowChain()
+        self.chain.set_price(0.0004)
+        self.server = MockRpcServer(self.chain)
+        self.server.start()
+
+    def teardown_method(self):
+        self.server.stop()
+
+    def test_pool_and_token_reads(self):
+        url, chain = self.server.url, self.chain
+        (pool,) = decode(['address'], call(url, chain.factory, encode_call(
+            'getPool(address,address,uint24)', ['address', 'address', 'uint24'],
+            [chain.token0.address, chain.token1.address, chain.fee])))
+        assert pool == chain.pool
+
+        sqrt_price, tick = decode(['uint160', 'int24', 'uint16', 'uint16', 'uint16', 'uint8', 'bool'],
+                                  call(url, pool, encode_call('slot0()')))[:2]
+        assert sqrt_price == sqrt_price_x96_from_price(0.0004, 6, 18)
+        assert tick == chain.tick
+
+        (decimals,) = decode(['uint8'], call(url, chain.token0.address, encode_call('decimals()')))
+        (balance,) = decode(['uint256'], call(url, chain.token0.address, encode_call(
+            'balanceOf(address)', ['address'], [chain.wallet])))
+        assert decimals == 6 and balance == chain.token0.balance
+
+    def test_aggregate3_allows_failures(self):
+        calls = [(self.chain.token1.address, True, encode_call('symbol()')),
+                 (self.chain.position_manager, True, encode_call('positions(uint256)', ['uint256'], [99]))]
+        (results,) = decode(['(bool,bytes)[]'], call(
+            self.server.url, self.chain.multicall, AGGREGATE3_SELECTOR + encode(['(address,bool,bytes)[]'], [calls])))
+        assert results[0][0] and decode(['string'], results[0][1]) == ('WETH',)
+        assert results[1][0] is False
+
+    def test_batch_and_unknown_method(self):
+        body = json.dumps([{'jsonrpc': '2.0', 'id': i, 'method': m, 'params': []}
+                           for i, m in enumerate(['eth_chainId', 'eth_blockNumber', 'debug_traceCall'])]).encode()
+        with urlopen(Request(self.server.url, data=body, headers={'Content-Type': 'application/json'})) as r:
+            responses = json.loads(r.read())
+        assert int(responses[0]['result'], 16) == self.chain.chain_id
+        assert int(responses[1]['result'], 16) == self.chain.block_number
+        assert responses[2]['error']['code'] == -32601
+
+    def mint_above_price(self, nonce, amount0):
+        chain = self.chain
+        tick_lower, tick_upper = chain.tick + 10, chain.tick + 1010
+        mint = encode_mint(chain.token0.address, chain.token1.address, chain.fee, tick_lower, tick_upper,
+                           amount0, 0, 0, 0, chain.wallet, 2 ** 32)
+        tx_hash = rpc(self.server.url, 'eth_sendRawTransaction', [sign(chain, nonce, mint)])['result']
+        return tick_lower, tick_upper, rpc(self.server.url, 'eth_getTransactionReceipt', [tx_hash])['result']
+
+    def test_mint_then_unwind_via_multicall(self):
+        chain, url = self.chain, self.server.url
+        balance0 = chain.token0.balance
+        tick_lower, tick_upper, receipt = self.mint_above_price(0, 1000 * 10 ** 6)
+        assert receipt['status'] == '0x1'
+        assert any(log['topics'][0] == '0x' + INCREASE_LIQUIDITY_TOPIC.hex() for log in receipt['logs'])
+        liquidity = liquidity_for_amounts(chain.sqrt_price_x96, tick_lower, tick_upper, 1000 * 10 ** 6, 0)
+        assert chain.positions[1]['liquidity'] == liquidity
+        deposited, _ = chain.position_amounts(1)
+        assert chain.token0.balance == balance0 - deposited and deposited <= 1000 * 10 ** 6
+        assert int(rpc(url, 'eth_getTransactionCount', [chain.wallet, 'pending'])['result'], 16) == 1
+
+        unwind = build_rebalance_multicall([(1, liquidity)], [], chain.wallet, 2 ** 32)
+        rpc(url, 'eth_sendRawTransaction', [sign(chain, 1, unwind)])
+        assert chain.positions == {}
+        assert chain.transactions[-1].names == ['decreaseLiquidity', 'collect', 'burn']
+        assert chain.token0.balance == balance0
+
+    def test_swap_fills_range_and_collect_pays_wallet(self):
+        chain, url = self.chain, self.server.url
+        balance0, balance1 = chain.token0.balance, chain.token1.balance
+        tick_lower, tick_upper, _ = self.mint_above_price(0, 1000 * 10 ** 6)
+        liquidity = chain.positions[1]['liquidity']
+        # Price rises through the whole range: token0 is sold for token1
+        above = sqrt_price_x96_at_tick(tick_upper + 100)
+        chain.apply_swap({'sqrt_price_x96': above, 'tick': tick_upper + 100, 'liquidity': 10 ** 18})
+        amount0, amount1 = chain.position_amounts(1)
+        assert amount0 == 0 and amount1 > 0
+        assert chain.positions[1]['owed1'] == amount1 * chain.fee // (10 ** 6 - chain.fee)
+        assert chain.positions[1]['owed0'] == 0
+
+        unwind = build_rebalance_multicall([(1, liquidity)], [], chain.wallet, 2 ** 32)
+        rpc(url, 'eth_sendRawTransaction', [sign(chain, 1, unwind)])
+        assert chain.positions == {}
+        assert chain.token0.balance < balance0
+        assert chain.token1.balance - balance1 > amount1
+        (wallet_weth,) = decode(['uint256'], call(url, chain.token1.address, encode_call(
+            'balanceOf(address)', ['address'], [chain.wallet])))
+        assert wallet_weth == chain.token1.balance
+
+    def test_mint_beyond_wallet_reverts(self):
+        chain = self.chain
+        balance0 = chain.token0.balance
+        _, _, receipt = self.mint_above_price(0, balance0 * 2)
+        assert receipt['status'] == '0x0'
+        assert chain.positions == {} and chain.token0.balance == balance0
+
+    def test_reverted_transaction_is_mined_without_effects(self):
+        chain, url = self.chain, self.server.url
+        burn_unknown = build_rebalance_multicall([(7, 1)], [], chain.wallet, 2 ** 32)
+        tx_hash = rpc(url, 'eth_sendRawTransaction', [sign(chain, 0, burn_unknown)])['result']
+        assert rpc(url, 'eth_getTransactionReceipt', [tx_hash])['result']['status'] == '0x0'
+
+
+class TestStreams:
+    """Test stream loading and OHLC synthesis."""
+
+    def test_load_stream_decodes_raw_logs(self, tmp_path):
+        data = encode(['int256', 'int256', 'uint160', 'uint128', 'int24'], [1, -1, 2 ** 96, 10 ** 18, 0])
+        lines = [
+            {'type': 'head', 'number': '0x10', 'timestamp': 100},
+            {'type': 'log', 'timestamp': 100, 'log': {'blockNumber': '0x10', 'logIndex': '0x2',
+                                                     'data': '0x' + data.hex()}}
+        ]
+        path = tmp_path / 'stream.jsonl'
+        path.write_text('\n'.join(json.dumps(line) for line in lines) + '\n')
+        head, swap = load_stream(str(path))
+        assert head['number'] == 16
+        assert swap['type'] == 'swap' and swap['sqrt_price_x96'] == 2 ** 96 and swap['log_index'] == 2
+
+    def test_unknown_event_rejected(self):
+        with pytest.raises(ValueError):
+            normalize_event({'type': 'trade'})
+
+    def test_stream_from_ohlc(self, tmp_path):
+        path = tmp_path / 'prices.csv'
+        path.write_text('timestamp,open,high,low,close,volume\n'
+                        '2024-01-01 00:00:00,0.0004,0.0004,0.0004,0.0004,1\n'
+                        '2024-01-01 00:15:00,0.0005,0.0005,0.0005,0.0005,1\n')
+        events = stream_from_ohlc(str(path))
+        assert [e['type'] for e in events] == ['head', 'swap', 'head', 'swap']
+        assert events[2]['timestamp'] - events[0]['timestamp'] == 900
+        assert events[2]['number'] > events[0]['number']
+        assert events[3]['sqrt_price_x96'] == sqrt_price_x96_from_price(0.0005, 6, 18)
+
+
+class FakeRebalancer:
+    """Stand-in for AutomatedRebalancer that rebalances when the price moves 10%"""
+
+    def __init__(self, chain, config):
+        self.chain = chain
+        self.config = config
+        self.heads = []
+        self.client = SimpleNamespace(on_new_head=self.heads.append)
+        self.last_rebalance_time = 0
+        self.anchor = None
+
+    def initialize_positions(self):
+        return True
+
+    def _sqrt_price_to_spot(self, sqrt_price_x96, token0, token1):
+        return (sqrt_price_x96 / 2 ** 96) ** 2 * 10 ** 12
+
+    def monitoring_tick(self, token0, token1, fee, spot_price=None):
+        if self.anchor is None or abs(spot_price / self.anchor - 1) > 0.1:
+            self.anchor = spot_price
+            self.last_rebalance_time = time.time()
+            self.chain.transactions.append(SimpleNamespace(names=['multicall']))
+
+
+class TestShadowRunner:
+    """Test pacing and decision recording."""
+
+    def make_events(self, prices, spacing=1.0):
+        events = []
+        for i, price in enumerate(prices):
+            events.append({'type': 'head', 'timestamp': i * spacing, 'number': i + 1, 'base_fee': None})
+            events.append({'type': 'swap', 'timestamp': i * spacing, 'block_number': i + 1, 'log_index': 0,
+                           'sqrt_price_x96': sqrt_price_x96_from_price(price, 6, 18), 'tick': 0,
+                           'liquidity': 10 ** 18})
+        return events
+
+    def run(self, events, speedup):
+        chain = ShadowChain()
+        runner = ShadowRunner(events, speedup=speedup, chain=chain,
+                              config_overrides={'INVENTORY_MODEL': 'GLFTModel'},
+                              rebalancer_factory=lambda config: FakeRebalancer(chain, config))
+        return runner, runner.run()
+
+    def test_config_points_at_mock_node(self):
+        runner = ShadowRunner([], chain=ShadowChain())
+        config = runner.build_config()
+        assert config.ETHEREUM_RPC_URL == runner.server.url
+        assert config.TOKEN_A_ADDRESS == runner.chain.token0.address
+        assert config.TELEGRAM_ENABLED is False and config.REBALANCE_WAL_PATH == ''
+        assert config.FEE_TIER == runner.chain.fee
+
+    def test_records_decisions(self):
+        runner, report = self.run(self.make_events([0.0004, 0.00041, 0.0005, 0.00051]), speedup=0)
+        assert report.heads == 4 and report.ticks == 4
+        assert [d['rebalanced'] for d in report.decisions] == [True, False, True, False]
+        assert report.rebalances == 2 and report.transactions == 2
+        assert report.decisions[2]['transactions'] == ['multicall']
+        assert report.latency['count'] == 4
+        assert report.to_dict()['tick_latency']['max_us'] > 0
+        assert report.initial_mint == {'timestamp': 0.0, 'ranges': []}
+        assert report.decisions[2]['ranges'] == [] and 'ranges' not in report.decisions[1]
+
+    def test_speedup_paces_replay(self):
+        events = self.make_events([0.0004] * 5, spacing=1.0)  # 4 stream seconds
+        _, report = self.run(events, speedup=20)
+        assert 0.18 <= report.wall_seconds < 1.0
+        assert report.achieved_speedup <= 21
+
+    def test_write_decisions(self, tmp_path):
+        _, report = self.run(self.make_events([0.0004, 0.0005]), speedup=0)
+        path = tmp_path / 'decisions.jsonl'
+        report.write_decisions(str(path))
+        lines = [json.loads(line) for line in path.read_text().splitlines()]
+        assert len(lines) == 2 and lines[1]['rebalanced'] is True
+
+
+class TestBacktestParity:
+    """Test the backtest parity report."""
+
+    def config(self):
+        return type('TestConfig', (Config,), {'INVENTORY_MODEL': 'GLFTModel', 'FEE_TIER': 5})()
+
+    def mirror(self, rebalances):
+        """ShadowReport whose rebalances land on the backtest's, at raw pool ticks"""
+        def ranges(bands):
+            return [[round(math.log(price * 10 ** 12, 1.0001)) for price in band] for band in bands]
+
+        report = ShadowReport(initial_mint={'timestamp': rebalances[0][0], 'ranges': ranges(rebalances[0][1])})
+        report.decisions = [{'timestamp': ts, 'rebalanced': True, 'ranges': ranges(bands)}
+                            for ts, bands in rebalances[1:]]
+        return report
+
+    def test_backtest_bands_follow_stream_timestamps(self):
+        rebalances = backtest_rebalances(DATA, 3000.0, 1.0, self.config())
+        stream_times = {e['timestamp'] for e in stream_from_ohlc(DATA)}
+        assert len(rebalances) > 1 and all(ts in stream_times for ts, _ in rebalances)
+        for _, bands in rebalances:
+            assert len(bands) == 2 and bands[0][0] < bands[0][1] <= bands[1][0] < bands[1][1]
+
+    def test_matching_replay_is_ok(self):
+        report = self.mirror(backtest_rebalances(DATA, 3000.0, 1.0, self.config()))
+        parity = compare_with_backtest(report, DATA, 3000.0, 1.0, {'INVENTORY_MODEL': 'GLFTModel'})
+        assert parity.ok and parity.matched == parity.shadow == parity.backtest
+
+    def test_differences_are_reported(self):
+        backtest = backtest_rebalances(DATA, 3000.0, 1.0, self.config())
+        report = self.mirror(backtest)
+        late = report.decisions.pop(0)
+        report.decisions.append(dict(late, timestamp=late['timestamp'] + 60))
+        report.decisions[0]['ranges'][1][1] += 50
+
+        parity = diff_rebalances(shadow_rebalances(report), backtest)
+        assert not parity.ok
+        assert parity.only_backtest == [late['timestamp']]
+        assert parity.only_shadow == [late['timestamp'] + 60]
+        assert [m['timestamp'] for m in parity.range_mismatches] == [report.decisions[0]['timestamp']]
+        assert 40 < parity.range_mismatches[0]['max_ticks'] < 60
+        assert parity.to_dict()['matched'] == len(backtest) - 2
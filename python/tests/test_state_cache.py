@@ -0,0 +1,105 @@
+"""Unit tests for the block-versioned state cache."""
+import pytest
+import sys
+import os
+import threading
+import time
+from unittest.mock import Mock
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from state_cache import StateCache
+
+
+def make_cache(block=100, poll=60):
+    config = Mock()
+    config.STATE_CACHE_BLOCK_POLL_SECONDS = poll
+    w3 = Mock()
+    w3.eth.block_number = block
+    return StateCache(w3, config)
+
+
+class TestStateCache:
+    """Test pinning, per-block invalidation and single-flight loads."""
+
+    def test_immutable_entries_are_pinned(self):
+        """Pinned reads survive new blocks and explicit invalidation."""
+        cache = make_cache()
+        loader = Mock(return_value=6)
+        for block in (101, 102):
+            cache.on_new_block(block)
+            cache.invalidate()
+            assert cache.get('0xUSDC', 'decimals', (), loader, mutable=False) == 6
+        loader.assert_called_once()
+
+    def test_mutable_entries_valid_for_one_block(self):
+        """Mutable reads are served from cache within a block and reloaded on the next."""
+        cache = make_cache()
+        loader = Mock(side_effect=['slot0@100', 'slot0@101'])
+        assert cache.get('0xPool', 'slot0', (), loader) == 'slot0@100'
+        assert cache.get('0xPOOL', 'slot0', (), loader) == 'slot0@100'  # address case-insensitive
+        cache.on_new_block(101)
+        assert cache.get('0xPool', 'slot0', (), loader) == 'slot0@101'
+        assert loader.call_count == 2
+
+    def test_args_are_part_of_the_key(self):
+        """Different positions are cached independently."""
+        cache = make_cache()
+        assert cache.get('0xNPM', 'positions', (1,), lambda: 'p1') == 'p1'
+        assert cache.get('0xNPM', 'positions', (2,), lambda: 'p2') == 'p2'
+
+    def test_head_polled_without_subscription(self):
+        """Without pushed heads the block number is re-read once the poll interval lapses."""
+        cache = make_cache(poll=0)
+        loader = Mock(side_effect=['a', 'b'])
+        assert cache.get('0xPool', 'slot0', (), loader) == 'a'
+        cache.w3.eth.block_number = 101
+        assert cache.get('0xPool', 'slot0', (), loader) == 'b'
+
+    def test_invalidate_drops_mutable_entries(self):
+        """Invalidation forces a reload after our own transactions."""
+        cache = make_cache()
+        loader = Mock(side_effect=['before', 'after'])
+        cache.get('0xNPM', 'positions', (1,), loader)
+        cache.invalidate('0xnpm')
+        assert cache.get('0xNPM', 'positions', (1,), loader) == 'after'
+
+    def test_invalidate_keeps_pushed_heads_authoritative(self):
+        """Invalidation clears values but does not fall back to polling eth_blockNumber."""
+        cache = make_cache()
+        cache.on_new_block(101)
+        cache.invalidate()
+        cache.w3.eth.block_number = 999
+        assert cache.current_block() == 101
+
+    def test_concurrent_reads_single_flight(self):
+        """Identical concurrent reads trigger exactly one load."""
+        cache = make_cache()
+        cache.on_new_block(100)
+        calls = []
+        release = threading.Event()
+
+        def slow_loader():
+            calls.append(1)
+            release.wait(2)
+            return 'slot0'
+
+        results = []
+        threads = [threading.Thread(target=lambda: results.append(cache.get('0xPool', 'slot0', (), slow_loader)))
+                   for _ in range(8)]
+        for t in threads:
+            t.start()
+        time.sleep(0.1)
+        release.set()
+        for t in threads:
+            t.join(2)
+
+        assert results == ['slot0'] * 8
+        assert len(calls) == 1
+        assert cache.stats['coalesced'] == 7
+
+    def test_loader_errors_are_not_cached(self):
+        """A failed read is raised to every waiter and retried next time."""
+        cache = make_cache()
+        with pytest.raises(RuntimeError):
+            cache.get('0xPool', 'slot0', (), Mock(side_effect=RuntimeError('rpc down')))
+        assert cache.get('0xPool', 'slot0', (), lambda: 'ok') == 'ok'
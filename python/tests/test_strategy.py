@@ -147,7 +147,23 @@ class TestAsymmetricLPStrategy:
         )
         
         assert result is True  # Should allow first mint when has_positions=False
-    
+
+    def test_rebalance_urgency_matches_trigger(self):
+        """Test that urgency crosses 1.0 exactly where should_rebalance fires."""
+        baseline = dict(last_rebalance_token0=1000.0, last_rebalance_token1=0.5, last_rebalance_price=3000.0)
+
+        calm = self.strategy.rebalance_urgency(3300.0, 1000.0, 0.5, **baseline)
+        assert calm == pytest.approx(0.25)  # 10% price move against a 40% threshold
+
+        depleted = self.strategy.rebalance_urgency(3000.0, 500.0, 0.5, **baseline)
+        assert depleted > 1.0
+        assert self.strategy.should_rebalance(3000.0, [], 500.0, 0.5, **baseline) is True
+
+        # Unknown balances count only the price leg; first mint is always most urgent
+        assert self.strategy.rebalance_urgency(3300.0, None, None, **baseline) == pytest.approx(0.25)
+        assert self.strategy.rebalance_urgency(3000.0, 0.0, 0.0, has_positions=False) == float('inf')
+        assert self.strategy.rebalance_urgency(3000.0, 1.0, 1.0) == 0.0
+
     def test_plan_rebalance_basic(self):
         """Test basic rebalance planning."""
         from unittest.mock import Mock
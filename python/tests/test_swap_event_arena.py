@@ -0,0 +1,81 @@
+"""Unit tests for the swap event arena and the lazy trade log."""
+import math
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from amm import AMMSimulator, SwapEventArena
+from backtest_engine import BacktestEngine, BacktestTrade, TradeLog
+from config import Config
+
+HERE = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def _simulator(price=3000.0):
+    simulator = AMMSimulator(fee_tier_bps=5, trade_detection_threshold=0.0001)
+    simulator.last_price = price
+    simulator.mint_bands_percent(price, 0.05, 0.05, 1500.0, 0.5)
+    return simulator
+
+
+def _path(n=300, price=3000.0):
+    return [price * (1 + 0.03 * math.sin(i / 7.0) + 0.0005 * (i % 3)) for i in range(n)]
+
+
+class TestSwapEventArena:
+    """Test the columnar event store."""
+
+    def test_append_grows_and_materializes(self):
+        arena = SwapEventArena(capacity=2)
+        for i in range(5):
+            assert arena.append(i, 100.0 + i, i % 2 == 0, 1.0, 0.01, 0.1 * i, 0.0, 2.0, 10.0, 20.0) == i
+        assert len(arena) == 5 and arena.capacity == 8
+        event = arena.event(3)
+        assert (event.timestamp, event.price, event.trade_type, event.fees_token0) == (3, 103.0, 'sell', 0.1 * 3)
+        arena.clear()
+        assert len(arena) == 0 and arena.capacity == 8
+
+    def test_compute_into_matches_compute(self):
+        eager, arena_sim = _simulator(), _simulator()
+        arena = SwapEventArena(capacity=4)
+        records = (arena_sim._token0_record, arena_sim._token1_record)
+        events = []
+        for t, price in enumerate(_path()):
+            event = eager.compute({'timestamp': t, 'close': price})
+            index = arena_sim.compute_into(t, price, arena)
+            assert (event is None) == (index < 0)
+            if event is not None:
+                events.append(event)
+                assert arena.event(index) == event
+        assert len(events) == len(arena) > 100
+        # Scratch records are reused, never reallocated
+        assert (arena_sim._token0_record, arena_sim._token1_record) == records
+
+
+class TestTradeLog:
+    """Test lazy trade materialization."""
+
+    def test_lazy_cached_sequence(self):
+        log = TradeLog(SwapEventArena(capacity=1))
+        for i in range(3):
+            log.record(log.events.append(i, 3000.0 + i, True, 1.0, 0.01, 0.5, 0.25, 1.0, 10.0, 1.0), 5.0, 7.5)
+        assert len(log) == 3 and not log._materialized
+        trade = log[-1]
+        assert isinstance(trade, BacktestTrade)
+        assert (trade.timestamp, trade.fees_earned, trade.range_b_percentage) == (2, 0.75, 7.5)
+        trade.fees_earned = 1.0
+        assert log[2].fees_earned == 1.0
+        assert [t.price for t in log[:2]] == [3000.0, 3001.0]
+        assert [t.timestamp for t in log] == [0, 1, 2]
+
+    def test_backtest_materializes_on_demand(self):
+        config = type('TestConfig', (Config,), {'INVENTORY_MODEL': 'GLFTModel'})()
+        result = BacktestEngine(config).run_backtest(
+            os.path.join(HERE, 'data', 'eth_usdc_3days_real_fixed.csv'), 3000.0, 1.0)
+        assert isinstance(result.trades, TradeLog)
+        assert result.total_trades == len(result.trades) > 0
+        assert len(result.trades._materialized) <= 1
+        last = result.trades[-1]
+        assert (last.new_token0_balance, last.new_token1_balance) == (
+            result.trades.events.new_token0_balance[len(result.trades) - 1],
+            result.trades.events.new_token1_balance[len(result.trades) - 1])
@@ -0,0 +1,206 @@
+"""Unit tests for the pipelined transaction executor."""
+import pytest
+import sys
+import os
+import threading
+import time
+from unittest.mock import Mock
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from rpc_gateway import SendOutcomeUnknown
+from tx_executor import NonceManager, TransactionExecutor
+from position_calldata import COLLECT_SELECTOR, MULTICALL_SELECTOR
+
+
+def make_client(receipts=None, start_nonce=7):
+    """Build a mock client whose chain mines every sent transaction immediately."""
+    client = Mock()
+    client.wallet_address = '0x' + '11' * 20
+    client.get_fee_params.return_value = {'maxFeePerGas': 30 * 10**9, 'maxPriorityFeePerGas': 10**9}
+    client.estimate_gas.return_value = 123456
+    client.account.sign_transaction.side_effect = lambda tx: Mock(rawTransaction=tx, hash=f"0xhash{tx['nonce']}")
+
+    sent = []
+
+    def send_raw_transaction(raw):
+        sent.append(raw)
+        return f"0xhash{raw['nonce']}"
+
+    def get_transaction_receipt(tx_hash):
+        nonce = int(tx_hash[len('0xhash'):])
+        status = (receipts or {}).get(nonce, 1)
+        return {'status': status, 'blockNumber': 100 + (nonce - start_nonce) // 3, 'gasUsed': 50000}
+
+    client.w3.eth.get_transaction_count.return_value = start_nonce
+    client.w3.eth.send_raw_transaction.side_effect = send_raw_transaction
+    client.w3.eth.get_transaction_receipt.side_effect = get_transaction_receipt
+    client.sent = sent
+    return client
+
+
+def make_config():
+    config = Mock()
+    config.UNISWAP_V3_POSITION_MANAGER = '0xPositionManager'
+    config.MAX_GAS_LIMIT = 500000
+    config.MULTICALL_GAS_LIMIT = 1500000
+    config.CHAIN_ID = 1
+    config.RECEIPT_POLL_INTERVAL_SECONDS = 0.01
+    config.RECEIPT_TIMEOUT_SECONDS = 2
+    return config
+
+
+class TestNonceManager:
+    """Test local nonce allocation."""
+
+    def test_allocate_reads_chain_once(self):
+        """Consecutive allocations only hit the chain on first use."""
+        w3 = Mock()
+        w3.eth.get_transaction_count.return_value = 5
+        manager = NonceManager(w3, '0xWallet')
+
+        assert manager.allocate(3) == [5, 6, 7]
+        assert manager.allocate(1) == [8]
+        w3.eth.get_transaction_count.assert_called_once_with('0xWallet', 'pending')
+
+    def test_reset_resyncs(self):
+        """After reset the next allocation re-reads the pending nonce."""
+        w3 = Mock()
+        w3.eth.get_transaction_count.side_effect = [5, 9]
+        manager = NonceManager(w3, '0xWallet')
+
+        manager.allocate(2)
+        manager.reset()
+        assert manager.allocate(1) == [9]
+
+    def test_concurrent_first_allocations_sync_once(self):
+        """Threads racing on an unsynced manager never receive the same nonce."""
+        w3 = Mock()
+
+        def slow_count(address, block):
+            time.sleep(0.01)
+            return 5
+        w3.eth.get_transaction_count.side_effect = slow_count
+        manager = NonceManager(w3, '0xWallet')
+        allocated = []
+        threads = [threading.Thread(target=lambda: allocated.extend(manager.allocate(2))) for _ in range(8)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        assert sorted(allocated) == list(range(5, 21))
+        w3.eth.get_transaction_count.assert_called_once()
+
+
+class TestTransactionExecutor:
+    """Test batch submission and receipt tracking."""
+
+    def setup_method(self):
+        self.client = make_client()
+        self.executor = TransactionExecutor(self.client, make_config())
+
+    def test_unwind_steps(self):
+        """Unwind builds decrease -> collect -> burn, skipping decrease for empty positions."""
+        steps = self.executor.build_unwind_steps(42, 1000, deadline=1)
+        assert [s['name'] for s in steps] == ['decreaseLiquidity:42', 'collect:42', 'burn:42']
+        assert steps[1]['data'].startswith('0x' + COLLECT_SELECTOR.hex())
+        assert steps[1]['to'] == '0xPositionManager'
+
+        steps = self.executor.build_unwind_steps(42, 0, deadline=1)
+        assert [s['name'] for s in steps] == ['collect:42', 'burn:42']
+
+    def test_multicall_step_is_estimated_against_multicall_cap(self):
+        """A bundled multicall is one transaction with one gas estimate under its own cap."""
+        calls = [bytes.fromhex(s['data'][2:]) for s in self.executor.build_unwind_steps(1, 1000, deadline=1)]
+        result = self.executor.execute_batch([self.executor.build_multicall_step('rebalance', calls)])
+
+        assert result['success']
+        assert len(self.client.sent) == 1
+        assert self.client.sent[0]['data'].startswith('0x' + MULTICALL_SELECTOR.hex())
+        self.client.estimate_gas.assert_called_once()
+        assert self.client.estimate_gas.call_args.kwargs['max_gas'] == 1500000
+
+    def test_batch_uses_consecutive_nonces_and_single_fee_read(self):
+        """All transactions are pre-signed with sequential nonces and one fee read."""
+        steps = self.executor.build_unwind_steps(1, 1000, deadline=1) + \
+            self.executor.build_unwind_steps(2, 1000, deadline=1)
+        result = self.executor.execute_batch(steps)
+
+        assert result['success']
+        assert [tx['nonce'] for tx in self.client.sent] == [7, 8, 9, 10, 11, 12]
+        self.client.get_fee_params.assert_called_once()
+        assert all(tx['maxFeePerGas'] == 30 * 10**9 for tx in self.client.sent)
+        self.client.w3.eth.get_transaction_count.assert_called_once()
+        assert result['block_span'] == 2
+        assert result['gas_used'] == 6 * 50000
+
+    def test_only_first_step_is_estimated(self):
+        """Dependent steps use per-operation gas defaults instead of eth_estimateGas."""
+        steps = self.executor.build_unwind_steps(1, 1000, deadline=1)
+        self.executor.execute_batch(steps)
+
+        self.client.estimate_gas.assert_called_once()
+        gas = [tx['gas'] for tx in self.client.sent]
+        assert gas == [123456, 150000, 100000]
+
+    def test_revert_marks_failure_and_resets_nonce(self):
+        """A reverted step fails the batch and forces a nonce re-sync."""
+        self.client = make_client(receipts={8: 0})
+        self.executor = TransactionExecutor(self.client, make_config())
+        result = self.executor.execute_batch(self.executor.build_unwind_steps(1, 1000, deadline=1))
+
+        assert not result['success']
+        assert [r['success'] for r in result['steps']] == [True, False, True]
+        assert self.executor.nonce_manager._next_nonce is None
+
+    def test_send_failure_stops_remaining_steps(self):
+        """Steps after a failed send are not broadcast."""
+        self.client.w3.eth.send_raw_transaction.side_effect = ['0xhash7', Exception('nonce too low')]
+        result = self.executor.execute_batch(self.executor.build_unwind_steps(1, 1000, deadline=1))
+
+        assert not result['success']
+        assert result['steps'][2]['error'] == 'Not submitted'
+        assert self.client.w3.eth.send_raw_transaction.call_count == 2
+
+    def test_already_known_send_counts_as_submitted(self):
+        """A node that already holds the transaction is tracked by the locally computed hash."""
+        send = self.client.w3.eth.send_raw_transaction.side_effect
+        replies = iter([None, ValueError({'code': -32000, 'message': 'already known'}), None])
+
+        def send_raw_transaction(raw):
+            reply = next(replies)
+            if reply is not None:
+                raise reply
+            return send(raw)
+        self.client.w3.eth.send_raw_transaction.side_effect = send_raw_transaction
+        result = self.executor.execute_batch(self.executor.build_unwind_steps(1, 1000, deadline=1))
+
+        assert result['success']
+        assert [r['tx_hash'] for r in result['steps']] == ['0xhash7', '0xhash8', '0xhash9']
+
+    def test_send_with_unknown_outcome_is_still_watched(self):
+        """A send that may have gone out is followed by hash; later steps are held back."""
+        self.client.w3.eth.send_raw_transaction.side_effect = [
+            '0xhash7', SendOutcomeUnknown('eth_sendRawTransaction may have been delivered')]
+        result = self.executor.execute_batch(self.executor.build_unwind_steps(1, 1000, deadline=1))
+
+        assert not result['success']
+        assert result['steps'][1]['success'] and result['steps'][1]['tx_hash'] == '0xhash8'
+        assert result['steps'][2]['error'] == 'Not submitted'
+        assert self.executor.nonce_manager._next_nonce is None
+
+    def test_failed_gas_estimate_or_signing_leaves_no_nonce_gap(self):
+        """A batch that fails before sending does not consume nonces."""
+        self.client.estimate_gas.side_effect = Exception('execution reverted')
+        with pytest.raises(Exception):
+            self.executor.execute_batch(self.executor.build_unwind_steps(1, 1000, deadline=1))
+        assert not self.client.sent and self.executor.nonce_manager._next_nonce is None
+
+        self.client.estimate_gas.side_effect = None
+        self.client.account.sign_transaction.side_effect = Exception('signer unavailable')
+        with pytest.raises(Exception):
+            self.executor.execute_batch(self.executor.build_unwind_steps(1, 1000, deadline=1))
+        assert self.executor.nonce_manager._next_nonce is None
+
+        self.client.account.sign_transaction.side_effect = lambda tx: Mock(rawTransaction=tx, hash=f"0xhash{tx['nonce']}")
+        assert self.executor.execute_batch(self.executor.build_unwind_steps(1, 1000, deadline=1))['success']
+        assert [tx['nonce'] for tx in self.client.sent] == [7, 8, 9]
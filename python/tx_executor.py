@@ -0,0 +1,383 @@
+"""
+AsymmetricLP - Transaction Executor
+Pipelines dependent position-manager transactions (collect/burn/mint) using a
+local nonce allocator so a whole rebalance lands within one or two blocks.
+"""
+import logging
+import threading
+import time
+from concurrent.futures import Future
+from typing import Dict, Any, List, Optional, Callable
+from config import Config
+from latency_metrics import metrics
+from position_calldata import MAX_UINT128, build_unwind_calls, encode_multicall
+from rpc_gateway import SendOutcomeUnknown
+
+logger = logging.getLogger(__name__)
+
+# Per-operation gas limits used for steps that cannot be estimated up front.
+# A dependent step (e.g. burn after decreaseLiquidity) would revert in
+# eth_estimateGas because its predecessor has not been mined yet.
+DEFAULT_GAS_LIMITS = {
+    'decreaseLiquidity': 250000,
+    'collect': 150000,
+    'burn': 100000,
+    'mint': 500000,
+    'multicall': 900000,
+}
+
+# Node replies meaning it already holds this exact signed transaction
+ALREADY_KNOWN_ERRORS = ('already known', 'known transaction', 'alreadyknown')
+
+
+def _signed_hash(signed_txn) -> str:
+    """Hash of a signed transaction, computed locally (no RPC reply needed)"""
+    tx_hash = signed_txn.hash
+    return tx_hash.hex() if hasattr(tx_hash, 'hex') else tx_hash
+
+
+class NonceManager:
+    """
+    Local nonce allocator for a single sending account.
+
+    The nonce is read from the chain once (pending block) and then handed out
+    locally, so back-to-back transactions do not each need an RPC round trip
+    and never race each other for the same nonce.
+    """
+
+    def __init__(self, w3, address: str):
+        """
+        Initialize the nonce manager
+
+        Args:
+            w3: Web3 instance
+            address: Sending account address
+        """
+        self.w3 = w3
+        self.address = address
+        self._lock = threading.Lock()
+        self._next_nonce: Optional[int] = None
+
+    def sync(self) -> int:
+        """
+        Re-read the next nonce from the chain (pending state)
+
+        Returns:
+            Next nonce to be used
+        """
+        with self._lock:
+            self._next_nonce = self.w3.eth.get_transaction_count(self.address, 'pending')
+            logger.debug(f"Nonce synced for {self.address}: {self._next_nonce}")
+            return self._next_nonce
+
+    def allocate(self, count: int = 1) -> List[int]:
+        """
+        Reserve a block of consecutive nonces
+
+        Args:
+            count: Number of nonces to reserve
+
+        Returns:
+            List of reserved nonces in submission order
+        """
+        with self._lock:
+            # Check and sync under one lock: two first allocations must not both read the chain
+            if self._next_nonce is None:
+                self._next_nonce = self.w3.eth.get_transaction_count(self.address, 'pending')
+                logger.debug(f"Nonce synced for {self.address}: {self._next_nonce}")
+            start = self._next_nonce
+            self._next_nonce += count
+            return list(range(start, start + count))
+
+    def reset(self):
+        """Drop the local nonce so the next allocation re-reads it from the chain"""
+        with self._lock:
+            self._next_nonce = None
+
+
+class PendingBatch:
+    """
+    A batch of submitted transactions whose receipts are tracked asynchronously.
+
+    A single background thread polls for all outstanding receipts, so the caller
+    is free to continue (or to wait on the whole batch at once).
+    """
+
+    def __init__(self, w3, steps: List[Dict[str, Any]], tx_hashes: List[Optional[str]],
+                 poll_interval: float, timeout: float):
+        self.w3 = w3
+        self.steps = steps
+        self.tx_hashes = tx_hashes
+        self.futures: List[Future] = [Future() for _ in steps]
+        self.poll_interval = poll_interval
+        self.timeout = timeout
+        self.submitted_at = time.time()
+        self._submitted_ns = time.perf_counter_ns()
+
+        # Steps that were never sent resolve immediately with None
+        for i, tx_hash in enumerate(tx_hashes):
+            if tx_hash is None:
+                self.futures[i].set_result(None)
+
+        self._tracker = threading.Thread(target=self._track_receipts, daemon=True)
+        self._tracker.start()
+
+    def _track_receipts(self):
+        """Poll receipts for every outstanding transaction until mined or timed out"""
+        outstanding = {i: h for i, h in enumerate(self.tx_hashes) if h is not None}
+        deadline = self.submitted_at + self.timeout
+
+        while outstanding and time.time() < deadline:
+            for i, tx_hash in list(outstanding.items()):
+                try:
+                    receipt = self.w3.eth.get_transaction_receipt(tx_hash)
+                except Exception:
+                    # Not mined yet (TransactionNotFound) or transient RPC error
+                    receipt = None
+                if receipt is not None:
+                    metrics.record(f"tx.confirm.{self.steps[i]['name'].split(':')[0]}",
+                                   time.perf_counter_ns() - self._submitted_ns)
+                    self.futures[i].set_result(receipt)
+                    del outstanding[i]
+            if outstanding:
+                time.sleep(self.poll_interval)
+
+        for i, tx_hash in outstanding.items():
+            self.futures[i].set_exception(
+                TimeoutError(f"Receipt for {self.steps[i]['name']} ({tx_hash}) not found after {self.timeout}s")
+            )
+
+    def wait(self) -> List[Dict[str, Any]]:
+        """
+        Block until every transaction in the batch is mined (or times out)
+
+        Returns:
+            One result dict per step, in submission order
+        """
+        results = []
+        for step, tx_hash, future in zip(self.steps, self.tx_hashes, self.futures):
+            if tx_hash is None:
+                results.append({'name': step['name'], 'success': False, 'error': 'Not submitted'})
+                continue
+            try:
+                receipt = future.result()
+                success = receipt['status'] == 1
+                results.append({
+                    'name': step['name'],
+                    'success': success,
+                    'tx_hash': tx_hash,
+                    'receipt': receipt,
+                    'block_number': receipt.get('blockNumber'),
+                    'gas_used': receipt.get('gasUsed', 0),
+                    'error': None if success else 'Transaction failed'
+                })
+            except Exception as e:
+                results.append({'name': step['name'], 'success': False, 'tx_hash': tx_hash, 'error': str(e)})
+        return results
+
+
+class TransactionExecutor:
+    """
+    Builds, pre-signs and submits dependent transactions back-to-back.
+
+    Fee parameters and nonce are fetched once per batch instead of once per
+    transaction, and receipts are awaited together rather than one by one.
+    """
+
+    def __init__(self, client, config: Config = None):
+        """
+        Initialize the executor
+
+        Args:
+            client: UniswapV3Client (provides w3, account and position manager)
+            config: Configuration object
+        """
+        self.client = client
+        self.w3 = client.w3
+        self.config = config or client.config
+        self.nonce_manager = NonceManager(self.w3, client.wallet_address)
+        self.poll_interval = float(getattr(self.config, 'RECEIPT_POLL_INTERVAL_SECONDS', 0.5))
+        self.receipt_timeout = float(getattr(self.config, 'RECEIPT_TIMEOUT_SECONDS', 180))
+
+    def make_step(self, name: str, data, to: str = None, value: int = 0,
+                  gas: Optional[int] = None) -> Dict[str, Any]:
+        """
+        Describe one transaction of a batch
+
+        Args:
+            name: Operation name (used for gas defaults and logging)
+            data: ABI-encoded calldata (hex string or bytes)
+            to: Target contract (defaults to the position manager)
+            value: ETH value to attach
+            gas: Explicit gas limit (defaults to the per-operation limit)
+
+        Returns:
+            Step dictionary accepted by submit_batch
+        """
+        return {
+            'name': name,
+            'to': to or self.config.UNISWAP_V3_POSITION_MANAGER,
+            'data': '0x' + data.hex() if isinstance(data, (bytes, bytearray)) else data,
+            'value': value,
+            'gas': gas
+        }
+
+    def _gas_cap(self, step: Dict[str, Any]) -> int:
+        """Upper gas bound for a step (a multicall bundles several operations)"""
+        if step['name'].split(':')[0] == 'multicall':
+            return self.config.MULTICALL_GAS_LIMIT
+        return self.config.MAX_GAS_LIMIT
+
+    def _gas_limit(self, step: Dict[str, Any], estimate: bool) -> int:
+        """Resolve the gas limit for a step, estimating only when it is safe to do so"""
+        cap = self._gas_cap(step)
+        if step.get('gas'):
+            return min(step['gas'], cap)
+        if estimate:
+            return self.client.estimate_gas({
+                'from': self.client.wallet_address,
+                'to': step['to'],
+                'data': step['data'],
+                'value': step.get('value', 0)
+            }, max_gas=cap)
+        default = DEFAULT_GAS_LIMITS.get(step['name'].split(':')[0], cap)
+        return min(default, cap)
+
+    def submit_batch(self, steps: List[Dict[str, Any]], estimate_first: bool = True) -> PendingBatch:
+        """
+        Pre-sign and submit a batch of dependent transactions back-to-back
+
+        Only the first step is gas-estimated (later steps depend on state the
+        earlier ones create). If a send fails part-way, the remaining steps are
+        not sent and the local nonce is re-synced from the chain.
+
+        Args:
+            steps: Steps created with make_step, in execution order
+            estimate_first: Whether to estimate gas for the first step
+
+        Returns:
+            PendingBatch tracking the receipts
+        """
+        if not steps:
+            return PendingBatch(self.w3, [], [], self.poll_interval, self.receipt_timeout)
+
+        fee_params = self.client.get_fee_params()
+        # Gas is resolved before any nonce is reserved, so a failed estimate leaves no gap
+        gas_limits = [self._gas_limit(step, estimate=(estimate_first and i == 0)) for i, step in enumerate(steps)]
+        nonces = self.nonce_manager.allocate(len(steps))
+
+        # Sign everything before the first send so submissions go out back-to-back
+        signed = []
+        try:
+            for step, gas, nonce in zip(steps, gas_limits, nonces):
+                transaction = {
+                    'from': self.client.wallet_address,
+                    'to': step['to'],
+                    'data': step['data'],
+                    'value': step.get('value', 0),
+                    'gas': gas,
+                    'nonce': nonce,
+                    'chainId': self.config.CHAIN_ID,
+                    **fee_params
+                }
+                signed.append(self.client.account.sign_transaction(transaction))
+        except Exception:
+            # None of the reserved nonces were used; re-read before the next batch
+            self.nonce_manager.reset()
+            raise
+
+        tx_hashes: List[Optional[str]] = []
+        failed = False
+        for step, signed_txn in zip(steps, signed):
+            if failed:
+                tx_hashes.append(None)
+                continue
+            try:
+                tx_hash = self.w3.eth.send_raw_transaction(signed_txn.rawTransaction)
+                tx_hashes.append(tx_hash.hex() if hasattr(tx_hash, 'hex') else tx_hash)
+                logger.info(f"Submitted {step['name']}: {tx_hashes[-1]}")
+            except Exception as e:
+                if any(marker in str(e).lower() for marker in ALREADY_KNOWN_ERRORS):
+                    tx_hashes.append(_signed_hash(signed_txn))
+                    logger.info(f"Submitted {step['name']}: {tx_hashes[-1]} (already known to the node)")
+                    continue
+                logger.error(f"Error submitting {step['name']}: {e}")
+                # A send that may have gone out is still watched by its own hash, so if it
+                # lands it is reported as mined rather than as never submitted
+                tx_hashes.append(_signed_hash(signed_txn) if isinstance(e, SendOutcomeUnknown) else None)
+                failed = True
+
+        if failed:
+            # Nonces after the failed step were never used on-chain
+            self.nonce_manager.reset()
+
+        return PendingBatch(self.w3, steps, tx_hashes, self.poll_interval, self.receipt_timeout)
+
+    def execute_batch(self, steps: List[Dict[str, Any]], estimate_first: bool = True,
+                      on_submitted: Optional[Callable[[List[str]], None]] = None) -> Dict[str, Any]:
+        """
+        Submit a batch and wait for all receipts
+
+        Args:
+            steps: Steps created with make_step, in execution order
+            estimate_first: Whether to estimate gas for the first step
+            on_submitted: Called with the broadcast tx hashes before waiting (e.g. to journal them)
+
+        Returns:
+            Dictionary with overall success, per-step results and block span
+        """
+        with metrics.span('tx.submit'):
+            batch = self.submit_batch(steps, estimate_first=estimate_first)
+        if on_submitted:
+            on_submitted([h for h in batch.tx_hashes if h is not None])
+        with metrics.span('tx.receipt_wait'):
+            results = batch.wait()
+
+        # Our own transactions changed pool/position/balance state
+        self.client.state_cache.invalidate()
+
+        blocks = [r['block_number'] for r in results if r.get('block_number') is not None]
+        block_span = (max(blocks) - min(blocks) + 1) if blocks else 0
+        success = bool(results) and all(r['success'] for r in results)
+        if not success:
+            # A reverted step leaves later nonces consumed; re-read before the next batch
+            self.nonce_manager.reset()
+
+        logger.info(f"Batch of {len(steps)} transactions {'succeeded' if success else 'failed'} "
+                    f"across {block_span} block(s) in {time.time() - batch.submitted_at:.2f}s")
+
+        return {
+            'success': success,
+            'steps': results,
+            'block_span': block_span,
+            'gas_used': sum(r.get('gas_used', 0) for r in results)
+        }
+
+    def build_unwind_steps(self, token_id: int, liquidity: int, deadline: int) -> List[Dict[str, Any]]:
+        """
+        Build decreaseLiquidity -> collect -> burn steps for one position
+
+        Args:
+            token_id: NFT token ID of the position
+            liquidity: Position liquidity to remove
+            deadline: Transaction deadline (timestamp)
+
+        Returns:
+            List of steps (decreaseLiquidity is skipped for empty positions)
+        """
+        calls = build_unwind_calls(token_id, liquidity, self.client.wallet_address, deadline)
+        names = (['decreaseLiquidity'] if liquidity > 0 else []) + ['collect', 'burn']
+        return [self.make_step(f'{name}:{token_id}', data) for name, data in zip(names, calls)]
+
+    def build_multicall_step(self, name: str, calls: List[bytes]) -> Dict[str, Any]:
+        """
+        Bundle several position-manager calls into one multicall step
+
+        Args:
+            name: Label appended to 'multicall:' for logging
+            calls: Calldata payloads, executed atomically in order
+
+        Returns:
+            Step dictionary accepted by submit_batch
+        """
+        return self.make_step(f'multicall:{name}', encode_multicall(calls))
@@ -8,6 +8,9 @@ from web3 import Web3
 from eth_account import Account
 from hexbytes import HexBytes
 from config import Config
+from fee_oracle import FeeOracle
+from state_cache import StateCache
+from rpc_gateway import make_web3
 
 # Set up logging
 logging.basicConfig(level=logging.INFO)
@@ -16,13 +19,23 @@ logger = logging.getLogger(__name__)
 class UniswapV3Client:
     """Client for interacting with Uniswap V3 protocol"""
     
-    def __init__(self, config: Config = None, read_only: bool = False):
-        """Initialize the Uniswap V3 client"""
+    def __init__(self, config: Config = None, read_only: bool = False, w3: Optional[Web3] = None,
+                 state_cache: Optional[StateCache] = None, fee_oracle: Optional[FeeOracle] = None):
+        """
+        Initialize the Uniswap V3 client
+        
+        Args:
+            config: Configuration object
+            read_only: Skip the account and config validation
+            w3: Shared Web3 connection (a new one is opened if None)
+            state_cache: Shared block-versioned cache (one per client if None)
+            fee_oracle: Shared fee oracle (one per client if None and enabled)
+        """
         self.config = config or Config()
         
-        # Initialize Web3 connection
-        self.w3 = Web3(Web3.HTTPProvider(self.config.ETHEREUM_RPC_URL))
-        if not self.w3.is_connected():
+        # Initialize Web3 connection through the shared RPC gateway (the orchestrator shares one across clients)
+        self.w3 = w3 or make_web3(self.config)
+        if w3 is None and not self.w3.is_connected():
             raise ConnectionError("Failed to connect to Ethereum network")
         
         # Initialize account only if not in read-only mode
@@ -49,8 +62,14 @@ class UniswapV3Client:
         self.position_manager_address = self.config.UNISWAP_V3_POSITION_MANAGER
         self.router_address = self.config.UNISWAP_V3_ROUTER
         
-        # Cache for token decimals
-        self.token_decimals_cache = {}
+        # Block-versioned cache for contract reads (decimals, pools, positions)
+        self.state_cache = state_cache or StateCache(self.w3, self.config)
+        
+        # Background EIP-1559 fee oracle (started by the rebalancer's monitoring loop)
+        if fee_oracle is not None:
+            self.fee_oracle = fee_oracle
+        else:
+            self.fee_oracle = FeeOracle(self.w3, self.config) if self.config.FEE_ORACLE_ENABLED else None
         
         # Contract ABIs (simplified versions)
         self.position_manager_abi = self._get_position_manager_abi()
@@ -134,6 +153,15 @@ class UniswapV3Client:
                 "stateMutability": "view",
                 "type": "function"
             },
+            {
+                "inputs": [
+                    {"internalType": "uint256", "name": "tokenId", "type": "uint256"}
+                ],
+                "name": "burn",
+                "outputs": [],
+                "stateMutability": "payable",
+                "type": "function"
+            },
             {
                 "inputs": [
                     {"internalType": "uint256", "name": "tokenId", "type": "uint256"},
@@ -204,6 +232,15 @@ class UniswapV3Client:
                 ],
                 "stateMutability": "view",
                 "type": "function"
+            },
+            {
+                "inputs": [],
+                "name": "liquidity",
+                "outputs": [
+                    {"internalType": "uint128", "name": "", "type": "uint128"}
+                ],
+                "stateMutability": "view",
+                "type": "function"
             }
         ]
     
@@ -250,6 +287,17 @@ class UniswapV3Client:
             }
         ]
     
+    def on_new_head(self, header: Dict[str, Any]):
+        """
+        New-head hook for block subscriptions: advances the state cache and fee oracle
+        
+        Args:
+            header: Block header (needs 'number')
+        """
+        self.state_cache.on_new_block(header['number'])
+        if self.fee_oracle:
+            self.fee_oracle.on_new_head(header)
+    
     def get_pool_address(self, token0: str, token1: str, fee: int) -> str:
         """Get the pool address for a given token pair and fee tier"""
         try:
@@ -257,7 +305,12 @@ class UniswapV3Client:
             token0_checksummed = self.w3.to_checksum_address(token0)
             token1_checksummed = self.w3.to_checksum_address(token1)
             
-            pool_address = self.factory.functions.getPool(token0_checksummed, token1_checksummed, fee).call()
+            # Pool addresses never change once deployed
+            pool_address = self.state_cache.get(
+                self.factory_address, 'getPool', (token0_checksummed, token1_checksummed, fee),
+                lambda: self.factory.functions.getPool(token0_checksummed, token1_checksummed, fee).call(),
+                mutable=False
+            )
             if pool_address == "0x0000000000000000000000000000000000000000":
                 raise ValueError(f"No pool found for tokens {token0}/{token1} with fee {fee}")
             return pool_address
@@ -276,10 +329,6 @@ class UniswapV3Client:
             Number of decimals for the token
         """
         try:
-            # Check cache first
-            if token_address in self.token_decimals_cache:
-                return self.token_decimals_cache[token_address]
-            
             # Ensure address is checksummed
             token_address_checksummed = self.w3.to_checksum_address(token_address)
             
@@ -289,14 +338,12 @@ class UniswapV3Client:
                 abi=self.erc20_abi
             )
             
-            # Fetch decimals from blockchain
-            decimals = token_contract.functions.decimals().call()
-            
-            # Cache the result
-            self.token_decimals_cache[token_address] = decimals
-            
-            logger.debug(f"Fetched decimals for token {token_address}: {decimals}")
-            return decimals
+            # Decimals are immutable: fetched once, then pinned in the state cache
+            return self.state_cache.get(
+                token_address_checksummed, 'decimals', (),
+                lambda: token_contract.functions.decimals().call(),
+                mutable=False
+            )
             
         except Exception as e:
             logger.error(f"Error fetching decimals for token {token_address}: {e}")
@@ -321,16 +368,22 @@ class UniswapV3Client:
             Dictionary with token information
         """
         try:
+            # Same checksummed key as get_token_decimals, whatever the caller's casing
+            token_address = self.w3.to_checksum_address(token_address)
+            
             # Create ERC20 contract instance
             token_contract = self.w3.eth.contract(
                 address=token_address,
                 abi=self.erc20_abi
             )
             
-            # Fetch token information
-            decimals = token_contract.functions.decimals().call()
-            symbol = token_contract.functions.symbol().call()
-            name = token_contract.functions.name().call()
+            # Token metadata is immutable
+            decimals = self.get_token_decimals(token_address)
+            symbol, name = self.state_cache.get(
+                token_address, 'symbol_name', (),
+                lambda: (token_contract.functions.symbol().call(), token_contract.functions.name().call()),
+                mutable=False
+            )
             
             return {
                 'address': token_address,
@@ -348,13 +401,22 @@ class UniswapV3Client:
                 'name': 'Unknown Token'
             }
     
+    def get_pool_liquidity(self, pool_address: str) -> int:
+        """Get the pool's current in-range liquidity"""
+        pool = self.w3.eth.contract(address=pool_address, abi=self.pool_abi)
+        return self.state_cache.get(pool_address, 'liquidity', (), lambda: pool.functions.liquidity().call())
+    
     def get_pool_info(self, pool_address: str) -> Dict[str, Any]:
         """Get current pool information"""
         try:
             pool = self.w3.eth.contract(address=pool_address, abi=self.pool_abi)
-            slot0 = pool.functions.slot0().call()
-            token0 = pool.functions.token0().call()
-            token1 = pool.functions.token1().call()
+            # Token order is fixed at deployment; slot0 changes per block
+            token0, token1 = self.state_cache.get(
+                pool_address, 'tokens', (),
+                lambda: (pool.functions.token0().call(), pool.functions.token1().call()),
+                mutable=False
+            )
+            slot0 = self.state_cache.get(pool_address, 'slot0', (), lambda: pool.functions.slot0().call())
             
             return {
                 'pool_address': pool_address,
@@ -375,7 +437,10 @@ class UniswapV3Client:
     def get_position_info(self, token_id: int) -> Dict[str, Any]:
         """Get information about a specific position"""
         try:
-            position = self.position_manager.functions.positions(token_id).call()
+            position = self.state_cache.get(
+                self.position_manager_address, 'positions', (token_id,),
+                lambda: self.position_manager.functions.positions(token_id).call()
+            )
             return {
                 'token_id': token_id,
                 'nonce': position[0],
@@ -395,8 +460,29 @@ class UniswapV3Client:
             logger.error(f"Error getting position info: {e}")
             raise
     
+    def get_fee_params(self) -> Dict[str, int]:
+        """
+        Fee fields for a new transaction
+        
+        Served from the fee oracle snapshot when available (no RPC on the hot
+        path), otherwise a legacy gasPrice read from the network.
+        
+        Returns:
+            {'maxFeePerGas', 'maxPriorityFeePerGas'} or {'gasPrice'}
+        """
+        if self.fee_oracle:
+            fee_params = self.fee_oracle.fee_params()
+            if fee_params:
+                return fee_params
+        return {'gasPrice': self.get_gas_price()}
+    
     def get_gas_price(self) -> int:
         """Get current gas price dynamically from the network"""
+        if self.fee_oracle:
+            snapshot = self.fee_oracle.snapshot()
+            if snapshot:
+                return snapshot.max_fee_per_gas
+        
         try:
             # Try to get gas price from the network
             gas_price = self.w3.eth.gas_price
@@ -445,11 +531,12 @@ class UniswapV3Client:
         logger.info(f"Gas price with {buffer_percentage*100}% buffer: {buffered_price} wei")
         return buffered_price
     
-    def estimate_gas(self, transaction: Dict[str, Any]) -> int:
-        """Estimate gas for a transaction"""
+    def estimate_gas(self, transaction: Dict[str, Any], max_gas: Optional[int] = None) -> int:
+        """Estimate gas for a transaction, capped at max_gas (defaults to MAX_GAS_LIMIT)"""
+        cap = max_gas or self.config.MAX_GAS_LIMIT
         try:
             gas_estimate = self.w3.eth.estimate_gas(transaction)
-            return min(gas_estimate, self.config.MAX_GAS_LIMIT)
+            return min(gas_estimate, cap)
         except Exception as e:
             logger.error(f"Error estimating gas: {e}")
-            return self.config.MAX_GAS_LIMIT
+            return cap
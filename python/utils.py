@@ -116,6 +116,38 @@ class UniswapV3Utils:
             # Both tokens needed (simplified)
             return amount0, amount1
     
+    @staticmethod
+    def get_amounts_for_liquidity(
+        liquidity: int,
+        sqrt_price_x96: int,
+        tick_lower: int,
+        tick_upper: int
+    ) -> Tuple[int, int]:
+        """
+        Token amounts a position's liquidity is worth at the given pool price
+
+        Args:
+            liquidity: Position liquidity
+            sqrt_price_x96: Current pool sqrtPriceX96
+            tick_lower: Lower tick bound
+            tick_upper: Upper tick bound
+
+        Returns:
+            Tuple of (amount0, amount1) in raw units, rounded down
+        """
+        q96 = 2 ** 96
+        sqrt_lower = int(math.sqrt(1.0001 ** tick_lower) * q96)
+        sqrt_upper = int(math.sqrt(1.0001 ** tick_upper) * q96)
+        sqrt_price = min(max(sqrt_price_x96, sqrt_lower), sqrt_upper)
+
+        amount0 = 0
+        amount1 = 0
+        if sqrt_price < sqrt_upper:
+            amount0 = (liquidity * q96 * (sqrt_upper - sqrt_price)) // (sqrt_upper * sqrt_price)
+        if sqrt_price > sqrt_lower:
+            amount1 = (liquidity * (sqrt_price - sqrt_lower)) // q96
+        return amount0, amount1
+
     @staticmethod
     def format_token_amount(amount: int, decimals: int, symbol: str = "") -> str:
         """
@@ -1,136 +1,104 @@
 #!/usr/bin/env python3
 """
-AsymmetricLP - 0MQ Inventory Subscriber Example
-Demonstrates how to receive inventory data from AsymmetricLP
+AsymmetricLP - Inventory Subscriber Example
+Demonstrates how to receive the binary inventory feed from AsymmetricLP,
+either over 0MQ or from the same-host shared-memory ring.
+
+Usage:
+    python zmq_subscriber_example.py                          # tcp://127.0.0.1:5555
+    python zmq_subscriber_example.py tcp://10.0.0.5:5555
+    python zmq_subscriber_example.py --shm /dev/shm/asymmetric_lp_ring
 """
-import json
-import zmq
+import sys
 import time
-from datetime import datetime
+from inventory_schema import (
+    decode_message, InventoryMessage, RebalanceMessage, BandsMessage, ErrorMessage
+)
 
-def main():
-    """Main subscriber loop"""
-    # Create 0MQ context and socket
+
+class GapDetector:
+    """Reports missed sequence numbers (e.g. a slow subscriber hitting the HWM)"""
+
+    def __init__(self):
+        self.last_seq = None
+        self.missed = 0
+
+    def check(self, seq: int):
+        if self.last_seq is not None and seq != self.last_seq + 1:
+            self.missed += seq - self.last_seq - 1
+            print(f"⚠️  Sequence gap: {self.last_seq} -> {seq} ({self.missed} missed so far)")
+        self.last_seq = seq
+
+
+def handle(payload: bytes, gaps: GapDetector):
+    """Decode one payload and print it with its end-to-end latency"""
+    envelope = decode_message(payload)
+    latency_us = (time.time_ns() - envelope.publish_ts_ns) / 1000
+    gaps.check(envelope.seq)
+    message = envelope.message
+    prefix = f"[seq {envelope.seq} | {latency_us:.1f}µs]"
+
+    if isinstance(message, InventoryMessage):
+        print(f"📊 {prefix} Inventory: A={message.token_a_balance:.6f} B={message.token_b_balance:.6f} "
+              f"spot={message.spot_price:.6f} vol={message.volatility:.4f} "
+              f"ranges={message.range_a_pct:.2f}%/{message.range_b_pct:.2f}%")
+    elif isinstance(message, RebalanceMessage):
+        print(f"🔄 {prefix} Rebalance {message.token_a_symbol}/{message.token_b_symbol}: "
+              f"spot={message.spot_price:.6f} ratio {message.old_ratio:.3f} -> {message.new_ratio:.3f} "
+              f"fees={message.fee_a:.6f}/{message.fee_b:.6f} gas={message.gas_used:,}")
+    elif isinstance(message, BandsMessage):
+        print(f"📐 {prefix} Bands: A=[{message.tick_lower_a}, {message.tick_upper_a}] "
+              f"B=[{message.tick_lower_b}, {message.tick_upper_b}] spot={message.spot_price:.6f}")
+    elif isinstance(message, ErrorMessage):
+        print(f"🚨 {prefix} Error {message.error_type}: {message.message}")
+
+
+def run_zmq(endpoint: str):
+    """Subscribe to every topic over 0MQ"""
+    import zmq
     context = zmq.Context()
     socket = context.socket(zmq.SUB)
-    
-    # Connect to publisher
-    socket.connect("tcp://localhost:5555")
-    
-    # Subscribe to all topics
+    socket.connect(endpoint)
     socket.setsockopt(zmq.SUBSCRIBE, b"")
-    
-    print("🔗 Connected to AsymmetricLP inventory publisher")
-    print("📡 Listening for inventory updates...")
-    print("=" * 80)
-    
+    print(f"🔗 Connected to AsymmetricLP inventory publisher at {endpoint}")
+
+    gaps = GapDetector()
     try:
         while True:
-            # Receive message
-            message = socket.recv_string()
-            
-            # Parse topic and data
-            topic, data_json = message.split(' ', 1)
-            data = json.loads(data_json)
-            
-            # Print based on topic
-            if topic == "inventory_update":
-                print_inventory_update(data)
-            elif topic == "rebalance_event":
-                print_rebalance_event(data)
-            elif topic == "error_event":
-                print_error_event(data)
-            else:
-                print(f"📨 Unknown topic: {topic}")
-                print(f"Data: {json.dumps(data, indent=2)}")
-            
-            print("-" * 80)
-            
-    except KeyboardInterrupt:
-        print("\n👋 Disconnecting...")
+            _topic, payload = socket.recv_multipart()
+            handle(payload, gaps)
     finally:
         socket.close()
         context.term()
 
-def print_inventory_update(data):
-    """Print inventory update data"""
-    timestamp = data['timestamp']
-    tokens = data['tokens']
-    inventory = data['inventory']
-    notionals = data['notionals']
-    
-    print(f"📊 Inventory Update - {timestamp}")
-    print(f"   Pair: {tokens['token_a']['symbol']}/{tokens['token_b']['symbol']}")
-    print(f"   Chain: {data['chain']} (ID: {data['chain_id']})")
-    print()
-    print(f"💰 Token Balances:")
-    print(f"   {tokens['token_a']['symbol']}: {tokens['token_a']['balance']:.6f} "
-          f"(${tokens['token_a']['usd_value']:.2f})")
-    print(f"   {tokens['token_b']['symbol']}: {tokens['token_b']['balance']:.6f} "
-          f"(${tokens['token_b']['usd_value']:.2f})")
-    print()
-    print(f"📈 Inventory Metrics:")
-    print(f"   Current Ratio: {inventory['current_ratio']:.3f}")
-    print(f"   Target Ratio: {inventory['target_ratio']:.3f}")
-    print(f"   Deviation: {inventory['deviation']:.3f}")
-    print(f"   Total Value: ${inventory['total_usd_value']:.2f}")
-    print(f"   Should Rebalance: {inventory['should_rebalance']}")
-    print()
-    print(f"💵 Notionals for CeFi MM:")
-    print(f"   Token A Notional: ${notionals['token_a_notional']:.2f}")
-    print(f"   Token B Notional: ${notionals['token_b_notional']:.2f}")
-    print(f"   Total Notional: ${notionals['total_notional']:.2f}")
-    print(f"   Imbalance USD: ${notionals['imbalance_usd']:.2f}")
-    print(f"   Imbalance %: {notionals['imbalance_percentage']:.2f}%")
-    print()
-    print(f"📊 Market Data:")
-    print(f"   Spot Price: {data['market']['spot_price']:.6f}")
-    print(f"   Volatility: {data['market']['volatility']:.4f}")
-    print(f"   Range A: {tokens['token_a']['range_percentage']:.2f}%")
-    print(f"   Range B: {tokens['token_b']['range_percentage']:.2f}%")
-
-def print_rebalance_event(data):
-    """Print rebalance event data"""
-    timestamp = data['timestamp']
-    tokens = data['tokens']
-    rebalance = data['rebalance']
-    
-    print(f"🔄 Rebalance Event - {timestamp}")
-    print(f"   Pair: {tokens['token_a_symbol']}/{tokens['token_b_symbol']}")
-    print(f"   Chain: {data['chain']} (ID: {data['chain_id']})")
-    print()
-    print(f"📊 Rebalance Details:")
-    print(f"   Spot Price: {rebalance['spot_price']:.6f}")
-    print(f"   Old Ratio: {rebalance['old_inventory_ratio']:.3f}")
-    print(f"   New Ratio: {rebalance['new_inventory_ratio']:.3f}")
-    print(f"   Ratio Change: {rebalance['ratio_change']:.3f}")
-    print(f"   Gas Used: {rebalance['gas_used']:,}")
-    print()
-    if data['fees']:
-        print(f"💰 Fees Collected:")
-        for token, amount in data['fees'].items():
-            print(f"   {token}: {amount:.6f}")
-    print()
-    print(f"📊 New Ranges:")
-    for token, range_pct in data['ranges'].items():
-        print(f"   {token}: {range_pct:.2f}%")
-
-def print_error_event(data):
-    """Print error event data"""
-    timestamp = data['timestamp']
-    error = data['error']
-    
-    print(f"🚨 Error Event - {timestamp}")
-    print(f"   Chain: {data['chain']} (ID: {data['chain_id']})")
-    print()
-    print(f"❌ Error Details:")
-    print(f"   Type: {error['type']}")
-    print(f"   Message: {error['message']}")
-    print()
-    if error['context']:
-        print(f"📋 Context:")
-        for key, value in error['context'].items():
-            print(f"   {key}: {value}")
+
+def run_shm(path: str):
+    """Busy-poll the shared-memory ring"""
+    from inventory_publisher import ShmRingReader
+    reader = ShmRingReader(path)
+    print(f"🔗 Attached to AsymmetricLP shared-memory ring at {path}")
+
+    gaps = GapDetector()
+    try:
+        while True:
+            for payload in reader.poll():
+                handle(payload, gaps)
+            time.sleep(0.0001)
+    finally:
+        reader.close()
+
+
+def main():
+    """Main subscriber loop"""
+    args = sys.argv[1:]
+    try:
+        if args[:1] == ['--shm']:
+            run_shm(args[1] if len(args) > 1 else '/dev/shm/asymmetric_lp_ring')
+        else:
+            run_zmq(args[0] if args else 'tcp://127.0.0.1:5555')
+    except KeyboardInterrupt:
+        print("\n👋 Disconnecting...")
+
 
 if __name__ == "__main__":
     main()